@@ -331,7 +331,25 @@ Bitmap *SpriteCache::LoadSprite(sprkey_t index, bool lock)
         RemapSpriteToPlaceholder(index);
         return nullptr;
     }
+    return InitLoadedSprite(index, image, lock);
+}
 
+bool SpriteCache::SetPreloadedSprite(sprkey_t index, std::unique_ptr<Bitmap> image)
+{
+    assert(index >= 0); // out of positive range indexes are valid to fail
+    assert(image);
+    if (!image || index < 0 || (size_t)index >= _spriteData.size())
+        return false;
+    // The slot might have been reassigned, or loaded in the normal way,
+    // while this image was being read
+    if (!_spriteData[index].IsAssetSprite() || _spriteData[index].IsError() ||
+        ResourceCache::Exists(index))
+        return false;
+    return InitLoadedSprite(index, image.release(), false) != nullptr;
+}
+
+Bitmap *SpriteCache::InitLoadedSprite(sprkey_t index, Bitmap *image, bool lock)
+{
     // Let the external user convert this sprite's image for their needs
     image = _callbacks.InitSprite(index, image, _sprInfos[index].Flags);
     if (!image)
@@ -376,7 +394,8 @@ void SpriteCache::InitNullSprite(sprkey_t index)
     _spriteData[index] = SpriteData();
 }
 
-int SpriteCache::SaveToFile(const String &filename, int store_flags, SpriteCompression compress, SpriteFileIndex &index)
+int SpriteCache::SaveToFile(const String &filename, int store_flags, SpriteCompression compress,
+    SpriteFileIndex &index, size_t num_threads)
 {
     // Gather a list of sprites;
     // the list contains pairs, where first element tells whether the sprites
@@ -393,7 +412,7 @@ int SpriteCache::SaveToFile(const String &filename, int store_flags, SpriteCompr
             (image || _spriteData[i].IsAssetSprite()),
             image.get()));
     }
-    return SaveSpriteFile(filename, sprites, &_file, store_flags, compress, index);
+    return SaveSpriteFile(filename, sprites, &_file, store_flags, compress, index, num_threads);
 }
 
 HError SpriteCache::InitFile(std::unique_ptr<Stream> &&sprite_file,
@@ -405,7 +424,19 @@ HError SpriteCache::InitFile(std::unique_ptr<Stream> &&sprite_file,
     HError err = _file.OpenFile(std::move(sprite_file), std::move(index_file), metrics);
     if (!err)
         return err;
+    InitSpriteInfos(metrics);
+    return HError::None();
+}
+
+void SpriteCache::InitFile(SpriteFile &&file, const std::vector<Size> &metrics)
+{
+    Reset();
+    _file = std::move(file);
+    InitSpriteInfos(metrics);
+}
 
+void SpriteCache::InitSpriteInfos(const std::vector<Size> &metrics)
+{
     // Initialize sprite infos
     size_t newsize = metrics.size();
     _sprInfos.resize(newsize);
@@ -426,7 +457,6 @@ HError SpriteCache::InitFile(std::unique_ptr<Stream> &&sprite_file,
             InitNullSprite(i);
         }
     }
-    return HError::None();
 }
 
 void SpriteCache::DetachFile()
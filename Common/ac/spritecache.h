@@ -88,8 +88,13 @@ public:
     // Loads sprite reference information and inits sprite stream
     HError      InitFile(std::unique_ptr<Stream> &&sprite_file,
                          std::unique_ptr<Stream> &&index_file);
-    // Saves current cache contents to the file
-    int         SaveToFile(const String &filename, int store_flags, SpriteCompression compress, SpriteFileIndex &index);
+    // Inits sprite references from the sprite file which was already opened
+    // elsewhere, using the metrics it reported
+    void        InitFile(SpriteFile &&file, const std::vector<Size> &metrics);
+    // Saves current cache contents to the file;
+    // num_threads tells how many threads may be used for preparing sprites (0 = all available)
+    int         SaveToFile(const String &filename, int store_flags, SpriteCompression compress,
+                           SpriteFileIndex &index, size_t num_threads = 1);
     // Closes an active sprite file stream
     void        DetachFile();
 
@@ -126,6 +131,11 @@ public:
     // Loads sprite using SpriteFile if such index is known,
     // frees the space if cache size reaches the limit
     void        PrecacheSprite(sprkey_t index);
+    // Puts a sprite image which was read from the asset file elsewhere into the cache,
+    // as if it was loaded by the cache itself; this lets load sprites in advance
+    // using a separate SpriteFile. The image is dropped if the slot is no longer
+    // an asset sprite, or has got loaded already. Returns if the image was accepted.
+    bool        SetPreloadedSprite(sprkey_t index, std::unique_ptr<Bitmap> image);
     // Loads the sprite if necessary and returns a *copy* of bitmap, passing
     // ownership to the caller. Skips storing the sprite in the cache
     // (unless it was already there).
@@ -173,8 +183,12 @@ protected:
     size_t CalcSize(const std::unique_ptr<Bitmap> &item) override;
 
 private:
+    // Initializes sprite infos and slots from the sprite file's metrics
+    void        InitSpriteInfos(const std::vector<Size> &metrics);
     // Load sprite from game resource and put into the cache
     Bitmap *    LoadSprite(sprkey_t index, bool lock = false);
+    // Runs the sprite init callbacks over the loaded image and puts it into the cache
+    Bitmap *    InitLoadedSprite(sprkey_t index, Bitmap *image, bool lock);
     // Remap the given index to the sprite 0
     void        RemapSpriteToPlaceholder(sprkey_t index);
     // Initialize the empty sprite slot
@@ -14,6 +14,7 @@
 #include "ac/spritefile.h"
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <time.h>
 #include "core/assetmanager.h"
 #include "gfx/bitmap.h"
@@ -21,6 +22,7 @@
 #include "util/file.h"
 #include "util/memory_compat.h"
 #include "util/memorystream.h"
+#include "util/threadpool.h"
 
 namespace AGS
 {
@@ -537,20 +539,12 @@ static sprkey_t FindTopmostSprite(const std::vector<std::pair<bool, Bitmap*>> &s
     return topmost;
 }
 
-int SaveSpriteFile(const String &save_to_file,
-    const std::vector<std::pair<bool, Bitmap*>> &sprites,
-    SpriteFile *read_from_file,
-    int store_flags, SpriteCompression compress, SpriteFileIndex &index)
+// Writes all the sprites using the given writer, which should be already initialized
+template <typename TWriter>
+static void WriteSpriteSet(TWriter &writer,
+    const std::vector<std::pair<bool, Bitmap*>> &sprites, sprkey_t lastslot,
+    SpriteFile *read_from_file, int store_flags, SpriteCompression compress)
 {
-    std::unique_ptr<Stream> output(File::CreateFile(save_to_file));
-    if (output == nullptr)
-        return -1;
-
-    sprkey_t lastslot = FindTopmostSprite(sprites);
-    SpriteFileWriter writer(std::move(output));
-    writer.Begin(store_flags, compress, lastslot);
-
-    std::unique_ptr<Bitmap> temp_bmp; // for disposing temp sprites
     std::vector<uint8_t> membuf; // for loading raw sprite data
 
     const bool diff_compress =
@@ -567,24 +561,21 @@ int SaveSpriteFile(const String &save_to_file,
         }
 
         Bitmap *image = sprites[i].second;
-        // if compression setting is different, load the sprite into memory
-        // (otherwise we will be able to simply copy bytes from one file to another
-        if ((image == nullptr) && diff_compress)
-        {
-            read_from_file->LoadSprite(i, image);
-            temp_bmp.reset(image);
-        }
-
         // if managed to load an image - save it according the new compression settings
         if (image != nullptr)
         {
             writer.WriteBitmap(image);
             continue;
         }
+        // if compression setting is different, load the sprite into memory
+        // (otherwise we will be able to simply copy bytes from one file to another
         else if (diff_compress)
         {
-            // sprite doesn't exist
-            writer.WriteEmptySlot();
+            read_from_file->LoadSprite(i, image);
+            if (image != nullptr)
+                writer.WriteBitmap(std::unique_ptr<Bitmap>(image));
+            else // sprite doesn't exist
+                writer.WriteEmptySlot();
             continue;
         }
 
@@ -600,8 +591,33 @@ int SaveSpriteFile(const String &save_to_file,
         writer.WriteRawData(hdr, &membuf[0], membuf.size());
     }
     writer.Finalize();
+}
+
+int SaveSpriteFile(const String &save_to_file,
+    const std::vector<std::pair<bool, Bitmap*>> &sprites,
+    SpriteFile *read_from_file,
+    int store_flags, SpriteCompression compress, SpriteFileIndex &index,
+    size_t num_threads)
+{
+    std::unique_ptr<Stream> output(File::CreateFile(save_to_file));
+    if (output == nullptr)
+        return -1;
 
-    index = writer.GetIndex();
+    sprkey_t lastslot = FindTopmostSprite(sprites);
+    if (num_threads == 1)
+    {
+        SpriteFileWriter writer(std::move(output));
+        writer.Begin(store_flags, compress, lastslot);
+        WriteSpriteSet(writer, sprites, lastslot, read_from_file, store_flags, compress);
+        index = writer.GetIndex();
+    }
+    else
+    {
+        ParallelSpriteFileWriter writer(std::move(output), num_threads);
+        writer.Begin(store_flags, compress, lastslot);
+        WriteSpriteSet(writer, sprites, lastslot, read_from_file, store_flags, compress);
+        index = writer.GetIndex();
+    }
     return 0;
 }
 
@@ -663,9 +679,9 @@ void SpriteFileWriter::Begin(int store_flags, SpriteCompression compress, sprkey
     }
 }
 
-void SpriteFileWriter::WriteBitmap(Bitmap *image)
+void SpriteFileWriter::PackBitmap(const Bitmap *image, int store_flags,
+    SpriteCompression compress, SpriteDatPacked &packed)
 {
-    if (!_out) return;
     int bpp = image->GetBPP();
     int w = image->GetWidth();
     int h = image->GetHeight();
@@ -673,13 +689,12 @@ void SpriteFileWriter::WriteBitmap(Bitmap *image)
 
     // (Optional) Handle storage options
     std::vector<uint8_t> indexed_buf;
-    uint32_t palette[256];
     uint32_t pal_count = 0;
     SpriteFormat sformat = kSprFmt_Undefined;
-    if ((_storeFlags & kSprStore_OptimizeForSize) != 0 && (image->GetBPP() > 1))
+    if ((store_flags & kSprStore_OptimizeForSize) != 0 && (image->GetBPP() > 1))
     { // Try to store this sprite as an indexed bitmap
         uint32_t gen_pal_count;
-        if (CreateIndexedBitmap(image, indexed_buf, palette, gen_pal_count) && gen_pal_count > 0)
+        if (CreateIndexedBitmap(image, indexed_buf, packed.Palette, gen_pal_count) && gen_pal_count > 0)
         { // Test the resulting size, and switch if the paletted image is less
             if (im_data.Size > (indexed_buf.size() + gen_pal_count * image->GetBPP()))
             {
@@ -689,14 +704,13 @@ void SpriteFileWriter::WriteBitmap(Bitmap *image)
             }
         }
     }
-    // (Optional) Compress the image data into the temp buffer
-    SpriteCompression compress = kSprCompress_None;
-    if (_compress != kSprCompress_None)
+    // (Optional) Compress the image data into the output buffer
+    packed.Data.clear();
+    if (compress != kSprCompress_None)
     {
         // TODO: rewrite this to only make a choice once the SpriteFile is initialized
         // and use either function ptr or a decompressing stream class object
-        compress = _compress;
-        Stream mems(std::make_unique<VectorStream>(_membuf, kStream_Write));
+        Stream mems(std::make_unique<VectorStream>(packed.Data, kStream_Write));
         bool result;
         switch (compress)
         {
@@ -709,13 +723,31 @@ void SpriteFileWriter::WriteBitmap(Bitmap *image)
         default: assert(!"Unsupported compression type!"); result = false; break;
         }
         // mark to write as a plain byte array
-        im_data = result ? ImBufferCPtr(&_membuf[0], _membuf.size(), 1) : ImBufferCPtr();
+        if (!result)
+            packed.Data.clear();
+        packed.DataBPP = 1;
     }
+    else
+    {
+        packed.Data.assign(im_data.Buf, im_data.Buf + im_data.Size);
+        packed.DataBPP = im_data.BPP;
+    }
+
+    packed.Hdr = SpriteDatHeader(bpp, sformat, pal_count, compress, w, h);
+}
+
+void SpriteFileWriter::WriteBitmap(const Bitmap *image)
+{
+    if (!_out) return;
+    PackBitmap(image, _storeFlags, _compress, _packed);
+    WritePackedData(_packed);
+}
 
-    // Write the final data
-    SpriteDatHeader hdr(bpp, sformat, pal_count, compress, w, h);
-    WriteSpriteData(hdr, im_data.Buf, im_data.Size, im_data.BPP, palette);
-    _membuf.clear();
+void SpriteFileWriter::WritePackedData(const SpriteDatPacked &packed)
+{
+    if (!_out) return;
+    WriteSpriteData(packed.Hdr, packed.Data.empty() ? nullptr : &packed.Data[0],
+        packed.Data.size(), packed.DataBPP, packed.Palette);
 }
 
 static inline void WriteSprHeader(const SpriteDatHeader &hdr, Stream *out)
@@ -796,5 +828,126 @@ void SpriteFileWriter::Finalize()
     _out.reset();
 }
 
+
+// A single sprite slot scheduled for writing
+struct ParallelSpriteFileWriter::Job
+{
+    enum JobType { kEmptySlot, kBitmap, kRawData };
+
+    JobType Type = kEmptySlot;
+    const Bitmap *Image = nullptr; // bitmap to pack
+    std::unique_ptr<Bitmap> OwnedImage; // bitmap owned by the writer
+    SpriteDatPacked Packed; // packed bitmap, or raw data
+    std::future<void> Done; // signals when the packing is complete
+};
+
+ParallelSpriteFileWriter::ParallelSpriteFileWriter(std::unique_ptr<Stream> &&out, size_t num_threads)
+    : _writer(std::move(out))
+    , _pool(new ThreadPool(num_threads))
+{
+    // Let each thread have a few jobs queued, in case some sprites take
+    // notably longer time to compress than the others.
+    _maxPendingJobs = _pool->GetThreadCount() * 4;
+}
+
+ParallelSpriteFileWriter::~ParallelSpriteFileWriter()
+{
+    // The pending jobs reference bitmaps and buffers,
+    // make sure they all are completed before anything is deleted
+    _pool->Wait();
+}
+
+void ParallelSpriteFileWriter::Begin(int store_flags, SpriteCompression compress, sprkey_t last_slot)
+{
+    _storeFlags = store_flags;
+    _compress = compress;
+    _writer.Begin(store_flags, compress, last_slot);
+}
+
+void ParallelSpriteFileWriter::WriteBitmap(const Bitmap *image)
+{
+    std::unique_ptr<Job> job(new Job());
+    job->Type = Job::kBitmap;
+    job->Image = image;
+    PushJob(std::move(job));
+}
+
+void ParallelSpriteFileWriter::WriteBitmap(std::unique_ptr<Bitmap> &&image)
+{
+    std::unique_ptr<Job> job(new Job());
+    job->Type = Job::kBitmap;
+    job->Image = image.get();
+    job->OwnedImage = std::move(image);
+    PushJob(std::move(job));
+}
+
+void ParallelSpriteFileWriter::WriteEmptySlot()
+{
+    std::unique_ptr<Job> job(new Job());
+    job->Type = Job::kEmptySlot;
+    PushJob(std::move(job));
+}
+
+void ParallelSpriteFileWriter::WriteRawData(const SpriteDatHeader &hdr, const uint8_t *data, size_t data_sz)
+{
+    std::unique_ptr<Job> job(new Job());
+    job->Type = Job::kRawData;
+    job->Packed.Hdr = hdr;
+    job->Packed.Data.assign(data, data + data_sz);
+    PushJob(std::move(job));
+}
+
+void ParallelSpriteFileWriter::Finalize()
+{
+    while (!_jobs.empty())
+        WriteFrontJob();
+    _writer.Finalize();
+}
+
+void ParallelSpriteFileWriter::PushJob(std::unique_ptr<Job> &&job)
+{
+    if (job->Type == Job::kBitmap)
+    {
+        Job *pjob = job.get();
+        const int store_flags = _storeFlags;
+        const SpriteCompression compress = _compress;
+        auto pack = [pjob, store_flags, compress]()
+        {
+            SpriteFileWriter::PackBitmap(pjob->Image, store_flags, compress, pjob->Packed);
+            pjob->OwnedImage.reset(); // no longer needed
+        };
+        job->Done = _pool->Submit(pack);
+    }
+    _jobs.push_back(std::move(job));
+
+    // Write out anything that is already prepared, and block if there are too many pending jobs
+    while (!_jobs.empty() &&
+           ((_jobs.size() > _maxPendingJobs) || (_jobs.front()->Type != Job::kBitmap) ||
+            (_jobs.front()->Done.wait_for(std::chrono::seconds(0)) == std::future_status::ready)))
+    {
+        WriteFrontJob();
+    }
+}
+
+void ParallelSpriteFileWriter::WriteFrontJob()
+{
+    std::unique_ptr<Job> job = std::move(_jobs.front());
+    _jobs.pop_front();
+    switch (job->Type)
+    {
+    case Job::kEmptySlot:
+        _writer.WriteEmptySlot();
+        break;
+    case Job::kBitmap:
+        job->Done.get();
+        _writer.WritePackedData(job->Packed);
+        break;
+    case Job::kRawData:
+        _writer.WriteRawData(job->Packed.Hdr,
+            job->Packed.Data.empty() ? nullptr : &job->Packed.Data[0], job->Packed.Data.size());
+        break;
+    }
+}
+
 } // namespace Common
 } // namespace AGS
@@ -16,11 +16,14 @@
 // SpriteFileWriter manages writing sprites into the output stream one by one,
 // accumulating index information, and may therefore be suitable for a variety
 // of situations.
+// ParallelSpriteFileWriter does the same, but prepares and compresses sprites
+// on a pool of worker threads, while still writing them in the strict order.
 //
 //=============================================================================
 #ifndef __AGS_CN_AC__SPRFILE_H
 #define __AGS_CN_AC__SPRFILE_H
 
+#include <deque>
 #include <memory>
 #include <vector>
 #include "core/types.h"
@@ -36,6 +39,7 @@ namespace Common
 {
 
 class Bitmap;
+class ThreadPool;
 
 // TODO: research old version differences
 enum SpriteFileVersion
@@ -118,6 +122,16 @@ struct SpriteDatHeader
           Compress(compress), Width(w), Height(h) {}
 };
 
+// Sprite data prepared for writing into the sprite file:
+// converted to the storage format and compressed if necessary.
+struct SpriteDatPacked
+{
+    SpriteDatHeader Hdr;
+    uint32_t Palette[256]; // palette, if applicable to storage format
+    std::vector<uint8_t> Data; // final pixel data
+    int DataBPP = 1; // element size of the pixel data, for correct byte order
+};
+
 
 // SpriteFile opens a sprite file for reading, reports general information,
 // and lets read sprites in any order.
@@ -194,7 +208,11 @@ public:
     // optionally hint how many sprites will be written.
     void Begin(int store_flags, SpriteCompression compress, sprkey_t last_slot = -1);
     // Writes a bitmap into file, compressing if necessary
-    void WriteBitmap(Bitmap *image);
+    void WriteBitmap(const Bitmap *image);
+    // Writes a bitmap into file and disposes it
+    void WriteBitmap(std::unique_ptr<Bitmap> &&image) { WriteBitmap(image.get()); }
+    // Writes a sprite data previously prepared by PackBitmap
+    void WritePackedData(const SpriteDatPacked &packed);
     // Writes an empty slot marker
     void WriteEmptySlot();
     // Writes a raw sprite data without any additional processing
@@ -202,6 +220,12 @@ public:
     // Finalizes current format; no further writing is possible after this
     void Finalize();
 
+    // Converts bitmap into the sprite data according to the storage flags
+    // and compression type. This does not depend on the writer's state,
+    // and so may be called from any thread.
+    static void PackBitmap(const Bitmap *image, int store_flags,
+        SpriteCompression compress, SpriteDatPacked &packed);
+
 private:
     // Writes prepared image data in a proper file format, following explicit data_bpp rule
     void WriteSpriteData(const SpriteDatHeader &hdr,
@@ -214,8 +238,61 @@ private:
     soff_t _lastSlotPos = -1; // last slot save position in file
     // sprite index accumulated on write for reporting back to user
     SpriteFileIndex _index;
-    // compression buffer
-    std::vector<uint8_t> _membuf;
+    // packed sprite buffer
+    SpriteDatPacked _packed;
+};
+
+
+// ParallelSpriteFileWriter writes a sprite file in a requested format,
+// and has same usage rules as SpriteFileWriter. The difference is that
+// the bitmaps are converted and compressed by a pool of worker threads.
+// The prepared sprites are written to the stream in the order of submission,
+// so the resulting file is identical to the one made by SpriteFileWriter.
+// NOTE: the bitmaps passed by a raw pointer must stay valid until
+// Finalize is called; the writer does not copy them.
+class ParallelSpriteFileWriter
+{
+public:
+    // Constructs the writer using the given number of worker threads;
+    // 0 means use as many threads as the system reports hardware threads.
+    ParallelSpriteFileWriter(std::unique_ptr<Stream> &&out, size_t num_threads = 0);
+    ~ParallelSpriteFileWriter();
+
+    // Get the sprite index, accumulated after write
+    const SpriteFileIndex &GetIndex() const { return _writer.GetIndex(); }
+
+    // Initializes new sprite file format;
+    // store_flags are SpriteStorage;
+    // optionally hint how many sprites will be written.
+    void Begin(int store_flags, SpriteCompression compress, sprkey_t last_slot = -1);
+    // Schedules a bitmap for writing; the bitmap must be kept alive until Finalize
+    void WriteBitmap(const Bitmap *image);
+    // Schedules a bitmap for writing; the writer takes ownership over the bitmap
+    void WriteBitmap(std::unique_ptr<Bitmap> &&image);
+    // Schedules an empty slot marker
+    void WriteEmptySlot();
+    // Schedules a raw sprite data without any additional processing;
+    // the data is copied into the internal buffer
+    void WriteRawData(const SpriteDatHeader &hdr, const uint8_t *data, size_t data_sz);
+    // Waits for all the pending sprites, writes them and finalizes the format;
+    // no further writing is possible after this
+    void Finalize();
+
+private:
+    struct Job;
+    // Schedules a new job, writes out any completed jobs if the queue is full
+    void PushJob(std::unique_ptr<Job> &&job);
+    // Waits for the first job in queue and writes its results
+    void WriteFrontJob();
+
+    SpriteFileWriter _writer;
+    std::unique_ptr<ThreadPool> _pool;
+    int _storeFlags = 0;
+    SpriteCompression _compress = kSprCompress_None;
+    // Jobs in the order of submission
+    std::deque<std::unique_ptr<Job>> _jobs;
+    // Max number of pending jobs, limits the memory used by the prepared data
+    size_t _maxPendingJobs = 0;
 };
 
 
@@ -224,10 +301,13 @@ private:
 // Accepts available sprites as pairs of bool and Bitmap pointer, where boolean value
 // tells if sprite exists and Bitmap pointer may be null;
 // If a sprite's bitmap is missing, it will try reading one from the input file stream.
+// num_threads tells how many threads may be used to prepare sprites for writing:
+// 1 means do everything on the calling thread, 0 means use all hardware threads.
 int SaveSpriteFile(const String &save_to_file,
     const std::vector<std::pair<bool, Bitmap*>> &sprites,
     SpriteFile *read_from_file, // optional file to read missing sprites from
-    int store_flags, SpriteCompression compress, SpriteFileIndex &index);
+    int store_flags, SpriteCompression compress, SpriteFileIndex &index,
+    size_t num_threads = 1);
 // Saves sprite index table in a separate file
 int SaveSpriteIndex(const String &filename, const SpriteFileIndex &index);
 
@@ -0,0 +1,163 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Micro-benchmark of the sprite transform kernels, compared to the Allegro
+// routines which they replace. Prints the average time of each operation,
+// for every supported instruction set and for 1 and all hardware threads.
+//
+// Usage: common_benchmark [sprite size] [iterations]
+//
+//=============================================================================
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <allegro.h>
+#include "gfx/bitmap.h"
+#include "gfx/blitkernels.h"
+#include "gfx/scalekernels.h"
+#include "gfx/transformkernels.h"
+#include "util/threadpool.h"
+
+using namespace AGS::Common;
+
+// Common's Bitmap requires the program to provide a palette color conversion
+void __my_setcolor(int *ctset, int newcol, int /*wantColDep*/)
+{
+    ctset[0] = newcol;
+}
+
+static int Iterations = 20;
+
+// Runs func the number of times, and prints the average time in milliseconds
+static void Measure(const char *name, const std::function<void()> &func)
+{
+    func(); // warm up
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < Iterations; ++i)
+        func();
+    const auto end = std::chrono::steady_clock::now();
+    printf("  %-28s %9.3f ms\n", name,
+        std::chrono::duration<double, std::milli>(end - start).count() / Iterations);
+}
+
+static const uint32_t *GetPixels(const Bitmap *bmp)
+{
+    return reinterpret_cast<const uint32_t*>(bmp->GetData());
+}
+
+static uint32_t *GetPixels(Bitmap *bmp)
+{
+    return reinterpret_cast<uint32_t*>(bmp->GetDataForWriting());
+}
+
+int main(int argc, char *argv[])
+{
+    const int size = (argc > 1) ? std::max(1, atoi(argv[1])) : 512;
+    if (argc > 2)
+        Iterations = std::max(1, atoi(argv[2]));
+    install_allegro(SYSTEM_NONE, &errno, atexit);
+
+    // A sprite with some transparent areas
+    std::unique_ptr<Bitmap> src(BitmapHelper::CreateBitmap(size, size, 32));
+    uint32_t seed = 1;
+    for (int y = 0; y < size; ++y)
+    {
+        uint32_t *row = reinterpret_cast<uint32_t*>(src->GetScanLineForWriting(y));
+        for (int x = 0; x < size; ++x)
+        {
+            seed = seed * 1103515245u + 12345u;
+            row[x] = ((x ^ y) & 0x1F) ? (seed | 0xFF000000) : MASK_COLOR_32;
+        }
+    }
+
+    // Rotation by 30 degrees, and 1.5x upscale
+    const int rot_size = size * 137 / 100;
+    const fixed_t angle = itofix(30 * 256 / 360);
+    const int big_size = size * 3 / 2;
+    std::unique_ptr<Bitmap> rotated(BitmapHelper::CreateBitmap(rot_size, rot_size, 32));
+    std::unique_ptr<Bitmap> resized(BitmapHelper::CreateBitmap(big_size, big_size, 32));
+    std::unique_ptr<Bitmap> flipped(BitmapHelper::CreateBitmap(size, size, 32));
+    uint32_t tint_table[256];
+    for (int i = 0; i < 256; ++i)
+        tint_table[i] = (i << 16) | ((i / 2) << 8) | (i / 4);
+
+    printf("Sprite %d x %d, %d iterations\n", size, size, Iterations);
+    printf("Allegro:\n");
+    Measure("rotate (pivot_sprite)", [&]() {
+        rotated->ClearTransparent();
+        rotated->RotateBlt(src.get(), rot_size / 2, rot_size / 2, size / 2, size / 2, angle); });
+    Measure("resize (stretch_blit)", [&]() {
+        resized->StretchBlt(src.get(), RectWH(0, 0, size, size), RectWH(0, 0, big_size, big_size)); });
+    Measure("flip (draw_sprite_h_flip)", [&]() {
+        flipped->ClearTransparent();
+        flipped->FlipBlt(src.get(), 0, 0, kFlip_Horizontal); });
+
+    std::vector<size_t> thread_counts = { 1u };
+    if (ThreadPool::GetHardwareThreadCount() > 1u)
+        thread_counts.push_back(ThreadPool::GetHardwareThreadCount());
+    for (SimdLevel level : { kSimd_None, kSimd_SSE2, kSimd_AVX2, kSimd_NEON })
+    {
+        if (!BlitKernels::IsSimdSupported(level))
+            continue;
+        BlitKernels::SetSimd(level);
+        for (size_t threads : thread_counts)
+        {
+            ThreadPool pool(threads);
+            auto for_each_rows = [&pool](int rows, const std::function<void(size_t, size_t)> &func) {
+                pool.ParallelFor(0, rows, func, 16); };
+            printf("%s, %zu thread(s):\n", BlitKernels::GetSimdName(level), threads);
+
+            TransformKernels::SpanMap map;
+            Measure("rotate nearest", [&]() {
+                rotated->ClearTransparent();
+                TransformKernels::MapRotation(map, size, size, rot_size, rot_size, rot_size / 2, rot_size / 2,
+                    size / 2, size / 2, angle);
+                for_each_rows(rot_size, [&](size_t y1, size_t y2) {
+                    TransformKernels::DrawNearest(GetPixels(src.get()), src->GetLineLength(), size, size,
+                        GetPixels(rotated.get()), rotated->GetLineLength(), map, y1, y2); }); });
+            Measure("rotate bilinear", [&]() {
+                rotated->ClearTransparent();
+                TransformKernels::MapRotation(map, size, size, rot_size, rot_size, rot_size / 2, rot_size / 2,
+                    size / 2, size / 2, angle);
+                for_each_rows(rot_size, [&](size_t y1, size_t y2) {
+                    TransformKernels::DrawBilinear(GetPixels(src.get()), src->GetLineLength(), size, size,
+                        GetPixels(rotated.get()), rotated->GetLineLength(), map, false, y1, y2); }); });
+            Measure("resize nearest", [&]() {
+                for_each_rows(big_size, [&](size_t y1, size_t y2) {
+                    ScaleKernels::ScaleNearest(GetPixels(src.get()), src->GetLineLength(), size, size,
+                        GetPixels(resized.get()), resized->GetLineLength(), big_size, big_size, y1, y2); }); });
+            Measure("resize bilinear", [&]() {
+                resized->ClearTransparent();
+                TransformKernels::MapScale(map, size, size, big_size, big_size);
+                for_each_rows(big_size, [&](size_t y1, size_t y2) {
+                    TransformKernels::DrawBilinear(GetPixels(src.get()), src->GetLineLength(), size, size,
+                        GetPixels(resized.get()), resized->GetLineLength(), map, false, y1, y2); }); });
+            Measure("flip horizontal", [&]() {
+                for_each_rows(size, [&](size_t y1, size_t y2) {
+                    TransformKernels::Flip(GetPixels(src.get()), src->GetLineLength(),
+                        GetPixels(flipped.get()), flipped->GetLineLength(), size, size, kFlip_Horizontal, y1, y2); }); });
+            Measure("tint", [&]() {
+                for_each_rows(size, [&](size_t y1, size_t y2) {
+                    for (size_t y = y1; y < y2; ++y)
+                        BlitKernels::ValueMapRow(reinterpret_cast<uint32_t*>(flipped->GetScanLineForWriting(y)),
+                            reinterpret_cast<const uint32_t*>(src->GetScanLine(y)), size, tint_table); }); });
+        }
+    }
+    return 0;
+}
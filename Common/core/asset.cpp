@@ -23,6 +23,9 @@ AssetInfo::AssetInfo()
     : LibUid(0)
     , Offset(0)
     , Size(0)
+    , Compression(kAssetCompress_None)
+    , DataSize(0)
+    , FrameSize(0)
 {
 }
 
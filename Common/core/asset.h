@@ -26,6 +26,13 @@ namespace AGS
 namespace Common
 {
 
+// Compression method of a single asset in library
+enum AssetCompression
+{
+    kAssetCompress_None     = 0,
+    kAssetCompress_Deflate  = 1  // deflate, in separately compressed frames
+};
+
 // Information on single asset
 struct AssetInfo
 {
@@ -33,7 +40,10 @@ struct AssetInfo
     String      FileName;   // filename associated with asset
     int32_t     LibUid;     // index of library partition (separate file)
     soff_t      Offset;     // asset's position in library file (in bytes)
-    soff_t      Size;       // asset's size (in bytes)
+    soff_t      Size;       // asset's size in library file (in bytes)
+    AssetCompression Compression; // asset's compression method
+    soff_t      DataSize;   // asset's uncompressed size (in bytes)
+    uint32_t    FrameSize;  // uncompressed size of a compressed frame
 
     AssetInfo();
 };
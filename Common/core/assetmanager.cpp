@@ -14,8 +14,11 @@
 #include "core/assetmanager.h"
 #include <algorithm>
 #include <regex>
+#include "util/compressedframestream.h"
 #include "util/directory.h"
 #include "util/file.h"
+#include "util/mappedfilestream.h"
+#include "util/memory_compat.h"
 #include "util/multifilelib.h"
 #include "util/path.h"
 
@@ -76,6 +79,7 @@ void AssetManager::SetSearchPriority(AssetSearchPriority priority)
     _libsPriority = priority;
     _libsSorter = _libsPriority == kAssetPriorityDir ? SortLibsPriorityDir : SortLibsPriorityLib;
     std::sort(_activeLibs.begin(), _activeLibs.end(), _libsSorter);
+    RebuildAssetIndex();
 }
 
 AssetSearchPriority AssetManager::GetSearchPriority() const
@@ -83,6 +87,13 @@ AssetSearchPriority AssetManager::GetSearchPriority() const
     return _libsPriority;
 }
 
+void AssetManager::SetMemoryMapping(bool on)
+{
+    _memoryMapping = on;
+    for (auto &lib : _libs)
+        UpdateLibMapping(lib.get());
+}
+
 AssetError AssetManager::AddLibrary(const String &path, const AssetLibInfo **out_lib)
 {
     return AddLibrary(path, "", out_lib);
@@ -112,6 +123,7 @@ AssetError AssetManager::AddLibrary(const String &path, const String &filters, c
     lib->Filters = filters.Split(',');
     auto place = std::upper_bound(_activeLibs.begin(), _activeLibs.end(), lib, _libsSorter);
     _activeLibs.insert(place, lib);
+    RebuildAssetIndex();
     if (out_lib)
         *out_lib = lib;
     return kAssetNoError;
@@ -126,6 +138,7 @@ void AssetManager::RemoveLibrary(const String &path)
             auto it_end = std::remove(_activeLibs.begin(), _activeLibs.end(), (*it).get());
             _activeLibs.erase(it_end, _activeLibs.end());
             _libs.erase(it);
+            RebuildAssetIndex();
             return;
         }
     }
@@ -135,6 +148,7 @@ void AssetManager::RemoveAllLibraries()
 {
     _libs.clear();
     _activeLibs.clear();
+    _assetIndex.clear();
 }
 
 size_t AssetManager::GetLibraryCount() const
@@ -149,6 +163,8 @@ const AssetLibInfo *AssetManager::GetLibraryInfo(size_t index) const
 
 bool AssetManager::DoesAssetExist(const String &asset_name, const String &filter) const
 {
+    const auto found = _assetIndex.find(asset_name);
+    const AssetLocations *locations = (found != _assetIndex.end()) ? &found->second : nullptr;
     for (const auto &lib : _activeLibs)
     {
         if (!lib->TestFilter(filter))
@@ -160,13 +176,9 @@ bool AssetManager::DoesAssetExist(const String &asset_name, const String &filter
             if (!filename.IsEmpty())
                 return true;
         }
-        else
+        else if (FindAssetInLib(lib, locations))
         {
-            for (const auto &a : lib->AssetInfos)
-            {
-                if (a.FileName.CompareNoCase(asset_name) == 0)
-                    return true;
-            }
+            return true;
         }
     }
     return false;
@@ -242,6 +254,7 @@ AssetError AssetManager::RegisterAssetLib(const String &path, AssetLibEx *&out_l
         {
             lib->RealLibFiles.push_back(File::FindFileCI(lib->BaseDir, lib->LibFileNames[i]));
         }
+        UpdateLibMapping(lib.get());
     }
 
     out_lib = lib.get();
@@ -249,36 +262,98 @@ AssetError AssetManager::RegisterAssetLib(const String &path, AssetLibEx *&out_l
     return kAssetNoError;
 }
 
+void AssetManager::UpdateLibMapping(AssetLibEx *lib)
+{
+    if (!IsAssetLibFile(lib))
+        return;
+    if (!_memoryMapping)
+    {
+        // the streams that are still open keep their mapping alive
+        lib->MappedFiles.clear();
+        return;
+    }
+    lib->MappedFiles.resize(lib->RealLibFiles.size());
+    for (size_t i = 0; i < lib->RealLibFiles.size(); ++i)
+    {
+        if (!lib->MappedFiles[i] && !lib->RealLibFiles[i].IsEmpty())
+            lib->MappedFiles[i] = MappedFile::Open(lib->RealLibFiles[i]);
+    }
+}
+
+void AssetManager::RebuildAssetIndex()
+{
+    _assetIndex.clear();
+    for (const auto *lib : _activeLibs)
+    {
+        if (!IsAssetLibFile(lib))
+            continue;
+        for (const auto &a : lib->AssetInfos)
+            _assetIndex[a.FileName].emplace_back(lib, &a);
+    }
+}
+
+/* static */ const AssetInfo *AssetManager::FindAssetInLib(const AssetLibEx *lib, const AssetLocations *locations)
+{
+    if (!locations)
+        return nullptr;
+    // Same asset name is normally present in one or few libraries at most
+    for (const auto &loc : *locations)
+    {
+        if (loc.Lib == lib)
+            return loc.Asset;
+    }
+    return nullptr;
+}
+
 std::unique_ptr<Stream> AssetManager::OpenAsset(const String &asset_name, const String &filter) const
 {
+    const auto found = _assetIndex.find(asset_name);
+    const AssetLocations *locations = (found != _assetIndex.end()) ? &found->second : nullptr;
     for (const auto *lib : _activeLibs)
     {
         if (!lib->TestFilter(filter)) continue; // filter does not match
 
         std::unique_ptr<Stream> s;
         if (IsAssetLibDir(lib))
+        {
             s = OpenAssetFromDir(lib, asset_name);
+        }
         else
-            s = OpenAssetFromLib(lib, asset_name);
+        {
+            const AssetInfo *asset = FindAssetInLib(lib, locations);
+            if (asset)
+                s = OpenAssetFromLib(lib, *asset);
+        }
         if (s)
             return s;
     }
     return nullptr;
 }
 
-std::unique_ptr<Stream> AssetManager::OpenAssetFromLib(const AssetLibEx *lib, const String &asset_name) const
+std::unique_ptr<Stream> AssetManager::OpenAssetFromLib(const AssetLibEx *lib, const AssetInfo &asset) const
 {
-    for (const auto &a : lib->AssetInfos)
+    if ((asset.LibUid < 0) || (static_cast<size_t>(asset.LibUid) >= lib->RealLibFiles.size()))
+        return nullptr;
+    std::unique_ptr<Stream> s;
+    if ((static_cast<size_t>(asset.LibUid) < lib->MappedFiles.size()) && lib->MappedFiles[asset.LibUid])
     {
-        if (a.FileName.CompareNoCase(asset_name) == 0)
-        {
-            String libfile = lib->RealLibFiles[a.LibUid];
-            if (libfile.IsEmpty())
-                return nullptr;
-            return File::OpenFile(libfile, a.Offset, a.Offset + a.Size);
-        }
+        s = std::make_unique<Stream>(std::make_unique<MappedFileStream>(
+            lib->MappedFiles[asset.LibUid], asset.Offset, asset.Offset + asset.Size));
     }
-    return nullptr;
+    else
+    {
+        String libfile = lib->RealLibFiles[asset.LibUid];
+        if (libfile.IsEmpty())
+            return nullptr;
+        s = File::OpenFile(libfile, asset.Offset, asset.Offset + asset.Size);
+    }
+    if (!s || (asset.Compression == kAssetCompress_None))
+        return s;
+    // Compressed asset: the stream returns the uncompressed data
+    auto cs = std::make_unique<CompressedFrameStream>(std::move(s), asset.DataSize, asset.FrameSize);
+    if (!cs->IsValid())
+        return nullptr;
+    return std::make_unique<Stream>(std::move(cs));
 }
 
 std::unique_ptr<Stream> AssetManager::OpenAssetFromDir(const AssetLibEx *lib, const String &file_name) const
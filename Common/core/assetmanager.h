@@ -38,8 +38,10 @@
 
 #include <memory>
 #include <functional>
+#include <unordered_map>
 #include "core/asset.h"
 #include "util/stream.h"
+#include "util/string_types.h"
 
 namespace AGS
 {
@@ -47,6 +49,7 @@ namespace Common
 {
 
 struct MultiFileLib;
+class MappedFile;
 
 enum AssetSearchPriority
 {
@@ -87,6 +90,13 @@ public:
     void         SetSearchPriority(AssetSearchPriority priority);
     // Gets current asset search priority
     AssetSearchPriority GetSearchPriority() const;
+    // Sets whether the library files should be mapped into memory;
+    // if enabled, the assets from the libraries are read from the mapped memory,
+    // and opening them does not involve any file operations.
+    // Libraries that fail to map are read from the files as usual.
+    void         SetMemoryMapping(bool on);
+    // Tells whether the library files are mapped into memory
+    bool         GetMemoryMapping() const { return _memoryMapping; }
 
     // Add library location to the list of asset locations
     AssetError   AddLibrary(const String &path, const AssetLibInfo **lib = nullptr);
@@ -122,20 +132,43 @@ private:
     {
         std::vector<String> Filters; // asset filters this library is matching to
         std::vector<String> RealLibFiles; // fixed up library filenames
+        std::vector<std::shared_ptr<MappedFile>> MappedFiles; // library files mapped into memory
 
         bool TestFilter(const String &filter) const;
     };
 
+    // AssetLocation refers to the asset entry in a particular library
+    struct AssetLocation
+    {
+        const AssetLibEx *Lib = nullptr;
+        const AssetInfo *Asset = nullptr;
+
+        AssetLocation() = default;
+        AssetLocation(const AssetLibEx *lib, const AssetInfo *asset)
+            : Lib(lib), Asset(asset) {}
+    };
+    typedef std::vector<AssetLocation> AssetLocations;
+
     // Loads library and registers its contents into the cache
     AssetError  RegisterAssetLib(const String &path, AssetLibEx *&lib);
+    // Maps or unmaps the library files, according to the current setting
+    void        UpdateLibMapping(AssetLibEx *lib);
+    // Rebuilds the asset index, must be called whenever the active libs change
+    void        RebuildAssetIndex();
+    // Finds the asset in the given library, using the asset's index entry
+    static const AssetInfo *FindAssetInLib(const AssetLibEx *lib, const AssetLocations *locations);
 
     // Tries to find asset in the given location, and then opens a stream for reading
-    std::unique_ptr<Stream> OpenAssetFromLib(const AssetLibEx *lib, const String &asset_name) const;
+    std::unique_ptr<Stream> OpenAssetFromLib(const AssetLibEx *lib, const AssetInfo &asset) const;
     std::unique_ptr<Stream> OpenAssetFromDir(const AssetLibEx *lib, const String &asset_name) const;
 
     std::vector<std::unique_ptr<AssetLibEx>> _libs;
     std::vector<AssetLibEx*> _activeLibs;
+    // Asset index: lists the asset's locations among the library files,
+    // in the same order as the active libs are searched
+    std::unordered_map<String, AssetLocations, HashStrNoCase, StrEqNoCase> _assetIndex;
     AssetSearchPriority _libsPriority = kAssetPriorityDir;
+    bool _memoryMapping = false;
     // Sorting function, depends on priority setting
     std::function<bool(const AssetLibInfo*, const AssetLibInfo*)> _libsSorter;
 };
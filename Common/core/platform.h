@@ -200,4 +200,8 @@
     #define DEBUG_SPRITECACHE (0)
 #endif
 
+#if !defined(DEBUG_FRAME_PROFILER)
+    #define DEBUG_FRAME_PROFILER (0)
+#endif
+
 #endif // __AC_PLATFORM_H
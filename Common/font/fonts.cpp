@@ -13,6 +13,7 @@
 //=============================================================================
 #include <algorithm>
 #include <cstdio>
+#include <unordered_map>
 #include <vector>
 #include <alfont.h>
 #include "ac/common.h" // set_our_eip
@@ -55,6 +56,12 @@ struct Font
     Bitmap TextStencil, TextStencilSub;
     Bitmap OutlineStencil, OutlineStencilSub;
 
+    // Cached glyph advances, for measuring the text char by char;
+    // low char codes are kept in array, the rest in a map
+    static const int AdvanceLowCount = 256;
+    std::vector<int> AdvanceLow;
+    std::unordered_map<int, int> AdvanceHigh;
+
     Font() = default;
     Font(Font &&font) = default;
     Font &operator =(Font &&font) = default;
@@ -67,6 +74,33 @@ static std::vector<Font> fonts;
 static std::unique_ptr<TTFFontRenderer> ttfRenderer;
 static std::unique_ptr<WFNFontRenderer> wfnRenderer;
 
+// Memorized result of split_lines, for the texts which are split often,
+// such as speech and labels that are redrawn every frame
+struct SplitLinesMemo
+{
+    size_t Hash = 0u;
+    std::string Text;
+    int Font = -1;
+    int Width = 0;
+    size_t MaxLines = 0u;
+    int UFormat = 0;
+    std::vector<String> Lines;
+};
+static const size_t SplitLinesMemoCount = 32;
+static std::vector<SplitLinesMemo> split_memo;
+static size_t split_memo_next = 0u; // next entry to replace
+
+// Resets all the cached text measurements of this font
+static void font_reset_text_cache(size_t fontNumber)
+{
+    fonts[fontNumber].AdvanceLow.clear();
+    fonts[fontNumber].AdvanceHigh.clear();
+    // the memo may contain results for the fonts which use this one as
+    // an outline, so forget everything
+    split_memo.clear();
+    split_memo_next = 0u;
+}
+
 
 FontInfo::FontInfo()
     : Flags(0)
@@ -94,6 +128,12 @@ void shutdown_font_renderer()
   wfnRenderer.reset();
 }
 
+void font_set_glyph_cache_size(size_t max_bytes)
+{
+  if (ttfRenderer)
+    ttfRenderer->SetGlyphCacheLimit(max_bytes);
+}
+
 void adjust_y_coordinate_for_text(int* ypos, size_t fontnum)
 {
   if (fontnum >= fonts.size() || !fonts[fontnum].Renderer)
@@ -115,6 +155,7 @@ bool is_font_loaded(size_t fontNumber)
 static void font_post_init(size_t fontNumber)
 {
     Font &font = fonts[fontNumber];
+    font_reset_text_cache(fontNumber);
     // If no font height property was provided, then try several methods,
     // depending on which interface is available
     if ((font.Metrics.NominalHeight == 0) && font.Renderer)
@@ -303,6 +344,7 @@ void set_font_outline(size_t font_number, int outline_type,
     fonts[font_number].Info.Outline = outline_type;
     fonts[font_number].Info.AutoOutlineStyle = style;
     fonts[font_number].Info.AutoOutlineThickness = thickness;
+    font_reset_text_cache(font_number);
 }
 
 bool is_font_antialiased(size_t font_number)
@@ -418,8 +460,93 @@ static void unescape_script_string(const char *cstr, std::string &out)
     out.insert(out.end(), cstr, off + 1);
 }
 
+// Tells if the text width in this font may be calculated as a sum of
+// glyph advances: this is true for the built-in renderers, which
+// do not apply kerning; plugins may do anything
+static bool font_has_additive_width(size_t fontNumber)
+{
+    if (fontNumber >= fonts.size() || !fonts[fontNumber].RendererInt)
+        return false;
+    const int outline = fonts[fontNumber].Info.Outline;
+    if (outline < 0) // FONT_OUTLINE_AUTO or FONT_OUTLINE_NONE
+        return true;
+    return (static_cast<size_t>(outline) < fonts.size()) && fonts[outline].RendererInt;
+}
+
+// Gets the width of a single char, caching the result
+static int get_char_advance(size_t fontNumber, int code)
+{
+    Font &font = fonts[fontNumber];
+    int *advance = nullptr;
+    if ((code >= 0) && (code < Font::AdvanceLowCount))
+    {
+        if (font.AdvanceLow.empty())
+            font.AdvanceLow.resize(Font::AdvanceLowCount, -1);
+        advance = &font.AdvanceLow[code];
+    }
+    else
+    {
+        advance = &font.AdvanceHigh.emplace(code, -1).first->second;
+    }
+    if (*advance < 0)
+    {
+        char uch[Utf8::UtfSz + 1]{};
+        usetc(uch, code);
+        *advance = font.Renderer->GetTextWidth(uch, fontNumber);
+    }
+    return *advance;
+}
+
+static size_t hash_text(const char *text)
+{
+    // FNV-1a
+    size_t hash = 2166136261u;
+    for (; *text; ++text)
+        hash = (hash ^ static_cast<uint8_t>(*text)) * 16777619u;
+    return hash;
+}
+
+static size_t split_lines_impl(const char *todis, SplitLines &lines, int wii, int fonnt, size_t max_lines);
+
 // Break up the text into lines
 size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, size_t max_lines) {
+    if (!font_has_additive_width(fonnt))
+        return split_lines_impl(todis, lines, wii, fonnt, max_lines);
+
+    // See if we have split this text recently
+    const size_t hash = hash_text(todis);
+    const int uformat = get_uformat();
+    for (const auto &memo : split_memo)
+    {
+        if ((memo.Hash == hash) && (memo.Font == fonnt) && (memo.Width == wii) &&
+            (memo.MaxLines == max_lines) && (memo.UFormat == uformat) && (memo.Text == todis))
+        {
+            lines.Reset();
+            for (const auto &line : memo.Lines)
+                lines.Add(line.GetCStr());
+            return lines.Count();
+        }
+    }
+
+    split_lines_impl(todis, lines, wii, fonnt, max_lines);
+
+    if (split_memo.size() < SplitLinesMemoCount)
+        split_memo.emplace_back();
+    SplitLinesMemo &memo = split_memo[split_memo_next];
+    split_memo_next = (split_memo_next + 1) % SplitLinesMemoCount;
+    memo.Hash = hash;
+    memo.Text = todis;
+    memo.Font = fonnt;
+    memo.Width = wii;
+    memo.MaxLines = max_lines;
+    memo.UFormat = uformat;
+    memo.Lines.resize(lines.Count());
+    for (size_t i = 0; i < lines.Count(); ++i)
+        memo.Lines[i] = lines[i];
+    return lines.Count();
+}
+
+static size_t split_lines_impl(const char *todis, SplitLines &lines, int wii, int fonnt, size_t max_lines) {
     // NOTE: following hack accomodates for the legacy math mistake in split_lines.
     // It's hard to tell how cruicial it is for the game looks, so research may be needed.
     // TODO: IMHO this should rely not on game format, but script API level, because it
@@ -447,6 +574,13 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
     const char *prev_ptr = scan_ptr; // previous scan pos
     const char *last_whitespace = nullptr; // last found whitespace
 
+    // With the built-in renderers we sum up the glyph advances, instead of
+    // measuring the whole line again after each added char
+    const bool additive = font_has_additive_width(fonnt);
+    const int outline_font = additive ? fonts[fonnt].Info.Outline : FONT_OUTLINE_NONE;
+    const int outline_thick = additive ? 2 * fonts[fonnt].Info.AutoOutlineThickness : 0;
+    int text_width = 0, outline_width = 0; // width of the test buffer
+
     while (true) {
         if (scan_ptr == end_ptr) {
             // end of the text, add the last line if necessary
@@ -470,9 +604,22 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
         } else {
             // copy next character to the test buffer and calculate its width
             char uch[Utf8::UtfSz + 1]{};
-            usetc(uch, ugetxc(&scan_ptr)); // this advances scan_ptr
+            const int code = ugetxc(&scan_ptr); // this advances scan_ptr
+            usetc(uch, code);
             test_buf.append(uch);
-            if (get_text_width_outlined(test_buf.c_str(), fonnt) > wii) {
+            int line_width;
+            if (additive) {
+                text_width += get_char_advance(fonnt, code);
+                if (outline_font >= 0) {
+                    outline_width += get_char_advance(outline_font, code);
+                    line_width = std::max(text_width, outline_width);
+                } else {
+                    line_width = text_width + outline_thick;
+                }
+            } else {
+                line_width = get_text_width_outlined(test_buf.c_str(), fonnt);
+            }
+            if (line_width > wii) {
                 // line is too wide, order the split
                 if (last_whitespace)
                     // revert to the last whitespace
@@ -494,6 +641,7 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
             test_buf.resize(split_at - theline); // cut the buffer at the split index
             lines.Add(test_buf.c_str());
             test_buf.clear();
+            text_width = outline_width = 0;
             // check if too many lines
             if (lines.Count() >= max_lines) {
                 lines[lines.Count() - 1].Append("...");
@@ -644,7 +792,10 @@ void adjust_fonts_for_render_mode(bool aa_mode)
     for (size_t i = 0; i < fonts.size(); ++i)
     {
         if (fonts[i].RendererInt)
+        {
             fonts[i].RendererInt->AdjustFontForAntiAlias(i, aa_mode);
+            font_reset_text_cache(i);
+        }
     }
 }
 
@@ -661,6 +812,7 @@ void wfreefont(size_t fontNumber)
     fonts[fontNumber].Renderer->FreeMemory(fontNumber);
 
   fonts[fontNumber].Renderer = nullptr;
+  font_reset_text_cache(fontNumber);
 }
 
 void free_all_fonts()
@@ -671,4 +823,6 @@ void free_all_fonts()
             fonts[i].Renderer->FreeMemory(i);
     }
     fonts.clear();
+    split_memo.clear();
+    split_memo_next = 0u;
 }
@@ -33,6 +33,8 @@ struct FontMetrics;
 
 void init_font_renderer(AGS::Common::AssetManager *amgr);
 void shutdown_font_renderer();
+// Sets the memory limit for the cache of the TTF glyph images, in bytes
+void font_set_glyph_cache_size(size_t max_bytes);
 void adjust_y_coordinate_for_text(int* ypos, size_t fontnum);
 IAGSFontRenderer* font_replace_renderer(size_t fontNumber, IAGSFontRenderer* renderer);
 IAGSFontRenderer* font_replace_renderer(size_t fontNumber, IAGSFontRenderer2* renderer);
@@ -144,6 +146,8 @@ private:
 
 // Break up the text into lines restricted by the given width;
 // returns number of lines, or 0 if text cannot be split well to fit in this width
+// NOTE: the results for the few recently split texts are cached, and
+// returned without measuring the text again.
 size_t split_lines(const char *texx, SplitLines &lines, int width, int fontNumber, size_t max_lines = -1);
 
 namespace AGS { namespace Common { extern SplitLines Lines; } }
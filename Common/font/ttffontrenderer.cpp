@@ -12,6 +12,7 @@
 //
 //=============================================================================
 #include "font/ttffontrenderer.h"
+#include <algorithm>
 #include <alfont.h>
 #include "ac/game_version.h"
 #include "core/platform.h"
@@ -63,11 +64,158 @@ void TTFFontRenderer::RenderText(const char *text, int fontNumber, BITMAP *desti
   if (y > destination->cb)  // optimisation
     return;
 
+  FontData &font = _fontData[fontNumber];
+  const int depth = bitmap_color_depth(destination);
+  const bool aa_mode = ShouldAntiAliasText() && (depth > 8);
   // Y - 1 because it seems to get drawn down a bit
-  if ((ShouldAntiAliasText()) && (bitmap_color_depth(destination) > 8))
-    alfont_textout_aa(destination, _fontData[fontNumber].AlFont, text, x, y - 1, colour);
+  if ((_glyphCacheLimit > 0) && (depth != 24) && destination->clip &&
+      alfont_is_plain_font(font.AlFont))
+    RenderCachedText(text, font, destination, x, y - 1, colour, aa_mode);
+  else if (aa_mode)
+    alfont_textout_aa(destination, font.AlFont, text, x, y - 1, colour);
   else
-    alfont_textout(destination, _fontData[fontNumber].AlFont, text, x, y - 1, colour);
+    alfont_textout(destination, font.AlFont, text, x, y - 1, colour);
+}
+
+const TTFFontRenderer::Glyph &TTFFontRenderer::GetGlyph(FontData &font, int character, bool aa_mode)
+{
+  const uint32_t key = (static_cast<uint32_t>(character) << 1) | (aa_mode ? 1u : 0u);
+  auto it = font.Glyphs.find(key);
+  if (it != font.Glyphs.end())
+    return it->second;
+
+  Glyph glyph;
+  ALFONT_GLYPH alglyph;
+  if (alfont_get_glyph(font.AlFont, character, &alglyph))
+  {
+    const int width = aa_mode ? alglyph.aawidth : alglyph.width;
+    const int height = aa_mode ? alglyph.aaheight : alglyph.height;
+    const uint8_t *src = aa_mode ? alglyph.aabmp : alglyph.bmp;
+    glyph.Advance = alglyph.advance;
+    // Find the visible part of the glyph image, and save only that
+    int x1 = width, y1 = height, x2 = -1, y2 = -1;
+    for (int y = 0; src && (y < height); ++y)
+    {
+      for (int x = 0; x < width; ++x)
+      {
+        const int alpha = src[y * width + x];
+        if (!alpha)
+          continue;
+        x1 = std::min(x1, x); x2 = std::max(x2, x);
+        y1 = std::min(y1, y); y2 = std::max(y2, y);
+        if (aa_mode && (alpha < 255))
+          glyph.LastAlpha = alpha;
+      }
+    }
+    if (x2 >= 0)
+    {
+      glyph.Left = (aa_mode ? alglyph.aaleft : alglyph.left) + x1;
+      glyph.Top = (aa_mode ? alglyph.aatop : alglyph.top) + y1;
+      glyph.Width = x2 - x1 + 1;
+      glyph.Height = y2 - y1 + 1;
+      glyph.Pixels.resize(glyph.Width * glyph.Height);
+      uint8_t *dst = glyph.Pixels.data();
+      for (int y = y1; y <= y2; ++y)
+      {
+        for (int x = x1; x <= x2; ++x)
+        {
+          // non-aa image only tells if the pixel is set
+          *(dst++) = aa_mode ? src[y * width + x] : (src[y * width + x] ? 255 : 0);
+        }
+      }
+    }
+  }
+
+  const size_t glyph_size = sizeof(Glyph) + glyph.Pixels.size();
+  if (_glyphCacheSize + glyph_size > _glyphCacheLimit)
+  {
+    for (auto &fd : _fontData)
+      ClearGlyphs(fd.second);
+  }
+  _glyphCacheSize += glyph_size;
+  return font.Glyphs.emplace(key, std::move(glyph)).first->second;
+}
+
+void TTFFontRenderer::ClearGlyphs(FontData &font)
+{
+  for (const auto &g : font.Glyphs)
+    _glyphCacheSize -= sizeof(Glyph) + g.second.Pixels.size();
+  font.Glyphs.clear();
+}
+
+void TTFFontRenderer::SetGlyphCacheLimit(size_t max_bytes)
+{
+  _glyphCacheLimit = max_bytes;
+  if (_glyphCacheSize > _glyphCacheLimit)
+  {
+    for (auto &fd : _fontData)
+      ClearGlyphs(fd.second);
+  }
+}
+
+typedef uint32_t(*AlfontBlender)(uint32_t, uint32_t, uint32_t);
+
+// 8-bit text is never anti-aliased
+static uint32_t NoBlender(uint32_t x, uint32_t /*y*/, uint32_t /*n*/) { return x; }
+
+// Draws the glyph in the same way as alfont does, for the plain fonts:
+// opaque pixels are written as-is, the semi-transparent ones are blended
+template <typename TPixel, AlfontBlender Blend>
+static void DrawGlyph(BITMAP *dst, const uint8_t *pixels, int width, int height, int x, int y, uint32_t colour)
+{
+  const int x1 = std::max(x, dst->cl), x2 = std::min(x + width, dst->cr);
+  const int y1 = std::max(y, dst->ct), y2 = std::min(y + height, dst->cb);
+  for (int dy = y1; dy < y2; ++dy)
+  {
+    const uint8_t *src = pixels + (dy - y) * width + (x1 - x);
+    TPixel *px = reinterpret_cast<TPixel*>(dst->line[dy]) + x1;
+    for (int dx = x1; dx < x2; ++dx, ++src, ++px)
+    {
+      const uint32_t alpha = *src;
+      if (alpha >= 255)
+        *px = static_cast<TPixel>(colour);
+      else if (alpha)
+        *px = static_cast<TPixel>(Blend(colour, *px, alpha));
+    }
+  }
+}
+
+void TTFFontRenderer::RenderCachedText(const char *text, FontData &font, BITMAP *destination,
+    int x, int y, int colour, bool aa_mode)
+{
+  // This follows the alfont_textout implementation, including the drawing
+  // mode which it leaves after itself
+  if ((y + alfont_get_font_height(font.AlFont) < destination->ct) ||
+      (y > destination->cb) || (x > destination->cr))
+    return;
+
+  int last_alpha = -1;
+  for (int c = ugetxc(&text); c != 0; c = ugetxc(&text))
+  {
+    if (x > destination->cr)
+      break;
+    const Glyph &glyph = GetGlyph(font, c, aa_mode);
+    if (glyph.Width > 0)
+    {
+      const uint8_t *pixels = glyph.Pixels.data();
+      const int gx = x + glyph.Left, gy = y + glyph.Top;
+      switch (bitmap_color_depth(destination))
+      {
+      case 8: DrawGlyph<uint8_t, NoBlender>(destination, pixels, glyph.Width, glyph.Height, gx, gy, colour); break;
+      case 15: DrawGlyph<uint16_t, __skiptranspixels_blender_trans15>(destination, pixels, glyph.Width, glyph.Height, gx, gy, colour); break;
+      case 16: DrawGlyph<uint16_t, __skiptranspixels_blender_trans16>(destination, pixels, glyph.Width, glyph.Height, gx, gy, colour); break;
+      case 32: DrawGlyph<uint32_t, __preservedalpha_blender_trans24>(destination, pixels, glyph.Width, glyph.Height, gx, gy, colour); break;
+      default: break;
+      }
+      if (glyph.LastAlpha >= 0)
+        last_alpha = glyph.LastAlpha;
+    }
+    x += glyph.Advance;
+  }
+
+  if (last_alpha >= 0)
+    set_preservedalpha_trans_blender(0, 0, 0, last_alpha);
+  solid_mode();
 }
 
 bool TTFFontRenderer::LoadFromDisk(int fontNumber, int fontSize)
@@ -178,11 +326,13 @@ void TTFFontRenderer::AdjustFontForAntiAlias(int fontNumber, bool /*aa_mode*/)
     const FontRenderParams &params = _fontData[fontNumber].Params;
     int old_height = alfont_get_font_height(alfptr);
     alfont_set_font_size_ex(alfptr, old_height, GetAlfontFlags(params.LoadMode));
+    ClearGlyphs(_fontData[fontNumber]);
   }
 }
 
 void TTFFontRenderer::FreeMemory(int fontNumber)
 {
+  ClearGlyphs(_fontData[fontNumber]);
   alfont_destroy_font(_fontData[fontNumber].AlFont);
   _fontData.erase(fontNumber);
 }
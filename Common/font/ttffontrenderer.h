@@ -15,6 +15,8 @@
 #define __AC_TTFFONTRENDERER_H
 
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include "core/assetmanager.h"
 #include "font/agsfontrenderer.h"
 #include "util/string.h"
@@ -23,6 +25,8 @@ struct ALFONT_FONT;
 
 class TTFFontRenderer : public IAGSFontRendererInternal {
 public:
+  static const size_t DefGlyphCacheLimit = 1024 * 1024; // 1 MB
+
   // IAGSFontRenderer implementation
   bool LoadFromDisk(int fontNumber, int fontSize) override;
   void FreeMemory(int fontNumber) override;
@@ -58,16 +62,42 @@ public:
   // Try load the TTF font, find the point size which results in pixel height
   // as close to the requested as possible; report its metrics
   bool MeasureFontOfPixelHeight(const AGS::Common::String &filename, int pixel_height, FontMetrics *metrics);
+  // Sets the memory limit for the pre-rasterized glyphs, in bytes;
+  // 0 disables the glyph cache, and the text is drawn by the font library
+  void SetGlyphCacheLimit(size_t max_bytes);
 
 private:
-    ALFONT_FONT *LoadTTF(const AGS::Common::String &filename, int font_size, int alfont_flags);
+    // Pre-rasterized glyph, ready for drawing
+    struct Glyph
+    {
+        int Left = 0, Top = 0; // offset from the text's drawing position
+        int Width = 0, Height = 0;
+        int Advance = 0;
+        // last partially transparent pixel, which defines the blender
+        // state left by the font library after drawing this glyph
+        int LastAlpha = -1;
+        std::vector<uint8_t> Pixels; // coverage, 255 is opaque
+    };
 
     struct FontData
     {
         ALFONT_FONT     *AlFont;
         FontRenderParams Params;
+        // glyphs, keyed by the character code and the anti-aliasing mode
+        std::unordered_map<uint32_t, Glyph> Glyphs;
     };
+
+    ALFONT_FONT *LoadTTF(const AGS::Common::String &filename, int font_size, int alfont_flags);
+    // Gets the glyph from the cache, rasterizes it if it was not cached yet
+    const Glyph &GetGlyph(FontData &font, int character, bool aa_mode);
+    // Draws the text using the cached glyphs
+    void RenderCachedText(const char *text, FontData &font, BITMAP *destination,
+        int x, int y, int colour, bool aa_mode);
+    void ClearGlyphs(FontData &font);
+
     std::map<int, FontData> _fontData;
+    size_t _glyphCacheLimit = DefGlyphCacheLimit;
+    size_t _glyphCacheSize = 0u;
     AGS::Common::AssetManager *_amgr = nullptr;
 };
 
@@ -17,6 +17,7 @@
 #include <string.h> // memcpy
 #include <aastr.h>
 #include "gfx/allegrobitmap.h"
+#include "gfx/blitkernels.h"
 #include "util/filestream.h"
 #include "debug/assert.h"
 
@@ -50,6 +51,7 @@ Bitmap::Bitmap(BITMAP *al_bmp, bool shared_data)
 Bitmap::Bitmap(Bitmap &&bmp)
 {
     _pixelData = std::move(bmp._pixelData);
+    _pixelDataSize = bmp._pixelDataSize;
     _alBitmap = bmp._alBitmap;
     _isDataOwner = bmp._isDataOwner;
     bmp._alBitmap = nullptr;
@@ -80,6 +82,7 @@ bool Bitmap::Create(int width, int height, int color_depth)
         return false;
 
     _pixelData = std::move(data);
+    _pixelDataSize = need_size;
     _alBitmap = bitmap;
     _isDataOwner = true;
     return true;
@@ -120,6 +123,33 @@ bool Bitmap::Create(PixelBuffer &&pxbuf)
         return false;
 
     _pixelData = std::move(data);
+    _pixelDataSize = data_sz;
+    _alBitmap = bitmap;
+    _isDataOwner = true;
+    return true;
+}
+
+bool Bitmap::Create(int width, int height, int color_depth, std::unique_ptr<uint8_t[]> &&data, size_t data_size)
+{
+    Destroy();
+
+    if (color_depth == 0)
+        color_depth = get_color_depth();
+
+    size_t need_size;
+    create_bitmap_userdata(color_depth, width, height, nullptr, 0u, 0u, &need_size);
+    if (!data || need_size > data_size)
+    {
+        data.reset(new uint8_t[need_size]);
+        data_size = need_size;
+    }
+
+    BITMAP *bitmap = create_bitmap_userdata(color_depth, width, height, data.get(), data_size, 0u, nullptr);
+    if (!bitmap)
+        return false;
+
+    _pixelData = std::move(data);
+    _pixelDataSize = data_size;
     _alBitmap = bitmap;
     _isDataOwner = true;
     return true;
@@ -154,7 +184,9 @@ bool Bitmap::CreateCopy(Bitmap *src, int color_depth)
 
     if (Create(src->_alBitmap->w, src->_alBitmap->h, color_depth ? color_depth : bitmap_color_depth(src->_alBitmap)))
     {
-        blit(src->_alBitmap, _alBitmap, 0, 0, 0, 0, _alBitmap->w, _alBitmap->h);
+        // Conversions between the most used color depths have faster kernels
+        if (!BlitKernels::ConvertPixels(this, src))
+            blit(src->_alBitmap, _alBitmap, 0, 0, 0, 0, _alBitmap->w, _alBitmap->h);
         return true;
     }
     return false;
@@ -176,6 +208,7 @@ void Bitmap::ForgetAllegroBitmap()
     _alBitmap = nullptr;
     _isDataOwner = false;
     _pixelData = {};
+    _pixelDataSize = 0u;
 }
 
 void Bitmap::Destroy()
@@ -187,6 +220,15 @@ void Bitmap::Destroy()
     _alBitmap = nullptr;
     _isDataOwner = false;
     _pixelData = {};
+    _pixelDataSize = 0u;
+}
+
+std::unique_ptr<uint8_t[]> Bitmap::ReleaseData(size_t &data_size)
+{
+    std::unique_ptr<uint8_t[]> data = std::move(_pixelData);
+    data_size = data ? _pixelDataSize : 0u;
+    Destroy();
+    return data;
 }
 
 bool Bitmap::SaveToFile(const char *filename, const void *palette)
@@ -544,6 +586,13 @@ Bitmap *CreateRawBitmapWrapper(BITMAP *al_bmp)
 	return bitmap;
 }
 
+size_t GetRequiredDataSize(int width, int height, int color_depth)
+{
+    size_t need_size;
+    create_bitmap_userdata(color_depth, width, height, nullptr, 0u, 0u, &need_size);
+    return need_size;
+}
+
 } // namespace BitmapHelper
 
 
@@ -56,6 +56,9 @@ public:
     bool    CreateTransparent(int width, int height, int color_depth = 0);
     // Create Bitmap and attach prepared pixel buffer
     bool    Create(PixelBuffer &&pxbuf);
+    // Create Bitmap over the given memory block, which may be larger than
+    // required for this bitmap; if it's too small then a new one is allocated
+    bool    Create(int width, int height, int color_depth, std::unique_ptr<uint8_t[]> &&data, size_t data_size);
     // Creates a sub-bitmap of the given bitmap; the sub-bitmap is a reference to
     // particular region inside a parent.
     // WARNING: the parent bitmap MUST be kept in memory for as long as sub-bitmap exists!
@@ -74,6 +77,10 @@ public:
     void    ForgetAllegroBitmap();
     // Deallocate bitmap
     void	Destroy();
+    // Deallocate bitmap, but return the pixel memory block for reuse;
+    // returns null if this bitmap does not own a separate memory block
+    // (e.g. is a sub-bitmap or wraps the raw allegro bitmap)
+    std::unique_ptr<uint8_t[]> ReleaseData(size_t &data_size);
 
     bool    SaveToFile(const String &filename, const void *palette)
             { return SaveToFile(filename.GetCStr(), palette); }
@@ -258,6 +265,7 @@ public:
 
 private:
     std::unique_ptr<uint8_t[]> _pixelData;
+    size_t  _pixelDataSize = 0u; // may be larger than the bitmap needs
     BITMAP *_alBitmap = nullptr;
     bool    _isDataOwner = false;
 };
@@ -271,6 +279,8 @@ namespace BitmapHelper
 	Bitmap *CreateRawBitmapOwner(BITMAP *al_bmp);
 	// NOTE: the resulting object __does not own__ bitmap data
 	Bitmap *CreateRawBitmapWrapper(BITMAP *al_bmp);
+    // Gets the size of the pixel memory block required for the bitmap
+    size_t  GetRequiredDataSize(int width, int height, int color_depth);
 } // namespace BitmapHelper
 
 } // namespace Common
@@ -0,0 +1,169 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/bitmappool.h"
+#include <allegro.h>
+
+namespace AGS
+{
+namespace Common
+{
+
+BitmapPool::BitmapPool(size_t max_bytes, uint32_t max_age)
+    : _maxBytes(max_bytes)
+    , _maxAge(max_age)
+{
+}
+
+void BitmapPool::SetLimits(size_t max_bytes, uint32_t max_age)
+{
+    _maxBytes = max_bytes;
+    _maxAge = max_age;
+    while (_stats.FreeBytes > _maxBytes && DeleteOldest());
+}
+
+int BitmapPool::RoundDimension(int dim)
+{
+    // Small sizes are rounded up to 16 pixels; larger ones to a quarter
+    // of their highest power of two, which keeps the waste under 25%
+    if (dim <= 64)
+        return (dim + 15) & ~15;
+    int step = 1;
+    while ((step << 1) <= dim)
+        step <<= 1;
+    step >>= 2;
+    return (dim + step - 1) & ~(step - 1);
+}
+
+uint64_t BitmapPool::MakeKey(int width, int height, int color_depth)
+{
+    return (static_cast<uint64_t>(color_depth) << 48) |
+        (static_cast<uint64_t>(static_cast<uint32_t>(width)) << 24) |
+        static_cast<uint64_t>(static_cast<uint32_t>(height));
+}
+
+std::unique_ptr<Bitmap> BitmapPool::GetBitmap(int width, int height, int color_depth)
+{
+    if (color_depth == 0)
+        color_depth = get_color_depth();
+    const int pool_w = RoundDimension(width);
+    const int pool_h = RoundDimension(height);
+
+    std::unique_ptr<uint8_t[]> data;
+    size_t data_size = 0u;
+    auto it = _buckets.find(MakeKey(pool_w, pool_h, color_depth));
+    if (it != _buckets.end() && !it->second.empty())
+    {
+        Block &block = it->second.back();
+        data = std::move(block.Data);
+        data_size = block.Size;
+        it->second.pop_back();
+        _stats.FreeBlocks--;
+        _stats.FreeBytes -= data_size;
+        _stats.Reused++;
+        _frameStats.Reused++;
+    }
+    else
+    {
+        data_size = BitmapHelper::GetRequiredDataSize(pool_w, pool_h, color_depth);
+        data.reset(new uint8_t[data_size]);
+        _stats.Allocations++;
+        _frameStats.Allocations++;
+    }
+
+    std::unique_ptr<Bitmap> bmp(new Bitmap());
+    if (!bmp->Create(width, height, color_depth, std::move(data), data_size))
+        return nullptr;
+    return bmp;
+}
+
+void BitmapPool::Release(std::unique_ptr<Bitmap> bmp)
+{
+    if (!bmp)
+        return;
+    const int pool_w = RoundDimension(bmp->GetWidth());
+    const int pool_h = RoundDimension(bmp->GetHeight());
+    const int color_depth = bmp->GetColorDepth();
+    size_t data_size;
+    std::unique_ptr<uint8_t[]> data = bmp->ReleaseData(data_size);
+    // Only keep the block if it fits any bitmap from its bucket;
+    // this is not so for the bitmaps which were created outside of the pool
+    if (!data || data_size < BitmapHelper::GetRequiredDataSize(pool_w, pool_h, color_depth))
+        return;
+
+    Block block;
+    block.Data = std::move(data);
+    block.Size = data_size;
+    block.LastUsed = _frame;
+    _buckets[MakeKey(pool_w, pool_h, color_depth)].push_back(std::move(block));
+    _stats.FreeBlocks++;
+    _stats.FreeBytes += data_size;
+    while (_stats.FreeBytes > _maxBytes && DeleteOldest());
+}
+
+void BitmapPool::NextFrame()
+{
+    _frame++;
+    for (auto it = _buckets.begin(); it != _buckets.end();)
+    {
+        auto &blocks = it->second;
+        // Blocks are ordered by the release time, so the old ones are at the front
+        size_t num_old = 0u;
+        for (; num_old < blocks.size() && (_frame - blocks[num_old].LastUsed) > _maxAge; ++num_old)
+        {
+            _stats.FreeBlocks--;
+            _stats.FreeBytes -= blocks[num_old].Size;
+        }
+        blocks.erase(blocks.begin(), blocks.begin() + num_old);
+        if (blocks.empty())
+            it = _buckets.erase(it);
+        else
+            ++it;
+    }
+
+    _lastFrameStats = _frameStats;
+    _lastFrameStats.FreeBlocks = _stats.FreeBlocks;
+    _lastFrameStats.FreeBytes = _stats.FreeBytes;
+    _frameStats = BitmapPoolStats();
+}
+
+void BitmapPool::Clear()
+{
+    _buckets.clear();
+    _stats.FreeBlocks = 0u;
+    _stats.FreeBytes = 0u;
+}
+
+bool BitmapPool::DeleteOldest()
+{
+    auto oldest = _buckets.end();
+    for (auto it = _buckets.begin(); it != _buckets.end(); ++it)
+    {
+        if (!it->second.empty() && (oldest == _buckets.end() ||
+                (_frame - it->second.front().LastUsed) > (_frame - oldest->second.front().LastUsed)))
+            oldest = it;
+    }
+    if (oldest == _buckets.end())
+        return false;
+
+    auto &blocks = oldest->second;
+    _stats.FreeBlocks--;
+    _stats.FreeBytes -= blocks.front().Size;
+    blocks.erase(blocks.begin());
+    if (blocks.empty())
+        _buckets.erase(oldest);
+    return true;
+}
+
+} // namespace Common
+} // namespace AGS
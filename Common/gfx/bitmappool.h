@@ -0,0 +1,111 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// BitmapPool keeps the pixel memory of the disposed bitmaps, and reuses it
+// for the new bitmaps of the similar size, reducing the number of heap
+// allocations when the temporary bitmaps are recreated every frame.
+//
+// The memory blocks are grouped in buckets by color depth and by bitmap
+// dimensions, rounded up to a certain step, which becomes coarser for the
+// larger sizes. The block is always allocated for the rounded dimensions,
+// so that it fits any bitmap from the same bucket. The returned bitmaps have
+// the exact requested size though, and their pixel data is contiguous.
+//
+// The free blocks which were not reused for a number of frames are deleted,
+// as well as the oldest ones if the total free memory exceeds the limit.
+//
+// NOTE: the pool is not thread-safe.
+//
+//=============================================================================
+#ifndef __AGS_CN_GFX__BITMAPPOOL_H
+#define __AGS_CN_GFX__BITMAPPOOL_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "gfx/bitmap.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+struct BitmapPoolStats
+{
+    // Number of the new memory blocks allocated, and of the reused ones
+    uint32_t Allocations = 0u;
+    uint32_t Reused = 0u;
+    // Number and total size of the free blocks kept in the pool
+    uint32_t FreeBlocks = 0u;
+    size_t   FreeBytes = 0u;
+};
+
+class BitmapPool
+{
+public:
+    // Default limits: 32 MB of free memory, kept for 120 frames
+    static const size_t DefaultMaxBytes = 32u * 1024 * 1024;
+    static const uint32_t DefaultMaxAge = 120u;
+
+    BitmapPool() = default;
+    BitmapPool(size_t max_bytes, uint32_t max_age);
+
+    // Sets the max total size of free memory blocks, and the max number of
+    // frames during which the free block may stay unused
+    void SetLimits(size_t max_bytes, uint32_t max_age);
+    // Gets a new bitmap of the exact size and color depth, using pooled
+    // memory if there's one suitable; the contents are not initialized
+    std::unique_ptr<Bitmap> GetBitmap(int width, int height, int color_depth);
+    // Disposes the bitmap, putting its memory into the pool
+    void Release(std::unique_ptr<Bitmap> bmp);
+    // Marks the start of the next frame, deletes free blocks that were
+    // not used for too long
+    void NextFrame();
+    // Deletes all the free memory blocks
+    void Clear();
+
+    // Gets the totals, accumulated since the pool's creation
+    const BitmapPoolStats &GetStats() const { return _stats; }
+    // Gets the stats for the last finished frame
+    const BitmapPoolStats &GetLastFrameStats() const { return _lastFrameStats; }
+
+    // Gets the bitmap dimension rounded up to the pool's bucket step
+    static int RoundDimension(int dim);
+
+private:
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> Data;
+        size_t Size = 0u;
+        uint32_t LastUsed = 0u; // frame index
+    };
+
+    static uint64_t MakeKey(int width, int height, int color_depth);
+    // Deletes the oldest free block; returns false if there are none
+    bool DeleteOldest();
+
+    size_t _maxBytes = DefaultMaxBytes;
+    uint32_t _maxAge = DefaultMaxAge;
+    uint32_t _frame = 0u;
+    // Free blocks per bucket, the most recently released are at the back
+    std::unordered_map<uint64_t, std::vector<Block>> _buckets;
+    BitmapPoolStats _stats;
+    BitmapPoolStats _frameStats;
+    BitmapPoolStats _lastFrameStats;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_GFX__BITMAPPOOL_H
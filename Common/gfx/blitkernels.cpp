@@ -0,0 +1,1480 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/blitkernels.h"
+#include <algorithm>
+#include <allegro.h>
+#include "gfx/bitmap.h"
+#include "gfx/simd.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace BlitKernels
+{
+
+static const uint32_t MaskColor32 = 0x00FF00FF; // MASK_COLOR_32
+
+//-----------------------------------------------------------------------------
+// Scalar implementation
+//-----------------------------------------------------------------------------
+
+// The common part of the Allegro's 32-bit blenders: merges x into y
+// with a factor of n / 256, discarding alpha.
+// NOTE: the unsigned overflows here are intended, and must be reproduced
+// by the vectorized variants, for the results to be identical.
+static inline uint32_t BlendPixel(uint32_t x, uint32_t y, uint32_t n)
+{
+    uint32_t res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
+    y &= 0xFF00;
+    x &= 0xFF00;
+    uint32_t g = (x - y) * n / 256 + y;
+    return (res & 0xFF00FF) | (g & 0xFF00);
+}
+
+static inline uint32_t IncNonZero(uint32_t n)
+{
+    return n ? n + 1 : 0;
+}
+
+static void AlphaBlendRow_Scalar(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t x = src[i];
+        if (x != MaskColor32)
+            dst[i] = BlendPixel(x, dst[i], IncNonZero(x >> 24));
+    }
+}
+
+static void AlphaBlendOpacityRow_Scalar(uint32_t *dst, const uint32_t *src, size_t count, uint32_t opacity)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t x = src[i];
+        if (x != MaskColor32)
+            dst[i] = BlendPixel(x, dst[i], IncNonZero((opacity * (x >> 24)) / 256));
+    }
+}
+
+static void TransBlendRow_Scalar(uint32_t *dst, const uint32_t *src, size_t count, uint32_t n)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t x = src[i];
+        if (x != MaskColor32)
+            dst[i] = BlendPixel(x, dst[i], n);
+    }
+}
+
+static void MaskedCopyRow_Scalar(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t x = src[i];
+        if (x != MaskColor32)
+            dst[i] = x;
+    }
+}
+
+static void TintRow_Scalar(uint32_t *dst, size_t count, uint32_t color, uint32_t n)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t y = dst[i];
+        if (y != MaskColor32)
+            dst[i] = BlendPixel(color, y, n);
+    }
+}
+
+static inline uint32_t MaxComponent(uint32_t c)
+{
+    return std::max(std::max(c & 0xFF, (c >> 8) & 0xFF), (c >> 16) & 0xFF);
+}
+
+static void ValueMapRow_Scalar(uint32_t *dst, const uint32_t *src, size_t count, const uint32_t *table)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t y = src[i];
+        dst[i] = (y == MaskColor32) ? y : ((table[MaxComponent(y)] & 0xFFFFFF) | (y & 0xFF000000));
+    }
+}
+
+static void ValueMapBlendRow_Scalar(uint32_t *dst, const uint32_t *src, size_t count, const uint32_t *table, uint32_t n)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t y = src[i];
+        const uint32_t x = (table[MaxComponent(y)] & 0xFFFFFF) | (y & 0xFF000000);
+        // the mapped pixel which happens to match the mask color is skipped too
+        dst[i] = (y == MaskColor32 || x == MaskColor32) ? y : (BlendPixel(x, y, n) | (y & 0xFF000000));
+    }
+}
+
+static void LightRow_Scalar(uint32_t *dst, const uint32_t *src, size_t count, uint32_t color, uint32_t n)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t y = src[i];
+        dst[i] = (y == MaskColor32) ? y : (BlendPixel(color, y, n) | (y & 0xFF000000));
+    }
+}
+
+static void SwapRedBlueRow_Scalar(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t c = src[i];
+        dst[i] = (c & 0xFF00FF00) | ((c >> 16) & 0xFF) | ((c & 0xFF) << 16);
+    }
+}
+
+// Per-component parameters of the 15/16 <-> 32-bit conversions,
+// in the order of red, green, blue
+struct ConvParams
+{
+    uint32_t Shift16[3]; // component shifts in a 15/16-bit pixel
+    uint32_t Shift32[3]; // component shifts in a 32-bit pixel
+    uint32_t Bits[3];    // component sizes in a 15/16-bit pixel
+    bool KeepMask;
+    uint32_t SrcMask;
+    uint32_t DstMask;
+    uint32_t DstMaskReplacement;
+};
+
+static ConvParams MakeConvParams(const PixelConversion &conv)
+{
+    const bool to32 = conv.DstDepth == 32;
+    const int depth16 = to32 ? conv.SrcDepth : conv.DstDepth;
+    ConvParams p;
+    for (int k = 0; k < 3; ++k)
+    {
+        p.Shift16[k] = static_cast<uint32_t>(to32 ? conv.SrcShift[k] : conv.DstShift[k]);
+        p.Shift32[k] = static_cast<uint32_t>(to32 ? conv.DstShift[k] : conv.SrcShift[k]);
+        p.Bits[k] = (depth16 == 16 && k == 1) ? 6 : 5;
+    }
+    p.KeepMask = conv.KeepMask;
+    p.SrcMask = conv.SrcMask;
+    p.DstMask = conv.DstMask;
+    p.DstMaskReplacement = conv.DstMaskReplacement;
+    return p;
+}
+
+// Same as Allegro's getr15/16 and makecol32: the component is expanded
+// to 8 bits by repeating its high bits in the low ones
+static inline uint32_t Convert16To32(uint32_t c, const ConvParams &p)
+{
+    uint32_t res = 0;
+    for (int k = 0; k < 3; ++k)
+    {
+        const uint32_t v = (c >> p.Shift16[k]) & ((1u << p.Bits[k]) - 1);
+        res |= ((v << (8 - p.Bits[k])) | (v >> (2 * p.Bits[k] - 8))) << p.Shift32[k];
+    }
+    return res;
+}
+
+// Same as Allegro's getr32 and makecol15/16
+static inline uint32_t Convert32To16(uint32_t c, const ConvParams &p)
+{
+    uint32_t res = 0;
+    for (int k = 0; k < 3; ++k)
+        res |= (((c >> p.Shift32[k]) & 0xFF) >> (8 - p.Bits[k])) << p.Shift16[k];
+    return res;
+}
+
+static inline uint32_t ApplyConvMask(uint32_t src, uint32_t res, const ConvParams &p)
+{
+    if (!p.KeepMask)
+        return res;
+    if (src == p.SrcMask)
+        return p.DstMask;
+    return (res == p.DstMask) ? p.DstMaskReplacement : res;
+}
+
+static void Convert16To32Row_Scalar(uint32_t *dst, const uint16_t *src, size_t count, const ConvParams &p)
+{
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = ApplyConvMask(src[i], Convert16To32(src[i], p), p);
+}
+
+static void Convert32To16Row_Scalar(uint16_t *dst, const uint32_t *src, size_t count, const ConvParams &p)
+{
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = static_cast<uint16_t>(ApplyConvMask(src[i], Convert32To16(src[i], p), p));
+}
+
+//-----------------------------------------------------------------------------
+// SSE2 implementation
+//-----------------------------------------------------------------------------
+#if defined(AGS_SIMD_SSE2)
+
+// 32-bit multiplication, keeping the low 32 bits of result;
+// SSE2 does not have one, so it's composed from 16-bit multiplications.
+// n must fit in 16 bits.
+static inline __m128i MulLo32_SSE2(__m128i d, __m128i n)
+{
+    const __m128i nn = _mm_or_si128(n, _mm_slli_epi32(n, 16));
+    const __m128i lo = _mm_mullo_epi16(d, nn);
+    const __m128i hi = _mm_mulhi_epu16(d, nn);
+    return _mm_add_epi32(lo, _mm_slli_epi32(hi, 16));
+}
+
+static inline __m128i BlendPixels_SSE2(__m128i x, __m128i y, __m128i n)
+{
+    const __m128i m_rb = _mm_set1_epi32(0xFF00FF);
+    const __m128i m_g = _mm_set1_epi32(0xFF00);
+    const __m128i y_g = _mm_and_si128(y, m_g);
+    __m128i rb = _mm_sub_epi32(_mm_and_si128(x, m_rb), _mm_and_si128(y, m_rb));
+    rb = _mm_add_epi32(_mm_srli_epi32(MulLo32_SSE2(rb, n), 8), y);
+    __m128i g = _mm_sub_epi32(_mm_and_si128(x, m_g), y_g);
+    g = _mm_add_epi32(_mm_srli_epi32(MulLo32_SSE2(g, n), 8), y_g);
+    return _mm_or_si128(_mm_and_si128(rb, m_rb), _mm_and_si128(g, m_g));
+}
+
+static inline __m128i IncNonZero_SSE2(__m128i n)
+{
+    const __m128i is_zero = _mm_cmpeq_epi32(n, _mm_setzero_si128());
+    return _mm_add_epi32(n, _mm_andnot_si128(is_zero, _mm_set1_epi32(1)));
+}
+
+// Selects a where mask is set, b otherwise
+static inline __m128i Select_SSE2(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static void AlphaBlendRow_SSE2(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    const __m128i mask_col = _mm_set1_epi32(MaskColor32);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        const __m128i n = IncNonZero_SSE2(_mm_srli_epi32(x, 24));
+        const __m128i res = BlendPixels_SSE2(x, y, n);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Select_SSE2(_mm_cmpeq_epi32(x, mask_col), y, res));
+    }
+    AlphaBlendRow_Scalar(dst + i, src + i, count - i);
+}
+
+static void AlphaBlendOpacityRow_SSE2(uint32_t *dst, const uint32_t *src, size_t count, uint32_t opacity)
+{
+    const __m128i mask_col = _mm_set1_epi32(MaskColor32);
+    const __m128i op = _mm_set1_epi32(opacity);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        // alpha * opacity always fits in 16 bits
+        const __m128i n = IncNonZero_SSE2(_mm_srli_epi32(_mm_mullo_epi16(_mm_srli_epi32(x, 24), op), 8));
+        const __m128i res = BlendPixels_SSE2(x, y, n);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Select_SSE2(_mm_cmpeq_epi32(x, mask_col), y, res));
+    }
+    AlphaBlendOpacityRow_Scalar(dst + i, src + i, count - i, opacity);
+}
+
+static void TransBlendRow_SSE2(uint32_t *dst, const uint32_t *src, size_t count, uint32_t n)
+{
+    const __m128i mask_col = _mm_set1_epi32(MaskColor32);
+    const __m128i nv = _mm_set1_epi32(n);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        const __m128i res = BlendPixels_SSE2(x, y, nv);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Select_SSE2(_mm_cmpeq_epi32(x, mask_col), y, res));
+    }
+    TransBlendRow_Scalar(dst + i, src + i, count - i, n);
+}
+
+static void MaskedCopyRow_SSE2(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    const __m128i mask_col = _mm_set1_epi32(MaskColor32);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Select_SSE2(_mm_cmpeq_epi32(x, mask_col), y, x));
+    }
+    MaskedCopyRow_Scalar(dst + i, src + i, count - i);
+}
+
+static void TintRow_SSE2(uint32_t *dst, size_t count, uint32_t color, uint32_t n)
+{
+    const __m128i mask_col = _mm_set1_epi32(MaskColor32);
+    const __m128i x = _mm_set1_epi32(color);
+    const __m128i nv = _mm_set1_epi32(n);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        const __m128i res = BlendPixels_SSE2(x, y, nv);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Select_SSE2(_mm_cmpeq_epi32(y, mask_col), y, res));
+    }
+    TintRow_Scalar(dst + i, count - i, color, n);
+}
+
+// Gets the max of the three color components, in the low byte of each pixel
+static inline __m128i MaxComponent_SSE2(__m128i x)
+{
+    const __m128i m = _mm_max_epu8(_mm_max_epu8(x, _mm_srli_epi32(x, 8)), _mm_srli_epi32(x, 16));
+    return _mm_and_si128(m, _mm_set1_epi32(0xFF));
+}
+
+// Looks up table entries for each pixel; SSE2 has no gather instruction
+static inline __m128i Lookup_SSE2(const uint32_t *table, __m128i index)
+{
+    alignas(16) uint32_t idx[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(idx), index);
+    return _mm_set_epi32(table[idx[3]], table[idx[2]], table[idx[1]], table[idx[0]]);
+}
+
+static void ValueMapRow_SSE2(uint32_t *dst, const uint32_t *src, size_t count, const uint32_t *table)
+{
+    const __m128i mask_col = _mm_set1_epi32(MaskColor32);
+    const __m128i m_rgb = _mm_set1_epi32(0xFFFFFF);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i x = _mm_or_si128(_mm_and_si128(Lookup_SSE2(table, MaxComponent_SSE2(y)), m_rgb),
+            _mm_andnot_si128(m_rgb, y));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Select_SSE2(_mm_cmpeq_epi32(y, mask_col), y, x));
+    }
+    ValueMapRow_Scalar(dst + i, src + i, count - i, table);
+}
+
+static void ValueMapBlendRow_SSE2(uint32_t *dst, const uint32_t *src, size_t count, const uint32_t *table, uint32_t n)
+{
+    const __m128i mask_col = _mm_set1_epi32(MaskColor32);
+    const __m128i m_rgb = _mm_set1_epi32(0xFFFFFF);
+    const __m128i nv = _mm_set1_epi32(n);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i y_a = _mm_andnot_si128(m_rgb, y);
+        const __m128i x = _mm_or_si128(_mm_and_si128(Lookup_SSE2(table, MaxComponent_SSE2(y)), m_rgb), y_a);
+        const __m128i res = _mm_or_si128(BlendPixels_SSE2(x, y, nv), y_a);
+        const __m128i skip = _mm_or_si128(_mm_cmpeq_epi32(y, mask_col), _mm_cmpeq_epi32(x, mask_col));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Select_SSE2(skip, y, res));
+    }
+    ValueMapBlendRow_Scalar(dst + i, src + i, count - i, table, n);
+}
+
+static void LightRow_SSE2(uint32_t *dst, const uint32_t *src, size_t count, uint32_t color, uint32_t n)
+{
+    const __m128i mask_col = _mm_set1_epi32(MaskColor32);
+    const __m128i m_rgb = _mm_set1_epi32(0xFFFFFF);
+    const __m128i x = _mm_set1_epi32(color);
+    const __m128i nv = _mm_set1_epi32(n);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i res = _mm_or_si128(BlendPixels_SSE2(x, y, nv), _mm_andnot_si128(m_rgb, y));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), Select_SSE2(_mm_cmpeq_epi32(y, mask_col), y, res));
+    }
+    LightRow_Scalar(dst + i, src + i, count - i, color, n);
+}
+
+static void SwapRedBlueRow_SSE2(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    const __m128i m_ag = _mm_set1_epi32(0xFF00FF00);
+    const __m128i m_b = _mm_set1_epi32(0xFF);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i res = _mm_or_si128(_mm_and_si128(c, m_ag),
+            _mm_or_si128(_mm_and_si128(_mm_srli_epi32(c, 16), m_b), _mm_slli_epi32(_mm_and_si128(c, m_b), 16)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), res);
+    }
+    SwapRedBlueRow_Scalar(dst + i, src + i, count - i);
+}
+
+// Conversion parameters as shift counts and masks for SSE2 instructions
+struct ConvParams_SSE2
+{
+    __m128i Shift16[3], Shift32[3], ScaleL[3], ScaleR[3], Reduce[3];
+    __m128i CompMask[3];
+    __m128i SrcMask, DstMask, DstMaskReplacement;
+
+    ConvParams_SSE2(const ConvParams &p)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            Shift16[k] = _mm_cvtsi32_si128(p.Shift16[k]);
+            Shift32[k] = _mm_cvtsi32_si128(p.Shift32[k]);
+            ScaleL[k] = _mm_cvtsi32_si128(8 - p.Bits[k]);
+            ScaleR[k] = _mm_cvtsi32_si128(2 * p.Bits[k] - 8);
+            Reduce[k] = _mm_cvtsi32_si128(8 - p.Bits[k]);
+            CompMask[k] = _mm_set1_epi32((1 << p.Bits[k]) - 1);
+        }
+        SrcMask = _mm_set1_epi32(p.SrcMask);
+        DstMask = _mm_set1_epi32(p.DstMask);
+        DstMaskReplacement = _mm_set1_epi32(p.DstMaskReplacement);
+    }
+};
+
+static inline __m128i Convert16To32_SSE2(__m128i c, const ConvParams_SSE2 &p)
+{
+    __m128i res = _mm_setzero_si128();
+    for (int k = 0; k < 3; ++k)
+    {
+        const __m128i v = _mm_and_si128(_mm_srl_epi32(c, p.Shift16[k]), p.CompMask[k]);
+        const __m128i v8 = _mm_or_si128(_mm_sll_epi32(v, p.ScaleL[k]), _mm_srl_epi32(v, p.ScaleR[k]));
+        res = _mm_or_si128(res, _mm_sll_epi32(v8, p.Shift32[k]));
+    }
+    return res;
+}
+
+static inline __m128i Convert32To16_SSE2(__m128i c, const ConvParams_SSE2 &p)
+{
+    const __m128i m = _mm_set1_epi32(0xFF);
+    __m128i res = _mm_setzero_si128();
+    for (int k = 0; k < 3; ++k)
+    {
+        const __m128i v = _mm_srl_epi32(_mm_and_si128(_mm_srl_epi32(c, p.Shift32[k]), m), p.Reduce[k]);
+        res = _mm_or_si128(res, _mm_sll_epi32(v, p.Shift16[k]));
+    }
+    return res;
+}
+
+static inline __m128i ApplyConvMask_SSE2(__m128i src, __m128i res, const ConvParams_SSE2 &p)
+{
+    res = Select_SSE2(_mm_cmpeq_epi32(res, p.DstMask), p.DstMaskReplacement, res);
+    return Select_SSE2(_mm_cmpeq_epi32(src, p.SrcMask), p.DstMask, res);
+}
+
+static void Convert16To32Row_SSE2(uint32_t *dst, const uint16_t *src, size_t count, const ConvParams &params)
+{
+    const ConvParams_SSE2 p(params);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i c1 = _mm_unpacklo_epi16(c, zero);
+        const __m128i c2 = _mm_unpackhi_epi16(c, zero);
+        __m128i res1 = Convert16To32_SSE2(c1, p);
+        __m128i res2 = Convert16To32_SSE2(c2, p);
+        if (params.KeepMask)
+        {
+            res1 = ApplyConvMask_SSE2(c1, res1, p);
+            res2 = ApplyConvMask_SSE2(c2, res2, p);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), res1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), res2);
+    }
+    Convert16To32Row_Scalar(dst + i, src + i, count - i, params);
+}
+
+static void Convert32To16Row_SSE2(uint16_t *dst, const uint32_t *src, size_t count, const ConvParams &params)
+{
+    const ConvParams_SSE2 p(params);
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i c2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4));
+        __m128i res1 = Convert32To16_SSE2(c1, p);
+        __m128i res2 = Convert32To16_SSE2(c2, p);
+        if (params.KeepMask)
+        {
+            res1 = ApplyConvMask_SSE2(c1, res1, p);
+            res2 = ApplyConvMask_SSE2(c2, res2, p);
+        }
+        // SSE2 only has a signed saturating pack, so move the values into
+        // the signed range and back
+        const __m128i res = _mm_add_epi16(_mm_packs_epi32(_mm_sub_epi32(res1, bias32), _mm_sub_epi32(res2, bias32)), bias16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), res);
+    }
+    Convert32To16Row_Scalar(dst + i, src + i, count - i, params);
+}
+
+#endif // AGS_SIMD_SSE2
+
+//-----------------------------------------------------------------------------
+// AVX2 implementation
+//-----------------------------------------------------------------------------
+#if defined(AGS_SIMD_AVX2)
+
+AGS_TARGET_AVX2 static inline __m256i BlendPixels_AVX2(__m256i x, __m256i y, __m256i n)
+{
+    const __m256i m_rb = _mm256_set1_epi32(0xFF00FF);
+    const __m256i m_g = _mm256_set1_epi32(0xFF00);
+    const __m256i y_g = _mm256_and_si256(y, m_g);
+    __m256i rb = _mm256_sub_epi32(_mm256_and_si256(x, m_rb), _mm256_and_si256(y, m_rb));
+    rb = _mm256_add_epi32(_mm256_srli_epi32(_mm256_mullo_epi32(rb, n), 8), y);
+    __m256i g = _mm256_sub_epi32(_mm256_and_si256(x, m_g), y_g);
+    g = _mm256_add_epi32(_mm256_srli_epi32(_mm256_mullo_epi32(g, n), 8), y_g);
+    return _mm256_or_si256(_mm256_and_si256(rb, m_rb), _mm256_and_si256(g, m_g));
+}
+
+AGS_TARGET_AVX2 static inline __m256i IncNonZero_AVX2(__m256i n)
+{
+    const __m256i is_zero = _mm256_cmpeq_epi32(n, _mm256_setzero_si256());
+    return _mm256_add_epi32(n, _mm256_andnot_si256(is_zero, _mm256_set1_epi32(1)));
+}
+
+AGS_TARGET_AVX2 static void AlphaBlendRow_AVX2(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    const __m256i mask_col = _mm256_set1_epi32(MaskColor32);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        const __m256i n = IncNonZero_AVX2(_mm256_srli_epi32(x, 24));
+        const __m256i res = BlendPixels_AVX2(x, y, n);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+            _mm256_blendv_epi8(res, y, _mm256_cmpeq_epi32(x, mask_col)));
+    }
+    AlphaBlendRow_Scalar(dst + i, src + i, count - i);
+}
+
+AGS_TARGET_AVX2 static void AlphaBlendOpacityRow_AVX2(uint32_t *dst, const uint32_t *src, size_t count, uint32_t opacity)
+{
+    const __m256i mask_col = _mm256_set1_epi32(MaskColor32);
+    const __m256i op = _mm256_set1_epi32(opacity);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        const __m256i n = IncNonZero_AVX2(_mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(x, 24), op), 8));
+        const __m256i res = BlendPixels_AVX2(x, y, n);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+            _mm256_blendv_epi8(res, y, _mm256_cmpeq_epi32(x, mask_col)));
+    }
+    AlphaBlendOpacityRow_Scalar(dst + i, src + i, count - i, opacity);
+}
+
+AGS_TARGET_AVX2 static void TransBlendRow_AVX2(uint32_t *dst, const uint32_t *src, size_t count, uint32_t n)
+{
+    const __m256i mask_col = _mm256_set1_epi32(MaskColor32);
+    const __m256i nv = _mm256_set1_epi32(n);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        const __m256i res = BlendPixels_AVX2(x, y, nv);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+            _mm256_blendv_epi8(res, y, _mm256_cmpeq_epi32(x, mask_col)));
+    }
+    TransBlendRow_Scalar(dst + i, src + i, count - i, n);
+}
+
+AGS_TARGET_AVX2 static void MaskedCopyRow_AVX2(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    const __m256i mask_col = _mm256_set1_epi32(MaskColor32);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+            _mm256_blendv_epi8(x, y, _mm256_cmpeq_epi32(x, mask_col)));
+    }
+    MaskedCopyRow_Scalar(dst + i, src + i, count - i);
+}
+
+AGS_TARGET_AVX2 static void TintRow_AVX2(uint32_t *dst, size_t count, uint32_t color, uint32_t n)
+{
+    const __m256i mask_col = _mm256_set1_epi32(MaskColor32);
+    const __m256i x = _mm256_set1_epi32(color);
+    const __m256i nv = _mm256_set1_epi32(n);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        const __m256i res = BlendPixels_AVX2(x, y, nv);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+            _mm256_blendv_epi8(res, y, _mm256_cmpeq_epi32(y, mask_col)));
+    }
+    TintRow_Scalar(dst + i, count - i, color, n);
+}
+
+AGS_TARGET_AVX2 static inline __m256i MaxComponent_AVX2(__m256i x)
+{
+    const __m256i m = _mm256_max_epu8(_mm256_max_epu8(x, _mm256_srli_epi32(x, 8)), _mm256_srli_epi32(x, 16));
+    return _mm256_and_si256(m, _mm256_set1_epi32(0xFF));
+}
+
+AGS_TARGET_AVX2 static inline __m256i Lookup_AVX2(const uint32_t *table, __m256i index)
+{
+    return _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 4);
+}
+
+AGS_TARGET_AVX2 static void ValueMapRow_AVX2(uint32_t *dst, const uint32_t *src, size_t count, const uint32_t *table)
+{
+    const __m256i mask_col = _mm256_set1_epi32(MaskColor32);
+    const __m256i m_rgb = _mm256_set1_epi32(0xFFFFFF);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i x = _mm256_or_si256(_mm256_and_si256(Lookup_AVX2(table, MaxComponent_AVX2(y)), m_rgb),
+            _mm256_andnot_si256(m_rgb, y));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+            _mm256_blendv_epi8(x, y, _mm256_cmpeq_epi32(y, mask_col)));
+    }
+    ValueMapRow_Scalar(dst + i, src + i, count - i, table);
+}
+
+AGS_TARGET_AVX2 static void ValueMapBlendRow_AVX2(uint32_t *dst, const uint32_t *src, size_t count, const uint32_t *table, uint32_t n)
+{
+    const __m256i mask_col = _mm256_set1_epi32(MaskColor32);
+    const __m256i m_rgb = _mm256_set1_epi32(0xFFFFFF);
+    const __m256i nv = _mm256_set1_epi32(n);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i y_a = _mm256_andnot_si256(m_rgb, y);
+        const __m256i x = _mm256_or_si256(_mm256_and_si256(Lookup_AVX2(table, MaxComponent_AVX2(y)), m_rgb), y_a);
+        const __m256i res = _mm256_or_si256(BlendPixels_AVX2(x, y, nv), y_a);
+        const __m256i skip = _mm256_or_si256(_mm256_cmpeq_epi32(y, mask_col), _mm256_cmpeq_epi32(x, mask_col));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_blendv_epi8(res, y, skip));
+    }
+    ValueMapBlendRow_Scalar(dst + i, src + i, count - i, table, n);
+}
+
+AGS_TARGET_AVX2 static void LightRow_AVX2(uint32_t *dst, const uint32_t *src, size_t count, uint32_t color, uint32_t n)
+{
+    const __m256i mask_col = _mm256_set1_epi32(MaskColor32);
+    const __m256i m_rgb = _mm256_set1_epi32(0xFFFFFF);
+    const __m256i x = _mm256_set1_epi32(color);
+    const __m256i nv = _mm256_set1_epi32(n);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i res = _mm256_or_si256(BlendPixels_AVX2(x, y, nv), _mm256_andnot_si256(m_rgb, y));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+            _mm256_blendv_epi8(res, y, _mm256_cmpeq_epi32(y, mask_col)));
+    }
+    LightRow_Scalar(dst + i, src + i, count - i, color, n);
+}
+
+AGS_TARGET_AVX2 static void SwapRedBlueRow_AVX2(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    const __m256i shuffle = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(c, shuffle));
+    }
+    SwapRedBlueRow_Scalar(dst + i, src + i, count - i);
+}
+
+// Conversion parameters as shift counts and masks for AVX2 instructions
+struct ConvParams_AVX2
+{
+    __m128i Shift16[3], Shift32[3], ScaleL[3], ScaleR[3], Reduce[3];
+    __m256i CompMask[3];
+    __m256i SrcMask, DstMask, DstMaskReplacement;
+
+    AGS_TARGET_AVX2 ConvParams_AVX2(const ConvParams &p)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            Shift16[k] = _mm_cvtsi32_si128(p.Shift16[k]);
+            Shift32[k] = _mm_cvtsi32_si128(p.Shift32[k]);
+            ScaleL[k] = _mm_cvtsi32_si128(8 - p.Bits[k]);
+            ScaleR[k] = _mm_cvtsi32_si128(2 * p.Bits[k] - 8);
+            Reduce[k] = _mm_cvtsi32_si128(8 - p.Bits[k]);
+            CompMask[k] = _mm256_set1_epi32((1 << p.Bits[k]) - 1);
+        }
+        SrcMask = _mm256_set1_epi32(p.SrcMask);
+        DstMask = _mm256_set1_epi32(p.DstMask);
+        DstMaskReplacement = _mm256_set1_epi32(p.DstMaskReplacement);
+    }
+};
+
+AGS_TARGET_AVX2 static inline __m256i Convert16To32_AVX2(__m256i c, const ConvParams_AVX2 &p)
+{
+    __m256i res = _mm256_setzero_si256();
+    for (int k = 0; k < 3; ++k)
+    {
+        const __m256i v = _mm256_and_si256(_mm256_srl_epi32(c, p.Shift16[k]), p.CompMask[k]);
+        const __m256i v8 = _mm256_or_si256(_mm256_sll_epi32(v, p.ScaleL[k]), _mm256_srl_epi32(v, p.ScaleR[k]));
+        res = _mm256_or_si256(res, _mm256_sll_epi32(v8, p.Shift32[k]));
+    }
+    return res;
+}
+
+AGS_TARGET_AVX2 static inline __m256i Convert32To16_AVX2(__m256i c, const ConvParams_AVX2 &p)
+{
+    const __m256i m = _mm256_set1_epi32(0xFF);
+    __m256i res = _mm256_setzero_si256();
+    for (int k = 0; k < 3; ++k)
+    {
+        const __m256i v = _mm256_srl_epi32(_mm256_and_si256(_mm256_srl_epi32(c, p.Shift32[k]), m), p.Reduce[k]);
+        res = _mm256_or_si256(res, _mm256_sll_epi32(v, p.Shift16[k]));
+    }
+    return res;
+}
+
+AGS_TARGET_AVX2 static inline __m256i ApplyConvMask_AVX2(__m256i src, __m256i res, const ConvParams_AVX2 &p)
+{
+    res = _mm256_blendv_epi8(res, p.DstMaskReplacement, _mm256_cmpeq_epi32(res, p.DstMask));
+    return _mm256_blendv_epi8(res, p.DstMask, _mm256_cmpeq_epi32(src, p.SrcMask));
+}
+
+AGS_TARGET_AVX2 static void Convert16To32Row_AVX2(uint32_t *dst, const uint16_t *src, size_t count, const ConvParams &params)
+{
+    const ConvParams_AVX2 p(params);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i c = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        __m256i res = Convert16To32_AVX2(c, p);
+        if (params.KeepMask)
+            res = ApplyConvMask_AVX2(c, res, p);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), res);
+    }
+    Convert16To32Row_Scalar(dst + i, src + i, count - i, params);
+}
+
+AGS_TARGET_AVX2 static void Convert32To16Row_AVX2(uint16_t *dst, const uint32_t *src, size_t count, const ConvParams &params)
+{
+    const ConvParams_AVX2 p(params);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i res = Convert32To16_AVX2(c, p);
+        if (params.KeepMask)
+            res = ApplyConvMask_AVX2(c, res, p);
+        // the pack works within 128-bit lanes, so gather the halves after it
+        res = _mm256_permute4x64_epi64(_mm256_packus_epi32(res, res), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(res));
+    }
+    Convert32To16Row_Scalar(dst + i, src + i, count - i, params);
+}
+
+#endif // AGS_SIMD_AVX2
+
+//-----------------------------------------------------------------------------
+// NEON implementation
+//-----------------------------------------------------------------------------
+#if defined(AGS_SIMD_NEON)
+
+static inline uint32x4_t BlendPixels_NEON(uint32x4_t x, uint32x4_t y, uint32x4_t n)
+{
+    const uint32x4_t m_rb = vdupq_n_u32(0xFF00FF);
+    const uint32x4_t m_g = vdupq_n_u32(0xFF00);
+    const uint32x4_t y_g = vandq_u32(y, m_g);
+    uint32x4_t rb = vsubq_u32(vandq_u32(x, m_rb), vandq_u32(y, m_rb));
+    rb = vaddq_u32(vshrq_n_u32(vmulq_u32(rb, n), 8), y);
+    uint32x4_t g = vsubq_u32(vandq_u32(x, m_g), y_g);
+    g = vaddq_u32(vshrq_n_u32(vmulq_u32(g, n), 8), y_g);
+    return vorrq_u32(vandq_u32(rb, m_rb), vandq_u32(g, m_g));
+}
+
+static inline uint32x4_t IncNonZero_NEON(uint32x4_t n)
+{
+    return vaddq_u32(n, vminq_u32(n, vdupq_n_u32(1)));
+}
+
+static void AlphaBlendRow_NEON(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    const uint32x4_t mask_col = vdupq_n_u32(MaskColor32);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t x = vld1q_u32(src + i);
+        const uint32x4_t y = vld1q_u32(dst + i);
+        const uint32x4_t n = IncNonZero_NEON(vshrq_n_u32(x, 24));
+        const uint32x4_t res = BlendPixels_NEON(x, y, n);
+        vst1q_u32(dst + i, vbslq_u32(vceqq_u32(x, mask_col), y, res));
+    }
+    AlphaBlendRow_Scalar(dst + i, src + i, count - i);
+}
+
+static void AlphaBlendOpacityRow_NEON(uint32_t *dst, const uint32_t *src, size_t count, uint32_t opacity)
+{
+    const uint32x4_t mask_col = vdupq_n_u32(MaskColor32);
+    const uint32x4_t op = vdupq_n_u32(opacity);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t x = vld1q_u32(src + i);
+        const uint32x4_t y = vld1q_u32(dst + i);
+        const uint32x4_t n = IncNonZero_NEON(vshrq_n_u32(vmulq_u32(vshrq_n_u32(x, 24), op), 8));
+        const uint32x4_t res = BlendPixels_NEON(x, y, n);
+        vst1q_u32(dst + i, vbslq_u32(vceqq_u32(x, mask_col), y, res));
+    }
+    AlphaBlendOpacityRow_Scalar(dst + i, src + i, count - i, opacity);
+}
+
+static void TransBlendRow_NEON(uint32_t *dst, const uint32_t *src, size_t count, uint32_t n)
+{
+    const uint32x4_t mask_col = vdupq_n_u32(MaskColor32);
+    const uint32x4_t nv = vdupq_n_u32(n);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t x = vld1q_u32(src + i);
+        const uint32x4_t y = vld1q_u32(dst + i);
+        const uint32x4_t res = BlendPixels_NEON(x, y, nv);
+        vst1q_u32(dst + i, vbslq_u32(vceqq_u32(x, mask_col), y, res));
+    }
+    TransBlendRow_Scalar(dst + i, src + i, count - i, n);
+}
+
+static void MaskedCopyRow_NEON(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    const uint32x4_t mask_col = vdupq_n_u32(MaskColor32);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t x = vld1q_u32(src + i);
+        const uint32x4_t y = vld1q_u32(dst + i);
+        vst1q_u32(dst + i, vbslq_u32(vceqq_u32(x, mask_col), y, x));
+    }
+    MaskedCopyRow_Scalar(dst + i, src + i, count - i);
+}
+
+static void TintRow_NEON(uint32_t *dst, size_t count, uint32_t color, uint32_t n)
+{
+    const uint32x4_t mask_col = vdupq_n_u32(MaskColor32);
+    const uint32x4_t x = vdupq_n_u32(color);
+    const uint32x4_t nv = vdupq_n_u32(n);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t y = vld1q_u32(dst + i);
+        const uint32x4_t res = BlendPixels_NEON(x, y, nv);
+        vst1q_u32(dst + i, vbslq_u32(vceqq_u32(y, mask_col), y, res));
+    }
+    TintRow_Scalar(dst + i, count - i, color, n);
+}
+
+static inline uint32x4_t MaxComponent_NEON(uint32x4_t x)
+{
+    const uint8x16_t m = vmaxq_u8(vmaxq_u8(vreinterpretq_u8_u32(x), vreinterpretq_u8_u32(vshrq_n_u32(x, 8))),
+        vreinterpretq_u8_u32(vshrq_n_u32(x, 16)));
+    return vandq_u32(vreinterpretq_u32_u8(m), vdupq_n_u32(0xFF));
+}
+
+// Looks up table entries for each pixel; NEON has no gather instruction
+static inline uint32x4_t Lookup_NEON(const uint32_t *table, uint32x4_t index)
+{
+    uint32_t idx[4];
+    vst1q_u32(idx, index);
+    const uint32_t res[4] = { table[idx[0]], table[idx[1]], table[idx[2]], table[idx[3]] };
+    return vld1q_u32(res);
+}
+
+static void ValueMapRow_NEON(uint32_t *dst, const uint32_t *src, size_t count, const uint32_t *table)
+{
+    const uint32x4_t mask_col = vdupq_n_u32(MaskColor32);
+    const uint32x4_t m_rgb = vdupq_n_u32(0xFFFFFF);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t y = vld1q_u32(src + i);
+        const uint32x4_t x = vbslq_u32(m_rgb, Lookup_NEON(table, MaxComponent_NEON(y)), y);
+        vst1q_u32(dst + i, vbslq_u32(vceqq_u32(y, mask_col), y, x));
+    }
+    ValueMapRow_Scalar(dst + i, src + i, count - i, table);
+}
+
+static void ValueMapBlendRow_NEON(uint32_t *dst, const uint32_t *src, size_t count, const uint32_t *table, uint32_t n)
+{
+    const uint32x4_t mask_col = vdupq_n_u32(MaskColor32);
+    const uint32x4_t m_rgb = vdupq_n_u32(0xFFFFFF);
+    const uint32x4_t nv = vdupq_n_u32(n);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t y = vld1q_u32(src + i);
+        const uint32x4_t x = vbslq_u32(m_rgb, Lookup_NEON(table, MaxComponent_NEON(y)), y);
+        const uint32x4_t res = vbslq_u32(m_rgb, BlendPixels_NEON(x, y, nv), y);
+        const uint32x4_t skip = vorrq_u32(vceqq_u32(y, mask_col), vceqq_u32(x, mask_col));
+        vst1q_u32(dst + i, vbslq_u32(skip, y, res));
+    }
+    ValueMapBlendRow_Scalar(dst + i, src + i, count - i, table, n);
+}
+
+static void LightRow_NEON(uint32_t *dst, const uint32_t *src, size_t count, uint32_t color, uint32_t n)
+{
+    const uint32x4_t mask_col = vdupq_n_u32(MaskColor32);
+    const uint32x4_t m_rgb = vdupq_n_u32(0xFFFFFF);
+    const uint32x4_t x = vdupq_n_u32(color);
+    const uint32x4_t nv = vdupq_n_u32(n);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t y = vld1q_u32(src + i);
+        const uint32x4_t res = vbslq_u32(m_rgb, BlendPixels_NEON(x, y, nv), y);
+        vst1q_u32(dst + i, vbslq_u32(vceqq_u32(y, mask_col), y, res));
+    }
+    LightRow_Scalar(dst + i, src + i, count - i, color, n);
+}
+
+static void SwapRedBlueRow_NEON(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        // deinterleaves 16 pixels into the planes of components
+        uint8x16x4_t c = vld4q_u8(reinterpret_cast<const uint8_t*>(src + i));
+        const uint8x16_t tmp = c.val[0];
+        c.val[0] = c.val[2];
+        c.val[2] = tmp;
+        vst4q_u8(reinterpret_cast<uint8_t*>(dst + i), c);
+    }
+    SwapRedBlueRow_Scalar(dst + i, src + i, count - i);
+}
+
+// Conversion parameters as shift counts and masks for NEON instructions;
+// NEON shifts by a vector of signed counts, negative ones shift right
+struct ConvParams_NEON
+{
+    int32x4_t Shift16[3], Shift32[3], ScaleL[3], ScaleR[3], Reduce[3];
+    int32x4_t RShift16[3], RShift32[3];
+    uint32x4_t CompMask[3];
+    uint32x4_t SrcMask, DstMask, DstMaskReplacement;
+
+    ConvParams_NEON(const ConvParams &p)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            const int bits = static_cast<int>(p.Bits[k]);
+            Shift16[k] = vdupq_n_s32(static_cast<int>(p.Shift16[k]));
+            Shift32[k] = vdupq_n_s32(static_cast<int>(p.Shift32[k]));
+            RShift16[k] = vdupq_n_s32(-static_cast<int>(p.Shift16[k]));
+            RShift32[k] = vdupq_n_s32(-static_cast<int>(p.Shift32[k]));
+            ScaleL[k] = vdupq_n_s32(8 - bits);
+            ScaleR[k] = vdupq_n_s32(8 - 2 * bits);
+            Reduce[k] = vdupq_n_s32(bits - 8);
+            CompMask[k] = vdupq_n_u32((1u << bits) - 1);
+        }
+        SrcMask = vdupq_n_u32(p.SrcMask);
+        DstMask = vdupq_n_u32(p.DstMask);
+        DstMaskReplacement = vdupq_n_u32(p.DstMaskReplacement);
+    }
+};
+
+static inline uint32x4_t Convert16To32_NEON(uint32x4_t c, const ConvParams_NEON &p)
+{
+    uint32x4_t res = vdupq_n_u32(0);
+    for (int k = 0; k < 3; ++k)
+    {
+        const uint32x4_t v = vandq_u32(vshlq_u32(c, p.RShift16[k]), p.CompMask[k]);
+        const uint32x4_t v8 = vorrq_u32(vshlq_u32(v, p.ScaleL[k]), vshlq_u32(v, p.ScaleR[k]));
+        res = vorrq_u32(res, vshlq_u32(v8, p.Shift32[k]));
+    }
+    return res;
+}
+
+static inline uint32x4_t Convert32To16_NEON(uint32x4_t c, const ConvParams_NEON &p)
+{
+    const uint32x4_t m = vdupq_n_u32(0xFF);
+    uint32x4_t res = vdupq_n_u32(0);
+    for (int k = 0; k < 3; ++k)
+    {
+        const uint32x4_t v = vshlq_u32(vandq_u32(vshlq_u32(c, p.RShift32[k]), m), p.Reduce[k]);
+        res = vorrq_u32(res, vshlq_u32(v, p.Shift16[k]));
+    }
+    return res;
+}
+
+static inline uint32x4_t ApplyConvMask_NEON(uint32x4_t src, uint32x4_t res, const ConvParams_NEON &p)
+{
+    res = vbslq_u32(vceqq_u32(res, p.DstMask), p.DstMaskReplacement, res);
+    return vbslq_u32(vceqq_u32(src, p.SrcMask), p.DstMask, res);
+}
+
+static void Convert16To32Row_NEON(uint32_t *dst, const uint16_t *src, size_t count, const ConvParams &params)
+{
+    const ConvParams_NEON p(params);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t c = vmovl_u16(vld1_u16(src + i));
+        uint32x4_t res = Convert16To32_NEON(c, p);
+        if (params.KeepMask)
+            res = ApplyConvMask_NEON(c, res, p);
+        vst1q_u32(dst + i, res);
+    }
+    Convert16To32Row_Scalar(dst + i, src + i, count - i, params);
+}
+
+static void Convert32To16Row_NEON(uint16_t *dst, const uint32_t *src, size_t count, const ConvParams &params)
+{
+    const ConvParams_NEON p(params);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t c = vld1q_u32(src + i);
+        uint32x4_t res = Convert32To16_NEON(c, p);
+        if (params.KeepMask)
+            res = ApplyConvMask_NEON(c, res, p);
+        vst1_u16(dst + i, vmovn_u32(res));
+    }
+    Convert32To16Row_Scalar(dst + i, src + i, count - i, params);
+}
+
+#endif // AGS_SIMD_NEON
+
+//-----------------------------------------------------------------------------
+// Dispatch
+//-----------------------------------------------------------------------------
+
+static bool CpuHasAVX2()
+{
+#if defined(AGS_SIMD_AVX2)
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    const bool os_xsave = (info[2] & (1 << 27)) != 0;
+    const bool cpu_avx = (info[2] & (1 << 28)) != 0;
+    if (!os_xsave || !cpu_avx || ((_xgetbv(0) & 0x6) != 0x6))
+        return false; // OS does not save AVX registers
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+#else
+    return false;
+#endif
+}
+
+static SimdLevel DetectSimd()
+{
+    if (IsSimdSupported(kSimd_AVX2))
+        return kSimd_AVX2;
+    if (IsSimdSupported(kSimd_SSE2))
+        return kSimd_SSE2;
+    if (IsSimdSupported(kSimd_NEON))
+        return kSimd_NEON;
+    return kSimd_None;
+}
+
+static SimdLevel CurrentSimd = DetectSimd();
+
+bool IsSimdSupported(SimdLevel level)
+{
+    switch (level)
+    {
+    case kSimd_None: return true;
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: return true;
+#endif
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2:
+    {
+        static const bool has_avx2 = CpuHasAVX2();
+        return has_avx2;
+    }
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: return true;
+#endif
+    default: return false;
+    }
+}
+
+SimdLevel GetSimd()
+{
+    return CurrentSimd;
+}
+
+void SetSimd(SimdLevel level)
+{
+    CurrentSimd = IsSimdSupported(level) ? level : kSimd_None;
+}
+
+const char *GetSimdName(SimdLevel level)
+{
+    switch (level)
+    {
+    case kSimd_SSE2: return "SSE2";
+    case kSimd_AVX2: return "AVX2";
+    case kSimd_NEON: return "NEON";
+    default: return "none";
+    }
+}
+
+void AlphaBlendRow(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    switch (CurrentSimd)
+    {
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2: AlphaBlendRow_AVX2(dst, src, count); return;
+#endif
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: AlphaBlendRow_SSE2(dst, src, count); return;
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: AlphaBlendRow_NEON(dst, src, count); return;
+#endif
+    default: AlphaBlendRow_Scalar(dst, src, count); return;
+    }
+}
+
+void AlphaBlendOpacityRow(uint32_t *dst, const uint32_t *src, size_t count, int opacity)
+{
+    const uint32_t op = static_cast<uint32_t>(std::min(std::max(opacity, 0), 0xFF));
+    switch (CurrentSimd)
+    {
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2: AlphaBlendOpacityRow_AVX2(dst, src, count, op); return;
+#endif
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: AlphaBlendOpacityRow_SSE2(dst, src, count, op); return;
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: AlphaBlendOpacityRow_NEON(dst, src, count, op); return;
+#endif
+    default: AlphaBlendOpacityRow_Scalar(dst, src, count, op); return;
+    }
+}
+
+void TransBlendRow(uint32_t *dst, const uint32_t *src, size_t count, int alpha)
+{
+    const uint32_t n = IncNonZero(static_cast<uint32_t>(std::min(std::max(alpha, 0), 0xFF)));
+    switch (CurrentSimd)
+    {
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2: TransBlendRow_AVX2(dst, src, count, n); return;
+#endif
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: TransBlendRow_SSE2(dst, src, count, n); return;
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: TransBlendRow_NEON(dst, src, count, n); return;
+#endif
+    default: TransBlendRow_Scalar(dst, src, count, n); return;
+    }
+}
+
+void MaskedCopyRow(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    switch (CurrentSimd)
+    {
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2: MaskedCopyRow_AVX2(dst, src, count); return;
+#endif
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: MaskedCopyRow_SSE2(dst, src, count); return;
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: MaskedCopyRow_NEON(dst, src, count); return;
+#endif
+    default: MaskedCopyRow_Scalar(dst, src, count); return;
+    }
+}
+
+void TintRow(uint32_t *dst, size_t count, uint32_t color, int amount)
+{
+    const uint32_t n = IncNonZero(static_cast<uint32_t>(std::min(std::max(amount, 0), 0xFF)));
+    switch (CurrentSimd)
+    {
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2: TintRow_AVX2(dst, count, color, n); return;
+#endif
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: TintRow_SSE2(dst, count, color, n); return;
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: TintRow_NEON(dst, count, color, n); return;
+#endif
+    default: TintRow_Scalar(dst, count, color, n); return;
+    }
+}
+
+void ValueMapRow(uint32_t *dst, const uint32_t *src, size_t count, const uint32_t *table)
+{
+    switch (CurrentSimd)
+    {
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2: ValueMapRow_AVX2(dst, src, count, table); return;
+#endif
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: ValueMapRow_SSE2(dst, src, count, table); return;
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: ValueMapRow_NEON(dst, src, count, table); return;
+#endif
+    default: ValueMapRow_Scalar(dst, src, count, table); return;
+    }
+}
+
+void ValueMapBlendRow(uint32_t *dst, const uint32_t *src, size_t count, const uint32_t *table, int amount)
+{
+    const uint32_t n = IncNonZero(static_cast<uint32_t>(std::min(std::max(amount, 0), 0xFF)));
+    switch (CurrentSimd)
+    {
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2: ValueMapBlendRow_AVX2(dst, src, count, table, n); return;
+#endif
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: ValueMapBlendRow_SSE2(dst, src, count, table, n); return;
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: ValueMapBlendRow_NEON(dst, src, count, table, n); return;
+#endif
+    default: ValueMapBlendRow_Scalar(dst, src, count, table, n); return;
+    }
+}
+
+void LightRow(uint32_t *dst, const uint32_t *src, size_t count, uint32_t color, int amount)
+{
+    const uint32_t n = IncNonZero(static_cast<uint32_t>(std::min(std::max(amount, 0), 0xFF)));
+    switch (CurrentSimd)
+    {
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2: LightRow_AVX2(dst, src, count, color, n); return;
+#endif
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: LightRow_SSE2(dst, src, count, color, n); return;
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: LightRow_NEON(dst, src, count, color, n); return;
+#endif
+    default: LightRow_Scalar(dst, src, count, color, n); return;
+    }
+}
+
+void SwapRedBlueRow(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    switch (CurrentSimd)
+    {
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2: SwapRedBlueRow_AVX2(dst, src, count); return;
+#endif
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: SwapRedBlueRow_SSE2(dst, src, count); return;
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: SwapRedBlueRow_NEON(dst, src, count); return;
+#endif
+    default: SwapRedBlueRow_Scalar(dst, src, count); return;
+    }
+}
+
+void Convert16To32Row(uint32_t *dst, const uint16_t *src, size_t count, const PixelConversion &conv)
+{
+    const ConvParams p = MakeConvParams(conv);
+    switch (CurrentSimd)
+    {
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2: Convert16To32Row_AVX2(dst, src, count, p); return;
+#endif
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: Convert16To32Row_SSE2(dst, src, count, p); return;
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: Convert16To32Row_NEON(dst, src, count, p); return;
+#endif
+    default: Convert16To32Row_Scalar(dst, src, count, p); return;
+    }
+}
+
+void Convert32To16Row(uint16_t *dst, const uint32_t *src, size_t count, const PixelConversion &conv)
+{
+    const ConvParams p = MakeConvParams(conv);
+    switch (CurrentSimd)
+    {
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2: Convert32To16Row_AVX2(dst, src, count, p); return;
+#endif
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: Convert32To16Row_SSE2(dst, src, count, p); return;
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: Convert32To16Row_NEON(dst, src, count, p); return;
+#endif
+    default: Convert32To16Row_Scalar(dst, src, count, p); return;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Bitmap kernels
+//-----------------------------------------------------------------------------
+
+// Clips the source rectangle placed at dst_x, dst_y to the destination's
+// clipping rect; returns false if nothing is left to draw
+static bool ClipBlit(const Bitmap *dst, const Bitmap *src, int &dst_x, int &dst_y,
+    int &src_x, int &src_y, int &width, int &height)
+{
+    const Rect clip = dst->GetClip();
+    src_x = std::max(0, clip.Left - dst_x);
+    src_y = std::max(0, clip.Top - dst_y);
+    width = std::min(src->GetWidth(), clip.Right + 1 - dst_x) - src_x;
+    height = std::min(src->GetHeight(), clip.Bottom + 1 - dst_y) - src_y;
+    dst_x += src_x;
+    dst_y += src_y;
+    return (width > 0) && (height > 0);
+}
+
+// Gets Allegro's current color component shifts for the given color depth
+static void GetComponentShifts(int depth, int shifts[3])
+{
+    switch (depth)
+    {
+    case 15: shifts[0] = _rgb_r_shift_15; shifts[1] = _rgb_g_shift_15; shifts[2] = _rgb_b_shift_15; break;
+    case 16: shifts[0] = _rgb_r_shift_16; shifts[1] = _rgb_g_shift_16; shifts[2] = _rgb_b_shift_16; break;
+    default: shifts[0] = _rgb_r_shift_32; shifts[1] = _rgb_g_shift_32; shifts[2] = _rgb_b_shift_32; break;
+    }
+}
+
+template <typename TRowFn>
+static void BlitRows(Bitmap *dst, const Bitmap *src, int dst_x, int dst_y, TRowFn row_fn)
+{
+    int src_x, src_y, width, height;
+    if ((dst->GetColorDepth() != 32) || (src->GetColorDepth() != 32) ||
+        !ClipBlit(dst, src, dst_x, dst_y, src_x, src_y, width, height))
+        return;
+    for (int y = 0; y < height; ++y)
+    {
+        uint32_t *dst_row = reinterpret_cast<uint32_t*>(dst->GetScanLineForWriting(dst_y + y)) + dst_x;
+        const uint32_t *src_row = reinterpret_cast<const uint32_t*>(src->GetScanLine(src_y + y)) + src_x;
+        row_fn(dst_row, src_row, static_cast<size_t>(width));
+    }
+}
+
+void AlphaBlend(Bitmap *dst, const Bitmap *src, int dst_x, int dst_y, int opacity)
+{
+    if (opacity >= 0xFF)
+        BlitRows(dst, src, dst_x, dst_y, AlphaBlendRow);
+    else
+        BlitRows(dst, src, dst_x, dst_y,
+            [opacity](uint32_t *d, const uint32_t *s, size_t count) { AlphaBlendOpacityRow(d, s, count, opacity); });
+}
+
+void TransBlend(Bitmap *dst, const Bitmap *src, int dst_x, int dst_y, int alpha)
+{
+    BlitRows(dst, src, dst_x, dst_y,
+        [alpha](uint32_t *d, const uint32_t *s, size_t count) { TransBlendRow(d, s, count, alpha); });
+}
+
+void MaskedCopy(Bitmap *dst, const Bitmap *src, int dst_x, int dst_y)
+{
+    BlitRows(dst, src, dst_x, dst_y, MaskedCopyRow);
+}
+
+void Tint(Bitmap *dst, uint32_t color, int amount)
+{
+    if (dst->GetColorDepth() != 32)
+        return;
+    const Rect clip = dst->GetClip();
+    const int width = clip.GetWidth();
+    if (width <= 0)
+        return;
+    for (int y = clip.Top; y <= clip.Bottom; ++y)
+    {
+        uint32_t *row = reinterpret_cast<uint32_t*>(dst->GetScanLineForWriting(y)) + clip.Left;
+        TintRow(row, static_cast<size_t>(width), color, amount);
+    }
+}
+
+
+void ValueMap(Bitmap *dst, const Bitmap *src, const uint32_t *table)
+{
+    BlitRows(dst, src, 0, 0,
+        [table](uint32_t *d, const uint32_t *s, size_t count) { ValueMapRow(d, s, count, table); });
+}
+
+void ValueMapBlend(Bitmap *dst, const Bitmap *src, const uint32_t *table, int amount)
+{
+    BlitRows(dst, src, 0, 0,
+        [table, amount](uint32_t *d, const uint32_t *s, size_t count) { ValueMapBlendRow(d, s, count, table, amount); });
+}
+
+void Light(Bitmap *dst, const Bitmap *src, uint32_t color, int amount)
+{
+    BlitRows(dst, src, 0, 0,
+        [color, amount](uint32_t *d, const uint32_t *s, size_t count) { LightRow(d, s, count, color, amount); });
+}
+
+void SwapRedBlue(Bitmap *bmp)
+{
+    if (bmp->GetColorDepth() != 32)
+        return;
+    for (int y = 0; y < bmp->GetHeight(); ++y)
+    {
+        uint32_t *row = reinterpret_cast<uint32_t*>(bmp->GetScanLineForWriting(y));
+        SwapRedBlueRow(row, row, static_cast<size_t>(bmp->GetWidth()));
+    }
+}
+
+bool ConvertPixels(Bitmap *dst, const Bitmap *src)
+{
+    const int src_depth = src->GetColorDepth();
+    const int dst_depth = dst->GetColorDepth();
+    const bool from16 = (src_depth == 15 || src_depth == 16) && (dst_depth == 32);
+    const bool to16 = (src_depth == 32) && (dst_depth == 15 || dst_depth == 16);
+    // Dithered conversion depends on the pixel position, and is left to Allegro
+    const int conv_flags = get_color_conversion();
+    if ((!from16 && !to16) || (to16 && (conv_flags & COLORCONV_DITHER_HI)) ||
+        (src->GetWidth() != dst->GetWidth()) || (src->GetHeight() != dst->GetHeight()))
+        return false;
+
+    PixelConversion conv;
+    conv.SrcDepth = src_depth;
+    conv.DstDepth = dst_depth;
+    GetComponentShifts(src_depth, conv.SrcShift);
+    GetComponentShifts(dst_depth, conv.DstShift);
+    conv.KeepMask = (conv_flags & COLORCONV_KEEP_TRANS) != 0;
+    conv.SrcMask = static_cast<uint32_t>(src->GetMaskColor());
+    conv.DstMask = static_cast<uint32_t>(dst->GetMaskColor());
+    // Same as the Allegro's blit chooses the mask color replacement
+    int g = 0, rc;
+    do
+        rc = makecol_depth(dst_depth, 255, ++g, 255);
+    while (static_cast<uint32_t>(rc) == conv.DstMask);
+    conv.DstMaskReplacement = static_cast<uint32_t>(rc);
+
+    const size_t width = static_cast<size_t>(src->GetWidth());
+    for (int y = 0; y < src->GetHeight(); ++y)
+    {
+        if (from16)
+            Convert16To32Row(reinterpret_cast<uint32_t*>(dst->GetScanLineForWriting(y)),
+                reinterpret_cast<const uint16_t*>(src->GetScanLine(y)), width, conv);
+        else
+            Convert32To16Row(reinterpret_cast<uint16_t*>(dst->GetScanLineForWriting(y)),
+                reinterpret_cast<const uint32_t*>(src->GetScanLine(y)), width, conv);
+    }
+    return true;
+}
+} // namespace BlitKernels
+
+} // namespace Common
+} // namespace AGS
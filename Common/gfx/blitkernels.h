@@ -0,0 +1,136 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Blit kernels: vectorized implementations of the most common 32-bit
+// blending operations, used by the software renderer.
+//
+// Each kernel produces exactly the same result as the corresponding Allegro
+// blit with the blender callback, but processes several pixels at once,
+// using SSE2 or AVX2 on x86 and NEON on ARM, with a scalar fallback.
+// The best instruction set is selected at runtime, depending on what the
+// CPU supports; SIMD may be disabled altogether by defining AGS_DISABLE_SIMD.
+//
+// All kernels treat MASK_COLOR_32 source pixels as transparent, like the
+// Allegro's sprite blits do. Bitmap variants require both bitmaps to be
+// 32-bit, and clip the drawing to the destination's clipping rectangle.
+//
+// Pixel conversion kernels reproduce the Allegro's blit between 15/16-bit
+// and 32-bit bitmaps, including the handling of the mask color.
+//
+//=============================================================================
+#ifndef __AGS_CN_GFX__BLITKERNELS_H
+#define __AGS_CN_GFX__BLITKERNELS_H
+
+#include <stddef.h>
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class Bitmap;
+
+// Describes a conversion between two pixel formats, following the rules
+// of the Allegro's color converting blit
+struct PixelConversion
+{
+    // Color depths: 15, 16 or 32
+    int SrcDepth = 0;
+    int DstDepth = 0;
+    // Component shifts, in the order of red, green, blue
+    int SrcShift[3] = {};
+    int DstShift[3] = {};
+    // Whether to convert source mask color into the destination's mask color;
+    // the pixels which become a mask color by chance are then replaced
+    bool KeepMask = false;
+    uint32_t SrcMask = 0u;
+    uint32_t DstMask = 0u;
+    uint32_t DstMaskReplacement = 0u;
+};
+
+enum SimdLevel
+{
+    kSimd_None,
+    kSimd_SSE2,
+    kSimd_AVX2,
+    kSimd_NEON
+};
+
+namespace BlitKernels
+{
+    // Tells if the given instruction set is supported by both the build and CPU
+    bool        IsSimdSupported(SimdLevel level);
+    // Gets the instruction set currently used by kernels
+    SimdLevel   GetSimd();
+    // Selects the instruction set to use; unsupported level falls back to scalar code
+    void        SetSimd(SimdLevel level);
+    const char *GetSimdName(SimdLevel level);
+
+    // Row kernels, processing count pixels.
+    // Alpha blend of ARGB source, same as Allegro's _blender_alpha32
+    void AlphaBlendRow(uint32_t *dst, const uint32_t *src, size_t count);
+    // Alpha blend of ARGB source with a global opacity (0 - 255) applied
+    // to the source alpha, same as software renderer's _trans_alpha_blender32
+    void AlphaBlendOpacityRow(uint32_t *dst, const uint32_t *src, size_t count, int opacity);
+    // Translucent blend of RGB source with a constant alpha (0 - 255),
+    // same as Allegro's trans blender
+    void TransBlendRow(uint32_t *dst, const uint32_t *src, size_t count, int alpha);
+    // Copies source pixels, skipping the mask color
+    void MaskedCopyRow(uint32_t *dst, const uint32_t *src, size_t count);
+    // Blends the constant color over destination pixels with a given amount
+    // (0 - 255), skipping the pixels of mask color; same as Allegro's
+    // draw_lit_sprite with a trans blender
+    void TintRow(uint32_t *dst, size_t count, uint32_t color, int amount);
+    // Replaces the RGB of each source pixel with a table entry, indexed by
+    // its max color component, keeping the alpha; mask pixels are copied as-is.
+    // This is what the HSV tint blenders do, since their result only depends
+    // on the "value" of the source pixel.
+    void ValueMapRow(uint32_t *dst, const uint32_t *src, size_t count, const uint32_t *table);
+    // Same as ValueMapRow, but also blends the mapped pixels over the source
+    // pixels with a given amount (0 - 255), keeping the source alpha
+    void ValueMapBlendRow(uint32_t *dst, const uint32_t *src, size_t count, const uint32_t *table, int amount);
+    // Blends the constant color over source pixels with a given amount
+    // (0 - 255), keeping the source alpha; mask pixels are copied as-is.
+    // Same as draw_lit_sprite with the engine's alpha preserving trans blender.
+    void LightRow(uint32_t *dst, const uint32_t *src, size_t count, uint32_t color, int amount);
+    // Swaps red and blue components of the pixels, may be done in place
+    void SwapRedBlueRow(uint32_t *dst, const uint32_t *src, size_t count);
+    // Converts 15/16-bit pixels to 32-bit and back
+    void Convert16To32Row(uint32_t *dst, const uint16_t *src, size_t count, const PixelConversion &conv);
+    void Convert32To16Row(uint16_t *dst, const uint32_t *src, size_t count, const PixelConversion &conv);
+
+    // Bitmap kernels, drawing src onto dst at the given position
+    // Alpha blends src; opacity of 255 means a plain alpha blend
+    void AlphaBlend(Bitmap *dst, const Bitmap *src, int dst_x, int dst_y, int opacity = 0xFF);
+    void TransBlend(Bitmap *dst, const Bitmap *src, int dst_x, int dst_y, int alpha);
+    void MaskedCopy(Bitmap *dst, const Bitmap *src, int dst_x, int dst_y);
+    // Tints the destination's clipping rectangle with the color
+    void Tint(Bitmap *dst, uint32_t color, int amount);
+    // Bitmap kernels, writing the processed src into dst at 0,0
+    void ValueMap(Bitmap *dst, const Bitmap *src, const uint32_t *table);
+    void ValueMapBlend(Bitmap *dst, const Bitmap *src, const uint32_t *table, int amount);
+    void Light(Bitmap *dst, const Bitmap *src, uint32_t color, int amount);
+    void SwapRedBlue(Bitmap *bmp);
+    // Converts src pixels into dst of the same size and different color depth,
+    // using the current Allegro's pixel format and color conversion settings;
+    // returns false if this conversion is not supported by kernels, in which
+    // case the caller should use the regular blit
+    bool ConvertPixels(Bitmap *dst, const Bitmap *src);
+} // namespace BlitKernels
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_GFX__BLITKERNELS_H
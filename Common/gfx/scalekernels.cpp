@@ -0,0 +1,375 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/scalekernels.h"
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "gfx/blitkernels.h"
+#include "gfx/simd.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace ScaleKernels
+{
+
+static inline const uint32_t *GetRow(const uint32_t *base, size_t pitch, int y)
+{
+    return reinterpret_cast<const uint32_t*>(reinterpret_cast<const uint8_t*>(base) + pitch * y);
+}
+
+static inline uint32_t *GetRow(uint32_t *base, size_t pitch, int y)
+{
+    return reinterpret_cast<uint32_t*>(reinterpret_cast<uint8_t*>(base) + pitch * y);
+}
+
+static inline bool UseSSE2()
+{
+#if defined(AGS_SIMD_SSE2)
+    const SimdLevel simd = BlitKernels::GetSimd();
+    return (simd == kSimd_SSE2) || (simd == kSimd_AVX2);
+#else
+    return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Scalar implementation
+//-----------------------------------------------------------------------------
+
+static void ReplicateRow_Scalar(uint32_t *dst, const uint32_t *src, size_t count, int factor)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t px = src[i];
+        for (int k = 0; k < factor; ++k)
+            *(dst++) = px;
+    }
+}
+
+// Interpolates between a and b with a weight of b being f / 256, for each
+// of the 4 channels; two channels are processed at once in 16-bit lanes.
+static inline uint32_t LerpPixel(uint32_t a, uint32_t b, uint32_t f)
+{
+    const uint32_t nf = 256 - f;
+    const uint32_t rb = (((a & 0xFF00FF) * nf + (b & 0xFF00FF) * f) >> 8) & 0xFF00FF;
+    const uint32_t ag = (((a >> 8) & 0xFF00FF) * nf + ((b >> 8) & 0xFF00FF) * f) & 0xFF00FF00;
+    return rb | ag;
+}
+
+static void LerpRows_Scalar(uint32_t *dst, const uint32_t *row0, const uint32_t *row1, size_t count, uint32_t f)
+{
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = LerpPixel(row0[i], row1[i], f);
+}
+
+static void LerpColumns_Scalar(uint32_t *dst, const uint32_t *row, const int *xs, const uint16_t *xw, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = LerpPixel(row[xs[i]], row[xs[i] + 1], xw[i * 4]);
+}
+
+//-----------------------------------------------------------------------------
+// SSE2 implementation
+//-----------------------------------------------------------------------------
+#if defined(AGS_SIMD_SSE2)
+
+static void ReplicateRow_SSE2(uint32_t *dst, const uint32_t *src, size_t count, int factor)
+{
+    size_t i = 0;
+    switch (factor)
+    {
+    case 2:
+        for (; i + 4 <= count; i += 4, dst += 8)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi32(v, v));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4), _mm_unpackhi_epi32(v, v));
+        }
+        break;
+    case 3:
+        for (; i + 4 <= count; i += 4, dst += 12)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 0, 0)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4), _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 2, 1, 1)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 2)));
+        }
+        break;
+    default: // 4 and more, fill whole vectors with each pixel
+        for (; i < count; ++i)
+        {
+            const __m128i v = _mm_set1_epi32(static_cast<int>(src[i]));
+            int k = 0;
+            for (; k + 4 <= factor; k += 4, dst += 4)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+            for (; k < factor; ++k)
+                *(dst++) = src[i];
+        }
+        break;
+    }
+    ReplicateRow_Scalar(dst, src + i, count - i, factor);
+}
+
+static void LerpRows_SSE2(uint32_t *dst, const uint32_t *row0, const uint32_t *row1, size_t count, uint32_t f)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w0 = _mm_set1_epi16(static_cast<short>(256 - f));
+    const __m128i w1 = _mm_set1_epi16(static_cast<short>(f));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + i));
+        const __m128i lo = _mm_srli_epi16(_mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), w0),
+            _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w1)), 8);
+        const __m128i hi = _mm_srli_epi16(_mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), w0),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w1)), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    LerpRows_Scalar(dst + i, row0 + i, row1 + i, count - i, f);
+}
+
+static void LerpColumns_SSE2(uint32_t *dst, const uint32_t *row, const int *xs, const uint16_t *xw, size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w_max = _mm_set1_epi16(256);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        // gather pairs of the neighbouring pixels, and arrange them as [l0 l1 r0 r1]
+        const __m128i p0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + xs[i]));
+        const __m128i p1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + xs[i + 1]));
+        const __m128i lr = _mm_shuffle_epi32(_mm_unpacklo_epi64(p0, p1), _MM_SHUFFLE(3, 1, 2, 0));
+        const __m128i w1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(xw + i * 4));
+        const __m128i w0 = _mm_sub_epi16(w_max, w1);
+        const __m128i res = _mm_srli_epi16(_mm_add_epi16(
+            _mm_mullo_epi16(_mm_unpacklo_epi8(lr, zero), w0),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(lr, zero), w1)), 8);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(res, res));
+    }
+    LerpColumns_Scalar(dst + i, row, xs + i, xw + i * 4, count - i);
+}
+
+#endif // AGS_SIMD_SSE2
+
+//-----------------------------------------------------------------------------
+// Dispatch
+//-----------------------------------------------------------------------------
+
+static void ReplicateRow(uint32_t *dst, const uint32_t *src, size_t count, int factor)
+{
+#if defined(AGS_SIMD_SSE2)
+    if (UseSSE2())
+    {
+        ReplicateRow_SSE2(dst, src, count, factor);
+        return;
+    }
+#endif
+    ReplicateRow_Scalar(dst, src, count, factor);
+}
+
+static void LerpRows(uint32_t *dst, const uint32_t *row0, const uint32_t *row1, size_t count, uint32_t f)
+{
+#if defined(AGS_SIMD_SSE2)
+    if (UseSSE2())
+    {
+        LerpRows_SSE2(dst, row0, row1, count, f);
+        return;
+    }
+#endif
+    LerpRows_Scalar(dst, row0, row1, count, f);
+}
+
+static void LerpColumns(uint32_t *dst, const uint32_t *row, const int *xs, const uint16_t *xw, size_t count)
+{
+#if defined(AGS_SIMD_SSE2)
+    if (UseSSE2())
+    {
+        LerpColumns_SSE2(dst, row, xs, xw, count);
+        return;
+    }
+#endif
+    LerpColumns_Scalar(dst, row, xs, xw, count);
+}
+
+void ScaleNearest(const uint32_t *src, size_t src_pitch, int src_w, int src_h,
+    uint32_t *dst, size_t dst_pitch, int dst_w, int dst_h, int dst_y1, int dst_y2)
+{
+    if ((src_w <= 0) || (src_h <= 0) || (dst_w <= 0) || (dst_h <= 0))
+        return;
+    dst_y1 = std::max(0, dst_y1);
+    dst_y2 = std::min(dst_h, dst_y2);
+
+    const bool int_scale_x = (dst_w % src_w) == 0;
+    std::vector<int> xs;
+    if (!int_scale_x)
+    {
+        xs.resize(dst_w);
+        for (int x = 0; x < dst_w; ++x)
+            xs[x] = static_cast<int>(static_cast<int64_t>(x) * src_w / dst_w);
+    }
+
+    int last_sy = -1;
+    const uint32_t *last_row = nullptr;
+    for (int y = dst_y1; y < dst_y2; ++y)
+    {
+        const int sy = static_cast<int>(static_cast<int64_t>(y) * src_h / dst_h);
+        uint32_t *dst_row = GetRow(dst, dst_pitch, y);
+        if (sy == last_sy)
+        {
+            // same source row as before, copy the already scaled one
+            memcpy(dst_row, last_row, dst_w * sizeof(uint32_t));
+            continue;
+        }
+
+        const uint32_t *src_row = GetRow(src, src_pitch, sy);
+        if (int_scale_x)
+        {
+            ReplicateRow(dst_row, src_row, src_w, dst_w / src_w);
+        }
+        else
+        {
+            for (int x = 0; x < dst_w; ++x)
+                dst_row[x] = src_row[xs[x]];
+        }
+        last_sy = sy;
+        last_row = dst_row;
+    }
+}
+
+// Calculates the source position corresponding to the center of the
+// destination pixel, in 8.8 fixed point, clamped to the source bounds
+static inline int GetSamplePos(int d, int src_len, int dst_len)
+{
+    const int64_t pos = (static_cast<int64_t>(2 * d + 1) * src_len * 128) / dst_len - 128;
+    return static_cast<int>(std::min<int64_t>(std::max<int64_t>(pos, 0), (src_len - 1) * 256));
+}
+
+void ScaleBilinear(const uint32_t *src, size_t src_pitch, int src_w, int src_h,
+    uint32_t *dst, size_t dst_pitch, int dst_w, int dst_h, int dst_y1, int dst_y2)
+{
+    if ((src_w <= 0) || (src_h <= 0) || (dst_w <= 0) || (dst_h <= 0))
+        return;
+    dst_y1 = std::max(0, dst_y1);
+    dst_y2 = std::min(dst_h, dst_y2);
+
+    // Horizontal sample positions and weights; weights are repeated for each
+    // channel, which lets vectorized code load them directly
+    std::vector<int> xs(dst_w);
+    std::vector<uint16_t> xw(dst_w * 4);
+    for (int x = 0; x < dst_w; ++x)
+    {
+        const int pos = GetSamplePos(x, src_w, dst_w);
+        xs[x] = pos >> 8;
+        std::fill(&xw[x * 4], &xw[x * 4] + 4, static_cast<uint16_t>(pos & 0xFF));
+    }
+    // Vertically interpolated source row; has an extra pixel at the end,
+    // so that the rightmost sample may always read a pair of pixels
+    std::vector<uint32_t> row(src_w + 1);
+
+    for (int y = dst_y1; y < dst_y2; ++y)
+    {
+        const int pos = GetSamplePos(y, src_h, dst_h);
+        const int sy = pos >> 8;
+        const uint32_t fy = pos & 0xFF;
+        const uint32_t *row0 = GetRow(src, src_pitch, sy);
+        if (fy == 0)
+        {
+            memcpy(row.data(), row0, src_w * sizeof(uint32_t));
+        }
+        else
+        {
+            const uint32_t *row1 = GetRow(src, src_pitch, std::min(sy + 1, src_h - 1));
+            LerpRows(row.data(), row0, row1, src_w, fy);
+        }
+        row[src_w] = row[src_w - 1];
+        LerpColumns(GetRow(dst, dst_pitch, y), row.data(), xs.data(), xw.data(), dst_w);
+    }
+}
+
+void ScalePixelArt(const uint32_t *src, size_t src_pitch, int src_w, int src_h,
+    uint32_t *dst, size_t dst_pitch, int factor, int src_y1, int src_y2)
+{
+    if ((src_w <= 0) || (src_h <= 0) || (factor < 2) || (factor > 3))
+        return;
+    src_y1 = std::max(0, src_y1);
+    src_y2 = std::min(src_h, src_y2);
+
+    // Pixel neighbourhood is named as:
+    //   A B C
+    //   D E F
+    //   G H I
+    // the edge pixels are repeated outside of the image.
+    for (int y = src_y1; y < src_y2; ++y)
+    {
+        const uint32_t *row_up = GetRow(src, src_pitch, std::max(y - 1, 0));
+        const uint32_t *row = GetRow(src, src_pitch, y);
+        const uint32_t *row_dn = GetRow(src, src_pitch, std::min(y + 1, src_h - 1));
+        uint32_t *dst0 = GetRow(dst, dst_pitch, y * factor);
+        uint32_t *dst1 = GetRow(dst, dst_pitch, y * factor + 1);
+        for (int x = 0; x < src_w; ++x)
+        {
+            const int xl = std::max(x - 1, 0);
+            const int xr = std::min(x + 1, src_w - 1);
+            const uint32_t B = row_up[x], D = row[xl], E = row[x], F = row[xr], H = row_dn[x];
+            if (factor == 2)
+            {
+                uint32_t *d0 = dst0 + x * 2, *d1 = dst1 + x * 2;
+                if ((B != H) && (D != F))
+                {
+                    d0[0] = (D == B) ? D : E;
+                    d0[1] = (B == F) ? F : E;
+                    d1[0] = (D == H) ? D : E;
+                    d1[1] = (H == F) ? F : E;
+                }
+                else
+                {
+                    d0[0] = d0[1] = d1[0] = d1[1] = E;
+                }
+            }
+            else
+            {
+                uint32_t *d0 = dst0 + x * 3, *d1 = dst1 + x * 3;
+                uint32_t *d2 = GetRow(dst, dst_pitch, y * 3 + 2) + x * 3;
+                if ((B != H) && (D != F))
+                {
+                    const uint32_t A = row_up[xl], C = row_up[xr], G = row_dn[xl], I = row_dn[xr];
+                    d0[0] = (D == B) ? D : E;
+                    d0[1] = (((D == B) && (E != C)) || ((B == F) && (E != A))) ? B : E;
+                    d0[2] = (B == F) ? F : E;
+                    d1[0] = (((D == B) && (E != G)) || ((D == H) && (E != A))) ? D : E;
+                    d1[1] = E;
+                    d1[2] = (((B == F) && (E != I)) || ((H == F) && (E != C))) ? F : E;
+                    d2[0] = (D == H) ? D : E;
+                    d2[1] = (((D == H) && (E != I)) || ((H == F) && (E != G))) ? H : E;
+                    d2[2] = (H == F) ? F : E;
+                }
+                else
+                {
+                    d0[0] = d0[1] = d0[2] = d1[0] = d1[1] = d1[2] = d2[0] = d2[1] = d2[2] = E;
+                }
+            }
+        }
+    }
+}
+
+} // namespace ScaleKernels
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,59 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Scale kernels: scaling of the 32-bit images, used by the software
+// renderer's graphic filters to upscale the final game frame.
+//
+// All kernels take raw pixel buffers with the pitch (row length) in bytes,
+// and only fill the given range of the destination rows, so that the work
+// may be split between several threads. The results do not depend on how
+// the rows are split, nor on the instruction set in use.
+//
+// The instruction set is the one selected by BlitKernels::SetSimd.
+// Vectorized variants are currently implemented for x86 (SSE2, also used
+// when AVX2 is selected); other CPUs run the scalar code.
+//
+//=============================================================================
+#ifndef __AGS_CN_GFX__SCALEKERNELS_H
+#define __AGS_CN_GFX__SCALEKERNELS_H
+
+#include <stddef.h>
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace ScaleKernels
+{
+    // Nearest-neighbour scaling of src into dst, for the dst rows in
+    // [dst_y1, dst_y2). Integer scale factors use a faster pixel replication.
+    void ScaleNearest(const uint32_t *src, size_t src_pitch, int src_w, int src_h,
+        uint32_t *dst, size_t dst_pitch, int dst_w, int dst_h, int dst_y1, int dst_y2);
+    // Bilinear scaling of src into dst, for the dst rows in [dst_y1, dst_y2).
+    // Interpolates all 4 channels, with 8-bit precision of the sample position.
+    void ScaleBilinear(const uint32_t *src, size_t src_pitch, int src_w, int src_h,
+        uint32_t *dst, size_t dst_pitch, int dst_w, int dst_h, int dst_y1, int dst_y2);
+    // Edge-preserving pixel art upscaling by the factor of 2 or 3, using the
+    // Scale2x / Scale3x (also known as AdvMAME2x/3x) algorithm. dst must be
+    // factor times larger than src. Processes the src rows in [src_y1, src_y2).
+    void ScalePixelArt(const uint32_t *src, size_t src_pitch, int src_w, int src_h,
+        uint32_t *dst, size_t dst_pitch, int factor, int src_y1, int src_y2);
+} // namespace ScaleKernels
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_GFX__SCALEKERNELS_H
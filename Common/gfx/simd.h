@@ -0,0 +1,52 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Compile-time selection of the SIMD instruction sets for the pixel kernels.
+// This header is only meant for the kernel implementations; the instruction
+// set used at runtime is chosen by BlitKernels::SetSimd.
+//
+// AGS_SIMD_SSE2 and AGS_SIMD_AVX2 are defined for x86 builds (AVX2 functions
+// are compiled with a target attribute and only called if CPU supports it),
+// AGS_SIMD_NEON for ARM builds. Define AGS_DISABLE_SIMD to use scalar code.
+//
+//=============================================================================
+#ifndef __AGS_CN_GFX__SIMD_H
+#define __AGS_CN_GFX__SIMD_H
+
+#if !defined(AGS_DISABLE_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define AGS_SIMD_SSE2 1
+#define AGS_SIMD_AVX2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define AGS_SIMD_NEON 1
+#endif
+#endif // !AGS_DISABLE_SIMD
+
+#if defined(AGS_SIMD_SSE2)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define AGS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define AGS_TARGET_AVX2
+#endif
+#endif
+
+#if defined(AGS_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+#endif // __AGS_CN_GFX__SIMD_H
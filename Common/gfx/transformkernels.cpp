@@ -0,0 +1,385 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/transformkernels.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <allegro.h>
+#include <allegro/internal/aintern.h>
+#include "gfx/blitkernels.h"
+#include "gfx/simd.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace TransformKernels
+{
+
+static const uint32_t MaskColor32 = 0x00FF00FF; // MASK_COLOR_32
+
+static inline const uint32_t *GetRow(const uint32_t *base, size_t pitch, int y)
+{
+    return reinterpret_cast<const uint32_t*>(reinterpret_cast<const uint8_t*>(base) + pitch * y);
+}
+
+static inline uint32_t *GetRow(uint32_t *base, size_t pitch, int y)
+{
+    return reinterpret_cast<uint32_t*>(reinterpret_cast<uint8_t*>(base) + pitch * y);
+}
+
+//-----------------------------------------------------------------------------
+// Span maps
+//-----------------------------------------------------------------------------
+
+// The map being filled by the RecordSpan callback; Allegro's scanline
+// callback does not let pass any user data along
+static thread_local SpanMap *RecordedMap = nullptr;
+
+static void RecordSpan(BITMAP * /*bmp*/, BITMAP * /*spr*/, fixed l_bmp_x, int bmp_y, fixed r_bmp_x,
+    fixed l_spr_x, fixed l_spr_y, fixed spr_dx, fixed spr_dy)
+{
+    Span &span = RecordedMap->Rows[bmp_y];
+    span.X1 = l_bmp_x >> 16;
+    span.X2 = r_bmp_x >> 16;
+    span.SrcX = l_spr_x;
+    span.SrcY = l_spr_y;
+    RecordedMap->DX = spr_dx;
+    RecordedMap->DY = spr_dy;
+}
+
+// Creates a fake bitmap, only having the size and clipping rectangle,
+// which is all that the Allegro's parallelogram mapping needs to know
+static BITMAP *CreateBitmapHeader(int width, int height)
+{
+    BITMAP *bmp = static_cast<BITMAP*>(calloc(1, sizeof(BITMAP)));
+    bmp->w = bmp->cr = width;
+    bmp->h = bmp->cb = height;
+    bmp->clip = TRUE;
+    return bmp;
+}
+
+void MapRotation(SpanMap &map, int src_w, int src_h, int dst_w, int dst_h,
+    int dst_x, int dst_y, int src_cx, int src_cy, fixed_t angle)
+{
+    map.DX = map.DY = 0;
+    map.Rows.assign(std::max(0, dst_h), Span());
+    if (src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0)
+        return;
+
+    // Same as what pivot_sprite does, except for the scanline drawer
+    fixed xs[4], ys[4];
+    _rotate_scale_flip_coordinates(itofix(src_w), itofix(src_h), itofix(dst_x), itofix(dst_y),
+        itofix(src_cx), itofix(src_cy), angle, itofix(1), itofix(1), FALSE, FALSE, xs, ys);
+    BITMAP *dst_bmp = CreateBitmapHeader(dst_w, dst_h);
+    BITMAP *src_bmp = CreateBitmapHeader(src_w, src_h);
+    RecordedMap = &map;
+    _parallelogram_map(dst_bmp, src_bmp, xs, ys, RecordSpan, FALSE);
+    RecordedMap = nullptr;
+    free(dst_bmp);
+    free(src_bmp);
+}
+
+void MapScale(SpanMap &map, int src_w, int src_h, int dst_w, int dst_h)
+{
+    map.DX = map.DY = 0;
+    map.Rows.assign(std::max(0, dst_h), Span());
+    if (src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0)
+        return;
+
+    // Each pixel samples the source at the position of its centre
+    map.DX = static_cast<int32_t>((static_cast<int64_t>(src_w) << 16) / dst_w);
+    const int32_t src_x = static_cast<int32_t>((static_cast<int64_t>(src_w) << 16) / (2 * dst_w));
+    for (int y = 0; y < dst_h; ++y)
+    {
+        Span &span = map.Rows[y];
+        span.X1 = 0;
+        span.X2 = dst_w - 1;
+        span.SrcX = src_x;
+        span.SrcY = static_cast<int32_t>(((static_cast<int64_t>(2 * y + 1) * src_h) << 16) / (2 * dst_h));
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Scalar implementation
+//-----------------------------------------------------------------------------
+
+static void DrawNearestRow_Scalar(uint32_t *dst, int count, const uint32_t *src, size_t src_pitch,
+    int32_t sx, int32_t sy, int32_t dx, int32_t dy)
+{
+    for (int i = 0; i < count; ++i, sx += dx, sy += dy)
+    {
+        const uint32_t c = GetRow(src, src_pitch, sy >> 16)[sx >> 16];
+        if (c != MaskColor32)
+            dst[i] = c;
+    }
+}
+
+// Interpolates 4 source pixels around the sample position
+static inline bool SampleBilinear(const uint32_t *src, size_t src_pitch, int src_w, int src_h,
+    int32_t sx, int32_t sy, bool has_alpha, uint32_t &result)
+{
+    // The source pixel centres are at the half of the fixed point unit
+    const int32_t fx = sx - 0x8000;
+    const int32_t fy = sy - 0x8000;
+    const int x = fx >> 16, y = fy >> 16;
+    const uint32_t wx = (fx >> 8) & 0xFF, wy = (fy >> 8) & 0xFF;
+    const int x0 = std::min(std::max(x, 0), src_w - 1), x1 = std::min(std::max(x + 1, 0), src_w - 1);
+    const int y0 = std::min(std::max(y, 0), src_h - 1), y1 = std::min(std::max(y + 1, 0), src_h - 1);
+    const uint32_t *row0 = GetRow(src, src_pitch, y0);
+    const uint32_t *row1 = GetRow(src, src_pitch, y1);
+    const uint32_t c[4] = { row0[x0], row0[x1], row1[x0], row1[x1] };
+    const uint32_t w[4] = { (256 - wx) * (256 - wy), wx * (256 - wy), (256 - wx) * wy, wx * wy };
+
+    // If all the pixels are fully opaque, then this is a plain weighted sum;
+    // two channels are processed at once in 32-bit halves of 64-bit values
+    const bool opaque = has_alpha ?
+        ((c[0] & c[1] & c[2] & c[3]) >= 0xFF000000) :
+        ((c[0] != MaskColor32) && (c[1] != MaskColor32) && (c[2] != MaskColor32) && (c[3] != MaskColor32));
+    if (opaque)
+    {
+        uint64_t rb = 0, ag = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            rb += w[i] * ((c[i] & 0xFF) | (static_cast<uint64_t>(c[i] & 0xFF0000) << 16));
+            ag += w[i] * (((c[i] >> 8) & 0xFF) | (static_cast<uint64_t>(c[i] >> 24) << 32));
+        }
+        rb = ((rb + 0x0000800000008000ULL) >> 16) & 0x000000FF000000FFULL;
+        ag = ((ag + 0x0000800000008000ULL) >> 16) & 0x000000FF000000FFULL;
+        const uint32_t argb = static_cast<uint32_t>(rb | (rb >> 16) | (ag << 8) | (ag >> 8));
+        result = (has_alpha || argb != MaskColor32) ? argb : (MaskColor32 | 0x100);
+        return true;
+    }
+
+    // Otherwise each pixel is weighted by its coverage, which is either its
+    // alpha, or 1 for any pixel except the mask color. Then the result is
+    // normalized by the total weight, which is 65536 for full coverage.
+    uint32_t k[4], total = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        k[i] = has_alpha ? w[i] * (c[i] >> 24) : ((c[i] != MaskColor32) ? w[i] : 0u);
+        total += k[i];
+    }
+    if (has_alpha)
+    {
+        const uint32_t alpha = (total + 0x8000) >> 16;
+        if (alpha == 0)
+            return false;
+        uint32_t rgb = 0;
+        for (int shift = 0; shift < 24; shift += 8)
+        {
+            const uint32_t sum = k[0] * ((c[0] >> shift) & 0xFF) + k[1] * ((c[1] >> shift) & 0xFF)
+                + k[2] * ((c[2] >> shift) & 0xFF) + k[3] * ((c[3] >> shift) & 0xFF);
+            rgb |= ((sum + total / 2) / total) << shift;
+        }
+        result = rgb | (alpha << 24);
+        return true;
+    }
+
+    if (total < 0x8000)
+        return false; // mostly transparent
+    uint32_t argb = 0;
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        const uint32_t sum = k[0] * ((c[0] >> shift) & 0xFF) + k[1] * ((c[1] >> shift) & 0xFF)
+            + k[2] * ((c[2] >> shift) & 0xFF) + k[3] * ((c[3] >> shift) & 0xFF);
+        argb |= ((sum + total / 2) / total) << shift;
+    }
+    // the result of interpolation must not become transparent by chance
+    result = (argb != MaskColor32) ? argb : (MaskColor32 | 0x100);
+    return true;
+}
+
+static void DrawBilinearRow(uint32_t *dst, int count, const uint32_t *src, size_t src_pitch,
+    int src_w, int src_h, int32_t sx, int32_t sy, int32_t dx, int32_t dy, bool has_alpha)
+{
+    for (int i = 0; i < count; ++i, sx += dx, sy += dy)
+    {
+        uint32_t c;
+        if (SampleBilinear(src, src_pitch, src_w, src_h, sx, sy, has_alpha, c))
+            dst[i] = c;
+    }
+}
+
+static void ReverseRow_Scalar(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = src[count - 1 - i];
+}
+
+//-----------------------------------------------------------------------------
+// SSE2 implementation
+//-----------------------------------------------------------------------------
+#if defined(AGS_SIMD_SSE2)
+
+static void ReverseRow_SSE2(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + count - i - 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+    ReverseRow_Scalar(dst + i, src, count - i);
+}
+
+//-----------------------------------------------------------------------------
+// AVX2 implementation
+//-----------------------------------------------------------------------------
+
+AGS_TARGET_AVX2 static void DrawNearestRow_AVX2(uint32_t *dst, int count, const uint32_t *src, size_t src_pitch,
+    int32_t sx, int32_t sy, int32_t dx, int32_t dy)
+{
+    // Source positions of 8 consecutive pixels, advanced by 8 steps at once;
+    // fixed point values wrap around exactly like the scalar accumulation
+    const __m256i steps = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i vx = _mm256_add_epi32(_mm256_set1_epi32(sx), _mm256_mullo_epi32(steps, _mm256_set1_epi32(dx)));
+    __m256i vy = _mm256_add_epi32(_mm256_set1_epi32(sy), _mm256_mullo_epi32(steps, _mm256_set1_epi32(dy)));
+    const __m256i step_x = _mm256_set1_epi32(static_cast<int32_t>(static_cast<uint32_t>(dx) * 8u));
+    const __m256i step_y = _mm256_set1_epi32(static_cast<int32_t>(static_cast<uint32_t>(dy) * 8u));
+    const __m256i pitch = _mm256_set1_epi32(static_cast<int32_t>(src_pitch / sizeof(uint32_t)));
+    const __m256i mask = _mm256_set1_epi32(static_cast<int32_t>(MaskColor32));
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i index = _mm256_add_epi32(
+            _mm256_mullo_epi32(_mm256_srai_epi32(vy, 16), pitch), _mm256_srai_epi32(vx, 16));
+        const __m256i c = _mm256_i32gather_epi32(reinterpret_cast<const int*>(src), index, 4);
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i),
+            _mm256_blendv_epi8(c, d, _mm256_cmpeq_epi32(c, mask)));
+        vx = _mm256_add_epi32(vx, step_x);
+        vy = _mm256_add_epi32(vy, step_y);
+    }
+    DrawNearestRow_Scalar(dst + i, count - i, src, src_pitch,
+        static_cast<int32_t>(static_cast<uint32_t>(sx) + static_cast<uint32_t>(dx) * i),
+        static_cast<int32_t>(static_cast<uint32_t>(sy) + static_cast<uint32_t>(dy) * i), dx, dy);
+}
+
+AGS_TARGET_AVX2 static void ReverseRow_AVX2(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + count - i - 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permutevar8x32_epi32(v, reverse));
+    }
+    ReverseRow_Scalar(dst + i, src, count - i);
+}
+
+#endif // AGS_SIMD_SSE2
+
+//-----------------------------------------------------------------------------
+// NEON implementation
+//-----------------------------------------------------------------------------
+#if defined(AGS_SIMD_NEON)
+
+static void ReverseRow_NEON(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint32x4_t v = vrev64q_u32(vld1q_u32(src + count - i - 4));
+        vst1q_u32(dst + i, vcombine_u32(vget_high_u32(v), vget_low_u32(v)));
+    }
+    ReverseRow_Scalar(dst + i, src, count - i);
+}
+
+#endif // AGS_SIMD_NEON
+
+//-----------------------------------------------------------------------------
+// Kernel dispatch
+//-----------------------------------------------------------------------------
+
+static void DrawNearestRow(uint32_t *dst, int count, const uint32_t *src, size_t src_pitch,
+    int32_t sx, int32_t sy, int32_t dx, int32_t dy)
+{
+#if defined(AGS_SIMD_AVX2)
+    if (BlitKernels::GetSimd() == kSimd_AVX2)
+    {
+        DrawNearestRow_AVX2(dst, count, src, src_pitch, sx, sy, dx, dy);
+        return;
+    }
+#endif
+    DrawNearestRow_Scalar(dst, count, src, src_pitch, sx, sy, dx, dy);
+}
+
+static void ReverseRow(uint32_t *dst, const uint32_t *src, size_t count)
+{
+    switch (BlitKernels::GetSimd())
+    {
+#if defined(AGS_SIMD_AVX2)
+    case kSimd_AVX2: ReverseRow_AVX2(dst, src, count); return;
+#endif
+#if defined(AGS_SIMD_SSE2)
+    case kSimd_SSE2: ReverseRow_SSE2(dst, src, count); return;
+#endif
+#if defined(AGS_SIMD_NEON)
+    case kSimd_NEON: ReverseRow_NEON(dst, src, count); return;
+#endif
+    default: ReverseRow_Scalar(dst, src, count); return;
+    }
+}
+
+void DrawNearest(const uint32_t *src, size_t src_pitch, int /*src_w*/, int /*src_h*/,
+    uint32_t *dst, size_t dst_pitch, const SpanMap &map, int dst_y1, int dst_y2)
+{
+    dst_y2 = std::min<int>(dst_y2, static_cast<int>(map.Rows.size()));
+    for (int y = std::max(0, dst_y1); y < dst_y2; ++y)
+    {
+        const Span &span = map.Rows[y];
+        if (span.X1 > span.X2)
+            continue;
+        DrawNearestRow(GetRow(dst, dst_pitch, y) + span.X1, span.X2 - span.X1 + 1,
+            src, src_pitch, span.SrcX, span.SrcY, map.DX, map.DY);
+    }
+}
+
+void DrawBilinear(const uint32_t *src, size_t src_pitch, int src_w, int src_h,
+    uint32_t *dst, size_t dst_pitch, const SpanMap &map, bool has_alpha, int dst_y1, int dst_y2)
+{
+    dst_y2 = std::min<int>(dst_y2, static_cast<int>(map.Rows.size()));
+    for (int y = std::max(0, dst_y1); y < dst_y2; ++y)
+    {
+        const Span &span = map.Rows[y];
+        if (span.X1 > span.X2)
+            continue;
+        DrawBilinearRow(GetRow(dst, dst_pitch, y) + span.X1, span.X2 - span.X1 + 1,
+            src, src_pitch, src_w, src_h, span.SrcX, span.SrcY, map.DX, map.DY, has_alpha);
+    }
+}
+
+void Flip(const uint32_t *src, size_t src_pitch, uint32_t *dst, size_t dst_pitch,
+    int width, int height, GraphicFlip flip, int dst_y1, int dst_y2)
+{
+    const bool flip_h = (flip == kFlip_Horizontal) || (flip == kFlip_Both);
+    const bool flip_v = (flip == kFlip_Vertical) || (flip == kFlip_Both);
+    dst_y2 = std::min(dst_y2, height);
+    for (int y = std::max(0, dst_y1); y < dst_y2; ++y)
+    {
+        const uint32_t *src_row = GetRow(src, src_pitch, flip_v ? (height - 1 - y) : y);
+        uint32_t *dst_row = GetRow(dst, dst_pitch, y);
+        if (flip_h)
+            ReverseRow(dst_row, src_row, width);
+        else
+            memcpy(dst_row, src_row, width * sizeof(uint32_t));
+    }
+}
+
+} // namespace TransformKernels
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,101 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Transform kernels: rotation, scaling and flipping of the 32-bit sprites,
+// used by the dynamic sprite operations.
+//
+// Rotation and scaling are done in two steps. First a SpanMap is built,
+// which tells which pixels of each destination row are covered by the
+// source image, and where these pixels sample the source. Then the rows are
+// drawn using the map, either with nearest-neighbour or bilinear sampling.
+// Like ScaleKernels, the drawing functions take raw pixel buffers and only
+// fill the given range of the destination rows, so that the work may be
+// split between several threads; the results do not depend on how the rows
+// are split, nor on the instruction set in use.
+//
+// Nearest-neighbour rotation produces exactly the same result as Allegro's
+// pivot_sprite, as the map is calculated by the same Allegro's routine.
+//
+//=============================================================================
+#ifndef __AGS_CN_GFX__TRANSFORMKERNELS_H
+#define __AGS_CN_GFX__TRANSFORMKERNELS_H
+
+#include <stddef.h>
+#include <vector>
+#include "core/types.h"
+#include "gfx/gfx_def.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+namespace TransformKernels
+{
+    // A run of the destination row's pixels [X1, X2], which sample the
+    // source at (SrcX, SrcY) for X1, and move by the map's (DX, DY) with each
+    // next pixel. Source coordinates are in 16.16 fixed point format, and
+    // point to the position of the destination pixel's centre.
+    struct Span
+    {
+        int X1 = 0;
+        int X2 = -1; // empty by default
+        int32_t SrcX = 0;
+        int32_t SrcY = 0;
+    };
+
+    // Tells how the destination pixels are mapped to the source image
+    struct SpanMap
+    {
+        // Source step per destination pixel, in 16.16 fixed point
+        int32_t DX = 0;
+        int32_t DY = 0;
+        // One span per destination row
+        std::vector<Span> Rows;
+    };
+
+    // Maps the source of src_w x src_h, rotated by the angle around its
+    // (src_cx, src_cy) point and placed with that point at (dst_x, dst_y),
+    // to the destination of dst_w x dst_h. The angle is in Allegro's format,
+    // where the full circle is 256 in 16.16 fixed point. The covered pixels
+    // are same as pivot_sprite would draw.
+    void MapRotation(SpanMap &map, int src_w, int src_h, int dst_w, int dst_h,
+        int dst_x, int dst_y, int src_cx, int src_cy, fixed_t angle);
+    // Maps the source of src_w x src_h stretched over the whole destination
+    // of dst_w x dst_h, with the pixel centres aligned
+    void MapScale(SpanMap &map, int src_w, int src_h, int dst_w, int dst_h);
+
+    // Draws the mapped source pixels for the dst rows in [dst_y1, dst_y2),
+    // taking the nearest source pixel and skipping the mask color
+    void DrawNearest(const uint32_t *src, size_t src_pitch, int src_w, int src_h,
+        uint32_t *dst, size_t dst_pitch, const SpanMap &map, int dst_y1, int dst_y2);
+    // Draws the mapped source pixels for the dst rows in [dst_y1, dst_y2),
+    // interpolating 4 nearest source pixels with 8-bit precision of the
+    // sample position; the samples outside of the source are clamped to its
+    // edge. If the source has alpha channel, then the pixels are weighted by
+    // their alpha, and the fully transparent results are skipped. Otherwise
+    // the mask color pixels are excluded from interpolation, and the result
+    // is only drawn if the other pixels contribute at least a half of it.
+    void DrawBilinear(const uint32_t *src, size_t src_pitch, int src_w, int src_h,
+        uint32_t *dst, size_t dst_pitch, const SpanMap &map, bool has_alpha, int dst_y1, int dst_y2);
+    // Copies src into dst of the same size, flipping it in the given
+    // direction; fills the dst rows in [dst_y1, dst_y2)
+    void Flip(const uint32_t *src, size_t src_pitch, uint32_t *dst, size_t dst_pitch,
+        int width, int height, GraphicFlip flip, int dst_y1, int dst_y2);
+} // namespace TransformKernels
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_GFX__TRANSFORMKERNELS_H
@@ -55,7 +55,7 @@ void GUIInvWindow::OnMouseUp()
 void GUIInvWindow::OnResized()
 {
     CalculateNumCells();
-    MarkChanged();
+    MarkPositionChanged(true);
 }
 
 void GUIInvWindow::WriteToFile(Stream *out) const
@@ -30,6 +30,13 @@
 
 #define MOVER_MOUSEDOWNLOCKED -4000
 
+// Minimal number of controls on GUI which makes it use the controls grid;
+// with less controls testing all of them is fast enough
+static const size_t ControlGridMinControls = 16;
+// Minimal size of the controls grid cell, and max number of cells along an axis
+static const int ControlGridMinCellSize = 16;
+static const int ControlGridMaxCells = 64;
+
 namespace AGS
 {
 namespace Common
@@ -85,6 +92,7 @@ void GUIMain::InitDefaults()
     _controls.clear();
     _ctrlRefs.clear();
     _ctrlDrawOrder.clear();
+    _ctrlGrid = ControlGrid();
 }
 
 int GUIMain::FindControlAt(int atx, int aty, int leeway, bool must_be_clickable) const
@@ -95,16 +103,36 @@ int GUIMain::FindControlAt(int atx, int aty, int leeway, bool must_be_clickable)
 
 int32_t GUIMain::FindControlAtLocal(int atx, int aty, int leeway, bool must_be_clickable) const
 {
+    // Use controls grid on larger GUIs; the grid does not account for leeway
+    if ((_controls.size() >= ControlGridMinControls) && (leeway == 0))
+    {
+        if (!_ctrlGrid.Valid)
+            RebuildControlGrid();
+        const ControlGrid &grid = _ctrlGrid;
+        if (grid.Bounds.IsInside(atx, aty))
+        {
+            const int cell = ((aty - grid.Bounds.Top) / grid.CellSize) * grid.Cols +
+                (atx - grid.Bounds.Left) / grid.CellSize;
+            for (uint32_t i = grid.CellStart[cell]; i < grid.CellStart[cell + 1]; ++i)
+            {
+                if (IsControlHitAt(grid.Items[i], atx, aty, 0, must_be_clickable))
+                    return grid.Items[i];
+            }
+            return -1;
+        }
+        else if (!grid.Unbounded)
+        {
+            return -1;
+        }
+        // else test all controls, as some of them may reach outside of grid bounds
+    }
+
     if (loaded_game_file_version <= kGameVersion_262)
     {
         // Ignore draw order On 2.6.2 and lower
         for (size_t i = 0; i < _controls.size(); ++i)
         {
-            if (!_controls[i]->IsVisible())
-                continue;
-            if (!_controls[i]->IsClickable() && must_be_clickable)
-                continue;
-            if (_controls[i]->IsOverControl(atx, aty, leeway))
+            if (IsControlHitAt(i, atx, aty, leeway, must_be_clickable))
                 return i;
         }
     }
@@ -113,17 +141,104 @@ int32_t GUIMain::FindControlAtLocal(int atx, int aty, int leeway, bool must_be_c
         for (size_t i = _controls.size(); i-- > 0;)
         {
             const int ctrl_index = _ctrlDrawOrder[i];
-            if (!_controls[ctrl_index]->IsVisible())
-                continue;
-            if (!_controls[ctrl_index]->IsClickable() && must_be_clickable)
-                continue;
-            if (_controls[ctrl_index]->IsOverControl(atx, aty, leeway))
+            if (IsControlHitAt(ctrl_index, atx, aty, leeway, must_be_clickable))
                 return ctrl_index;
         }
     }
     return -1;
 }
 
+bool GUIMain::IsControlHitAt(int index, int atx, int aty, int leeway, bool must_be_clickable) const
+{
+    const GUIObject *ctrl = _controls[index];
+    return ctrl->IsVisible() && (ctrl->IsClickable() || !must_be_clickable) &&
+        ctrl->IsOverControl(atx, aty, leeway);
+}
+
+void GUIMain::RebuildControlGrid() const
+{
+    ControlGrid &grid = _ctrlGrid;
+    grid = ControlGrid();
+    grid.Valid = true;
+
+    // Controls in the order of testing, same as in FindControlAtLocal
+    const size_t count = _controls.size();
+    std::vector<int32_t> order(count);
+    for (size_t i = 0; i < count; ++i)
+        order[i] = (loaded_game_file_version <= kGameVersion_262) ? i : _ctrlDrawOrder[count - 1 - i];
+
+    // Slider's handle may be positioned outside of slider's rect, so sliders are
+    // registered in every cell; all the others only in the cells which they overlap
+    std::vector<Rect> ctrl_rects(count);
+    std::vector<bool> ctrl_any(count);
+    bool has_bounds = false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const GUIObject *ctrl = _controls[i];
+        ctrl_any[i] = _ctrlRefs[i].first == kGUISlider;
+        grid.Unbounded |= ctrl_any[i];
+        if ((ctrl->GetWidth() <= 0) || (ctrl->GetHeight() <= 0))
+            continue; // cannot be hit, other than by the slider handle
+        ctrl_rects[i] = RectWH(ctrl->X, ctrl->Y, ctrl->GetWidth(), ctrl->GetHeight());
+        grid.Bounds = has_bounds ? SumRects(grid.Bounds, ctrl_rects[i]) : ctrl_rects[i];
+        has_bounds = true;
+    }
+    if (!has_bounds)
+    {
+        grid.CellStart.push_back(0u); // empty bounds, nothing may be hit inside
+        return;
+    }
+
+    const int max_side = std::max(grid.Bounds.GetWidth(), grid.Bounds.GetHeight());
+    grid.CellSize = std::max(ControlGridMinCellSize, (max_side + ControlGridMaxCells - 1) / ControlGridMaxCells);
+    grid.Cols = (grid.Bounds.GetWidth() + grid.CellSize - 1) / grid.CellSize;
+    grid.Rows = (grid.Bounds.GetHeight() + grid.CellSize - 1) / grid.CellSize;
+
+    // Gets the range of cells covered by the control
+    const auto get_cells = [&](int32_t index, int &col0, int &row0, int &col1, int &row1)
+    {
+        if (ctrl_any[index])
+        {
+            col0 = row0 = 0;
+            col1 = grid.Cols - 1;
+            row1 = grid.Rows - 1;
+            return true;
+        }
+        const Rect &rc = ctrl_rects[index];
+        if (rc.IsEmpty())
+            return false;
+        col0 = (rc.Left - grid.Bounds.Left) / grid.CellSize;
+        row0 = (rc.Top - grid.Bounds.Top) / grid.CellSize;
+        col1 = (rc.Right - grid.Bounds.Left) / grid.CellSize;
+        row1 = (rc.Bottom - grid.Bounds.Top) / grid.CellSize;
+        return true;
+    };
+
+    // Count the items in each cell first, then fill them in the order of testing
+    grid.CellStart.assign(grid.Cols * grid.Rows + 1, 0u);
+    int col0, row0, col1, row1;
+    for (int32_t index : order)
+    {
+        if (!get_cells(index, col0, row0, col1, row1))
+            continue;
+        for (int row = row0; row <= row1; ++row)
+            for (int col = col0; col <= col1; ++col)
+                grid.CellStart[row * grid.Cols + col + 1]++;
+    }
+    for (size_t cell = 1; cell < grid.CellStart.size(); ++cell)
+        grid.CellStart[cell] += grid.CellStart[cell - 1];
+    grid.Items.resize(grid.CellStart.back());
+    std::vector<uint32_t> cell_fill(grid.CellStart.begin(), grid.CellStart.end() - 1);
+    for (int32_t index : order)
+    {
+        if (!get_cells(index, col0, row0, col1, row1))
+            continue;
+        for (int row = row0; row <= row1; ++row)
+            for (int col = col0; col <= col1; ++col)
+                grid.Items[cell_fill[row * grid.Cols + col]++] = index;
+    }
+}
+
 int GUIMain::GetControlCount() const
 {
     return (int32_t)_controls.size();
@@ -187,6 +302,7 @@ void GUIMain::NotifyControlPosition()
     MouseWasAt.X = -1;
     MouseWasAt.Y = -1;
     _hasControlsChanged = true; // for software render, and in case of shape change
+    InvalidateControlGrid();
 }
 
 void GUIMain::NotifyControlState(int objid, bool mark_changed)
@@ -221,18 +337,21 @@ void GUIMain::ResetOverControl()
     MouseWasAt.X = -1;
     MouseWasAt.Y = -1;
     MouseOverCtrl = -1;
+    InvalidateControlGrid();
 }
 
 void GUIMain::AddControl(GUIControlType type, int id, GUIObject *control)
 {
     _ctrlRefs.emplace_back(type, id);
     _controls.push_back(control);
+    InvalidateControlGrid();
 }
 
 void GUIMain::RemoveAllControls()
 {
     _ctrlRefs.clear();
     _controls.clear();
+    InvalidateControlGrid();
 }
 
 bool GUIMain::BringControlToFront(int index)
@@ -277,18 +396,42 @@ void GUIMain::DrawSelf(Bitmap *ds)
     set_our_eip(379);
 }
 
-void GUIMain::DrawWithControls(Bitmap *ds)
+int GUIMain::DrawWithControls(Bitmap *ds)
 {
     ds->ResetClip();
     DrawSelf(ds);
-    DrawControls(ds);
+    return DrawControls(ds);
 }
 
-void GUIMain::DrawControls(Bitmap *ds)
+int GUIMain::DrawControls(Bitmap *ds)
+{
+    return DrawControlsImpl(ds, nullptr);
+}
+
+int GUIMain::DrawRegion(Bitmap *ds, const Rect &region)
+{
+    const Rect rc = IntersectRects(RectWH(0, 0, ds->GetWidth(), ds->GetHeight()), region);
+    if (rc.IsEmpty())
+        return 0;
+    // GUI itself only uses the drawing operations which respect the clip rect
+    ds->SetClip(rc);
+    ds->ClearTransparent();
+    DrawSelf(ds);
+    ds->ResetClip();
+    // Controls may set their own clipping, so give them a sub-bitmap instead
+    Bitmap sub_ds;
+    sub_ds.CreateSubBitmap(ds, rc);
+    return DrawControlsImpl(&sub_ds, &rc);
+}
+
+int GUIMain::DrawControlsImpl(Bitmap *ds, const Rect *region)
 {
     if ((GUI::Context.DisabledState != kGuiDis_Undefined) && (GUI::Options.DisabledStyle == kGuiDis_Blackout))
-        return; // don't draw GUI controls
+        return 0; // don't draw GUI controls
 
+    const int off_x = region ? -region->Left : 0;
+    const int off_y = region ? -region->Top : 0;
+    int draw_count = 0;
     Bitmap tempbmp; // in case we need transforms
     for (size_t ctrl_index = 0; ctrl_index < _controls.size(); ++ctrl_index)
     {
@@ -302,21 +445,32 @@ void GUIMain::DrawControls(Bitmap *ds)
         if (!objToDraw->IsEnabled() && (GUI::Options.DisabledStyle == kGuiDis_Blackout))
             continue;
 
+        const bool clipped = GUI::Options.ClipControls && objToDraw->IsContentClipped();
+        if (region)
+        {
+            const Rect rc = objToDraw->CalcGraphicRect(clipped);
+            if (!AreRectsIntersecting(*region, RectWH(objToDraw->X + rc.Left, objToDraw->Y + rc.Top, rc.GetWidth(), rc.GetHeight())))
+                continue;
+        }
+        const int obj_x = objToDraw->X + off_x;
+        const int obj_y = objToDraw->Y + off_y;
+        draw_count++;
+
         // Depending on draw properties - draw directly on the gui surface, or use a buffer
         if (objToDraw->GetTransparency() == 0)
         {
-            if (GUI::Options.ClipControls && objToDraw->IsContentClipped())
-                ds->SetClip(RectWH(objToDraw->X, objToDraw->Y, obj_size.Width, obj_size.Height));
+            if (clipped)
+                ds->SetClip(RectWH(obj_x, obj_y, obj_size.Width, obj_size.Height));
             else
                 ds->ResetClip();
-            objToDraw->Draw(ds, objToDraw->X, objToDraw->Y);
+            objToDraw->Draw(ds, obj_x, obj_y);
         }
         else
         {
-            const Rect rc = objToDraw->CalcGraphicRect(GUI::Options.ClipControls && objToDraw->IsContentClipped());
+            const Rect rc = objToDraw->CalcGraphicRect(clipped);
             tempbmp.CreateTransparent(rc.GetWidth(), rc.GetHeight());
             objToDraw->Draw(&tempbmp, -rc.Left, -rc.Top);
-            draw_gui_sprite(ds, true, objToDraw->X + rc.Left, objToDraw->Y + rc.Top,
+            draw_gui_sprite(ds, true, obj_x + rc.Left, obj_y + rc.Top,
                 &tempbmp, objToDraw->HasAlphaChannel(), kBlendMode_Alpha,
                 GfxDef::LegacyTrans255ToAlpha255(objToDraw->GetTransparency()));
         }
@@ -328,11 +482,11 @@ void GUIMain::DrawControls(Bitmap *ds)
             if (GUI::Options.OutlineControls)
                 selectedColour = 13;
             color_t draw_color = ds->GetCompatibleColor(selectedColour);
-            DrawBlob(ds, objToDraw->X + obj_size.Width - get_fixed_pixel_size(1) - 1, objToDraw->Y, draw_color);
-            DrawBlob(ds, objToDraw->X, objToDraw->Y + obj_size.Height - get_fixed_pixel_size(1) - 1, draw_color);
-            DrawBlob(ds, objToDraw->X, objToDraw->Y, draw_color);
-            DrawBlob(ds, objToDraw->X + obj_size.Width - get_fixed_pixel_size(1) - 1,
-                    objToDraw->Y + obj_size.Height - get_fixed_pixel_size(1) - 1, draw_color);
+            DrawBlob(ds, obj_x + obj_size.Width - get_fixed_pixel_size(1) - 1, obj_y, draw_color);
+            DrawBlob(ds, obj_x, obj_y + obj_size.Height - get_fixed_pixel_size(1) - 1, draw_color);
+            DrawBlob(ds, obj_x, obj_y, draw_color);
+            DrawBlob(ds, obj_x + obj_size.Width - get_fixed_pixel_size(1) - 1,
+                    obj_y + obj_size.Height - get_fixed_pixel_size(1) - 1, draw_color);
         }
         if (GUI::Options.OutlineControls)
         {
@@ -340,18 +494,19 @@ void GUIMain::DrawControls(Bitmap *ds)
             color_t draw_color = ds->GetCompatibleColor(selectedColour);
             for (int i = 0; i < obj_size.Width; i += 2)
             {
-                ds->PutPixel(i + objToDraw->X, objToDraw->Y, draw_color);
-                ds->PutPixel(i + objToDraw->X, objToDraw->Y + obj_size.Height - 1, draw_color);
+                ds->PutPixel(i + obj_x, obj_y, draw_color);
+                ds->PutPixel(i + obj_x, obj_y + obj_size.Height - 1, draw_color);
             }
             for (int i = 0; i < obj_size.Height; i += 2)
             {
-                ds->PutPixel(objToDraw->X, i + objToDraw->Y, draw_color);
-                ds->PutPixel(objToDraw->X + obj_size.Width - 1, i + objToDraw->Y, draw_color);
+                ds->PutPixel(obj_x, i + obj_y, draw_color);
+                ds->PutPixel(obj_x + obj_size.Width - 1, i + obj_y, draw_color);
             }
         }
     }
 
     set_our_eip(380);
+    return draw_count;
 }
 
 void GUIMain::DrawBlob(Bitmap *ds, int x, int y, color_t draw_color)
@@ -450,6 +605,7 @@ void GUIMain::ResortZOrder()
     _ctrlDrawOrder.resize(ctrl_sort.size());
     for (size_t i = 0; i < ctrl_sort.size(); ++i)
         _ctrlDrawOrder[i] = ctrl_sort[i]->Id;
+    InvalidateControlGrid();
 }
 
 void GUIMain::SetClickable(bool on)
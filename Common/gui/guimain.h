@@ -161,8 +161,13 @@ public:
     // Operations
     bool    BringControlToFront(int index);
     void    DrawSelf(Bitmap *ds);
-    void    DrawWithControls(Bitmap *ds);
-    void    DrawControls(Bitmap *ds);
+    // Draws GUI and controls, returns the number of controls drawn
+    int     DrawWithControls(Bitmap *ds);
+    int     DrawControls(Bitmap *ds);
+    // Redraws a region of the GUI surface previously drawn by DrawWithControls:
+    // clears it, and draws GUI and only the controls which overlap it;
+    // returns the number of controls drawn
+    int     DrawRegion(Bitmap *ds, const Rect &region);
     // Polls GUI state, providing current cursor (mouse) coordinates
     void    Poll(int mx, int my);
     // Reconnects this GUIMain with the child controls from the global guiobject collection
@@ -199,6 +204,13 @@ private:
     void    DrawBlob(Bitmap *ds, int x, int y, color_t draw_color);
     // Same as FindControlAt but expects local space coordinates
     int32_t FindControlAtLocal(int atx, int aty, int leeway, bool must_be_clickable) const;
+    // Tells if the control may be found at this position, and is eligible for the hit test
+    bool    IsControlHitAt(int index, int atx, int aty, int leeway, bool must_be_clickable) const;
+    // Marks the controls grid for rebuilding, when controls changed their
+    // positions, sizes or the order
+    void    InvalidateControlGrid() { _ctrlGrid.Valid = false; }
+    // Rebuilds the grid of controls, used to speed up finding control at position
+    void    RebuildControlGrid() const;
 
     // TODO: all members are currently public; hide them later
 public:
@@ -241,6 +253,26 @@ private:
     std::vector<GUIObject*> _controls;
     // Sorted array of controls in z-order.
     std::vector<int32_t>    _ctrlDrawOrder;
+    // Uniform grid over the controls' rectangles, used to find the control
+    // under the given position without testing every one of them.
+    // Each cell references the controls which overlap it, in the order
+    // in which they are tested (topmost first).
+    struct ControlGrid
+    {
+        bool    Valid = false;
+        bool    Unbounded = false; // some controls may be hit outside of their rects
+        Rect    Bounds;
+        int     CellSize = 0;
+        int     Cols = 0;
+        int     Rows = 0;
+        std::vector<uint32_t> CellStart; // first item of each cell, and the end
+        std::vector<int32_t>  Items; // control indexes
+    };
+    mutable ControlGrid     _ctrlGrid;
+
+    // Draws controls, optionally only the ones overlapping the region;
+    // when the region is given, the ds is assumed to be its sub-bitmap
+    int     DrawControlsImpl(Bitmap *ds, const Rect *region);
 };
 
 
@@ -4999,6 +4999,52 @@ void alfont_set_char_extra_spacing(ALFONT_FONT *f, int spacing) {
 }
 
 
+int alfont_is_plain_font(ALFONT_FONT *f) {
+  return (alfont_textmode < 0) && (f->type == 0) && (f->style == 0) &&
+    (f->outline_top <= 0) && (f->outline_bottom <= 0) && (f->outline_left <= 0) && (f->outline_right <= 0) &&
+    (f->outline_hollow == FALSE) && (f->underline == FALSE) && (f->background == FALSE) &&
+    (f->transparency == 255) && (f->fixed_width == FALSE);
+}
+
+
+int alfont_get_glyph(ALFONT_FONT *f, int character, ALFONT_GLYPH *glyph) {
+  int glyph_index;
+  struct _ALFONT_CACHED_GLYPH *cglyph;
+
+  memset(glyph, 0, sizeof(ALFONT_GLYPH));
+
+  /* same lookup as in alfont_textout */
+  if (f->face->charmap)
+    glyph_index = FT_Get_Char_Index(f->face, character);
+  else
+    glyph_index = character;
+  if ((glyph_index < 0) || (glyph_index >= f->face->num_glyphs))
+    return FALSE;
+
+  _alfont_cache_glyph(f, glyph_index);
+  cglyph = &f->cached_glyphs[glyph_index];
+
+  /* the offsets are relative to the text position, same as when drawing */
+  if (cglyph->mono_available && cglyph->bmp) {
+    glyph->width = cglyph->width;
+    glyph->height = cglyph->height;
+    glyph->left = cglyph->left;
+    glyph->top = f->face_ascender - cglyph->top;
+    glyph->bmp = cglyph->bmp;
+  }
+  if (cglyph->aa_available && cglyph->aabmp) {
+    glyph->aawidth = cglyph->aawidth;
+    glyph->aaheight = cglyph->aaheight;
+    glyph->aaleft = cglyph->aaleft;
+    glyph->aatop = f->face_ascender - cglyph->aatop;
+    glyph->aabmp = cglyph->aabmp;
+  }
+  if (cglyph->advancex)
+    glyph->advance = cglyph->advancex + f->ch_spacing;
+  return TRUE;
+}
+
+
 void alfont_set_language(ALFONT_FONT *f, const char *language) {
   if (language == NULL) {
 	f->language = NULL;
@@ -123,6 +123,34 @@ ALFONT_DLL_DECLSPEC int alfont_get_nof_available_fixed_sizes(ALFONT_FONT *f);
 ALFONT_DLL_DECLSPEC int alfont_get_char_extra_spacing(ALFONT_FONT *f);
 ALFONT_DLL_DECLSPEC void alfont_set_char_extra_spacing(ALFONT_FONT *f, int spacing);
 
+/* AGS: raster data and metrics of a single glyph, for drawing the text
+   without the alfont_textout functions */
+typedef struct ALFONT_GLYPH {
+  int width, height;        /* size of the 1-bit image, stored as 1 byte per pixel */
+  int left, top;            /* its offset from the text's drawing position */
+  const unsigned char *bmp; /* NULL if not available */
+  int aawidth, aaheight;    /* size of the anti-aliased image, stored as 0-255 coverage */
+  int aaleft, aatop;
+  const unsigned char *aabmp;
+  int advance;              /* horizontal advance, including the extra char spacing */
+} ALFONT_GLYPH;
+
+/* AGS: tells if the font is drawn with the default settings (no text conversion,
+   style, outline, underline, background, transparency or fixed width), in which
+   case drawing the glyphs returned by alfont_get_glyph gives exactly the same
+   result as alfont_textout and alfont_textout_aa */
+ALFONT_DLL_DECLSPEC int alfont_is_plain_font(ALFONT_FONT *f);
+/* AGS: gets the glyph for the given character, rasterizing it if not done yet;
+   returns FALSE if the font has no such glyph. The image pointers remain valid
+   until the font is resized or destroyed. */
+ALFONT_DLL_DECLSPEC int alfont_get_glyph(ALFONT_FONT *f, int character, ALFONT_GLYPH *glyph);
+
+/* AGS: blenders used to draw the anti-aliased text, see set_blender_mode() */
+ALFONT_DLL_DECLSPEC uint32_t __skiptranspixels_blender_trans15(uint32_t x, uint32_t y, uint32_t n);
+ALFONT_DLL_DECLSPEC uint32_t __skiptranspixels_blender_trans16(uint32_t x, uint32_t y, uint32_t n);
+ALFONT_DLL_DECLSPEC uint32_t __preservedalpha_blender_trans24(uint32_t x, uint32_t y, uint32_t n);
+ALFONT_DLL_DECLSPEC void set_preservedalpha_trans_blender(int r, int g, int b, int a);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,124 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <memory>
+#include "gtest/gtest.h"
+#include "gfx/bitmappool.h"
+
+using namespace AGS::Common;
+
+TEST(BitmapPool, RoundDimension) {
+    ASSERT_EQ(BitmapPool::RoundDimension(1), 16);
+    ASSERT_EQ(BitmapPool::RoundDimension(16), 16);
+    ASSERT_EQ(BitmapPool::RoundDimension(17), 32);
+    ASSERT_EQ(BitmapPool::RoundDimension(64), 64);
+    ASSERT_EQ(BitmapPool::RoundDimension(65), 80);
+    ASSERT_EQ(BitmapPool::RoundDimension(100), 112);
+    ASSERT_EQ(BitmapPool::RoundDimension(320), 320);
+    ASSERT_EQ(BitmapPool::RoundDimension(321), 384);
+    ASSERT_EQ(BitmapPool::RoundDimension(1000), 1024);
+}
+
+TEST(BitmapPool, ReuseMemory) {
+    BitmapPool pool;
+    std::unique_ptr<Bitmap> bmp = pool.GetBitmap(100, 50, 32);
+    ASSERT_TRUE(bmp);
+    ASSERT_EQ(bmp->GetWidth(), 100);
+    ASSERT_EQ(bmp->GetHeight(), 50);
+    ASSERT_EQ(bmp->GetColorDepth(), 32);
+    ASSERT_EQ(bmp->GetLineLength(), 100 * 4);
+    const uint8_t *data = bmp->GetData();
+    pool.Release(std::move(bmp));
+    ASSERT_EQ(pool.GetStats().FreeBlocks, 1u);
+
+    // Same bucket, different exact size: the memory is reused
+    bmp = pool.GetBitmap(110, 60, 32);
+    ASSERT_TRUE(bmp);
+    ASSERT_EQ(bmp->GetWidth(), 110);
+    ASSERT_EQ(bmp->GetHeight(), 60);
+    ASSERT_EQ(bmp->GetLineLength(), 110 * 4);
+    ASSERT_EQ(bmp->GetData(), data);
+    ASSERT_EQ(pool.GetStats().Allocations, 1u);
+    ASSERT_EQ(pool.GetStats().Reused, 1u);
+    ASSERT_EQ(pool.GetStats().FreeBlocks, 0u);
+    // Writing over the whole bitmap must stay within the block
+    bmp->Clear(0xFFFFFFFF);
+    bmp->PutPixel(109, 59, 0);
+    ASSERT_EQ(bmp->GetPixel(109, 59), 0);
+
+    // Another color depth or bucket requires a new allocation
+    std::unique_ptr<Bitmap> bmp2 = pool.GetBitmap(110, 60, 16);
+    std::unique_ptr<Bitmap> bmp3 = pool.GetBitmap(200, 60, 32);
+    ASSERT_EQ(pool.GetStats().Allocations, 3u);
+    pool.Release(std::move(bmp));
+    pool.Release(std::move(bmp2));
+    pool.Release(std::move(bmp3));
+    ASSERT_EQ(pool.GetStats().FreeBlocks, 3u);
+    pool.Clear();
+    ASSERT_EQ(pool.GetStats().FreeBlocks, 0u);
+    ASSERT_EQ(pool.GetStats().FreeBytes, 0u);
+}
+
+TEST(BitmapPool, ReleaseForeignBitmap) {
+    BitmapPool pool;
+    // An exact-size bitmap does not fit its bucket, and is not kept
+    pool.Release(std::unique_ptr<Bitmap>(new Bitmap(100, 50, 32)));
+    ASSERT_EQ(pool.GetStats().FreeBlocks, 0u);
+    // ...unless its size is already rounded
+    pool.Release(std::unique_ptr<Bitmap>(new Bitmap(64, 32, 32)));
+    ASSERT_EQ(pool.GetStats().FreeBlocks, 1u);
+    // Sub-bitmaps do not have their own memory
+    Bitmap parent(64, 64, 32);
+    pool.Release(std::unique_ptr<Bitmap>(new Bitmap(&parent, RectWH(0, 0, 32, 32))));
+    ASSERT_EQ(pool.GetStats().FreeBlocks, 1u);
+    pool.Release(nullptr);
+}
+
+TEST(BitmapPool, TrimByAge) {
+    BitmapPool pool(BitmapPool::DefaultMaxBytes, 2u);
+    pool.Release(pool.GetBitmap(16, 16, 32));
+    pool.NextFrame();
+    ASSERT_EQ(pool.GetLastFrameStats().Allocations, 1u);
+    pool.Release(pool.GetBitmap(32, 32, 32));
+    pool.NextFrame();
+    ASSERT_EQ(pool.GetStats().FreeBlocks, 2u);
+    ASSERT_EQ(pool.GetLastFrameStats().FreeBlocks, 2u);
+    pool.NextFrame();
+    ASSERT_EQ(pool.GetStats().FreeBlocks, 1u); // the first one expired
+    ASSERT_EQ(pool.GetStats().FreeBytes, 32u * 32 * 4);
+    // Reusing the block resets its age
+    pool.Release(pool.GetBitmap(32, 32, 32));
+    pool.NextFrame();
+    pool.NextFrame();
+    ASSERT_EQ(pool.GetStats().FreeBlocks, 1u);
+    ASSERT_EQ(pool.GetLastFrameStats().Allocations, 0u);
+    pool.NextFrame();
+    ASSERT_EQ(pool.GetStats().FreeBlocks, 0u);
+}
+
+TEST(BitmapPool, TrimBySize) {
+    BitmapPool pool(2u * 32 * 32 * 4, BitmapPool::DefaultMaxAge);
+    std::unique_ptr<Bitmap> bmp1 = pool.GetBitmap(32, 32, 32);
+    std::unique_ptr<Bitmap> bmp2 = pool.GetBitmap(32, 32, 32);
+    std::unique_ptr<Bitmap> bmp3 = pool.GetBitmap(16, 16, 32);
+    const uint8_t *data2 = bmp2->GetData();
+    pool.Release(std::move(bmp1));
+    pool.NextFrame();
+    pool.Release(std::move(bmp2));
+    pool.Release(std::move(bmp3));
+    // The oldest block is deleted to fit into the limit
+    ASSERT_EQ(pool.GetStats().FreeBlocks, 2u);
+    ASSERT_EQ(pool.GetStats().FreeBytes, 32u * 32 * 4 + 16u * 16 * 4);
+    bmp1 = pool.GetBitmap(32, 32, 32);
+    ASSERT_EQ(bmp1->GetData(), data2);
+}
@@ -0,0 +1,322 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <allegro.h>
+#include <allegro/internal/aintern.h>
+#include "gtest/gtest.h"
+#include "gfx/bitmap.h"
+#include "gfx/blitkernels.h"
+
+using namespace AGS::Common;
+
+// Common's Bitmap requires the program to provide a palette color conversion
+void __my_setcolor(int *ctset, int newcol, int /*wantColDep*/)
+{
+    ctset[0] = newcol;
+}
+
+static const SimdLevel AllSimdLevels[] = { kSimd_None, kSimd_SSE2, kSimd_AVX2, kSimd_NEON };
+
+// Generates pixels with all the special cases: mask color, zero and
+// full alpha, and random values
+static std::vector<uint32_t> MakeTestPixels(size_t count, uint32_t seed)
+{
+    std::vector<uint32_t> pixels(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t px = (seed >> 8) | ((seed & 0xFF) << 24);
+        switch (i % 7)
+        {
+        case 0: px = MASK_COLOR_32; break;
+        case 1: px &= 0x00FFFFFF; break;
+        case 2: px |= 0xFF000000; break;
+        default: break;
+        }
+        pixels[i] = px;
+    }
+    return pixels;
+}
+
+// A copy of the software renderer's _trans_alpha_blender32
+static uint32_t TransAlphaBlender32(uint32_t x, uint32_t y, uint32_t n)
+{
+    uint32_t res, g;
+    n = (n * geta32(x)) / 256;
+    if (n)
+        n++;
+    res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
+    y &= 0xFF00;
+    x &= 0xFF00;
+    g = (x - y) * n / 256 + y;
+    res &= 0xFF00FF;
+    g &= 0xFF00;
+    return res | g;
+}
+
+TEST(BlitKernels, RowsMatchBlenders) {
+    const size_t count = 67; // not a multiple of any vector size
+    const std::vector<uint32_t> src = MakeTestPixels(count, 1);
+    const std::vector<uint32_t> dst = MakeTestPixels(count, 2);
+    const int alphas[] = { 1, 64, 128, 200, 254, 255 };
+    const SimdLevel was_simd = BlitKernels::GetSimd();
+
+    for (SimdLevel level : AllSimdLevels)
+    {
+        if (!BlitKernels::IsSimdSupported(level))
+            continue;
+        BlitKernels::SetSimd(level);
+        SCOPED_TRACE(BlitKernels::GetSimdName(level));
+
+        std::vector<uint32_t> res = dst;
+        BlitKernels::AlphaBlendRow(res.data(), src.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(res[i], src[i] == MASK_COLOR_32 ? dst[i] : _blender_alpha32(src[i], dst[i], 0));
+
+        res = dst;
+        BlitKernels::MaskedCopyRow(res.data(), src.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(res[i], src[i] == MASK_COLOR_32 ? dst[i] : src[i]);
+
+        for (int alpha : alphas)
+        {
+            res = dst;
+            BlitKernels::AlphaBlendOpacityRow(res.data(), src.data(), count, alpha);
+            for (size_t i = 0; i < count; ++i)
+                ASSERT_EQ(res[i], src[i] == MASK_COLOR_32 ? dst[i] : TransAlphaBlender32(src[i], dst[i], alpha));
+
+            res = dst;
+            BlitKernels::TransBlendRow(res.data(), src.data(), count, alpha);
+            for (size_t i = 0; i < count; ++i)
+                ASSERT_EQ(res[i], src[i] == MASK_COLOR_32 ? dst[i] : _blender_trans24(src[i], dst[i], alpha));
+
+            const uint32_t color = 0x00347F0Cu;
+            res = dst;
+            BlitKernels::TintRow(res.data(), count, color, alpha);
+            for (size_t i = 0; i < count; ++i)
+                ASSERT_EQ(res[i], dst[i] == MASK_COLOR_32 ? dst[i] : _blender_trans24(color, dst[i], alpha));
+        }
+    }
+    BlitKernels::SetSimd(was_simd);
+}
+
+TEST(BlitKernels, BitmapMatchesAllegro) {
+    const int w = 45, h = 23;
+    std::unique_ptr<Bitmap> src(BitmapHelper::CreateBitmap(w, h, 32));
+    std::unique_ptr<Bitmap> dst1(BitmapHelper::CreateBitmap(60, 40, 32));
+    std::unique_ptr<Bitmap> dst2(BitmapHelper::CreateBitmap(60, 40, 32));
+    const std::vector<uint32_t> src_px = MakeTestPixels(w * h, 3);
+    const std::vector<uint32_t> dst_px = MakeTestPixels(60 * 40, 4);
+    for (int y = 0; y < h; ++y)
+        memcpy(src->GetScanLineForWriting(y), &src_px[y * w], w * sizeof(uint32_t));
+
+    // Partially clipped both by the bitmap's borders, and a custom clip rect
+    const int pos[][2] = { { 5, 5 }, { -10, -7 }, { 30, 25 } };
+    for (const auto &p : pos)
+    {
+        for (Bitmap *dst : { dst1.get(), dst2.get() })
+        {
+            for (int y = 0; y < 40; ++y)
+                memcpy(dst->GetScanLineForWriting(y), &dst_px[y * 60], 60 * sizeof(uint32_t));
+            dst->SetClip(Rect(2, 3, 50, 36));
+        }
+        set_alpha_blender();
+        dst1->TransBlendBlt(src.get(), p[0], p[1]);
+        BlitKernels::AlphaBlend(dst2.get(), src.get(), p[0], p[1]);
+        for (int y = 0; y < 40; ++y)
+            ASSERT_EQ(memcmp(dst1->GetScanLine(y), dst2->GetScanLine(y), 60 * sizeof(uint32_t)), 0);
+
+        dst1->Blit(src.get(), 0, 0, p[0], p[1], w, h, kBitmap_Transparency);
+        BlitKernels::MaskedCopy(dst2.get(), src.get(), p[0], p[1]);
+        for (int y = 0; y < 40; ++y)
+            ASSERT_EQ(memcmp(dst1->GetScanLine(y), dst2->GetScanLine(y), 60 * sizeof(uint32_t)), 0);
+    }
+}
+
+// A copy of the engine's _myblender_color32 and _myblender_color32_light
+static uint32_t TintBlender32(uint32_t x, uint32_t y, uint32_t /*n*/)
+{
+    float xh, xs, xv, yh, ys, yv;
+    int r, g, b;
+    rgb_to_hsv(getr32(x), getg32(x), getb32(x), &xh, &xs, &xv);
+    rgb_to_hsv(getr32(y), getg32(y), getb32(y), &yh, &ys, &yv);
+    hsv_to_rgb(xh, xs, yv, &r, &g, &b);
+    return makeacol32(r, g, b, geta32(y));
+}
+
+static uint32_t TintLightBlender32(uint32_t x, uint32_t y, uint32_t n)
+{
+    float xh, xs, xv, yh, ys, yv;
+    int r, g, b;
+    rgb_to_hsv(getr32(x), getg32(x), getb32(x), &xh, &xs, &xv);
+    rgb_to_hsv(getr32(y), getg32(y), getb32(y), &yh, &ys, &yv);
+    yv -= (1.0 - ((float)n / 250.0));
+    if (yv < 0.0) yv = 0.0;
+    hsv_to_rgb(xh, xs, yv, &r, &g, &b);
+    return makeacol32(r, g, b, geta32(y));
+}
+
+// A copy of the engine's _myblender_alpha_trans24
+static uint32_t AlphaTransBlender24(uint32_t x, uint32_t y, uint32_t n)
+{
+    return _blender_trans24(x, y & 0xFFFFFF, n) | (y & 0xFF000000);
+}
+
+static void FillBitmap(Bitmap *bmp, const std::vector<uint32_t> &px)
+{
+    const int w = bmp->GetWidth();
+    for (int y = 0; y < bmp->GetHeight(); ++y)
+        memcpy(bmp->GetScanLineForWriting(y), &px[y * w], w * sizeof(uint32_t));
+}
+
+static bool BitmapsEqual(const Bitmap *bmp1, const Bitmap *bmp2)
+{
+    for (int y = 0; y < bmp1->GetHeight(); ++y)
+        if (memcmp(bmp1->GetScanLine(y), bmp2->GetScanLine(y), bmp1->GetLineLength()) != 0)
+            return false;
+    return true;
+}
+
+TEST(BlitKernels, TintMatchesBlenders) {
+    const int w = 37, h = 19;
+    std::unique_ptr<Bitmap> src(BitmapHelper::CreateBitmap(w, h, 32));
+    std::unique_ptr<Bitmap> dst1(BitmapHelper::CreateBitmap(w, h, 32));
+    std::unique_ptr<Bitmap> dst2(BitmapHelper::CreateBitmap(w, h, 32));
+    std::unique_ptr<Bitmap> temp(BitmapHelper::CreateBitmap(w, h, 32));
+    FillBitmap(src.get(), MakeTestPixels(w * h, 5));
+    const int tint_cols[][3] = { { 255, 0, 0 }, { 30, 200, 140 }, { 0, 0, 0 }, { 128, 128, 128 } };
+    const int luminances[] = { 250, 100, 0 };
+    const int amounts[] = { 0, 1, 100, 247 };
+    const SimdLevel was_simd = BlitKernels::GetSimd();
+
+    for (SimdLevel level : AllSimdLevels)
+    {
+        if (!BlitKernels::IsSimdSupported(level))
+            continue;
+        BlitKernels::SetSimd(level);
+        SCOPED_TRACE(BlitKernels::GetSimdName(level));
+
+        for (const auto &col : tint_cols)
+        {
+            for (int lum : luminances)
+            {
+                BLENDER_FUNC blender = (lum >= 250) ? TintBlender32 : TintLightBlender32;
+                const uint32_t tint = makecol32(col[0], col[1], col[2]);
+                uint32_t table[256];
+                for (int v = 0; v < 256; ++v)
+                    table[v] = blender(tint, makeacol32(v, v, v, 0), lum);
+
+                // Full tint: lit blend with the tint blender
+                set_blender_mode(nullptr, nullptr, blender, col[0], col[1], col[2], 0);
+                dst1->FillTransparent();
+                dst1->LitBlendBlt(src.get(), 0, 0, lum);
+                BlitKernels::ValueMap(dst2.get(), src.get(), table);
+                ASSERT_TRUE(BitmapsEqual(dst1.get(), dst2.get()));
+
+                // Partial tint: tinted image blended over the original
+                for (int amount : amounts)
+                {
+                    set_blender_mode(nullptr, nullptr, blender, col[0], col[1], col[2], 0);
+                    dst1->Blit(src.get(), 0, 0, 0, 0, w, h);
+                    temp->FillTransparent();
+                    temp->LitBlendBlt(src.get(), 0, 0, lum);
+                    set_blender_mode(nullptr, nullptr, AlphaTransBlender24, 0, 0, 0, amount);
+                    dst1->TransBlendBlt(temp.get(), 0, 0);
+                    BlitKernels::ValueMapBlend(dst2.get(), src.get(), table, amount);
+                    ASSERT_TRUE(BitmapsEqual(dst1.get(), dst2.get()));
+                }
+            }
+        }
+
+        // Light level: lit blend with the alpha preserving trans blender
+        for (int lit_col : { 8, 248 })
+        {
+            for (int amount : amounts)
+            {
+                set_blender_mode(nullptr, nullptr, AlphaTransBlender24, lit_col, lit_col, lit_col, 0);
+                dst1->FillTransparent();
+                dst1->LitBlendBlt(src.get(), 0, 0, amount);
+                BlitKernels::Light(dst2.get(), src.get(), makecol32(lit_col, lit_col, lit_col), amount);
+                ASSERT_TRUE(BitmapsEqual(dst1.get(), dst2.get()));
+            }
+        }
+
+        // Red and blue swap
+        const std::vector<uint32_t> px = MakeTestPixels(67, 6);
+        std::vector<uint32_t> res = px;
+        BlitKernels::SwapRedBlueRow(res.data(), res.data(), res.size());
+        for (size_t i = 0; i < px.size(); ++i)
+            ASSERT_EQ(res[i], makeacol32(getb32(px[i]), getg32(px[i]), getr32(px[i]), geta32(px[i])));
+    }
+    BlitKernels::SetSimd(was_simd);
+}
+
+TEST(BlitKernels, ConvertMatchesAllegro) {
+    const int w = 29, h = 11;
+    const int was_conv = get_color_conversion();
+    const SimdLevel was_simd = BlitKernels::GetSimd();
+    // 32-bit pixels include the ones which become a 15/16-bit mask color
+    std::vector<uint32_t> px32 = MakeTestPixels(w * h, 7);
+    px32[3] = 0xFFFF00FF;
+    px32[4] = 0x00FC03FC;
+    px32[5] = 0x12F805F8;
+    std::unique_ptr<Bitmap> src32(BitmapHelper::CreateBitmap(w, h, 32));
+    FillBitmap(src32.get(), px32);
+
+    for (SimdLevel level : AllSimdLevels)
+    {
+        if (!BlitKernels::IsSimdSupported(level))
+            continue;
+        BlitKernels::SetSimd(level);
+        SCOPED_TRACE(BlitKernels::GetSimdName(level));
+
+        for (int conv : { COLORCONV_TOTAL, COLORCONV_TOTAL | COLORCONV_KEEP_TRANS })
+        {
+            set_color_conversion(conv);
+            for (int depth16 : { 15, 16 })
+            {
+                SCOPED_TRACE(depth16);
+                // 32-bit to 15/16-bit
+                std::unique_ptr<Bitmap> ref16(BitmapHelper::CreateBitmap(w, h, depth16));
+                blit(src32->GetAllegroBitmap(), ref16->GetAllegroBitmap(), 0, 0, 0, 0, w, h);
+                std::unique_ptr<Bitmap> res16(BitmapHelper::CreateBitmap(w, h, depth16));
+                ASSERT_TRUE(BlitKernels::ConvertPixels(res16.get(), src32.get()));
+                ASSERT_TRUE(BitmapsEqual(ref16.get(), res16.get()));
+
+                // 15/16-bit to 32-bit, using every possible pixel value
+                std::unique_ptr<Bitmap> src16(BitmapHelper::CreateBitmap(256, 256, depth16));
+                for (int y = 0; y < 256; ++y)
+                {
+                    uint16_t *row = reinterpret_cast<uint16_t*>(src16->GetScanLineForWriting(y));
+                    for (int x = 0; x < 256; ++x)
+                        row[x] = static_cast<uint16_t>(y * 256 + x);
+                }
+                std::unique_ptr<Bitmap> ref32(BitmapHelper::CreateBitmap(256, 256, 32));
+                blit(src16->GetAllegroBitmap(), ref32->GetAllegroBitmap(), 0, 0, 0, 0, 256, 256);
+                std::unique_ptr<Bitmap> res32(BitmapHelper::CreateBitmap(256, 256, 32));
+                ASSERT_TRUE(BlitKernels::ConvertPixels(res32.get(), src16.get()));
+                ASSERT_TRUE(BitmapsEqual(ref32.get(), res32.get()));
+            }
+        }
+    }
+    // Same depth, or a different size, is not supported
+    std::unique_ptr<Bitmap> other(BitmapHelper::CreateBitmap(w, h, 32));
+    ASSERT_FALSE(BlitKernels::ConvertPixels(other.get(), src32.get()));
+    other.reset(BitmapHelper::CreateBitmap(w + 1, h, 16));
+    ASSERT_FALSE(BlitKernels::ConvertPixels(other.get(), src32.get()));
+    set_color_conversion(was_conv);
+    BlitKernels::SetSimd(was_simd);
+}
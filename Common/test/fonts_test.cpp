@@ -0,0 +1,200 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <allegro.h>
+#include "gtest/gtest.h"
+#include "core/platform.h"
+#include "core/assetmanager.h"
+#include "font/fonts.h"
+#include "game/main_game_file.h"
+#include "util/file.h"
+#include "util/stream.h"
+#include "util/utf8.h"
+
+using namespace AGS::Common;
+
+// Stubs for the functions which the font module expects from the program
+GameDataVersion loaded_game_file_version = kGameVersion_Current;
+void set_our_eip(int) {}
+int get_our_eip() { return 0; }
+int get_fixed_pixel_size(int pixels) { return pixels; }
+bool ShouldAntiAliasText() { return false; }
+
+#if (AGS_PLATFORM_TEST_FILE_IO)
+
+static const char *WFNFile[] = { "agsfnt0.wfn", "agsfnt1.wfn" };
+
+// Writes a WFN font with the ASCII chars of various widths;
+// the glyphs themselves are empty, as only the widths matter here
+static void WriteTestWFN(const char *filename, int salt)
+{
+    const int char_count = 128;
+    std::vector<uint16_t> offsets;
+    std::vector<uint8_t> char_data;
+    const uint16_t data_offset = 15 + sizeof(uint16_t);
+    for (int c = 0; c < char_count; ++c)
+    {
+        const uint16_t width = 1 + (c * 7 + salt) % 9, height = 2;
+        offsets.push_back(static_cast<uint16_t>(data_offset + char_data.size()));
+        char_data.push_back(width & 0xFF); char_data.push_back(width >> 8);
+        char_data.push_back(height & 0xFF); char_data.push_back(height >> 8);
+        char_data.insert(char_data.end(), ((width + 7) / 8) * height, 0);
+    }
+    auto out = File::CreateFile(filename);
+    ASSERT_TRUE(out);
+    out->Write("WGT Font File  ", 15);
+    out->WriteInt16(static_cast<int16_t>(data_offset + char_data.size()));
+    out->Write(char_data.data(), char_data.size());
+    out->WriteArrayOfInt16(reinterpret_cast<const int16_t*>(offsets.data()), offsets.size());
+}
+
+// The original split_lines algorithm, which measures the whole line again
+// after appending each char; used as a reference for the results.
+// NOTE: this does not unescape the text, so the test texts must not
+// have any escaped chars.
+static size_t split_lines_reference(const char *todis, std::vector<std::string> &lines, int wii, int fonnt, size_t max_lines)
+{
+    wii -= 1;
+    lines.clear();
+    const std::string line_buf = todis;
+    std::string test_buf;
+    const char *end_ptr = line_buf.c_str() + line_buf.size();
+    const char *theline = line_buf.c_str();
+    const char *scan_ptr = theline;
+    const char *prev_ptr = scan_ptr;
+    const char *last_whitespace = nullptr;
+
+    while (true) {
+        if (scan_ptr == end_ptr) {
+            if (scan_ptr > theline)
+                lines.push_back(test_buf);
+            break;
+        }
+        prev_ptr = scan_ptr;
+        if (*scan_ptr == ' ')
+            last_whitespace = scan_ptr;
+
+        const char *split_at = nullptr;
+        if (*scan_ptr == '\n') {
+            split_at = scan_ptr;
+            ugetxc(&scan_ptr);
+        } else {
+            char uch[Utf8::UtfSz + 1]{};
+            usetc(uch, ugetxc(&scan_ptr));
+            test_buf.append(uch);
+            if (get_text_width_outlined(test_buf.c_str(), fonnt) > wii)
+                split_at = last_whitespace ? last_whitespace : prev_ptr;
+        }
+
+        if (split_at != nullptr) {
+            if (split_at == theline && !((*theline == ' ') || (*theline == '\n'))) {
+                lines.clear();
+                break;
+            }
+            test_buf.resize(split_at - theline);
+            lines.push_back(test_buf);
+            test_buf.clear();
+            if (lines.size() >= max_lines) {
+                lines.back().append("...");
+                break;
+            }
+            theline = split_at;
+            if ((*theline == ' ') || (*theline == '\n'))
+                ugetxc(&theline);
+            scan_ptr = theline;
+            prev_ptr = theline;
+            last_whitespace = nullptr;
+        }
+    }
+    return lines.size();
+}
+
+class FontsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        set_uformat(U_UTF8);
+        WriteTestWFN(WFNFile[0], 0);
+        WriteTestWFN(WFNFile[1], 5);
+        _assets.AddLibrary(".");
+        init_font_renderer(&_assets);
+    }
+
+    void TearDown() override {
+        shutdown_font_renderer();
+        File::DeleteFile(WFNFile[0]);
+        File::DeleteFile(WFNFile[1]);
+    }
+
+    AssetManager _assets;
+};
+
+TEST_F(FontsTest, SplitLinesMatchesReference) {
+    // font 0: plain; font 1: outlined by font 0; font 2: auto outline;
+    // font 3: scaled, outlined by font 1
+    FontInfo finfo;
+    ASSERT_TRUE(load_font_size(0, finfo));
+    ASSERT_TRUE(load_font_size(1, finfo));
+    set_font_outline(1, 0);
+    ASSERT_TRUE(load_font_size(2, finfo));
+    set_font_outline(2, FONT_OUTLINE_AUTO, FontInfo::kSquared, 2);
+    finfo.SizeMultiplier = 2;
+    ASSERT_TRUE(load_font_size(3, finfo));
+    set_font_outline(3, 1);
+
+    const char *words[] = { "a", "the", "Hello", "wonderful", "x", "supercalifragilistic",
+        "\n", "  ", "h\xC3\xA9llo", "\xE6\x97\xA5\xE6\x9C\xAC", "W" };
+    const size_t word_count = sizeof(words) / sizeof(words[0]);
+    SplitLines lines;
+    std::vector<std::string> ref_lines;
+    uint32_t seed = 7;
+    auto next_rand = [&seed]() { seed = seed * 1103515245u + 12345u; return (seed >> 8); };
+    for (int i = 0; i < 3000; ++i)
+    {
+        std::string text;
+        const size_t word_num = next_rand() % 40;
+        for (size_t w = 0; w < word_num; ++w)
+        {
+            text += words[next_rand() % word_count];
+            if (next_rand() % 3)
+                text += ' ';
+        }
+        const int width = 2 + next_rand() % 300;
+        const int font = next_rand() % 4;
+        const size_t max_lines = (next_rand() % 4 == 0) ? (1 + next_rand() % 4) : SIZE_MAX;
+        // split some texts twice, for the recently split texts are remembered
+        const int repeat = (i % 5 == 0) ? 2 : 1;
+        split_lines_reference(text.c_str(), ref_lines, width, font, max_lines);
+        for (int r = 0; r < repeat; ++r)
+        {
+            split_lines(text.c_str(), lines, width, font, max_lines);
+            ASSERT_EQ(lines.Count(), ref_lines.size()) << "text: \"" << text << "\", width " << width << ", font " << font;
+            for (size_t l = 0; l < ref_lines.size(); ++l)
+                ASSERT_STREQ(lines[l].GetCStr(), ref_lines[l].c_str()) << "text: \"" << text << "\", width " << width << ", font " << font;
+        }
+    }
+
+    // Changing the font settings resets the remembered results
+    const char *text = "the wonderful x";
+    split_lines(text, lines, 60, 2);
+    set_font_outline(2, FONT_OUTLINE_AUTO, FontInfo::kSquared, 10);
+    split_lines_reference(text, ref_lines, 60, 2, SIZE_MAX);
+    split_lines(text, lines, 60, 2);
+    ASSERT_EQ(lines.Count(), ref_lines.size());
+    for (size_t l = 0; l < ref_lines.size(); ++l)
+        ASSERT_STREQ(lines[l].GetCStr(), ref_lines[l].c_str());
+}
+
+#endif // AGS_PLATFORM_TEST_FILE_IO
@@ -11,7 +11,9 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <vector>
 #include "gtest/gtest.h"
+#include "util/geometry.h"
 #include "util/scaling.h"
 #include "util/math.h"
 
@@ -55,3 +57,33 @@ TEST(Math, AxisScaling) {
         AxScale(i, 200);
     }
 }
+
+TEST(Math, MergeIntersectingRects) {
+    std::vector<Rect> rects;
+    MergeIntersectingRects(rects);
+    ASSERT_TRUE(rects.empty());
+
+    // Separate rects, including the ones touching but not overlapping
+    rects = { RectWH(0, 0, 10, 10), RectWH(10, 0, 10, 10), RectWH(0, 20, 5, 5) };
+    MergeIntersectingRects(rects);
+    ASSERT_EQ(rects.size(), 3u);
+
+    // Overlapping rects are replaced by their bounding rect
+    rects = { RectWH(0, 0, 10, 10), RectWH(5, 5, 10, 10), RectWH(50, 50, 5, 5) };
+    MergeIntersectingRects(rects);
+    ASSERT_EQ(rects.size(), 2u);
+    ASSERT_EQ(rects[0], RectWH(0, 0, 15, 15));
+    ASSERT_EQ(rects[1], RectWH(50, 50, 5, 5));
+
+    // The bounding rect may overlap a rect which was checked before
+    rects = { RectWH(20, 0, 5, 5), RectWH(0, 0, 10, 10), RectWH(9, 9, 20, 2) };
+    MergeIntersectingRects(rects);
+    ASSERT_EQ(rects.size(), 1u);
+    ASSERT_EQ(rects[0], Rect(0, 0, 28, 10));
+
+    // Same rects, and rects inside others
+    rects = { RectWH(0, 0, 10, 10), RectWH(0, 0, 10, 10), RectWH(2, 2, 3, 3) };
+    MergeIntersectingRects(rects);
+    ASSERT_EQ(rects.size(), 1u);
+    ASSERT_EQ(rects[0], RectWH(0, 0, 10, 10));
+}
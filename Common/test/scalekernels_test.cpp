@@ -0,0 +1,147 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <vector>
+#include "gtest/gtest.h"
+#include "gfx/blitkernels.h"
+#include "gfx/scalekernels.h"
+
+using namespace AGS::Common;
+
+static const SimdLevel AllSimdLevels[] = { kSimd_None, kSimd_SSE2, kSimd_AVX2, kSimd_NEON };
+
+static std::vector<uint32_t> MakeTestImage(int w, int h, uint32_t seed)
+{
+    std::vector<uint32_t> pixels(w * h);
+    for (auto &px : pixels)
+    {
+        seed = seed * 1103515245u + 12345u;
+        px = (seed >> 8) | ((seed & 0xFF) << 24);
+    }
+    return pixels;
+}
+
+TEST(ScaleKernels, NearestMatchesReference) {
+    const int src_w = 13, src_h = 7;
+    const std::vector<uint32_t> src = MakeTestImage(src_w, src_h, 1);
+    const int sizes[][2] = { { 13, 7 }, { 26, 14 }, { 39, 21 }, { 52, 28 }, { 91, 49 }, { 30, 17 }, { 8, 5 } };
+    const SimdLevel was_simd = BlitKernels::GetSimd();
+
+    for (SimdLevel level : AllSimdLevels)
+    {
+        if (!BlitKernels::IsSimdSupported(level))
+            continue;
+        BlitKernels::SetSimd(level);
+        SCOPED_TRACE(BlitKernels::GetSimdName(level));
+
+        for (const auto &sz : sizes)
+        {
+            const int dst_w = sz[0], dst_h = sz[1];
+            std::vector<uint32_t> dst(dst_w * dst_h);
+            // do it in two parts, as if on separate threads
+            ScaleKernels::ScaleNearest(src.data(), src_w * 4, src_w, src_h, dst.data(), dst_w * 4, dst_w, dst_h, 0, dst_h / 2);
+            ScaleKernels::ScaleNearest(src.data(), src_w * 4, src_w, src_h, dst.data(), dst_w * 4, dst_w, dst_h, dst_h / 2, dst_h);
+            for (int y = 0; y < dst_h; ++y)
+                for (int x = 0; x < dst_w; ++x)
+                    ASSERT_EQ(dst[y * dst_w + x], src[(y * src_h / dst_h) * src_w + (x * src_w / dst_w)]);
+        }
+    }
+    BlitKernels::SetSimd(was_simd);
+}
+
+TEST(ScaleKernels, BilinearSameOnAllSimd) {
+    const int src_w = 21, src_h = 11;
+    const std::vector<uint32_t> src = MakeTestImage(src_w, src_h, 2);
+    const int sizes[][2] = { { 21, 11 }, { 67, 35 }, { 10, 6 }, { 84, 44 } };
+    const SimdLevel was_simd = BlitKernels::GetSimd();
+
+    for (const auto &sz : sizes)
+    {
+        const int dst_w = sz[0], dst_h = sz[1];
+        BlitKernels::SetSimd(kSimd_None);
+        std::vector<uint32_t> ref(dst_w * dst_h);
+        ScaleKernels::ScaleBilinear(src.data(), src_w * 4, src_w, src_h, ref.data(), dst_w * 4, dst_w, dst_h, 0, dst_h);
+        if ((dst_w == src_w) && (dst_h == src_h))
+        {
+            ASSERT_EQ(ref, src); // no scaling means a plain copy
+        }
+
+        for (SimdLevel level : AllSimdLevels)
+        {
+            if (!BlitKernels::IsSimdSupported(level))
+                continue;
+            BlitKernels::SetSimd(level);
+            SCOPED_TRACE(BlitKernels::GetSimdName(level));
+            std::vector<uint32_t> dst(dst_w * dst_h);
+            for (int y = 0; y < dst_h; y += 4)
+                ScaleKernels::ScaleBilinear(src.data(), src_w * 4, src_w, src_h, dst.data(), dst_w * 4, dst_w, dst_h, y, y + 4);
+            ASSERT_EQ(dst, ref);
+        }
+    }
+    BlitKernels::SetSimd(was_simd);
+}
+
+TEST(ScaleKernels, BilinearInterpolates) {
+    // 2x1 image of black and white, upscaled to 8x1
+    const uint32_t src[2] = { 0xFF000000, 0xFFFFFFFF };
+    uint32_t dst[8];
+    ScaleKernels::ScaleBilinear(src, sizeof(src), 2, 1, dst, sizeof(dst), 8, 1, 0, 1);
+    // outer pixels are clamped to the image edges
+    ASSERT_EQ(dst[0], 0xFF000000);
+    ASSERT_EQ(dst[1], 0xFF000000);
+    ASSERT_EQ(dst[6], 0xFFFFFFFF);
+    ASSERT_EQ(dst[7], 0xFFFFFFFF);
+    // and the middle ones are the gradient
+    for (int i = 2; i < 6; ++i)
+    {
+        ASSERT_GT(dst[i] & 0xFF, dst[i - 1] & 0xFF);
+        ASSERT_EQ(dst[i] & 0xFF, (dst[i] >> 8) & 0xFF);
+    }
+}
+
+TEST(ScaleKernels, PixelArt) {
+    const uint32_t X = 0xFFFFFFFF, O = 0xFF000000;
+    // the diagonal edges of a checker pattern get joined
+    const uint32_t diag[4] = { X, O, O, X };
+    uint32_t dst2[16];
+    ScaleKernels::ScalePixelArt(diag, 2 * 4, 2, 2, dst2, 4 * 4, 2, 0, 2);
+    const uint32_t expect2[16] = {
+        X, X, O, O,
+        X, O, X, O,
+        O, X, O, X,
+        O, O, X, X };
+    for (int i = 0; i < 16; ++i)
+        ASSERT_EQ(dst2[i], expect2[i]);
+
+    // same result regardless of how the rows are split
+    const int src_w = 17, src_h = 9;
+    std::vector<uint32_t> src = MakeTestImage(src_w, src_h, 3);
+    for (size_t i = 0; i < src.size(); ++i)
+        src[i] = (src[i] & 1) ? X : O; // need equal colors for the algorithm to work
+    for (int factor = 2; factor <= 3; ++factor)
+    {
+        const int dst_w = src_w * factor, dst_h = src_h * factor;
+        std::vector<uint32_t> ref(dst_w * dst_h), dst(dst_w * dst_h);
+        ScaleKernels::ScalePixelArt(src.data(), src_w * 4, src_w, src_h, ref.data(), dst_w * 4, factor, 0, src_h);
+        for (int y = 0; y < src_h; ++y)
+            ScaleKernels::ScalePixelArt(src.data(), src_w * 4, src_w, src_h, dst.data(), dst_w * 4, factor, y, y + 1);
+        ASSERT_EQ(dst, ref);
+        // the center of each 3x3 block is always the source pixel
+        if (factor == 3)
+        {
+            for (int y = 0; y < src_h; ++y)
+                for (int x = 0; x < src_w; ++x)
+                    ASSERT_EQ(dst[(y * 3 + 1) * dst_w + x * 3 + 1], src[y * src_w + x]);
+        }
+    }
+}
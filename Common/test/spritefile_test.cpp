@@ -0,0 +1,102 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/spritefile.h"
+#include "gfx/bitmap.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+// Generates a set of sprites of various color depths and sizes; sprites
+// with few colors let the writer use palette optimization; nulls are
+// written as empty slots
+static std::vector<std::unique_ptr<Bitmap>> MakeTestSprites()
+{
+    const int depths[] = { 8, 16, 32 };
+    std::vector<std::unique_ptr<Bitmap>> sprites;
+    uint32_t seed = 1;
+    for (int i = 0; i < 24; ++i)
+    {
+        if (i % 7 == 3)
+        {
+            sprites.push_back(nullptr);
+            continue;
+        }
+        const int depth = depths[i % 3];
+        const int w = 1 + (i * 13) % 40, h = 1 + (i * 7) % 25;
+        const int colors = (i % 2) ? 4 : 0x10000;
+        std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateBitmap(w, h, depth));
+        for (int y = 0; y < h; ++y)
+        {
+            for (int x = 0; x < w; ++x)
+            {
+                seed = seed * 1103515245u + 12345u;
+                // repeating runs of pixels make RLE and LZW do some work
+                const uint32_t c = ((x / 3) % 2) ? ((seed >> 8) % colors) : 0u;
+                bmp->PutPixel(x, y, (depth == 8) ? (c & 0xFF) : ((depth == 16) ? (c & 0xFFFF) : (c | 0xFF000000)));
+            }
+        }
+        sprites.push_back(std::move(bmp));
+    }
+    return sprites;
+}
+
+TEST(SpriteFile, ParallelWriterMatchesWriter) {
+    const std::vector<std::unique_ptr<Bitmap>> sprites = MakeTestSprites();
+    const SpriteCompression compressions[] =
+        { kSprCompress_None, kSprCompress_RLE, kSprCompress_LZW, kSprCompress_Deflate };
+
+    for (int store_flags : { 0, (int)kSprStore_OptimizeForSize })
+    {
+        for (SpriteCompression compress : compressions)
+        {
+            std::vector<uint8_t> ref_buf;
+            SpriteFileWriter writer(std::make_unique<Stream>(
+                std::make_unique<VectorStream>(ref_buf, kStream_Write)));
+            writer.Begin(store_flags, compress, sprites.size() - 1);
+            for (const auto &bmp : sprites)
+            {
+                if (bmp)
+                    writer.WriteBitmap(bmp.get());
+                else
+                    writer.WriteEmptySlot();
+            }
+            writer.Finalize();
+
+            for (size_t threads : { 1u, 2u, 5u })
+            {
+                std::vector<uint8_t> buf;
+                {
+                    ParallelSpriteFileWriter pwriter(std::make_unique<Stream>(
+                        std::make_unique<VectorStream>(buf, kStream_Write)), threads);
+                    pwriter.Begin(store_flags, compress, sprites.size() - 1);
+                    for (const auto &bmp : sprites)
+                    {
+                        if (bmp)
+                            pwriter.WriteBitmap(bmp.get());
+                        else
+                            pwriter.WriteEmptySlot();
+                    }
+                    pwriter.Finalize();
+                    ASSERT_EQ(pwriter.GetIndex().Offsets, writer.GetIndex().Offsets);
+                }
+                ASSERT_EQ(buf, ref_buf) << "compression " << compress << ", store flags "
+                    << store_flags << ", threads " << threads;
+            }
+        }
+    }
+}
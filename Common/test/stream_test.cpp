@@ -11,13 +11,17 @@
 // https://opensource.org/license/artistic-2-0/
 //
 //=============================================================================
+#include <algorithm>
 #include <array>
+#include <cstring>
 #include <memory>
 #include <vector>
 #include "gtest/gtest.h"
 #include "util/bufferedstream.h"
+#include "util/compressedframestream.h"
 #include "util/file.h"
 #include "util/filestream.h"
+#include "util/mappedfilestream.h"
 #include "util/memory_compat.h"
 #include "util/memorystream.h"
 #include "util/string_utils.h"
@@ -266,6 +270,55 @@ TEST(Stream, DataStreamSection) {
     in.Close();
 }
 
+TEST(Stream, CompressedFrameStream) {
+    // Source data: partly compressible, partly random
+    const uint32_t frame_size = 1000;
+    const size_t data_len = frame_size * 4 + 123;
+    std::vector<uint8_t> data(data_len);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < data_len; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (i < frame_size * 2) ? static_cast<uint8_t>(i / 16) : static_cast<uint8_t>(seed >> 16);
+    }
+    //-------------------------------------------------------------------------
+    // Compress
+    std::vector<uint8_t> membuf;
+    {
+        Stream in(std::make_unique<VectorStream>(data, kStream_Read));
+        Stream out(std::make_unique<VectorStream>(membuf, kStream_Write));
+        ASSERT_TRUE(CompressedFrameStream::Compress(&in, data_len, frame_size, &out));
+    }
+    ASSERT_LT(membuf.size(), data_len);
+    //-------------------------------------------------------------------------
+    // Read data back sequentially
+    Stream in(std::make_unique<CompressedFrameStream>(
+        std::make_unique<Stream>(std::make_unique<VectorStream>(membuf, kStream_Read)),
+        data_len, frame_size));
+    ASSERT_TRUE(in.CanRead());
+    ASSERT_TRUE(in.CanSeek());
+    ASSERT_EQ(in.GetLength(), data_len);
+    std::vector<uint8_t> readbuf(data_len);
+    ASSERT_EQ(in.Read(readbuf.data(), data_len), data_len);
+    ASSERT_TRUE(in.EOS());
+    ASSERT_EQ(readbuf, data);
+    //-------------------------------------------------------------------------
+    // Read with seeks, crossing frame boundaries
+    const soff_t positions[] = { 3 * frame_size - 10, 5, frame_size * 4 + 100, frame_size - 1, 0 };
+    for (soff_t pos : positions)
+    {
+        ASSERT_EQ(in.Seek(pos, kSeekBegin), pos);
+        const size_t len = std::min<size_t>(50, data_len - pos);
+        ASSERT_EQ(in.Read(readbuf.data(), len), len);
+        ASSERT_EQ(memcmp(readbuf.data(), data.data() + pos, len), 0);
+        ASSERT_EQ(in.GetPosition(), pos + static_cast<soff_t>(len));
+    }
+    ASSERT_EQ(in.Seek(-1, kSeekEnd), static_cast<soff_t>(data_len - 1));
+    ASSERT_EQ(in.ReadByte(), data[data_len - 1]);
+    ASSERT_EQ(in.ReadByte(), -1);
+    in.Close();
+}
+
 #if (AGS_PLATFORM_TEST_FILE_IO)
 
 static const char *DummyFile = "dummy.dat";
@@ -671,4 +724,54 @@ TEST_F(FileBasedTest, BufferedSectionStream) {
     File::DeleteFile(DummyFile);
 }
 
+TEST_F(FileBasedTest, MappedFileStream) {
+    //-------------------------------------------------------------------------
+    // Write data into the temp file
+    Stream out(std::make_unique<FileStream>(DummyFile, kFile_CreateAlways, kStream_Write));
+    out.WriteInt32(0);
+    out.WriteInt32(1);
+    const auto section_start = out.GetPosition();
+    out.WriteInt32(2);
+    out.WriteInt32(3);
+    const auto section_end = out.GetPosition();
+    out.WriteInt32(4);
+    out.Close();
+
+    //-------------------------------------------------------------------------
+    // Map the file and read the section back
+    auto mf = MappedFile::Open(DummyFile);
+    ASSERT_TRUE(mf != nullptr);
+    ASSERT_EQ(mf->GetSize(), 5 * sizeof(int32_t));
+    MappedFileStream *mfs = new MappedFileStream(mf, section_start, section_end);
+    Stream in{ std::unique_ptr<IStreamBase>(mfs) };
+    mf.reset(); // stream must keep the mapping alive
+    ASSERT_TRUE(in.CanRead());
+    ASSERT_TRUE(in.CanSeek());
+    ASSERT_FALSE(in.CanWrite());
+    ASSERT_EQ(in.GetLength(), section_end - section_start);
+    ASSERT_EQ(mfs->GetDataSize(), static_cast<size_t>(section_end - section_start));
+    int32_t direct[2];
+    memcpy(direct, mfs->GetData(), sizeof(direct));
+    ASSERT_EQ(direct[0], 2);
+    ASSERT_EQ(direct[1], 3);
+    ASSERT_EQ(in.ReadInt32(), 2);
+    ASSERT_EQ(in.ReadInt32(), 3);
+    ASSERT_TRUE(in.EOS());
+    // reading past section end - results in no data
+    ASSERT_EQ(in.ReadByte(), -1);
+    ASSERT_EQ(in.Seek(0, kSeekBegin), 0);
+    ASSERT_EQ(in.ReadInt32(), 2);
+    in.Close();
+
+    // Section past the file end is clamped
+    auto mf2 = MappedFile::Open(DummyFile);
+    ASSERT_TRUE(mf2 != nullptr);
+    MappedFileStream in2(mf2, section_end, section_end + 100);
+    ASSERT_EQ(in2.GetLength(), static_cast<soff_t>(sizeof(int32_t)));
+    in2.Close();
+    mf2.reset();
+
+    File::DeleteFile(DummyFile);
+}
+
 #endif // AGS_PLATFORM_TEST_FILE_IO
@@ -0,0 +1,84 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <atomic>
+#include <thread>
+#include "gtest/gtest.h"
+#include "util/taskgraph.h"
+#include "util/threadpool.h"
+
+using namespace AGS::Common;
+
+// Builds a diamond-shaped graph, where each task records the order
+// in which it was completed
+static void TestTaskGraphOrder(ThreadPool *pool)
+{
+    std::atomic<int> counter(0);
+    int order[5] = {};
+    std::thread::id main_id = std::this_thread::get_id();
+    bool main_task_on_main = false;
+
+    TaskGraph graph;
+    auto a = graph.Add("a", [&]() { order[0] = counter++; return true; });
+    auto b = graph.Add("b", [&]() { order[1] = counter++; return true; }, { a });
+    auto c = graph.Add("c", [&]() {
+        order[2] = counter++;
+        main_task_on_main = std::this_thread::get_id() == main_id;
+        return true; }, { a }, true);
+    auto d = graph.Add("d", [&]() { order[3] = counter++; return true; }, { b, c });
+    graph.Add("e", [&]() { order[4] = counter++; return true; });
+    ASSERT_TRUE(graph.Run(pool));
+
+    ASSERT_EQ(counter, 5);
+    ASSERT_LT(order[0], order[1]);
+    ASSERT_LT(order[0], order[2]);
+    ASSERT_LT(order[1], order[3]);
+    ASSERT_LT(order[2], order[3]);
+    ASSERT_TRUE(main_task_on_main);
+    for (const auto &info : graph.GetTasks())
+    {
+        ASSERT_TRUE(info.Done);
+        ASSERT_TRUE(info.Succeeded);
+    }
+    ASSERT_EQ(graph.GetTasks()[d].Name, "d");
+}
+
+TEST(TaskGraph, Sequential) {
+    TestTaskGraphOrder(nullptr);
+}
+
+TEST(TaskGraph, Parallel) {
+    ThreadPool pool(3);
+    TestTaskGraphOrder(&pool);
+}
+
+TEST(TaskGraph, Failure) {
+    ThreadPool pool(2);
+    bool dependent_run = false;
+    TaskGraph graph;
+    auto a = graph.Add("a", []() { return false; });
+    graph.Add("b", [&]() { dependent_run = true; return true; }, { a });
+    ASSERT_FALSE(graph.Run(&pool));
+    ASSERT_FALSE(dependent_run);
+    ASSERT_FALSE(graph.GetTasks()[0].Succeeded);
+    ASSERT_FALSE(graph.GetTasks()[1].Done);
+
+    // Tasks which are ready but not started yet are skipped too
+    bool queued_run = false;
+    TaskGraph graph2;
+    graph2.Add("a", []() { return false; });
+    graph2.Add("b", [&]() { queued_run = true; return true; });
+    ASSERT_FALSE(graph2.Run(nullptr));
+    ASSERT_FALSE(queued_run);
+    ASSERT_FALSE(graph2.GetTasks()[1].Done);
+}
@@ -0,0 +1,220 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <allegro.h>
+#include "gtest/gtest.h"
+#include "gfx/bitmap.h"
+#include "gfx/blitkernels.h"
+#include "gfx/scalekernels.h"
+#include "gfx/transformkernels.h"
+
+using namespace AGS::Common;
+
+static const SimdLevel AllSimdLevels[] = { kSimd_None, kSimd_SSE2, kSimd_AVX2, kSimd_NEON };
+
+// Generates a sprite with transparent areas, and both opaque and
+// translucent pixels
+static std::unique_ptr<Bitmap> MakeTestSprite(int w, int h, uint32_t seed)
+{
+    std::unique_ptr<Bitmap> bmp(BitmapHelper::CreateBitmap(w, h, 32));
+    for (int y = 0; y < h; ++y)
+    {
+        uint32_t *row = reinterpret_cast<uint32_t*>(bmp->GetScanLineForWriting(y));
+        for (int x = 0; x < w; ++x)
+        {
+            seed = seed * 1103515245u + 12345u;
+            uint32_t px = (seed >> 8) | ((seed & 0xFF) << 24);
+            if ((x + y) % 5 == 0)
+                px = MASK_COLOR_32;
+            else if ((x * y) % 7 == 1)
+                px &= 0x00FFFFFF;
+            row[x] = px;
+        }
+    }
+    return bmp;
+}
+
+static bool BitmapsEqual(const Bitmap *bmp1, const Bitmap *bmp2)
+{
+    for (int y = 0; y < bmp1->GetHeight(); ++y)
+        if (memcmp(bmp1->GetScanLine(y), bmp2->GetScanLine(y), bmp1->GetWidth() * sizeof(uint32_t)) != 0)
+            return false;
+    return true;
+}
+
+// Allegro's fixed point math reports overflows through allegro_errno,
+// which is only assigned by install_allegro
+static void InitAllegro()
+{
+    if (!allegro_errno)
+        install_allegro(SYSTEM_NONE, &errno, atexit);
+}
+
+// Runs func(y1, y2) over the rows, split into the given number of bands,
+// as if the work was distributed between threads
+static void ForEachBand(int rows, int bands, const std::function<void(int, int)> &func)
+{
+    for (int i = 0; i < bands; ++i)
+        func(rows * i / bands, rows * (i + 1) / bands);
+}
+
+TEST(TransformKernels, RotateMatchesAllegro) {
+    const int sizes[][2] = { { 31, 17 }, { 64, 64 }, { 9, 40 }, { 1, 1 } };
+    const int angles[] = { 1, 30, 45, 90, 135, 180, 211, 270, 359 };
+    const SimdLevel was_simd = BlitKernels::GetSimd();
+    InitAllegro();
+
+    for (const auto &sz : sizes)
+    {
+        std::unique_ptr<Bitmap> src = MakeTestSprite(sz[0], sz[1], sz[0] * 100 + sz[1]);
+        for (int angle : angles)
+        {
+            // same destination size and pivots as DynamicSprite.Rotate uses
+            const int dst_w = sz[0] + sz[1], dst_h = sz[0] + sz[1];
+            const int dst_x = dst_w / 2 + dst_w % 2, dst_y = dst_h / 2;
+            const int src_cx = sz[0] / 2, src_cy = sz[1] / 2;
+            const fixed_t al_angle = itofix((angle * 256) / 360);
+            std::unique_ptr<Bitmap> ref(BitmapHelper::CreateTransparentBitmap(dst_w, dst_h, 32));
+            ref->RotateBlt(src.get(), dst_x, dst_y, src_cx, src_cy, al_angle);
+
+            TransformKernels::SpanMap map;
+            TransformKernels::MapRotation(map, sz[0], sz[1], dst_w, dst_h, dst_x, dst_y, src_cx, src_cy, al_angle);
+            for (SimdLevel level : AllSimdLevels)
+            {
+                if (!BlitKernels::IsSimdSupported(level))
+                    continue;
+                BlitKernels::SetSimd(level);
+                SCOPED_TRACE(BlitKernels::GetSimdName(level));
+                for (int bands : { 1, 3, 7 })
+                {
+                    std::unique_ptr<Bitmap> dst(BitmapHelper::CreateTransparentBitmap(dst_w, dst_h, 32));
+                    ForEachBand(dst_h, bands, [&](int y1, int y2) {
+                        TransformKernels::DrawNearest(reinterpret_cast<const uint32_t*>(src->GetData()), src->GetLineLength(),
+                            sz[0], sz[1], reinterpret_cast<uint32_t*>(dst->GetDataForWriting()), dst->GetLineLength(),
+                            map, y1, y2); });
+                    ASSERT_TRUE(BitmapsEqual(ref.get(), dst.get())) << "size " << sz[0] << "x" << sz[1] << ", angle " << angle;
+                }
+            }
+        }
+    }
+    BlitKernels::SetSimd(was_simd);
+}
+
+TEST(TransformKernels, FlipMatchesAllegro) {
+    const int w = 37, h = 13;
+    std::unique_ptr<Bitmap> src = MakeTestSprite(w, h, 5);
+    const GraphicFlip flips[] = { kFlip_None, kFlip_Horizontal, kFlip_Vertical, kFlip_Both };
+    const SimdLevel was_simd = BlitKernels::GetSimd();
+
+    for (GraphicFlip flip : flips)
+    {
+        std::unique_ptr<Bitmap> ref(BitmapHelper::CreateTransparentBitmap(w, h, 32));
+        ref->FlipBlt(src.get(), 0, 0, flip);
+        for (SimdLevel level : AllSimdLevels)
+        {
+            if (!BlitKernels::IsSimdSupported(level))
+                continue;
+            BlitKernels::SetSimd(level);
+            SCOPED_TRACE(BlitKernels::GetSimdName(level));
+            std::unique_ptr<Bitmap> dst(BitmapHelper::CreateBitmap(w, h, 32));
+            ForEachBand(h, 3, [&](int y1, int y2) {
+                TransformKernels::Flip(reinterpret_cast<const uint32_t*>(src->GetData()), src->GetLineLength(),
+                    reinterpret_cast<uint32_t*>(dst->GetDataForWriting()), dst->GetLineLength(), w, h, flip, y1, y2); });
+            ASSERT_TRUE(BitmapsEqual(ref.get(), dst.get())) << "flip " << flip;
+        }
+    }
+    BlitKernels::SetSimd(was_simd);
+}
+
+TEST(TransformKernels, ResizeNearestMatchesAllegro) {
+    const int src_w = 23, src_h = 11;
+    std::unique_ptr<Bitmap> src = MakeTestSprite(src_w, src_h, 6);
+    const int sizes[][2] = { { 23, 11 }, { 46, 22 }, { 50, 7 }, { 5, 30 }, { 1, 1 }, { 211, 97 } };
+    for (const auto &sz : sizes)
+    {
+        std::unique_ptr<Bitmap> ref(BitmapHelper::CreateBitmap(sz[0], sz[1], 32));
+        ref->StretchBlt(src.get(), RectWH(0, 0, src_w, src_h), RectWH(0, 0, sz[0], sz[1]));
+        std::unique_ptr<Bitmap> dst(BitmapHelper::CreateBitmap(sz[0], sz[1], 32));
+        ForEachBand(sz[1], 3, [&](int y1, int y2) {
+            ScaleKernels::ScaleNearest(reinterpret_cast<const uint32_t*>(src->GetData()), src->GetLineLength(), src_w, src_h,
+                reinterpret_cast<uint32_t*>(dst->GetDataForWriting()), dst->GetLineLength(), sz[0], sz[1], y1, y2); });
+        ASSERT_TRUE(BitmapsEqual(ref.get(), dst.get())) << "size " << sz[0] << "x" << sz[1];
+    }
+}
+
+TEST(TransformKernels, Bilinear) {
+    const int src_w = 19, src_h = 14;
+    std::unique_ptr<Bitmap> src = MakeTestSprite(src_w, src_h, 7);
+    const uint32_t *src_px = reinterpret_cast<const uint32_t*>(src->GetData());
+    const size_t src_pitch = src->GetLineLength();
+    InitAllegro();
+
+    for (bool has_alpha : { false, true })
+    {
+        // Same size: the opaque pixels are copied, transparent are skipped
+        TransformKernels::SpanMap map;
+        TransformKernels::MapScale(map, src_w, src_h, src_w, src_h);
+        std::unique_ptr<Bitmap> dst(BitmapHelper::CreateTransparentBitmap(src_w, src_h, 32));
+        TransformKernels::DrawBilinear(src_px, src_pitch, src_w, src_h,
+            reinterpret_cast<uint32_t*>(dst->GetDataForWriting()), dst->GetLineLength(), map, has_alpha, 0, src_h);
+        for (int y = 0; y < src_h; ++y)
+        {
+            for (int x = 0; x < src_w; ++x)
+            {
+                const uint32_t px = src->GetPixel(x, y);
+                const bool skipped = has_alpha ? (geta32(px) == 0) : (px == MASK_COLOR_32);
+                ASSERT_EQ(dst->GetPixel(x, y), skipped ? MASK_COLOR_32 : px);
+            }
+        }
+
+        // Scaled and rotated: results do not depend on the rows split
+        const int dst_w = 47, dst_h = 33;
+        TransformKernels::SpanMap maps[2];
+        TransformKernels::MapScale(maps[0], src_w, src_h, dst_w, dst_h);
+        TransformKernels::MapRotation(maps[1], src_w, src_h, dst_w, dst_h, dst_w / 2, dst_h / 2, src_w / 2, src_h / 2, itofix(50));
+        for (const auto &m : maps)
+        {
+            std::unique_ptr<Bitmap> ref(BitmapHelper::CreateTransparentBitmap(dst_w, dst_h, 32));
+            TransformKernels::DrawBilinear(src_px, src_pitch, src_w, src_h,
+                reinterpret_cast<uint32_t*>(ref->GetDataForWriting()), ref->GetLineLength(), m, has_alpha, 0, dst_h);
+            for (int bands : { 2, 5 })
+            {
+                std::unique_ptr<Bitmap> dst2(BitmapHelper::CreateTransparentBitmap(dst_w, dst_h, 32));
+                ForEachBand(dst_h, bands, [&](int y1, int y2) {
+                    TransformKernels::DrawBilinear(src_px, src_pitch, src_w, src_h,
+                        reinterpret_cast<uint32_t*>(dst2->GetDataForWriting()), dst2->GetLineLength(), m, has_alpha, y1, y2); });
+                ASSERT_TRUE(BitmapsEqual(ref.get(), dst2.get()));
+            }
+        }
+    }
+
+    // Opaque pixels are interpolated
+    std::unique_ptr<Bitmap> bw(BitmapHelper::CreateBitmap(2, 1, 32));
+    bw->PutPixel(0, 0, 0xFF000000);
+    bw->PutPixel(1, 0, 0xFFFFFFFF);
+    TransformKernels::SpanMap map;
+    TransformKernels::MapScale(map, 2, 1, 4, 1);
+    uint32_t row[4];
+    TransformKernels::DrawBilinear(reinterpret_cast<const uint32_t*>(bw->GetData()), bw->GetLineLength(), 2, 1,
+        row, sizeof(row), map, true, 0, 1);
+    ASSERT_EQ(row[0], 0xFF000000u);
+    ASSERT_EQ(row[1], 0xFF404040u);
+    ASSERT_EQ(row[2], 0xFFBFBFBFu);
+    ASSERT_EQ(row[3], 0xFFFFFFFFu);
+}
@@ -0,0 +1,225 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "util/compressedframestream.h"
+#include <algorithm>
+#include <string.h>
+#include <miniz.h>
+
+namespace AGS
+{
+namespace Common
+{
+
+CompressedFrameStream::CompressedFrameStream(std::unique_ptr<Stream> &&base, soff_t data_size, uint32_t frame_size)
+    : _base(std::move(base))
+    , _dataSize(std::max<soff_t>(0, data_size))
+    , _frameSize(frame_size)
+{
+    if (!_base || (_frameSize == 0))
+    {
+        _base.reset();
+        return;
+    }
+    _path = _base->GetPath();
+
+    const size_t frame_count = static_cast<size_t>((_dataSize + _frameSize - 1) / _frameSize);
+    if (static_cast<size_t>(_base->ReadInt32()) != frame_count)
+    {
+        _base.reset(); // invalid data
+        return;
+    }
+    _frameOffsets.resize(frame_count + 1);
+    soff_t offset = (1 + frame_count) * sizeof(int32_t);
+    for (size_t i = 0; i < frame_count; ++i)
+    {
+        _frameOffsets[i] = offset;
+        offset += static_cast<uint32_t>(_base->ReadInt32());
+    }
+    _frameOffsets[frame_count] = offset;
+}
+
+/* static */ bool CompressedFrameStream::Compress(Stream *in, soff_t data_size, uint32_t frame_size, Stream *out)
+{
+    if (frame_size == 0)
+        return false;
+    const size_t frame_count = static_cast<size_t>((data_size + frame_size - 1) / frame_size);
+    std::vector<uint8_t> frame(frame_size);
+    std::vector<uint8_t> packed(mz_compressBound(frame_size));
+    std::vector<int32_t> stored_sizes(frame_count);
+    // Reserve the frame table, will write it after compressing the frames
+    const soff_t table_pos = out->GetPosition();
+    out->WriteInt32(static_cast<int32_t>(frame_count));
+    out->WriteByteCount(0, frame_count * sizeof(int32_t));
+    for (size_t i = 0; i < frame_count; ++i)
+    {
+        const size_t raw_size = static_cast<size_t>(
+            std::min<soff_t>(frame_size, data_size - static_cast<soff_t>(i) * frame_size));
+        if (in->Read(frame.data(), raw_size) != raw_size)
+            return false;
+        mz_ulong packed_size = static_cast<mz_ulong>(packed.size());
+        if ((mz_compress2(packed.data(), &packed_size, frame.data(), static_cast<mz_ulong>(raw_size),
+                MZ_DEFAULT_COMPRESSION) == MZ_OK) && (packed_size < raw_size))
+        {
+            out->Write(packed.data(), packed_size);
+            stored_sizes[i] = static_cast<int32_t>(packed_size);
+        }
+        else
+        {
+            // store uncompressed
+            out->Write(frame.data(), raw_size);
+            stored_sizes[i] = static_cast<int32_t>(raw_size);
+        }
+    }
+    const soff_t end_pos = out->GetPosition();
+    out->Seek(table_pos + sizeof(int32_t), kSeekBegin);
+    out->WriteArrayOfInt32(stored_sizes.data(), frame_count);
+    out->Seek(end_pos, kSeekBegin);
+    return !out->GetError();
+}
+
+StreamMode CompressedFrameStream::GetMode() const
+{
+    return _base ? static_cast<StreamMode>(kStream_Read | kStream_Seek) : kStream_None;
+}
+
+bool CompressedFrameStream::EOS() const
+{
+    return _pos >= _dataSize;
+}
+
+soff_t CompressedFrameStream::GetLength() const
+{
+    return _dataSize;
+}
+
+soff_t CompressedFrameStream::GetPosition() const
+{
+    return _pos;
+}
+
+bool CompressedFrameStream::GetError() const
+{
+    const bool error = _error;
+    _error = false;
+    return error;
+}
+
+bool CompressedFrameStream::LoadFrame(size_t index)
+{
+    if (index == _curFrame)
+        return true;
+    _curFrame = SIZE_MAX;
+    const size_t raw_size = static_cast<size_t>(
+        std::min<soff_t>(_frameSize, _dataSize - static_cast<soff_t>(index) * _frameSize));
+    const size_t stored_size = static_cast<size_t>(_frameOffsets[index + 1] - _frameOffsets[index]);
+    _frame.resize(raw_size);
+    if (_base->Seek(_frameOffsets[index], kSeekBegin) != _frameOffsets[index])
+        return false;
+    if (stored_size == raw_size)
+    {
+        // frame is stored uncompressed
+        if (_base->Read(_frame.data(), raw_size) != raw_size)
+            return false;
+    }
+    else
+    {
+        _packed.resize(stored_size);
+        if (_base->Read(_packed.data(), stored_size) != stored_size)
+            return false;
+        mz_ulong unpacked_size = static_cast<mz_ulong>(raw_size);
+        if ((mz_uncompress(_frame.data(), &unpacked_size, _packed.data(), static_cast<mz_ulong>(stored_size)) != MZ_OK) ||
+            (unpacked_size != raw_size))
+            return false;
+    }
+    _curFrame = index;
+    return true;
+}
+
+size_t CompressedFrameStream::Read(void *buffer, size_t size)
+{
+    if (!_base)
+        return 0;
+    uint8_t *dst = static_cast<uint8_t*>(buffer);
+    size_t total_read = 0;
+    while ((size > 0) && (_pos < _dataSize))
+    {
+        const size_t frame_index = static_cast<size_t>(_pos / _frameSize);
+        if (!LoadFrame(frame_index))
+        {
+            _error = true;
+            break;
+        }
+        const size_t frame_pos = static_cast<size_t>(_pos - static_cast<soff_t>(frame_index) * _frameSize);
+        const size_t chunk = std::min(size, _frame.size() - frame_pos);
+        memcpy(dst, _frame.data() + frame_pos, chunk);
+        dst += chunk;
+        size -= chunk;
+        total_read += chunk;
+        _pos += chunk;
+    }
+    return total_read;
+}
+
+int32_t CompressedFrameStream::ReadByte()
+{
+    uint8_t b;
+    if (Read(&b, 1) != 1)
+        return -1;
+    return b;
+}
+
+size_t CompressedFrameStream::Write(const void * /*buffer*/, size_t /*size*/)
+{
+    return 0; // read-only stream
+}
+
+int32_t CompressedFrameStream::WriteByte(uint8_t /*b*/)
+{
+    return -1; // read-only stream
+}
+
+soff_t CompressedFrameStream::Seek(soff_t offset, StreamSeek origin)
+{
+    if (!_base)
+        return -1;
+    soff_t want_pos = -1;
+    switch (origin)
+    {
+    case StreamSeek::kSeekBegin: want_pos = offset; break;
+    case StreamSeek::kSeekCurrent: want_pos = _pos + offset; break;
+    case StreamSeek::kSeekEnd: want_pos = _dataSize + offset; break;
+    default: return -1;
+    }
+    // the frame will be decompressed on the next read
+    _pos = std::min(std::max<soff_t>(0, want_pos), _dataSize);
+    return _pos;
+}
+
+bool CompressedFrameStream::Flush()
+{
+    return false;
+}
+
+void CompressedFrameStream::Close()
+{
+    _base.reset();
+    _frameOffsets.clear();
+    _frame.clear();
+    _curFrame = SIZE_MAX;
+    _dataSize = 0;
+    _pos = 0;
+}
+
+} // namespace Common
+} // namespace AGS
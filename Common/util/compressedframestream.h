@@ -0,0 +1,93 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// CompressedFrameStream reads data which was compressed in separate frames.
+//
+// The data is split into frames of equal uncompressed size (except the last
+// one), and each frame is compressed independently with deflate (zlib).
+// This lets seek to any position by only decompressing a single frame
+// containing it.
+// The format is:
+//   int32 - number of frames
+//   int32 x frames - stored size of each frame; if the stored size equals
+//                    the uncompressed frame size, then the frame is not
+//                    compressed (this is used when compression did not help)
+//   frame data
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__COMPRESSEDFRAMESTREAM_H
+#define __AGS_CN_UTIL__COMPRESSEDFRAMESTREAM_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "util/stream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class CompressedFrameStream : public StreamBase
+{
+public:
+    // Default uncompressed frame size
+    static const uint32_t DefaultFrameSize = 256 * 1024;
+
+    // Constructs a stream over the compressed data in the base stream, which
+    // must start at the frame table; data_size is the total uncompressed size,
+    // frame_size is the uncompressed size of a frame.
+    CompressedFrameStream(std::unique_ptr<Stream> &&base, soff_t data_size, uint32_t frame_size);
+    ~CompressedFrameStream() override = default;
+
+    // Compresses data_size bytes from the input stream, and writes it
+    // into the output stream in the frame format; returns if succeeded
+    static bool Compress(Stream *in, soff_t data_size, uint32_t frame_size, Stream *out);
+
+    StreamMode GetMode() const override;
+    bool    EOS() const override;
+    soff_t  GetLength() const override;
+    soff_t  GetPosition() const override;
+    bool    GetError() const override;
+
+    size_t  Read(void *buffer, size_t size) override;
+    int32_t ReadByte() override;
+    size_t  Write(const void *buffer, size_t size) override;
+    int32_t WriteByte(uint8_t b) override;
+
+    soff_t  Seek(soff_t offset, StreamSeek origin) override;
+
+    bool    Flush() override;
+    void    Close() override;
+
+private:
+    // Loads and decompresses the frame, makes it current
+    bool    LoadFrame(size_t index);
+
+    std::unique_ptr<Stream> _base;
+    soff_t   _dataSize = 0;
+    uint32_t _frameSize = 0;
+    soff_t   _pos = 0;
+    // Offsets of each frame in the base stream, plus the end offset
+    std::vector<soff_t> _frameOffsets;
+    std::vector<uint8_t> _frame; // current decompressed frame
+    std::vector<uint8_t> _packed; // compressed frame buffer
+    size_t   _curFrame = SIZE_MAX;
+    mutable bool _error = false;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__COMPRESSEDFRAMESTREAM_H
@@ -141,5 +141,31 @@ Rect IntersectRects(const Rect &r1, const Rect &r2)
         std::min(r1.Right, r2.Right), std::min(r1.Bottom, r2.Bottom));
 }
 
+void MergeIntersectingRects(std::vector<Rect> &rects)
+{
+    // A merged rectangle may intersect the ones which were checked before,
+    // so repeat until there's nothing to merge
+    for (bool merged = true; merged;)
+    {
+        merged = false;
+        for (size_t i = 0; i < rects.size(); ++i)
+        {
+            for (size_t j = i + 1; j < rects.size();)
+            {
+                if (AreRectsIntersecting(rects[i], rects[j]))
+                {
+                    rects[i] = SumRects(rects[i], rects[j]);
+                    rects.erase(rects.begin() + j);
+                    merged = true;
+                }
+                else
+                {
+                    ++j;
+                }
+            }
+        }
+    }
+}
+
 //} // namespace Common
 //} // namespace AGS
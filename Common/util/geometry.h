@@ -19,6 +19,7 @@
 #define __AGS_CN_UTIL__GEOMETRY_H
 
 #include <cmath>
+#include <vector>
 #include "util/math.h"
 
 namespace AGSMath = AGS::Common::Math;
@@ -442,6 +443,9 @@ Rect PlaceInRect(const Rect &place, const Rect &item, const RectPlacement &place
 Rect SumRects(const Rect &r1, const Rect &r2);
 // Intersect two rectangles, the resolt is the rectangle bounding their intersection
 Rect IntersectRects(const Rect &r1, const Rect &r2);
+// Replaces each group of intersecting rectangles in the list with their
+// bounding rectangle, so that none of the remaining rectangles intersect
+void MergeIntersectingRects(std::vector<Rect> &rects);
 //} // namespace Common
 //} // namespace AGS
 
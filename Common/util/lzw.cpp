@@ -36,10 +36,12 @@ void _delete(int);
 #define root (node+1+N+N+N)
 #define NIL -1
 
-uint8_t *lzbuffer;
-int *node;
-int pos;
-size_t outbytes = 0;
+// The work buffers are per thread, because sprites may be compressed or
+// expanded on a background thread while the main thread loads other ones
+static thread_local uint8_t *lzbuffer;
+static thread_local int *node;
+static thread_local int pos;
+static thread_local size_t outbytes = 0;
 
 int insert(int i, int run)
 {
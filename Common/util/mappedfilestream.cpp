@@ -0,0 +1,137 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "util/mappedfilestream.h"
+#include <algorithm>
+#include <cstdint>
+#if AGS_PLATFORM_OS_WINDOWS
+#include "platform/windows/windows.h"
+#include "util/stdio_compat.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AGS
+{
+namespace Common
+{
+
+#if AGS_PLATFORM_OS_WINDOWS
+
+std::shared_ptr<MappedFile> MappedFile::Open(const String &filename)
+{
+    WCHAR wpath[MAX_PATH_SZ];
+    MultiByteToWideChar(CP_UTF8, 0, filename.GetCStr(), -1, wpath, MAX_PATH_SZ);
+    HANDLE hfile = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hfile == INVALID_HANDLE_VALUE)
+        return nullptr;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(hfile, &file_size) || (file_size.QuadPart == 0) ||
+        (static_cast<uint64_t>(file_size.QuadPart) > SIZE_MAX))
+    {
+        CloseHandle(hfile);
+        return nullptr;
+    }
+    HANDLE hmapping = CreateFileMappingW(hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+    // the mapping keeps its own reference to the file
+    CloseHandle(hfile);
+    if (!hmapping)
+        return nullptr;
+    void *data = MapViewOfFile(hmapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data)
+    {
+        CloseHandle(hmapping);
+        return nullptr;
+    }
+
+    std::shared_ptr<MappedFile> mf(new MappedFile());
+    mf->_path = filename;
+    mf->_data = static_cast<const uint8_t*>(data);
+    mf->_size = static_cast<size_t>(file_size.QuadPart);
+    mf->_hMapping = hmapping;
+    return mf;
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data)
+        UnmapViewOfFile(_data);
+    if (_hMapping)
+        CloseHandle(static_cast<HANDLE>(_hMapping));
+}
+
+#else // POSIX
+
+std::shared_ptr<MappedFile> MappedFile::Open(const String &filename)
+{
+    int fd = open(filename.GetCStr(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode) || (st.st_size == 0) ||
+        (static_cast<uint64_t>(st.st_size) > SIZE_MAX))
+    {
+        close(fd);
+        return nullptr;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+
+    std::shared_ptr<MappedFile> mf(new MappedFile());
+    mf->_path = filename;
+    mf->_data = static_cast<const uint8_t*>(data);
+    mf->_size = size;
+    return mf;
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data)
+        munmap(const_cast<uint8_t*>(_data), _size);
+}
+
+#endif // POSIX
+
+
+MappedFileStream::MappedFileStream(std::shared_ptr<MappedFile> file, soff_t start_off, soff_t end_off)
+    : MemoryStream(nullptr, 0u)
+    , _file(file)
+{
+    if (!_file)
+        return;
+    const soff_t file_size = static_cast<soff_t>(_file->GetSize());
+    start_off = std::min(std::max<soff_t>(0, start_off), file_size);
+    end_off = std::min(std::max(start_off, end_off), file_size);
+    _cbuf = _file->GetData() + start_off;
+    _buf_sz = static_cast<size_t>(end_off - start_off);
+    _len = _buf_sz;
+    _mode = static_cast<StreamMode>(kStream_Read | kStream_Seek);
+    _path = _file->GetPath();
+}
+
+void MappedFileStream::Close()
+{
+    MemoryStream::Close();
+    _file.reset();
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,85 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// MappedFile maps a whole file into the process memory for reading.
+//
+// MappedFileStream is a read-only stream over a section of the mapped file.
+// It shares the ownership over MappedFile, so the mapping stays valid for
+// as long as any stream is using it. Reading from such stream does not
+// involve any file operations, and the stream's data may also be accessed
+// directly, as a contiguous memory range, without copying it anywhere.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__MAPPEDFILESTREAM_H
+#define __AGS_CN_UTIL__MAPPEDFILESTREAM_H
+
+#include <memory>
+#include "core/platform.h"
+#include "util/memorystream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class MappedFile
+{
+public:
+    ~MappedFile();
+
+    // Maps the file into memory; returns null if the file cannot be opened or mapped
+    static std::shared_ptr<MappedFile> Open(const String &filename);
+
+    const String  &GetPath() const { return _path; }
+    const uint8_t *GetData() const { return _data; }
+    size_t         GetSize() const { return _size; }
+
+private:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator =(const MappedFile&) = delete;
+
+    String   _path;
+    const uint8_t *_data = nullptr;
+    size_t   _size = 0u;
+#if AGS_PLATFORM_OS_WINDOWS
+    void    *_hMapping = nullptr; // HANDLE
+#endif
+};
+
+
+class MappedFileStream : public MemoryStream
+{
+public:
+    // Constructs a stream over the [start_off, end_off) range of the mapped file;
+    // the range is clamped to the actual file size
+    MappedFileStream(std::shared_ptr<MappedFile> file, soff_t start_off, soff_t end_off);
+    ~MappedFileStream() override = default;
+
+    // Gets the direct pointer to the stream's data;
+    // the pointer remains valid only until this stream is closed
+    const uint8_t *GetData() const { return _cbuf; }
+    // Gets the size of the stream's data
+    size_t         GetDataSize() const { return _buf_sz; }
+
+    void    Close() override;
+
+private:
+    std::shared_ptr<MappedFile> _file;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__MAPPEDFILESTREAM_H
@@ -44,7 +44,7 @@ namespace MFLUtil
     MFLError ReadV21(AssetLibInfo &lib, Stream *in);
     MFLError ReadV30(AssetLibInfo &lib, Stream *in, MFLVersion lib_version);
 
-    void     WriteV30(const AssetLibInfo &lib, Stream *out);
+    void     WriteV30(const AssetLibInfo &lib, MFLVersion lib_version, Stream *out);
 
     // Encryption / decryption 
     int      GetNextPseudoRand(int &rand_val);
@@ -108,6 +108,13 @@ MFLUtil::MFLError MFLUtil::ReadHeader(AssetLibInfo &lib, Stream *in)
         err = ReadSingleFileLib(lib, in);
     }
 
+    // uncompressed assets have their data size equal to the stored size
+    for (auto &asset : lib.AssetInfos)
+    {
+        if (asset.Compression == kAssetCompress_None)
+            asset.DataSize = asset.Size;
+    }
+
     // apply absolute offset for the assets contained in base data file
     // (since only base data file may be EXE file, other clib parts are always on their own)
     if (abs_offset > 0)
@@ -178,7 +185,7 @@ MFLUtil::MFLError MFLUtil::ReadSigsAndVersion(Stream *in, MFLVersion *p_lib_vers
     if ((lib_version != kMFLVersion_SingleLib) && (lib_version != kMFLVersion_MultiV10) &&
         (lib_version != kMFLVersion_MultiV11) && (lib_version != kMFLVersion_MultiV15) &&
         (lib_version != kMFLVersion_MultiV20) && (lib_version != kMFLVersion_MultiV21) &&
-        lib_version != kMFLVersion_MultiV30)
+        (lib_version != kMFLVersion_MultiV30) && (lib_version != kMFLVersion_MultiV31))
         return kMFLErrLibVersion; // unsupported version
 
     if (p_lib_version)
@@ -349,7 +356,7 @@ MFLUtil::MFLError MFLUtil::ReadV21(AssetLibInfo &lib, Stream *in)
     return kMFLNoError;
 }
 
-MFLUtil::MFLError MFLUtil::ReadV30(AssetLibInfo &lib, Stream *in, MFLVersion /* lib_version */)
+MFLUtil::MFLError MFLUtil::ReadV30(AssetLibInfo &lib, Stream *in, MFLVersion lib_version)
 {
     // NOTE: removed encryption like in v21, because it makes little sense
     // with open-source program. But if really wanted it may be restored
@@ -372,6 +379,15 @@ MFLUtil::MFLError MFLUtil::ReadV30(AssetLibInfo &lib, Stream *in, MFLVersion /*
         asset.LibUid = (uint8_t)in->ReadInt8();
         asset.Offset = in->ReadInt64();
         asset.Size = in->ReadInt64();
+        if (lib_version >= kMFLVersion_MultiV31)
+        {
+            asset.Compression = static_cast<AssetCompression>(in->ReadInt8());
+            asset.DataSize = in->ReadInt64();
+            asset.FrameSize = static_cast<uint32_t>(in->ReadInt32());
+            if ((asset.Compression != kAssetCompress_None) &&
+                (asset.Compression != kAssetCompress_Deflate))
+                return kMFLErrLibVersion; // unknown compression
+        }
     }
     return kMFLNoError;
 }
@@ -385,11 +401,11 @@ void MFLUtil::WriteHeader(const AssetLibInfo &lib, MFLVersion lib_version, int l
     // First datafile in chain: write the table of contents
     if (lib_index == 0)
     {
-        WriteV30(lib, out);
+        WriteV30(lib, lib_version, out);
     }
 }
 
-void MFLUtil::WriteV30(const AssetLibInfo &lib, Stream *out)
+void MFLUtil::WriteV30(const AssetLibInfo &lib, MFLVersion lib_version, Stream *out)
 {
     out->WriteInt32(0); // reserved options
     // filenames for all library parts
@@ -407,6 +423,12 @@ void MFLUtil::WriteV30(const AssetLibInfo &lib, Stream *out)
         out->WriteInt8(static_cast<uint8_t>(asset.LibUid));
         out->WriteInt64(asset.Offset);
         out->WriteInt64(asset.Size);
+        if (lib_version >= kMFLVersion_MultiV31)
+        {
+            out->WriteInt8(static_cast<uint8_t>(asset.Compression));
+            out->WriteInt64(asset.DataSize);
+            out->WriteInt32(static_cast<int32_t>(asset.FrameSize));
+        }
     }
 }
 
@@ -0,0 +1,174 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "util/taskgraph.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include "util/threadpool.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+using namespace std::chrono;
+
+TaskGraph::TaskID TaskGraph::Add(const String &name, TaskFunc func,
+    const std::vector<TaskID> &deps, bool main_thread)
+{
+    const TaskID id = _tasks.size();
+    Task task;
+    task.Func = std::move(func);
+    for (TaskID dep : deps)
+    {
+        if (dep < id)
+        {
+            _tasks[dep].Dependents.push_back(id);
+            task.DepCount++;
+        }
+    }
+    _tasks.push_back(std::move(task));
+    TaskInfo info;
+    info.Name = name;
+    info.MainThread = main_thread;
+    _info.push_back(info);
+    return id;
+}
+
+bool TaskGraph::Run(ThreadPool *pool)
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<TaskID> main_queue; // tasks ready to run on this thread
+    std::vector<size_t> dep_left(_tasks.size());
+    size_t running = 0; // tasks scheduled but not completed yet
+    std::vector<std::future<void>> pool_tasks;
+    bool failed = false;
+    const auto graph_start = steady_clock::now();
+
+    for (size_t i = 0; i < _tasks.size(); ++i)
+    {
+        dep_left[i] = _tasks[i].DepCount;
+        _info[i].Done = false;
+        _info[i].Succeeded = false;
+    }
+
+    std::function<void(TaskID)> run_task;
+    // Decides where to run the ready tasks; must be called with the mutex
+    // unlocked, because the pool may run the task right away
+    auto schedule = [&](const std::vector<TaskID> &ready)
+    {
+        for (TaskID id : ready)
+        {
+            if (pool && !_info[id].MainThread)
+            {
+                auto res = pool->Submit([&run_task, id]() { run_task(id); });
+                std::lock_guard<std::mutex> lk(mutex);
+                pool_tasks.push_back(std::move(res));
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lk(mutex);
+                main_queue.push_back(id);
+            }
+        }
+        cond.notify_all();
+    };
+
+    run_task = [&](TaskID id)
+    {
+        {
+            // Tasks which were already queued when another one failed are skipped
+            std::lock_guard<std::mutex> lk(mutex);
+            if (failed)
+            {
+                running--;
+                cond.notify_all();
+                return;
+            }
+        }
+        const auto start = steady_clock::now();
+        bool ok = false;
+        try { ok = _tasks[id].Func(); }
+        catch (...) { ok = false; }
+        const auto end = steady_clock::now();
+
+        std::vector<TaskID> ready;
+        {
+            std::lock_guard<std::mutex> lk(mutex);
+            auto &info = _info[id];
+            info.Done = true;
+            info.Succeeded = ok;
+            info.StartTime = duration_cast<microseconds>(start - graph_start);
+            info.Duration = duration_cast<microseconds>(end - start);
+            failed |= !ok;
+            if (!failed)
+            {
+                for (TaskID dep : _tasks[id].Dependents)
+                {
+                    if (--dep_left[dep] == 0)
+                        ready.push_back(dep);
+                }
+            }
+            running += ready.size();
+        }
+        schedule(ready);
+        // Only mark this task as finished after its dependents are scheduled,
+        // so that Run() does not exit while anything is still being submitted
+        std::lock_guard<std::mutex> lk(mutex);
+        running--;
+        cond.notify_all();
+    };
+
+    std::vector<TaskID> ready;
+    for (size_t i = 0; i < _tasks.size(); ++i)
+    {
+        if (dep_left[i] == 0)
+            ready.push_back(i);
+    }
+    running = ready.size();
+    schedule(ready);
+
+    // Run main thread tasks as they become ready, until everything is done
+    for (;;)
+    {
+        TaskID id;
+        {
+            std::unique_lock<std::mutex> lk(mutex);
+            cond.wait(lk, [&]() { return !main_queue.empty() || running == 0; });
+            if (main_queue.empty())
+                break;
+            id = main_queue.front();
+            main_queue.pop_front();
+        }
+        run_task(id);
+    }
+    // The pool tasks may still be leaving run_task, make sure that they
+    // are done before the local state gets destroyed
+    for (auto &res : pool_tasks)
+        res.wait();
+
+    _totalTime = duration_cast<microseconds>(steady_clock::now() - graph_start);
+    if (failed)
+        return false;
+    for (const auto &info : _info)
+    {
+        if (!info.Done)
+            return false; // circular dependencies
+    }
+    return true;
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,91 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// TaskGraph runs a set of tasks with dependencies between them.
+//
+// Each task starts as soon as all the tasks it depends on have completed.
+// Tasks may be run either on a ThreadPool's workers, or on the thread which
+// called Run(); the latter is meant for operations which have to be done on
+// the main thread, such as creating a window. If any task fails, no further
+// tasks are started, including the ones already queued on either thread,
+// but Run() still waits for the ones already running.
+//
+// The start time and duration of every task is recorded, and may be
+// retrieved after the graph has finished.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__TASKGRAPH_H
+#define __AGS_CN_UTIL__TASKGRAPH_H
+
+#include <chrono>
+#include <functional>
+#include <vector>
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class ThreadPool;
+
+class TaskGraph
+{
+public:
+    typedef size_t TaskID;
+    // Task function returns whether the task succeeded
+    typedef std::function<bool()> TaskFunc;
+
+    struct TaskInfo
+    {
+        String Name;
+        bool   MainThread = false;
+        bool   Done = false; // the task has been run
+        bool   Succeeded = false;
+        // Start time relative to the graph's start, and duration
+        std::chrono::microseconds StartTime{};
+        std::chrono::microseconds Duration{};
+    };
+
+    // Adds a task to the graph, which depends on the listed tasks;
+    // main_thread tells that the task must be run on the thread calling Run()
+    TaskID Add(const String &name, TaskFunc func,
+        const std::vector<TaskID> &deps = std::vector<TaskID>(), bool main_thread = false);
+    // Runs all the tasks; the tasks not marked as main thread ones are passed
+    // to the pool, or run on the calling thread if pool is null.
+    // Returns when all the started tasks are complete; returns false if any
+    // task has failed or could not be run due to unresolved dependencies.
+    bool Run(ThreadPool *pool);
+
+    const std::vector<TaskInfo> &GetTasks() const { return _info; }
+    // Total time spent in the last Run()
+    std::chrono::microseconds GetTotalTime() const { return _totalTime; }
+
+private:
+    struct Task
+    {
+        TaskFunc Func;
+        std::vector<TaskID> Dependents;
+        size_t DepCount = 0;
+    };
+
+    std::vector<Task> _tasks;
+    std::vector<TaskInfo> _info;
+    std::chrono::microseconds _totalTime{};
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__TASKGRAPH_H
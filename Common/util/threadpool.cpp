@@ -0,0 +1,167 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "util/threadpool.h"
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+namespace AGS
+{
+namespace Common
+{
+
+size_t ThreadPool::GetHardwareThreadCount()
+{
+#if !defined(AGS_DISABLE_THREADS)
+    const size_t hw_threads = std::thread::hardware_concurrency();
+    return hw_threads > 0 ? hw_threads : 1;
+#else
+    return 1;
+#endif
+}
+
+#if !defined(AGS_DISABLE_THREADS)
+
+ThreadPool::ThreadPool(size_t num_threads)
+{
+    _threadCount = num_threads > 0 ? num_threads : GetHardwareThreadCount();
+    _threads.reserve(_threadCount);
+    for (size_t i = 0; i < _threadCount; ++i)
+        _threads.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _stop = true;
+    }
+    _taskCond.notify_all();
+    for (auto &thread : _threads)
+        thread.join();
+}
+
+std::future<void> ThreadPool::Submit(std::function<void()> task)
+{
+    // std::function requires a copyable object, so we wrap packaged_task into shared_ptr
+    auto ptask = std::make_shared<std::packaged_task<void()>>(std::move(task));
+    std::future<void> result = ptask->get_future();
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _tasks.emplace_back([ptask]() { (*ptask)(); });
+    }
+    _taskCond.notify_one();
+    return result;
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lk(_mutex);
+    _doneCond.wait(lk, [this]() { return _tasks.empty() && _activeTasks == 0; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lk(_mutex);
+            _taskCond.wait(lk, [this]() { return _stop || !_tasks.empty(); });
+            if (_tasks.empty())
+                return; // stop requested, and nothing else left to do
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+            _activeTasks++;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            _activeTasks--;
+            if (_tasks.empty() && _activeTasks == 0)
+                _doneCond.notify_all();
+        }
+    }
+}
+
+#else // AGS_DISABLE_THREADS
+
+ThreadPool::ThreadPool(size_t /*num_threads*/)
+{
+    _threadCount = 1;
+}
+
+ThreadPool::~ThreadPool() = default;
+
+std::future<void> ThreadPool::Submit(std::function<void()> task)
+{
+    std::packaged_task<void()> ptask(std::move(task));
+    std::future<void> result = ptask.get_future();
+    ptask();
+    return result;
+}
+
+void ThreadPool::Wait()
+{
+}
+
+#endif // AGS_DISABLE_THREADS
+
+void ThreadPool::ParallelFor(size_t begin, size_t end,
+    const std::function<void(size_t, size_t)> &func, size_t min_chunk)
+{
+    if (begin >= end)
+        return;
+    const size_t count = end - begin;
+    min_chunk = std::max<size_t>(1u, min_chunk);
+    const size_t num_chunks = std::min(_threadCount, (count + min_chunk - 1) / min_chunk);
+    if (num_chunks <= 1)
+    {
+        func(begin, end);
+        return;
+    }
+
+    // Distribute the remainder over the first chunks, one index each
+    const size_t chunk_size = count / num_chunks;
+    const size_t remainder = count % num_chunks;
+    std::vector<std::future<void>> results;
+    results.reserve(num_chunks - 1);
+    size_t chunk_begin = begin;
+    size_t first_chunk_end = 0;
+    for (size_t i = 0; i < num_chunks; ++i)
+    {
+        const size_t chunk_end = chunk_begin + chunk_size + (i < remainder ? 1 : 0);
+        if (i == 0)
+            first_chunk_end = chunk_end; // this one will be run on the calling thread
+        else
+            results.push_back(Submit([&func, chunk_begin, chunk_end]() { func(chunk_begin, chunk_end); }));
+        chunk_begin = chunk_end;
+    }
+    // Other chunks are referencing func, so we must wait for all of them
+    // to complete before leaving, even if anything throws
+    std::exception_ptr error;
+    try { func(begin, first_chunk_end); }
+    catch (...) { error = std::current_exception(); }
+    for (auto &res : results)
+        res.wait();
+    if (error)
+        std::rethrow_exception(error);
+    for (auto &res : results)
+        res.get(); // rethrows, if the task has thrown an exception
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,93 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// ThreadPool runs arbitrary tasks on a fixed set of worker threads.
+//
+// Tasks are scheduled with Submit(), which returns a future that may be used
+// to wait for a particular task's completion. ParallelFor() splits a range
+// of indexes into equal chunks and processes them on the workers, returning
+// only when all of them are done; the split only depends on the range and
+// the number of threads, so the chunk boundaries are always predictable.
+//
+// When the engine is built with AGS_DISABLE_THREADS, the pool does not
+// create any threads, and all the tasks are run right away on the calling
+// thread.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__THREADPOOL_H
+#define __AGS_CN_UTIL__THREADPOOL_H
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <vector>
+#if !defined(AGS_DISABLE_THREADS)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace AGS
+{
+namespace Common
+{
+
+class ThreadPool
+{
+public:
+    // Creates a pool with the given number of worker threads;
+    // 0 means use as many threads as the system reports hardware threads.
+    explicit ThreadPool(size_t num_threads = 0);
+    // Waits for all the scheduled tasks to complete and stops the threads
+    ~ThreadPool();
+
+    // Returns the number of hardware threads, or 1 if it cannot be detected
+    static size_t GetHardwareThreadCount();
+
+    // Tells the number of worker threads in this pool;
+    // always returns at least 1, even if tasks are run on a calling thread
+    size_t GetThreadCount() const { return _threadCount; }
+    // Schedules a task for execution
+    std::future<void> Submit(std::function<void()> task);
+    // Splits the [begin, end) range into consecutive chunks and runs
+    // func(chunk_begin, chunk_end) for each of them on the workers;
+    // blocks until all chunks are processed.
+    // min_chunk tells the minimal number of indexes which worth a separate task.
+    void ParallelFor(size_t begin, size_t end,
+        const std::function<void(size_t, size_t)> &func, size_t min_chunk = 1);
+    // Blocks until all currently scheduled tasks are completed
+    void Wait();
+
+private:
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool &operator =(const ThreadPool&) = delete;
+
+    size_t _threadCount = 1;
+#if !defined(AGS_DISABLE_THREADS)
+    void WorkerLoop();
+
+    std::vector<std::thread> _threads;
+    std::deque<std::function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _taskCond; // signals a new task or a stop request
+    std::condition_variable _doneCond; // signals that all tasks are done
+    size_t _activeTasks = 0; // number of tasks currently being run
+    bool _stop = false;
+#endif
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__THREADPOOL_H
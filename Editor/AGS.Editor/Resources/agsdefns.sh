@@ -471,6 +471,14 @@ enum InputType
 };
 #endif
 
+#ifdef SCRIPT_API_v362
+enum TransformQuality
+{
+  eTransformNearest = 0,
+  eTransformBilinear = 1
+};
+#endif
+
 internalstring autoptr builtin managed struct String {
   /// Creates a formatted string using the supplied parameters.
   import static String Format(const string format, ...);    // $AUTOCOMPLETESTATICONLY$
@@ -1393,9 +1401,17 @@ builtin managed struct DynamicSprite {
   /// Gets a drawing surface that can be used to manually draw onto the sprite.
   import DrawingSurface* GetDrawingSurface();
   /// Resizes the sprite.
-  import void Resize(int width, int height);
+  import void Resize(int width, int height
+#ifdef SCRIPT_API_v362
+	, TransformQuality quality = eTransformNearest
+#endif
+  );
   /// Rotates the sprite by the specified number of degrees.
-  import void Rotate(int angle, int width=SCR_NO_VALUE, int height=SCR_NO_VALUE);
+  import void Rotate(int angle, int width=SCR_NO_VALUE, int height=SCR_NO_VALUE
+#ifdef SCRIPT_API_v362
+	, TransformQuality quality = eTransformNearest
+#endif
+  );
   /// Saves the sprite to a BMP or PCX file.
   import int  SaveToFile(const string filename);
   /// Permanently tints the sprite to the specified colour.
@@ -2307,6 +2323,11 @@ enum EngineValueID {
   ENGINE_VALUE_I_TEXCACHE_NORMAL,
   ENGINE_VALUE_I_FPS_MAX,
   ENGINE_VALUE_I_FPS,
+  ENGINE_VALUE_I_RENDER_SPRITES,
+  ENGINE_VALUE_I_RENDER_DRAWCALLS,
+  ENGINE_VALUE_I_RENDER_PIXELS_REDRAWN,
+  ENGINE_VALUE_I_RENDER_GUI_CONTROLS_REDRAWN,
+  ENGINE_VALUE_I_BITMAP_ALLOCS,
   ENGINE_VALUE_LAST                      // in case user wants to iterate them
 };
 #endif
@@ -1883,7 +1883,8 @@ void SaveTempSpritefile(int store_flags, AGS::Common::SpriteCompression compress
     AGSString n_temp_spritefile = TextHelper::ConvertUTF8(temp_spritefile);
     AGSString n_temp_indexfile = TextHelper::ConvertUTF8(temp_indexfile);
     AGS::Common::SpriteFileIndex index;
-    if (spriteset.SaveToFile(n_temp_spritefile, store_flags, compressSprites, index) != 0)
+    // use all the available cpu threads for compressing sprites
+    if (spriteset.SaveToFile(n_temp_spritefile, store_flags, compressSprites, index, 0) != 0)
         throw gcnew AGSEditorException(String::Format("Unable to save the sprites. An error occurred whilst writing the sprite file.{0}Temp path: {1}",
             Environment::NewLine, temp_spritefile));
     saved_spritefile = n_temp_spritefile;
@@ -39,6 +39,7 @@
 #include "ac/properties.h"
 #include "ac/room.h"
 #include "ac/screenoverlay.h"
+#include "ac/spriteprecache.h"
 #include "ac/string.h"
 #include "ac/system.h"
 #include "ac/view.h"
@@ -1867,6 +1868,13 @@ void fix_player_sprite(MoveList*cmls,CharacterInfo*chinf) {
         return;
 
     const int useloop = GetDirectionalLoop(chinf, xpmove, ypmove);
+    // only request the loop's sprites when walking in a new loop
+    CharacterExtras &chex = charextra[chinf->index_id];
+    if ((chex.precache_view != chinf->view) || (chex.precache_loop != useloop)) {
+        chex.precache_view = chinf->view;
+        chex.precache_loop = useloop;
+        precache_anim_loop(chinf->view, useloop);
+    }
 
     if ((game.options[OPT_ROTATECHARS] == 0) || ((chinf->flags & CHF_NOTURNING) != 0)) {
         chinf->loop = useloop;
@@ -2205,6 +2213,7 @@ void animate_character(CharacterInfo *chap, int loopn, int sppd, int rept,
         chap->scrname, chap->view+1, loopn, sppd, rept, sframe);
 
     Character_StopMoving(chap);
+    precache_anim_loop(chap->view, loopn);
 
     chap->set_animating(rept != 0, direction == 0, sppd);
     chap->loop=loopn;
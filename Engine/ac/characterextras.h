@@ -62,6 +62,9 @@ struct CharacterExtras
     //
     // zoom factor of sprite offsets, fixed at 100 in backwards compatible mode
     int   zoom_offs = 100;
+    // last walking view and loop which sprites were precached
+    int   precache_view = -1;
+    int   precache_loop = -1;
 
     int GetEffectiveY(CharacterInfo *chi) const; // return Y - Z
 
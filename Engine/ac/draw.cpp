@@ -43,12 +43,14 @@
 #include "ac/sprite.h"
 #include "ac/string.h"
 #include "ac/system.h"
+#include "ac/timer.h"
 #include "ac/viewframe.h"
 #include "ac/walkablearea.h"
 #include "ac/walkbehind.h"
 #include "ac/dynobj/scriptsystem.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/frameprofiler.h"
 #include "font/fonts.h"
 #include "gui/guimain.h"
 #include "gui/guiobject.h"
@@ -59,9 +61,12 @@
 #include "gfx/gfx_util.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/ali3dexception.h"
+#include "gfx/bitmappool.h"
 #include "gfx/blender.h"
+#include "gfx/blitkernels.h"
 #include "main/game_run.h"
 #include "media/audio/audio_system.h"
+#include "util/threadpool.h"
 #include "util/wgt2allg.h"
 
 using namespace AGS::Common;
@@ -100,6 +105,8 @@ struct DrawState
     WalkBehindMethodEnum WalkBehindMethod = DrawAsSeparateSprite;
     // Whether there are currently remnants of a on-screen effect
     bool ScreenIsDirty = false;
+    // Number of GUI controls redrawn during the last frame
+    size_t GuiControlsRedrawn = 0u;
 
     // A map of shared "control blocks" per each sprite used
     // when preparing object textures. "Control block" is currently just
@@ -186,7 +193,8 @@ struct ObjTexture
 // if active sprite / texture should be reconstructed
 struct ObjectCache
 {
-    std::unique_ptr<Bitmap> image;
+    // Transformed sprite image, may be shared with other objects
+    std::shared_ptr<Bitmap> image;
     bool  in_use = false; // CHECKME: possibly may be removed
     int   sppic = 0;
     // TODO: pickout tint settings, maybe even share with Char/Obj structs,
@@ -349,6 +357,136 @@ private:
     std::unordered_map<uint32_t, TexDataRef> _txRefs;
 } texturecache(spriteset);
 
+// SpriteTransformKey describes a sprite image transformed for the software
+// rendering: scaled, flipped, tinted or lit.
+struct SpriteTransformKey
+{
+    uint32_t SpriteID = UINT32_MAX;
+    int   Width = 0, Height = 0;
+    bool  Mirrored = false;
+    bool  Antialias = false;
+    int   TintAmount = 0, TintR = 0, TintG = 0, TintB = 0, TintLight = 0;
+    int   LightLevel = 0;
+
+    bool operator ==(const SpriteTransformKey &other) const
+    {
+        return (SpriteID == other.SpriteID) && (Width == other.Width) && (Height == other.Height) &&
+            (Mirrored == other.Mirrored) && (Antialias == other.Antialias) &&
+            (TintAmount == other.TintAmount) && (TintR == other.TintR) && (TintG == other.TintG) &&
+            (TintB == other.TintB) && (TintLight == other.TintLight) && (LightLevel == other.LightLevel);
+    }
+};
+
+struct SpriteTransformKeyHash
+{
+    size_t operator()(const SpriteTransformKey &key) const
+    {
+        size_t hash = std::hash<uint32_t>()(key.SpriteID);
+        const int values[] = { key.Width, key.Height, (key.Mirrored ? 1 : 0) | (key.Antialias ? 2 : 0),
+            key.TintAmount, key.TintR, key.TintG, key.TintB, key.TintLight, key.LightLevel };
+        for (int v : values)
+            hash ^= std::hash<int>()(v) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        return hash;
+    }
+};
+
+//
+// TransformedSpriteCache stores the sprite images transformed by the software
+// renderer, so that the objects which display same sprite with the same
+// scaling and tint could share a single image instead of redoing the
+// transformation each. Similar to the TextureCache, it consists of:
+// * a long-term MRU cache, limited by the configured memory budget;
+// * a short-term cache of weak references to the images currently used by
+//   the objects on screen (objects keep strong references in ObjectCache).
+// The cached images are immutable; users must copy them if they need to draw.
+class TransformedSpriteCache :
+    public ResourceCache<SpriteTransformKey, std::shared_ptr<Bitmap>, size_t, SpriteTransformKeyHash>
+{
+public:
+    // Gets existing image from either MRU cache, or short-term cache
+    std::shared_ptr<Bitmap> Get(const SpriteTransformKey &key)
+    {
+        auto bmp = ResourceCache::Get(key);
+        if (bmp)
+            return bmp;
+        const auto found = _refs.find(key);
+        if (found != _refs.end())
+        {
+            bmp = found->second.lock();
+            if (bmp)
+            {
+                Put(key, bmp);
+                return bmp;
+            }
+            _refs.erase(found);
+        }
+        return nullptr;
+    }
+
+    // Adds a new transformed image
+    void Add(const SpriteTransformKey &key, const std::shared_ptr<Bitmap> &bmp)
+    {
+        if (_refs.size() >= _pruneRefsAt)
+            PruneRefs();
+        _refs[key] = bmp;
+        Put(key, bmp);
+    }
+
+    // Disposes all the images made of the given sprite
+    void DisposeSprite(uint32_t sprite_id)
+    {
+        for (auto it = _refs.begin(); it != _refs.end();)
+        {
+            if (it->first.SpriteID == sprite_id)
+            {
+                ResourceCache::Dispose(it->first);
+                it = _refs.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void Clear()
+    {
+        ResourceCache::Clear();
+        _refs.clear();
+        _pruneRefsAt = MinPruneRefs;
+    }
+
+private:
+    size_t CalcSize(const std::shared_ptr<Bitmap> &item) override
+    {
+        assert(item);
+        return item ? item->GetDataSize() : 0u;
+    }
+
+    // Removes references to the images which are no longer used by anyone
+    void PruneRefs()
+    {
+        for (auto it = _refs.begin(); it != _refs.end();)
+        {
+            if (it->second.expired())
+                it = _refs.erase(it);
+            else
+                ++it;
+        }
+        _pruneRefsAt = std::max(MinPruneRefs, _refs.size() * 2);
+    }
+
+    static const size_t MinPruneRefs = 256;
+    // Image short-term cache, keeps images while they are in the immediate use;
+    // also lets find all the images of a particular sprite
+    std::unordered_map<SpriteTransformKey, std::weak_ptr<Bitmap>, SpriteTransformKeyHash> _refs;
+    size_t _pruneRefsAt = MinPruneRefs;
+} transformcache;
+
+// Pool of the pixel memory for the temporary bitmaps, which are often
+// recreated with the different sizes, e.g. transformed character sprites
+BitmapPool bitmappool;
+
 // actsps is used for temporary storage of the bitmap and texture
 // of the latest version of the sprite (room objects and characters);
 // objects sprites begin with index 0, characters are after ACTSP_OBJSOFF
@@ -363,6 +501,29 @@ std::vector<IDriverDependantBitmap*> gui_render_tex;
 std::vector<ObjTexture> guiobjbg;
 // first control texture index of each GUI
 std::vector<int> guiobjddbref;
+// Last drawn state of a GUI control, used to find which parts of the GUI
+// surface have to be redrawn when only some of its controls have changed
+struct GUIControlDrawState
+{
+    bool Drawn = false;
+    int  X = 0, Y = 0, Width = 0, Height = 0;
+    int  Transparency = 0;
+    int  ZOrder = -1;
+    Rect Area; // graphic rect, in GUI's coordinates
+
+    bool IsSameLayout(const GUIControlDrawState &other) const
+    {
+        return Drawn == other.Drawn && X == other.X && Y == other.Y &&
+            Width == other.Width && Height == other.Height &&
+            Transparency == other.Transparency && ZOrder == other.ZOrder;
+    }
+};
+// control states, indexed same as the control textures
+std::vector<GUIControlDrawState> guiobjstate;
+// tells which GUI render targets have to be composed again
+std::vector<bool> gui_render_dirty;
+// render targets generation, for which the GUI render targets were composed
+uint32_t gui_render_generation = 0u;
 // Overlays textures
 std::vector<ObjTexture> overtxs;
 // For debugging room masks
@@ -421,6 +582,128 @@ std::vector<SpriteListEntry> thingsToDrawList;
 // sprlist - will be sorted using baseline and appended to main list
 std::vector<SpriteListEntry> sprlist;
 
+// Types of the room sprites, in the order in which they are drawn if
+// their baselines are equal
+enum RoomSpriteType
+{
+    kRoomSprite_Object,
+    kRoomSprite_Character,
+    kRoomSprite_Overlay,
+    kRoomSprite_WalkBehind
+};
+
+// RoomSpriteList is a list of room sprites sorted in the baseline order,
+// which is kept between the frames. Each sprite is identified by a stable
+// key, made of its type and index, which also resolves the equal baselines.
+// As the sprites rarely change their order, the list is mostly repaired
+// by an insertion sort, instead of being sorted from scratch every frame.
+class RoomSpriteList
+{
+public:
+    // Starts a new pass of adding sprites
+    void Begin()
+    {
+        _stamp++;
+    }
+
+    // Adds or updates the sprite with the given key
+    void Add(RoomSpriteType type, int index, const SpriteListEntry &entry)
+    {
+        const uint64_t key = (static_cast<uint64_t>(type) << 32) | static_cast<uint32_t>(index);
+        uint32_t slot;
+        auto it = _slotByKey.find(key);
+        if (it != _slotByKey.end())
+        {
+            slot = it->second;
+        }
+        else
+        {
+            if (_freeSlots.empty())
+            {
+                slot = static_cast<uint32_t>(_items.size());
+                _items.emplace_back();
+            }
+            else
+            {
+                slot = _freeSlots.back();
+                _freeSlots.pop_back();
+            }
+            _slotByKey.insert(std::make_pair(key, slot));
+            _order.push_back(slot);
+        }
+        Item &item = _items[slot];
+        item.Key = key;
+        item.Entry = entry;
+        item.Stamp = _stamp;
+    }
+
+    // Removes the sprites which were not added during the last pass,
+    // restores the sorting order, and appends the result to the draw list
+    void Finish(std::vector<SpriteListEntry> &draw_list)
+    {
+        for (uint32_t slot : _order)
+        {
+            if (_items[slot].Stamp != _stamp)
+            {
+                _slotByKey.erase(_items[slot].Key);
+                _freeSlots.push_back(slot);
+            }
+        }
+        _order.erase(std::remove_if(_order.begin(), _order.end(),
+            [this](uint32_t slot) { return _items[slot].Stamp != _stamp; }), _order.end());
+
+        Sort();
+        for (uint32_t slot : _order)
+            draw_list.push_back(_items[slot].Entry);
+    }
+
+    void Clear()
+    {
+        _items.clear();
+        _freeSlots.clear();
+        _slotByKey.clear();
+        _order.clear();
+    }
+
+private:
+    struct Item
+    {
+        uint64_t Key = 0u;
+        SpriteListEntry Entry;
+        uint32_t Stamp = 0u; // pass during which the sprite was last added
+    };
+
+    bool Less(uint32_t slot1, uint32_t slot2) const;
+
+    // Insertion sort is linear on the nearly sorted list; if there turn out
+    // to be too many changes, e.g. after the room change, then fallback to
+    // a regular sort
+    void Sort()
+    {
+        size_t shifts_left = _order.size() * 4 + 64;
+        for (size_t i = 1; i < _order.size(); ++i)
+        {
+            const uint32_t slot = _order[i];
+            size_t j = i;
+            for (; (j > 0) && Less(slot, _order[j - 1]) && (shifts_left > 0); --j, --shifts_left)
+                _order[j] = _order[j - 1];
+            _order[j] = slot;
+            if (shifts_left == 0)
+            {
+                std::sort(_order.begin(), _order.end(),
+                    [this](uint32_t slot1, uint32_t slot2) { return Less(slot1, slot2); });
+                return;
+            }
+        }
+    }
+
+    std::vector<Item> _items; // sprites, indexed by the slot
+    std::vector<uint32_t> _freeSlots;
+    std::unordered_map<uint64_t, uint32_t> _slotByKey;
+    std::vector<uint32_t> _order; // slots, in the drawing order
+    uint32_t _stamp = 0u;
+} roomsprlist;
+
 // For raw drawing
 std::unique_ptr<Bitmap> raw_saved_screen;
 std::unique_ptr<Bitmap> dynamicallyCreatedSurfaces[MAX_DYNAMIC_SURFACES];
@@ -433,24 +716,7 @@ void setpal() {
 // PSP: convert 32 bit RGB to BGR.
 Bitmap *convert_32_to_32bgr(Bitmap *tempbl) {
 
-    int i = 0;
-    int j = 0;
-    unsigned char* current;
-    while (i < tempbl->GetHeight())
-    {
-        current = tempbl->GetScanLineForWriting(i);
-        while (j < tempbl->GetWidth())
-        {
-            current[0] ^= current[2];
-            current[2] ^= current[0];
-            current[0] ^= current[2];
-            current += 4;
-            j++;
-        }
-        i++;
-        j = 0;
-    }
-
+    BlitKernels::SwapRedBlue(tempbl);
     return tempbl;
 }
 
@@ -734,6 +1000,8 @@ void init_draw_method()
     if (drawstate.SoftwareRender)
     {
         drawstate.WalkBehindMethod = DrawOverCharSprite;
+        transformcache.SetMaxCacheSize(usetup.TransformCacheSize * 1024);
+        Debug::Printf("Transformed sprite cache set: %zu KB", usetup.TransformCacheSize);
     }
     else
     {
@@ -760,6 +1028,8 @@ void dispose_draw_method()
     dispose_room_drawdata();
     dispose_invalid_regions(false);
     destroy_blank_image();
+    transformcache.Clear();
+    bitmappool.Clear();
 }
 
 void init_game_drawdata()
@@ -783,6 +1053,8 @@ void init_game_drawdata()
         guio_num += gui.GetControlCount();
     }
     guiobjbg.resize(guio_num);
+    guiobjstate.resize(guio_num);
+    gui_render_dirty.resize(game.numgui, true);
 }
 
 extern void dispose_engine_overlay();
@@ -801,10 +1073,13 @@ void dispose_game_drawdata()
     walkbehindobj.clear();
 
     texturecache_clear();
+    transformcache.Clear();
     guibg.clear();
     gui_render_tex.clear();
     guiobjbg.clear();
     guiobjddbref.clear();
+    guiobjstate.clear();
+    gui_render_dirty.clear();
 
     dispose_engine_overlay();
 }
@@ -818,6 +1093,7 @@ static void dispose_debug_room_drawdata()
 void dispose_room_drawdata()
 {
     CameraDrawData.clear();
+    roomsprlist.Clear();
     dispose_invalid_regions(true);
 }
 
@@ -848,6 +1124,8 @@ void clear_drawobj_cache()
         tex = nullptr;
     }
     for (auto &o : guiobjbg) o = ObjTexture();
+    for (auto &st : guiobjstate) st = GUIControlDrawState();
+    gui_render_dirty.assign(gui_render_dirty.size(), true);
     overtxs.clear();
 
     // Clear sprite update notification blocks
@@ -1064,6 +1342,8 @@ void notify_sprite_changed(int sprnum, bool deleted)
         clear_shared_texture(sprnum);
     else
         update_shared_texture(sprnum);
+    // Transformed images will be recreated on demand
+    transformcache.DisposeSprite(sprnum);
 
     // For texture-based renderers updating a shared texture will already
     // update all the related drawn objects on screen; software renderer
@@ -1230,6 +1510,7 @@ void render_to_screen()
             System_SetVSyncInternal(new_vsync);
     }
 
+    AGS_PROFILE_SCOPE(kFramePhase_DriverRender);
     bool succeeded = false;
     while (!succeeded && !want_exit && !abort_engine)
     {
@@ -1426,14 +1707,15 @@ static void clear_sprite_list()
     sprlist.clear();
 }
 
-static void add_to_sprite_list(IDriverDependantBitmap* ddb, int x, int y, int zorder, bool isWalkBehind, int id = -1)
+// Fills the sprite list entry; returns false if the sprite should not be drawn
+static bool make_sprite_list_entry(SpriteListEntry &sprite, IDriverDependantBitmap* ddb,
+    int x, int y, int zorder, bool isWalkBehind, int id)
 {
     assert(ddb);
     // completely invisible, so don't draw it at all
     if (ddb->GetAlpha() == 0)
-        return;
+        return false;
 
-    SpriteListEntry sprite;
     sprite.id = id;
     sprite.ddb = ddb;
     sprite.zorder = zorder;
@@ -1444,8 +1726,22 @@ static void add_to_sprite_list(IDriverDependantBitmap* ddb, int x, int y, int zo
         sprite.takesPriorityIfEqual = !isWalkBehind;
     else
         sprite.takesPriorityIfEqual = isWalkBehind;
+    return true;
+}
 
-    sprlist.push_back(sprite);
+static void add_to_sprite_list(IDriverDependantBitmap* ddb, int x, int y, int zorder, int id = -1)
+{
+    SpriteListEntry sprite;
+    if (make_sprite_list_entry(sprite, ddb, x, y, zorder, false, id))
+        sprlist.push_back(sprite);
+}
+
+static void add_to_room_sprite_list(RoomSpriteType type, int index,
+    IDriverDependantBitmap* ddb, int x, int y, int zorder, int id = -1)
+{
+    SpriteListEntry sprite;
+    if (make_sprite_list_entry(sprite, ddb, x, y, zorder, type == kRoomSprite_WalkBehind, id))
+        roomsprlist.Add(type, index, sprite);
 }
 
 // Sprite drawing order sorting function,
@@ -1470,13 +1766,30 @@ static bool spritelistentry_room_less(const SpriteListEntry &e1, const SpriteLis
     return e1.zorder < e2.zorder;
 }
 
+bool RoomSpriteList::Less(uint32_t slot1, uint32_t slot2) const
+{
+    const Item &item1 = _items[slot1];
+    const Item &item2 = _items[slot2];
+    if (spritelistentry_room_less(item1.Entry, item2.Entry))
+        return true;
+    if (spritelistentry_room_less(item2.Entry, item1.Entry))
+        return false;
+    return item1.Key < item2.Key;
+}
+
 // copy the sorted sprites into the Things To Draw list
-static void draw_sprite_list(bool is_room)
+static void draw_sprite_list()
 {
-    std::sort(sprlist.begin(), sprlist.end(), is_room ? spritelistentry_room_less : spritelistentry_less);
+    std::sort(sprlist.begin(), sprlist.end(), spritelistentry_less);
     thingsToDrawList.insert(thingsToDrawList.end(), sprlist.begin(), sprlist.end());
 }
 
+// copy the sorted room sprites into the Things To Draw list
+static void draw_room_sprite_list()
+{
+    roomsprlist.Finish(thingsToDrawList);
+}
+
 // Push the gathered list of sprites into the active graphic renderer
 void put_sprite_list_on_screen(bool in_room);
 //
@@ -1557,11 +1870,9 @@ Bitmap *recycle_bitmap(Bitmap *bimp, int coldep, int wid, int hit, bool make_tra
             return bimp;
         }
 
-        delete bimp;
+        release_pooled_bitmap(bimp);
     }
-    bimp = make_transparent ? BitmapHelper::CreateTransparentBitmap(wid, hit,coldep) :
-        BitmapHelper::CreateBitmap(wid, hit,coldep);
-    return bimp;
+    return create_pooled_bitmap(coldep, wid, hit, make_transparent);
 }
 
 void recycle_bitmap(std::unique_ptr<Common::Bitmap> &bimp, int coldep, int wid, int hit, bool make_transparent)
@@ -1569,6 +1880,34 @@ void recycle_bitmap(std::unique_ptr<Common::Bitmap> &bimp, int coldep, int wid,
     bimp.reset(recycle_bitmap(bimp.release(), coldep, wid, hit, make_transparent));
 }
 
+Bitmap *create_pooled_bitmap(int coldep, int wid, int hit, bool make_transparent)
+{
+    Bitmap *bmp = bitmappool.GetBitmap(wid, hit, coldep).release();
+    if (bmp && make_transparent)
+        bmp->ClearTransparent();
+    return bmp;
+}
+
+void release_pooled_bitmap(Bitmap *bmp)
+{
+    bitmappool.Release(std::unique_ptr<Bitmap>(bmp));
+}
+
+void release_pooled_bitmap(std::unique_ptr<Bitmap> bmp)
+{
+    bitmappool.Release(std::move(bmp));
+}
+
+void update_bitmap_pool()
+{
+    bitmappool.NextFrame();
+}
+
+size_t get_bitmap_pool_allocations()
+{
+    return bitmappool.GetLastFrameStats().Allocations;
+}
+
 // Get the local tint at the specified X & Y co-ordinates, based on
 // room regions and SetAmbientTint
 // tint_amnt will be set to 0 if there is no tint enabled
@@ -1683,7 +2022,7 @@ static void apply_tint_or_light(ObjTexture &actsp, int light_level,
      // otherwise, make a new target bmp
      else {
          oldwas = std::move(actsp.Bmp);
-         actsp.Bmp.reset(BitmapHelper::CreateBitmap(oldwas->GetWidth(), oldwas->GetHeight(), coldept));
+         actsp.Bmp.reset(create_pooled_bitmap(coldept, oldwas->GetWidth(), oldwas->GetHeight()));
      }
      Bitmap *active_spr = actsp.Bmp.get();
 
@@ -1697,7 +2036,6 @@ static void apply_tint_or_light(ObjTexture &actsp, int light_level,
          // to LitBlendBlt defines how much it will be darkened/lightened by.
          
          int lit_amnt;
-         active_spr->FillTransparent();
          // It's a light level, not a tint
          if (game.color_depth == 1) {
              // 256-col
@@ -1712,11 +2050,22 @@ static void apply_tint_or_light(ObjTexture &actsp, int light_level,
              lit_amnt = abs(light_level) * 2;
          }
 
-         active_spr->LitBlendBlt(oldwas.get(), 0, 0, lit_amnt);
+         if ((coldept == 32) && (oldwas->GetColorDepth() == 32) &&
+             (active_spr->GetSize() == oldwas->GetSize())) {
+             // same as the lit blend with the above blender
+             const int lit_col = (light_level < 0) ? 8 : 248;
+             BlitKernels::Light(active_spr, oldwas.get(), makecol32(lit_col, lit_col, lit_col), lit_amnt);
+         }
+         else {
+             active_spr->FillTransparent();
+             active_spr->LitBlendBlt(oldwas.get(), 0, 0, lit_amnt);
+         }
      }
 
      if (oldwas.get() == blitFrom)
          oldwas.release();
+     else
+         release_pooled_bitmap(std::move(oldwas));
 
  }
  else if (blitFrom) {
@@ -1752,13 +2101,13 @@ static Bitmap *transform_sprite(Bitmap *src, bool src_has_alpha, std::unique_ptr
 
         if (flip != kFlip_None)
         {
-            Bitmap tempbmp;
-            tempbmp.CreateTransparent(dst_sz.Width, dst_sz.Height, src->GetColorDepth());
+            Bitmap *tempbmp = create_pooled_bitmap(src->GetColorDepth(), dst_sz.Width, dst_sz.Height, true);
             if ((IS_ANTIALIAS_SPRITES) && !src_has_alpha)
-                tempbmp.AAStretchBlt(src, RectWH(dst_sz), kBitmap_Transparency);
+                tempbmp->AAStretchBlt(src, RectWH(dst_sz), kBitmap_Transparency);
             else
-                tempbmp.StretchBlt(src, RectWH(dst_sz), kBitmap_Transparency);
-            dst->FlipBlt(&tempbmp, 0, 0, kFlip_Horizontal);
+                tempbmp->StretchBlt(src, RectWH(dst_sz), kBitmap_Transparency);
+            dst->FlipBlt(tempbmp, 0, 0, kFlip_Horizontal);
+            release_pooled_bitmap(tempbmp);
         }
         else
         {
@@ -1792,6 +2141,24 @@ static bool scale_and_flip_sprite(ObjTexture &actsp, int sppic, int width, int h
     return result != src;
 }
 
+// Records the parameters of a newly prepared object image in ObjectCache 'objsav'
+static void set_cached_object_params(ObjectCache &objsav, const ObjectCache &objsrc, int specialpic,
+    int tint_level, int tint_red, int tint_green, int tint_blue, int tint_light, int light_level, bool is_mirrored)
+{
+    objsav.in_use = true;
+    objsav.sppic = specialpic;
+    objsav.tintamnt = tint_level;
+    objsav.tintr = tint_red;
+    objsav.tintg = tint_green;
+    objsav.tintb = tint_blue;
+    objsav.tintlight = tint_light;
+    objsav.lightlev = light_level;
+    objsav.zoom = objsrc.zoom;
+    objsav.mirrored = is_mirrored;
+    objsav.x = objsrc.x;
+    objsav.y = objsrc.y;
+}
+
 // Prepares the ObjTexture 'actsp' for an arbitrary room entity.
 // Records visual parameters in ObjectCache 'objsav'.
 // Returns true if actsp's raw image was not changed and actsps is still
@@ -1911,9 +2278,36 @@ static bool construct_object_gfx(const ViewFrame *vf, int pic,
         return false; // image was modified
     }
 
-    // Not cached, so draw the image
+    // See if any other object has the same transformed image already;
+    // 8-bit images are not shared, as their look depends on the palette
     Bitmap *sprite = spriteset[pic];
     const int coldept = sprite->GetColorDepth();
+    SpriteTransformKey tf_key;
+    if (coldept > 8)
+    {
+        tf_key.SpriteID = pic;
+        tf_key.Width = scale_size.Width;
+        tf_key.Height = scale_size.Height;
+        tf_key.Mirrored = is_mirrored;
+        tf_key.Antialias = IS_ANTIALIAS_SPRITES;
+        tf_key.TintAmount = tint_level;
+        tf_key.TintR = tint_red;
+        tf_key.TintG = tint_green;
+        tf_key.TintB = tint_blue;
+        tf_key.TintLight = tint_light;
+        tf_key.LightLevel = light_level;
+        if (auto shared_image = transformcache.Get(tf_key))
+        {
+            recycle_bitmap(actsp.Bmp, shared_image->GetColorDepth(), shared_image->GetWidth(), shared_image->GetHeight());
+            actsp.Bmp->Blit(shared_image.get(), 0, 0);
+            objsav.image = shared_image;
+            set_cached_object_params(objsav, objsrc, specialpic, tint_level, tint_red, tint_green, tint_blue,
+                tint_light, light_level, is_mirrored);
+            return false; // image was modified
+        }
+    }
+
+    // Not cached, so draw the image
     const int src_sprwidth = sprite->GetWidth();
     const int src_sprheight = sprite->GetHeight();
     bool actsps_used = false;
@@ -1943,21 +2337,13 @@ static bool construct_object_gfx(const ViewFrame *vf, int pic,
         actsp.Bmp->Blit(sprite, 0, 0);
     }
 
-    // Create the cached image and store it
-    objsav.in_use = true;
-    recycle_bitmap(objsav.image, actsp.Bmp->GetColorDepth(), actsp.Bmp->GetWidth(), actsp.Bmp->GetHeight());
-    objsav.image->Blit(actsp.Bmp.get(), 0, 0);
-    objsav.sppic = specialpic;
-    objsav.tintamnt = tint_level;
-    objsav.tintr = tint_red;
-    objsav.tintg = tint_green;
-    objsav.tintb = tint_blue;
-    objsav.tintlight = tint_light;
-    objsav.lightlev = light_level;
-    objsav.zoom = objsrc.zoom;
-    objsav.mirrored = is_mirrored;
-    objsav.x = objsrc.x;
-    objsav.y = objsrc.y;
+    // Create the cached image and store it; a new image is made each time,
+    // because the previous one may be shared with other objects
+    objsav.image.reset(BitmapHelper::CreateBitmapCopy(actsp.Bmp.get()));
+    if (tf_key.SpriteID != UINT32_MAX)
+        transformcache.Add(tf_key, objsav.image);
+    set_cached_object_params(objsav, objsrc, specialpic, tint_level, tint_red, tint_green, tint_blue,
+        tint_light, light_level, is_mirrored);
     return false; // image was modified
 }
 
@@ -2082,7 +2468,7 @@ void prepare_objects_for_drawing()
             Size(obj.last_width, obj.last_height), atx, aty, usebasel,
             (obj.flags & OBJF_NOWALKBEHINDS) == 0, obj.transparent, hw_accel);
         // Finally, add the texture to the draw list
-        add_to_sprite_list(actsp.Ddb, atx, aty, usebasel, false);
+        add_to_room_sprite_list(kRoomSprite_Object, objid, actsp.Ddb, atx, aty, usebasel);
     }
 }
 
@@ -2090,7 +2476,8 @@ void prepare_objects_for_drawing()
 
 // Draws srcimg onto destimg, tinting to the specified level
 // Totally overwrites the contents of the destination image
-void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int light_level, int luminance) {
+void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int light_level, int luminance,
+                 ThreadPool *pool) {
 
     if ((srcimg->GetColorDepth() != ds->GetColorDepth()) ||
         (srcimg->GetColorDepth() <= 8)) {
@@ -2100,6 +2487,37 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
             return;
     }
 
+    if ((srcimg->GetColorDepth() == 32) && (ds->GetSize() == srcimg->GetSize())) {
+        // In 32-bit mode the tint blender's result is precalculated for
+        // every possible pixel "value", and applied by the faster kernels
+        uint32_t tint_table[256];
+        make_tint_table32(tint_table, red, grn, blu, luminance);
+        if (!pool)
+        {
+            if (light_level >= 100)
+                BlitKernels::ValueMap(ds, srcimg, tint_table);
+            else
+                BlitKernels::ValueMapBlend(ds, srcimg, tint_table, (light_level * 25) / 10);
+            return;
+        }
+
+        const int width = ds->GetWidth();
+        const int amount = (light_level * 25) / 10;
+        pool->ParallelFor(0, ds->GetHeight(), [&](size_t y1, size_t y2)
+        {
+            for (size_t y = y1; y < y2; ++y)
+            {
+                uint32_t *dst_row = reinterpret_cast<uint32_t*>(ds->GetScanLineForWriting(y));
+                const uint32_t *src_row = reinterpret_cast<const uint32_t*>(srcimg->GetScanLine(y));
+                if (light_level >= 100)
+                    BlitKernels::ValueMapRow(dst_row, src_row, width, tint_table);
+                else
+                    BlitKernels::ValueMapBlendRow(dst_row, src_row, width, tint_table, amount);
+            }
+        }, 16 /* min rows per task */);
+        return;
+    }
+
     // For performance reasons, we have a seperate blender for
     // when light is being adjusted and when it is not.
     // If luminance >= 250, then normal brightness, otherwise darken
@@ -2122,13 +2540,13 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
         ds->Blit(srcimg, 0, 0, 0, 0, srcimg->GetWidth(), srcimg->GetHeight());
         // Render the colourised image to a temporary bitmap,
         // then transparently draw it over the original image
-        Bitmap *finaltarget = BitmapHelper::CreateTransparentBitmap(srcimg->GetWidth(), srcimg->GetHeight(), srcimg->GetColorDepth());
+        Bitmap *finaltarget = create_pooled_bitmap(srcimg->GetColorDepth(), srcimg->GetWidth(), srcimg->GetHeight(), true);
         finaltarget->LitBlendBlt(srcimg, 0, 0, luminance);
 
         // customized trans blender to preserve alpha channel
         set_my_trans_blender (0, 0, 0, light_level);
         ds->TransBlendBlt (finaltarget, 0, 0);
-        delete finaltarget;
+        release_pooled_bitmap(finaltarget);
     }
 }
 
@@ -2192,7 +2610,7 @@ void prepare_characters_for_drawing()
             Size(chex.width, chex.height), atx, aty, usebasel,
             (chin.flags & CHF_NOWALKBEHINDS) == 0, chin.transparency, hw_accel);
         // Finally, add the texture to the draw list
-        add_to_sprite_list(actsp.Ddb, atx, aty, usebasel, false);
+        add_to_room_sprite_list(kRoomSprite_Character, charid, actsp.Ddb, atx, aty, usebasel);
     }
 }
 
@@ -2226,7 +2644,8 @@ static void add_roomovers_for_drawing()
         if (!over.IsRoomLayer()) continue; // not a room layer
         if (over.transparency == 255) continue; // skip fully transparent
         Point pos = get_overlay_position(over);
-        add_to_sprite_list(overtxs[over.type].Ddb, pos.X, pos.Y, over.zorder, false, over.creation_id);
+        add_to_room_sprite_list(kRoomSprite_Overlay, over.creation_id,
+            overtxs[over.type].Ddb, pos.X, pos.Y, over.zorder, over.creation_id);
     }
 }
 
@@ -2254,7 +2673,7 @@ void prepare_room_sprites()
     }
     current_background_is_dirty = false; // Note this is only place where this flag is checked
 
-    clear_sprite_list();
+    roomsprlist.Begin();
 
     if ((debug_flags & DBG_NOOBJECTS) == 0)
     {
@@ -2274,8 +2693,8 @@ void prepare_room_sprites()
                     const auto &wbobj = walkbehindobj[wb];
                     if (wbobj.Ddb)
                     {
-                        add_to_sprite_list(wbobj.Ddb, wbobj.Pos.X, wbobj.Pos.Y,
-                            croom->walkbehind_base[wb], true);
+                        add_to_room_sprite_list(kRoomSprite_WalkBehind, static_cast<int>(wb),
+                            wbobj.Ddb, wbobj.Pos.X, wbobj.Pos.Y, croom->walkbehind_base[wb]);
                     }
                 }
             }
@@ -2283,7 +2702,7 @@ void prepare_room_sprites()
             if (pl_any_want_hook(AGSE_PRESCREENDRAW))
                 add_render_stage(AGSE_PRESCREENDRAW);
 
-            draw_sprite_list(true);
+            draw_room_sprite_list();
         }
     }
     set_our_eip(36);
@@ -2368,10 +2787,15 @@ void dispose_engine_overlay()
 void draw_fps(const Rect &viewport)
 {
     const int font = FONT_NORMAL;
+    // Frame pacing is displayed on the second line, if there's any
+    const FramePacingStats pacing = getFramePacingStats(false);
+    const int line_count = (pacing.Frames > 0u) ? 2 : 1;
+    const int line_height = get_font_linespacing(font);
+    const int height = get_font_surface_height(font) + line_height * (line_count - 1) + get_fixed_pixel_size(5);
     auto &fpsDisplay = gl_DrawFPS.bmp;
-    if (fpsDisplay == nullptr || gl_DrawFPS.font != font)
+    if (fpsDisplay == nullptr || gl_DrawFPS.font != font || fpsDisplay->GetHeight() != height)
     {
-        recycle_bitmap(fpsDisplay, game.GetColorDepth(), viewport.GetWidth(), (get_font_surface_height(font) + get_fixed_pixel_size(5)));
+        recycle_bitmap(fpsDisplay, game.GetColorDepth(), viewport.GetWidth(), height);
         gl_DrawFPS.font = font;
     }
 
@@ -2398,6 +2822,13 @@ void draw_fps(const Rect &viewport)
     int text_off = get_font_surface_extent(font).first; // TODO: a generic function that accounts for this?
     wouttext_outline(fpsDisplay.get(), 1, 1 - text_off, font, text_color, fps_buffer);
     wouttext_outline(fpsDisplay.get(), viewport.GetWidth() / 2, 1 - text_off, font, text_color, loop_buffer);
+    if (pacing.Frames > 0u)
+    {
+        char pacing_buffer[80];
+        snprintf(pacing_buffer, sizeof(pacing_buffer), "Late ms: p50 %.2f p90 %.2f p99 %.2f max %.2f",
+            pacing.P50, pacing.P90, pacing.P99, pacing.Max);
+        wouttext_outline(fpsDisplay.get(), 1, 1 + line_height - text_off, font, text_color, pacing_buffer);
+    }
 
     gl_DrawFPS.ddb = recycle_ddb_bitmap(gl_DrawFPS.ddb, gl_DrawFPS.bmp.get());
     int yp = viewport.GetHeight() - fpsDisplay->GetHeight();
@@ -2405,6 +2836,75 @@ void draw_fps(const Rect &viewport)
     invalidate_sprite_glob(1, yp, gl_DrawFPS.ddb);
 }
 
+// Gets the current drawing state of the GUI control
+static GUIControlDrawState get_guictrl_drawstate(GUIObject *obj)
+{
+    GUIControlDrawState st;
+    st.Drawn = obj->IsVisible() && !obj->GetSize().IsNull() &&
+        (obj->IsEnabled() || (GUI::Options.DisabledStyle != kGuiDis_Blackout));
+    st.X = obj->X;
+    st.Y = obj->Y;
+    st.Width = obj->GetWidth();
+    st.Height = obj->GetHeight();
+    st.Transparency = obj->GetTransparency();
+    st.ZOrder = obj->ZOrder;
+    if (st.Drawn)
+    {
+        const Rect rc = obj->CalcGraphicRect(GUI::Options.ClipControls && obj->IsContentClipped());
+        st.Area = OffsetRect(rc, Point(obj->X, obj->Y));
+    }
+    return st;
+}
+
+// Remembers the drawing state of all the GUI controls, and resets their changed flags
+static void save_guictrl_drawstates(GUIMain &gui)
+{
+    int draw_index = guiobjddbref[gui.ID];
+    for (int i = 0; i < gui.GetControlCount(); ++i, ++draw_index)
+    {
+        GUIObject *obj = gui.GetControl(i);
+        guiobjstate[draw_index] = get_guictrl_drawstate(obj);
+        obj->ClearChanged();
+    }
+}
+
+// Redraws only the parts of the GUI surface covered by the changed controls,
+// in their old and new positions. Returns false if the changed area is too
+// large, in which case the whole GUI should be redrawn instead.
+static bool redraw_gui_regions(GUIMain &gui, Bitmap *ds)
+{
+    if ((GUI::Context.DisabledState >= 0) && (GUI::Options.DisabledStyle == kGuiDis_Blackout))
+        return false; // controls are not drawn at all, whole GUI needs an update
+
+    std::vector<Rect> regions;
+    const int draw_index = guiobjddbref[gui.ID];
+    for (int i = 0; i < gui.GetControlCount(); ++i)
+    {
+        GUIObject *obj = gui.GetControl(i);
+        const auto &old_st = guiobjstate[draw_index + i];
+        const GUIControlDrawState new_st = get_guictrl_drawstate(obj);
+        if (!obj->HasChanged() && new_st.IsSameLayout(old_st))
+            continue;
+        if (old_st.Drawn)
+            regions.push_back(old_st.Area);
+        if (new_st.Drawn && !(old_st.Drawn && (new_st.Area == old_st.Area)))
+            regions.push_back(new_st.Area);
+    }
+    // Merge overlapping regions, so that no control is drawn twice
+    MergeIntersectingRects(regions);
+    // Redrawing many regions is slower than redrawing everything once
+    int dirty_area = 0;
+    for (const auto &rc : regions)
+        dirty_area += rc.GetWidth() * rc.GetHeight();
+    if (dirty_area > gui.Width * gui.Height / 2)
+        return false;
+
+    for (const auto &rc : regions)
+        drawstate.GuiControlsRedrawn += gui.DrawRegion(ds, rc);
+    save_guictrl_drawstates(gui);
+    return true;
+}
+
 // Draw GUI controls as separate sprites, each on their own texture
 static void construct_guictrl_tex(GUIMain &gui)
 {
@@ -2426,6 +2926,7 @@ static void construct_guictrl_tex(GUIMain &gui)
         Rect obj_surf = obj->CalcGraphicRect(GUI::Options.ClipControls);
         recycle_bitmap(objbg.Bmp, game.GetColorDepth(), obj_surf.GetWidth(), obj_surf.GetHeight(), true);
         obj->Draw(objbg.Bmp.get(), -obj_surf.Left, -obj_surf.Top);
+        drawstate.GuiControlsRedrawn++;
 
         sync_object_texture(objbg, obj->HasAlphaChannel());
         objbg.Off = Point(obj_surf.GetLT());
@@ -2433,6 +2934,11 @@ static void construct_guictrl_tex(GUIMain &gui)
     }
 }
 
+size_t get_gui_controls_redrawn()
+{
+    return drawstate.GuiControlsRedrawn;
+}
+
 // Push gui bg & controls textures for the render to the corresponding render target
 static void draw_gui_controls_batch(int gui_id)
 {
@@ -2486,6 +2992,7 @@ void draw_gui_and_overlays()
         gfxDriver->DrawSprite(AGSE_PREGUIDRAW, 0, nullptr); // render stage
 
     clear_sprite_list();
+    drawstate.GuiControlsRedrawn = 0u;
 
     // Add active overlays to the sprite list
     const auto &overs = get_overlays();
@@ -2495,7 +3002,7 @@ void draw_gui_and_overlays()
         if (over.IsRoomLayer()) continue; // not a ui layer
         if (over.transparency == 255) continue; // skip fully transparent
         Point pos = get_overlay_position(over);
-        add_to_sprite_list(overtxs[over.type].Ddb, pos.X, pos.Y, over.zorder, false, over.creation_id);
+        add_to_sprite_list(overtxs[over.type].Ddb, pos.X, pos.Y, over.zorder, over.creation_id);
     }
 
     // Add GUIs
@@ -2525,20 +3032,30 @@ void draw_gui_and_overlays()
                 if (gui.HasChanged() || (draw_with_controls && gui.HasControlsChanged()))
                 {
                     auto &gbg = guibg[index];
-                    recycle_bitmap(gbg.Bmp, game.GetColorDepth(), gui.Width, gui.Height, true);
-                    if (draw_with_controls)
-                        gui.DrawWithControls(gbg.Bmp.get());
-                    else
-                        gui.DrawSelf(gbg.Bmp.get());
-
                     const bool is_alpha = gui.HasAlphaChannel();
-                    if (is_alpha)
+                    // old-style (pre-3.0.2) GUI alpha rendering
+                    const bool legacy_alpha = is_alpha &&
+                        (game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_Legacy) && (gui.BgImage > 0);
+                    // If only some controls have changed, then try redrawing
+                    // only the parts of the existing GUI image which they cover
+                    const bool can_redraw_regions = draw_with_controls && !gui.HasChanged() && !legacy_alpha &&
+                        gbg.Bmp && (gbg.Bmp->GetSize() == Size(gui.Width, gui.Height)) &&
+                        (gbg.Bmp->GetColorDepth() == game.GetColorDepth());
+                    if (!can_redraw_regions || !redraw_gui_regions(gui, gbg.Bmp.get()))
                     {
-                        if ((game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_Legacy) && (gui.BgImage > 0))
+                        recycle_bitmap(gbg.Bmp, game.GetColorDepth(), gui.Width, gui.Height, true);
+                        if (draw_with_controls)
                         {
-                            // old-style (pre-3.0.2) GUI alpha rendering
-                            repair_alpha_channel(gbg.Bmp.get(), spriteset[gui.BgImage]);
+                            drawstate.GuiControlsRedrawn += gui.DrawWithControls(gbg.Bmp.get());
+                            save_guictrl_drawstates(gui);
+                        }
+                        else
+                        {
+                            gui.DrawSelf(gbg.Bmp.get());
                         }
+
+                        if (legacy_alpha)
+                            repair_alpha_channel(gbg.Bmp.get(), spriteset[gui.BgImage]);
                     }
                     sync_object_texture(gbg, is_alpha);
                 }
@@ -2552,10 +3069,19 @@ void draw_gui_and_overlays()
 
                 set_our_eip(374);
 
+                gui_render_dirty[index] = true;
                 gui.ClearChanged();
             }
         }
         set_our_eip(38);
+        // If the driver has lost the render targets contents, then all of
+        // the GUI render targets have to be composed again
+        const uint32_t rt_generation = gfxDriver->GetRenderTargetsGeneration();
+        if (rt_generation != gui_render_generation)
+        {
+            gui_render_dirty.assign(gui_render_dirty.size(), true);
+            gui_render_generation = rt_generation;
+        }
         // Draw the GUIs
         for (int index = 0; index < game.numgui; ++index)
         {
@@ -2574,21 +3100,32 @@ void draw_gui_and_overlays()
             if (!gui_ddb) continue;
             if (draw_controls_as_textures)
             {
-                gui_render_tex[index] = recycle_render_target(gui_render_tex[index],
-                    gui_ddb->GetWidth(), gui_ddb->GetHeight(), gui_ddb->GetColorDepth(), false);
+                // Compose the GUI render target again only if anything has changed
+                // on it, or if the render target is created anew, or has lost its contents
+                auto *gui_rtex = gui_render_tex[index];
+                if (!gui_rtex || (gui_rtex->GetWidth() != gui_ddb->GetWidth()) ||
+                    (gui_rtex->GetHeight() != gui_ddb->GetHeight()) ||
+                    (gui_rtex->GetColorDepth() != gui_ddb->GetColorDepth()))
+                {
+                    gui_render_tex[index] = recycle_render_target(gui_rtex,
+                        gui_ddb->GetWidth(), gui_ddb->GetHeight(), gui_ddb->GetColorDepth(), false);
+                    gui_render_dirty[index] = true;
+                }
                 // Render control textures onto the GUI texture
-                draw_gui_controls_batch(index);
+                if (gui_render_dirty[index])
+                    draw_gui_controls_batch(index);
+                gui_render_dirty[index] = false;
                 // Replace gui bg ddb with a render target texture,
                 // and push it to the sprite list instead
                 gui_ddb = gui_render_tex[index];
             }
             gui_ddb->SetAlpha(GfxDef::LegacyTrans255ToAlpha255(gui.Transparency));
-            add_to_sprite_list(gui_ddb, gui.X, gui.Y, gui.ZOrder, false, index);
+            add_to_sprite_list(gui_ddb, gui.X, gui.Y, gui.ZOrder, index);
         }
     }
 
     // Move the resulting sprlist with guis and overlays to render
-    draw_sprite_list(false);
+    draw_sprite_list();
     put_sprite_list_on_screen(false);
     set_our_eip(1099);
 }
@@ -2637,7 +3174,10 @@ void GfxDriverOnInitCallback(void *data)
 static void construct_room_view()
 {
     draw_preroom_background();
-    prepare_room_sprites();
+    {
+        AGS_PROFILE_SCOPE(kFramePhase_PrepareRoom);
+        prepare_room_sprites();
+    }
     // reset the Baselines Changed flag now that we've drawn stuff
     walk_behind_baselines_changed = 0;
 
@@ -2707,7 +3247,10 @@ static void construct_room_view()
 static void construct_ui_view()
 {
     gfxDriver->BeginSpriteBatch(play.GetUIViewport());
-    draw_gui_and_overlays();
+    {
+        AGS_PROFILE_SCOPE(kFramePhase_DrawGUI);
+        draw_gui_and_overlays();
+    }
     gfxDriver->EndSpriteBatch();
     clear_draw_list();
 }
@@ -2790,6 +3333,8 @@ void construct_game_scene(bool full_redraw)
 
     pl_run_plugin_hooks(AGSE_PRERENDER, 0);
 
+    reset_invalidrects_stats();
+
     // Possible reasons to invalidate whole screen for the software renderer
     if (full_redraw || play.screen_tint > 0 || play.shakesc_length > 0)
         invalidate_screen();
@@ -2985,6 +3530,7 @@ void render_graphics(IDriverDependantBitmap *extraBitmap, int extraX, int extraY
     if ((in_new_room > 0) & (game.color_depth > 1))
         return;
 
+    AGS_PROFILE_SCOPE(kFramePhase_Render);
     // TODO: find out if it's okay to move shake to update function
     update_shakescreen();
 
@@ -27,6 +27,7 @@ namespace AGS
     namespace Common
     {
         typedef std::shared_ptr<Common::Bitmap> PBitmap;
+        class ThreadPool;
     }
     namespace Engine { class IDriverDependantBitmap; }
 }
@@ -116,6 +117,15 @@ void mark_current_background_dirty();
 // Avoid freeing and reallocating the memory if possible
 Common::Bitmap *recycle_bitmap(Common::Bitmap *bimp, int coldep, int wid, int hit, bool make_transparent = false);
 void recycle_bitmap(std::unique_ptr<Common::Bitmap> &bimp, int coldep, int wid, int hit, bool make_transparent = false);
+// Creates a bitmap using the pooled pixel memory, optionally clears it to transparent
+Common::Bitmap *create_pooled_bitmap(int coldep, int wid, int hit, bool make_transparent = false);
+// Disposes the bitmap, putting its pixel memory into the pool for reuse
+void release_pooled_bitmap(Common::Bitmap *bmp);
+void release_pooled_bitmap(std::unique_ptr<Common::Bitmap> bmp);
+// Marks the next frame for the bitmap pool, frees the memory unused for a while
+void update_bitmap_pool();
+// Gets the number of bitmap memory allocations done during the last frame
+size_t get_bitmap_pool_allocations();
 Engine::IDriverDependantBitmap* recycle_ddb_bitmap(Engine::IDriverDependantBitmap *ddb, Common::Bitmap *source, bool has_alpha = false, bool opaque = false);
 Engine::IDriverDependantBitmap* recycle_ddb_sprite(Engine::IDriverDependantBitmap *ddb, uint32_t sprite_id,
     Common::Bitmap *source, bool has_alpha = false, bool opaque = false);
@@ -132,12 +142,17 @@ void construct_game_screen_overlay(bool draw_mouse = true);
 void construct_engine_overlay();
 // Clears black game borders in legacy letterbox mode
 void clear_letterbox_borders();
+// Gets the number of GUI controls redrawn during the last frame
+size_t get_gui_controls_redrawn();
 
 void debug_draw_room_mask(RoomAreaMask mask);
 void debug_draw_movelist(int charnum);
 void update_room_debug();
 
-void tint_image (Common::Bitmap *g, Common::Bitmap *source, int red, int grn, int blu, int light_level, int luminance=255);
+// Tints the source image into g; if the thread pool is given, then the
+// 32-bit images may be processed by several threads
+void tint_image (Common::Bitmap *g, Common::Bitmap *source, int red, int grn, int blu, int light_level, int luminance=255,
+                 Common::ThreadPool *pool = nullptr);
 void draw_sprite_support_alpha(Common::Bitmap *ds, bool ds_has_alpha, int xpos, int ypos, Common::Bitmap *image, bool src_has_alpha,
                                Common::BlendMode blend_mode = Common::kBlendMode_Alpha, int alpha = 0xFF);
 void draw_sprite_slot_support_alpha(Common::Bitmap *ds, bool ds_has_alpha, int xpos, int ypos, int src_slot,
@@ -37,6 +37,7 @@
 //=============================================================================
 
 #include <string.h>
+#include <algorithm>
 #include <vector>
 #include "ac/draw_software.h"
 #include "gfx/bitmap.h"
@@ -45,28 +46,33 @@
 using namespace AGS::Common;
 using namespace AGS::Engine;
 
-// TODO: choose these values depending on game resolution?
-#define MAXDIRTYREGIONS 25
-#define WHOLESCREENDIRTY (MAXDIRTYREGIONS + 5)
-#define MAX_SPANS_PER_ROW 4
+// Dirty surface is split into square tiles, and the whole tile is redrawn if
+// any pixel inside it was invalidated. Smaller tiles redraw less excessive
+// pixels, but cost more to mark and scan; surfaces bigger than this area
+// use larger tiles.
+#define SMALL_TILE_SHIFT 3 // 8x8 tiles
+#define LARGE_TILE_SHIFT 4 // 16x16 tiles
+#define SMALL_TILE_MAX_AREA (640 * 480)
+// If this share of tiles is dirty (in percents), then it's faster to redraw whole surface
+#define WHOLE_SURFACE_DIRTY_PERCENT 75
 
 // Dirty rects store coordinate values in the coordinate system of a camera surface,
 // where coords always span from 0,0 to surface width,height.
 // Converting from room to dirty rects would require subtracting room camera offsets.
-struct IRSpan
-{
-    int x1, x2;
-    int mergeSpan(int tx1, int tx2);
-
-    IRSpan();
-};
-
-struct IRRow
+//
+// Invalidated areas are kept on two levels: a map of dirty tiles, and the range
+// of dirty tiles for each row of tiles. Marking a rectangle costs only as much as
+// the number of tiles it covers, and overlapping rectangles merge naturally,
+// so there's no limit on how many of them may be registered per frame.
+// When redrawing, the clean tile rows are skipped right away, and consecutive
+// rows with identical dirty tiles are joined into taller rectangles.
+struct TileRow
 {
-    IRSpan span[MAX_SPANS_PER_ROW];
-    int numSpans;
+    // Range of dirty tiles in this row, inclusive; first > last means none
+    int FirstDirty = INT32_MAX;
+    int LastDirty = -1;
 
-    IRRow();
+    bool IsDirty() const { return FirstDirty <= LastDirty; }
 };
 
 struct DirtyRects
@@ -81,11 +87,17 @@ struct DirtyRects
     // The dirty rects are saved in coordinates limited to (0,0)->(camera size) rather than room or screen coords
     PlaneScaling Screen2DirtySurf;
 
-    std::vector<IRRow> DirtyRows;
-    Rect DirtyRegions[MAXDIRTYREGIONS];
-    size_t NumDirtyRegions;
+    // Size of a tile, as a power of 2
+    int TileShift = SMALL_TILE_SHIFT;
+    int TileCols = 0;
+    int TileRows = 0;
+    // Dirty tile flags, TileCols x TileRows
+    std::vector<uint8_t> Tiles;
+    std::vector<TileRow> Rows;
+    size_t NumDirtyTiles = 0;
+    // Whole surface is to be redrawn
+    bool WholeDirty = false;
 
-    DirtyRects();
     bool IsInit() const;
     // Initialize dirty rects for the given surface size
     void Init(const Size &surf_size, const Rect &viewport);
@@ -94,53 +106,32 @@ struct DirtyRects
     void Destroy();
     // Mark all surface as tidy
     void Reset();
+    // Mark the rectangle in surface coordinates as dirty (inclusive, must be clipped)
+    void MarkDirty(int x1, int y1, int x2, int y2);
+    // Tells if it's cheaper to redraw the whole surface
+    bool IsWholeDirty() const;
 };
 
 
-IRSpan::IRSpan()
-    : x1(0), x2(0)
-{
-}
-
-IRRow::IRRow()
-    : numSpans(0)
-{
-}
-
-int IRSpan::mergeSpan(int tx1, int tx2)
-{
-    if ((tx1 > x2) || (tx2 < x1))
-        return 0;
-    // overlapping, increase the span
-    if (tx1 < x1)
-        x1 = tx1;
-    if (tx2 > x2)
-        x2 = tx2;
-    return 1;
-}
-
-DirtyRects::DirtyRects()
-    : NumDirtyRegions(0)
-{
-}
-
 bool DirtyRects::IsInit() const
 {
-    return DirtyRows.size() > 0;
+    return TileRows > 0;
 }
 
 void DirtyRects::Init(const Size &surf_size, const Rect &viewport)
 {
-    int height = surf_size.Height;
     if (SurfaceSize != surf_size)
     {
         Destroy();
         SurfaceSize = surf_size;
-        DirtyRows.resize(height);
-
-        NumDirtyRegions = WHOLESCREENDIRTY;
-        for (int i = 0; i < height; ++i)
-            DirtyRows[i].numSpans = 0;
+        TileShift = (surf_size.Width * surf_size.Height > SMALL_TILE_MAX_AREA) ?
+            LARGE_TILE_SHIFT : SMALL_TILE_SHIFT;
+        const int tile_size = 1 << TileShift;
+        TileCols = (surf_size.Width + tile_size - 1) >> TileShift;
+        TileRows = (surf_size.Height + tile_size - 1) >> TileShift;
+        Tiles.resize(TileCols * TileRows);
+        Rows.resize(TileRows);
+        WholeDirty = true;
     }
 
     Viewport = viewport;
@@ -155,16 +146,51 @@ void DirtyRects::SetSurfaceOffsets(int x, int y)
 
 void DirtyRects::Destroy()
 {
-    DirtyRows.clear();
-    NumDirtyRegions = 0;
+    Tiles.clear();
+    Rows.clear();
+    TileCols = TileRows = 0;
+    NumDirtyTiles = 0;
+    WholeDirty = false;
 }
 
 void DirtyRects::Reset()
 {
-    NumDirtyRegions = 0;
+    for (int ty = 0; ty < TileRows; ++ty)
+    {
+        TileRow &row = Rows[ty];
+        if (!row.IsDirty())
+            continue;
+        memset(&Tiles[ty * TileCols + row.FirstDirty], 0, row.LastDirty - row.FirstDirty + 1);
+        row = TileRow();
+    }
+    NumDirtyTiles = 0;
+    WholeDirty = false;
+}
+
+void DirtyRects::MarkDirty(int x1, int y1, int x2, int y2)
+{
+    if (WholeDirty)
+        return; // no point in tracking anything
+    const int tx1 = x1 >> TileShift, tx2 = x2 >> TileShift;
+    const int ty1 = y1 >> TileShift, ty2 = y2 >> TileShift;
+    for (int ty = ty1; ty <= ty2; ++ty)
+    {
+        uint8_t *tile = &Tiles[ty * TileCols];
+        for (int tx = tx1; tx <= tx2; ++tx)
+        {
+            NumDirtyTiles += 1 - tile[tx];
+            tile[tx] = 1;
+        }
+        TileRow &row = Rows[ty];
+        row.FirstDirty = std::min(row.FirstDirty, tx1);
+        row.LastDirty = std::max(row.LastDirty, tx2);
+    }
+}
 
-    for (size_t i = 0; i < DirtyRows.size(); ++i)
-        DirtyRows[i].numSpans = 0;
+bool DirtyRects::IsWholeDirty() const
+{
+    return WholeDirty ||
+        (NumDirtyTiles * 100 >= Tiles.size() * WHOLE_SURFACE_DIRTY_PERCENT);
 }
 
 // Dirty rects for the game screen background (black screen);
@@ -177,6 +203,8 @@ std::vector<DirtyRects> RoomCamRects;
 // Saved room camera offsets to know if we must invalidate whole surface.
 // TODO: if we support rotation then we also need to compare full transform!
 std::vector<std::pair<int, int>> RoomCamPositions;
+// Number of pixels redrawn since the last stats reset
+size_t PixelsRedrawn = 0;
 
 
 void dispose_invalid_regions(bool /* room_only */)
@@ -244,8 +272,8 @@ void invalidate_all_rects()
     for (auto &rects : RoomCamRects)
     {
         if (!IsRectInsideRect(rects.Viewport, BlackRects.Viewport))
-            BlackRects.NumDirtyRegions = WHOLESCREENDIRTY;
-        rects.NumDirtyRegions = WHOLESCREENDIRTY;
+            BlackRects.WholeDirty = true;
+        rects.WholeDirty = true;
     }
 }
 
@@ -253,23 +281,15 @@ void invalidate_all_camera_rects(int view_index)
 {
     if (view_index < 0)
         return;
-    RoomCamRects[view_index].NumDirtyRegions = WHOLESCREENDIRTY;
+    RoomCamRects[view_index].WholeDirty = true;
 }
 
 void invalidate_rect_on_surf(int x1, int y1, int x2, int y2, DirtyRects &rects)
 {
-    if (rects.DirtyRows.size() == 0)
-        return;
-    if (rects.NumDirtyRegions >= MAXDIRTYREGIONS) {
-        // too many invalid rectangles, just mark the whole thing dirty
-        rects.NumDirtyRegions = WHOLESCREENDIRTY;
+    if (!rects.IsInit())
         return;
-    }
-
     if(x1 > x2 || y1 > y2) return;
 
-    int a;
-
     const Size &surfsz = rects.SurfaceSize;
 
     if(x1 >= surfsz.Width || y1 >= surfsz.Height || x2 < 0 || y2 < 0) return;
@@ -278,68 +298,8 @@ void invalidate_rect_on_surf(int x1, int y1, int x2, int y2, DirtyRects &rects)
     if (y2 >= surfsz.Height) y2 = surfsz.Height - 1;
     if (x1 < 0) x1 = 0;
     if (y1 < 0) y1 = 0;
-    rects.NumDirtyRegions++;
-
-    // ** Span code
-    std::vector<IRRow> &dirtyRow = rects.DirtyRows;
-    int s, foundOne;
-    // add this rect to the list for this row
-    for (a = y1; a <= y2; a++) {
-        foundOne = 0;
-        for (s = 0; s < dirtyRow[a].numSpans; s++) {
-            if (dirtyRow[a].span[s].mergeSpan(x1, x2)) {
-                foundOne = 1;
-                break;
-            }
-        }
-        if (foundOne) {
-            // we were merged into a span, so we're ok
-            int t;
-            // check whether now two of the spans overlap each other
-            // in which case merge them
-            for (s = 0; s < dirtyRow[a].numSpans; s++) {
-                for (t = s + 1; t < dirtyRow[a].numSpans; t++) {
-                    if (dirtyRow[a].span[s].mergeSpan(dirtyRow[a].span[t].x1, dirtyRow[a].span[t].x2)) {
-                        dirtyRow[a].numSpans--;
-                        for (int u = t; u < dirtyRow[a].numSpans; u++)
-                            dirtyRow[a].span[u] = dirtyRow[a].span[u + 1];
-                        break;
-                    }
-                }
-            }
-        }
-        else if (dirtyRow[a].numSpans < MAX_SPANS_PER_ROW) {
-            dirtyRow[a].span[dirtyRow[a].numSpans].x1 = x1;
-            dirtyRow[a].span[dirtyRow[a].numSpans].x2 = x2;
-            dirtyRow[a].numSpans++;
-        }
-        else {
-            // didn't fit in an existing span, and there are none spare
-            int nearestDist = 99999, nearestWas = -1, extendLeft = 0;
-            // find the nearest span, and enlarge that to include this rect
-            for (s = 0; s < dirtyRow[a].numSpans; s++) {
-                int tleft = dirtyRow[a].span[s].x1 - x2;
-                if ((tleft > 0) && (tleft < nearestDist)) {
-                    nearestDist = tleft;
-                    nearestWas = s;
-                    extendLeft = 1;
-                }
-                int tright = x1 - dirtyRow[a].span[s].x2;
-                if ((tright > 0) && (tright < nearestDist)) {
-                    nearestDist = tright;
-                    nearestWas = s;
-                    extendLeft = 0;
-                }
-            }
-            assert(nearestWas >= 0);
-            if (extendLeft)
-                dirtyRow[a].span[nearestWas].x1 = x1;
-            else
-                dirtyRow[a].span[nearestWas].x2 = x2;
-        }
-    }
-    // ** End span code
-    //}
+
+    rects.MarkDirty(x1, y1, x2, y2);
 }
 
 void invalidate_rect_ds(DirtyRects &rects, int x1, int y1, int x2, int y2, bool in_room)
@@ -393,6 +353,45 @@ void invalidate_rect_global(int x1, int y1, int x2, int y2)
         invalidate_rect_ds(rects, x1, y1, x2, y2, false);
 }
 
+// Calls the given function for each dirty rectangle on the surface, in surface coordinates.
+// Consecutive rows of tiles having identical dirty tiles are passed as a single rectangle.
+template <typename TFunc>
+void for_each_dirty_rect(const DirtyRects &rects, TFunc func)
+{
+    const int shift = rects.TileShift;
+    const int surf_w = rects.SurfaceSize.Width;
+    const int surf_h = rects.SurfaceSize.Height;
+    for (int ty = 0, rowsInOne = 1; ty < rects.TileRows; ty += rowsInOne, rowsInOne = 1)
+    {
+        const TileRow &row = rects.Rows[ty];
+        if (!row.IsDirty())
+            continue;
+        const uint8_t *tiles = &rects.Tiles[ty * rects.TileCols];
+        const int row_len = row.LastDirty - row.FirstDirty + 1;
+        // if there are rows with identical tiles, do them all in one go
+        for (; ty + rowsInOne < rects.TileRows; ++rowsInOne)
+        {
+            const TileRow &next_row = rects.Rows[ty + rowsInOne];
+            if ((next_row.FirstDirty != row.FirstDirty) || (next_row.LastDirty != row.LastDirty) ||
+                (memcmp(&tiles[row.FirstDirty], &tiles[rowsInOne * rects.TileCols + row.FirstDirty], row_len) != 0))
+                break;
+        }
+
+        const int y1 = ty << shift;
+        const int y2 = std::min((ty + rowsInOne) << shift, surf_h) - 1;
+        for (int tx = row.FirstDirty; tx <= row.LastDirty; ++tx)
+        {
+            if (!tiles[tx])
+                continue;
+            const int run_start = tx;
+            for (; tx < row.LastDirty && tiles[tx + 1]; ++tx);
+            const int x1 = run_start << shift;
+            const int x2 = std::min((tx + 1) << shift, surf_w) - 1;
+            func(Rect(x1, y1, x2, y2));
+        }
+    }
+}
+
 // Note that this function is denied to perform any kind of scaling or other transformation
 // other than blitting with offset. This is mainly because destination could be a 32-bit virtual screen
 // while room background was 16-bit and Allegro lib does not support stretching between colour depths.
@@ -400,7 +399,7 @@ void invalidate_rect_global(int x1, int y1, int x2, int y2)
 // must blit src on ds at 0;0. Otherwise, actual Viewport offset is used.
 void update_invalid_region(Bitmap *ds, Bitmap *src, const DirtyRects &rects, bool no_transform)
 {
-    if (rects.NumDirtyRegions == 0)
+    if (!rects.WholeDirty && (rects.NumDirtyTiles == 0))
         return;
 
     if (!no_transform)
@@ -411,86 +410,61 @@ void update_invalid_region(Bitmap *ds, Bitmap *src, const DirtyRects &rects, boo
     const int dst_x = no_transform ? 0 : rects.Viewport.Left;
     const int dst_y = no_transform ? 0 : rects.Viewport.Top;
 
-    if (rects.NumDirtyRegions == WHOLESCREENDIRTY)
+    if (rects.IsWholeDirty())
     {
         ds->Blit(src, src_x, src_y, dst_x, dst_y, rects.SurfaceSize.Width, rects.SurfaceSize.Height);
+        PixelsRedrawn += rects.SurfaceSize.Width * rects.SurfaceSize.Height;
     }
-    else
+    // TODO: is this IsMemoryBitmap check is still relevant?
+    // If bitmaps properties match and no transform required other than linear offset
+    else if (src->GetColorDepth() == ds->GetColorDepth())
     {
-        const std::vector<IRRow> &dirtyRow = rects.DirtyRows;
-        const int surf_height = rects.SurfaceSize.Height;
-        // TODO: is this IsMemoryBitmap check is still relevant?
-        // If bitmaps properties match and no transform required other than linear offset
-        if (src->GetColorDepth() == ds->GetColorDepth())
+        const int bypp = src->GetBPP();
+        // do the fast memory copy
+        for_each_dirty_rect(rects, [ds, src, src_x, src_y, dst_x, dst_y, bypp](const Rect &r)
         {
-            const int bypp = src->GetBPP();
-            // do the fast memory copy
-            for (int i = 0; i < surf_height; i++)
+            const size_t copy_len = r.GetWidth() * bypp;
+            for (int y = r.Top; y <= r.Bottom; ++y)
             {
-                const uint8_t *src_scanline = src->GetScanLine(i + src_y);
-                uint8_t *dst_scanline = ds->GetScanLineForWriting(i + dst_y);
-                const IRRow &dirty_row = dirtyRow[i];
-                for (int k = 0; k < dirty_row.numSpans; k++)
-                {
-                    int tx1 = dirty_row.span[k].x1;
-                    int tx2 = dirty_row.span[k].x2;
-                    memcpy(&dst_scanline[(tx1 + dst_x) * bypp], &src_scanline[(tx1 + src_x) * bypp], ((tx2 - tx1) + 1) * bypp);
-                }
+                memcpy(&ds->GetScanLineForWriting(y + dst_y)[(r.Left + dst_x) * bypp],
+                    &src->GetScanLine(y + src_y)[(r.Left + src_x) * bypp], copy_len);
             }
-        }
-        // If has to use Blit, but still must draw with no transform but offset
-        else
+            PixelsRedrawn += r.GetWidth() * r.GetHeight();
+        });
+    }
+    // If has to use Blit, but still must draw with no transform but offset
+    else
+    {
+        // do fast copy without transform
+        for_each_dirty_rect(rects, [ds, src, src_x, src_y, dst_x, dst_y](const Rect &r)
         {
-            // do fast copy without transform
-            for (int i = 0, rowsInOne = 1; i < surf_height; i += rowsInOne, rowsInOne = 1)
-            {
-                // if there are rows with identical masks, do them all in one go
-                // TODO: what is this for? may this be done at the invalidate_rect merge step?
-                while ((i + rowsInOne < surf_height) && (memcmp(&dirtyRow[i], &dirtyRow[i + rowsInOne], sizeof(IRRow)) == 0))
-                    rowsInOne++;
-
-                const IRRow &dirty_row = dirtyRow[i];
-                for (int k = 0; k < dirty_row.numSpans; k++)
-                {
-                    int tx1 = dirty_row.span[k].x1;
-                    int tx2 = dirty_row.span[k].x2;
-                    ds->Blit(src, tx1 + src_x, i + src_y, tx1 + dst_x, i + dst_y, (tx2 - tx1) + 1, rowsInOne);
-                }
-            }
-        }
+            ds->Blit(src, r.Left + src_x, r.Top + src_y, r.Left + dst_x, r.Top + dst_y, r.GetWidth(), r.GetHeight());
+            PixelsRedrawn += r.GetWidth() * r.GetHeight();
+        });
     }
 }
 
 void update_invalid_region(Bitmap *ds, color_t fill_color, const DirtyRects &rects)
 {
+    if (!rects.WholeDirty && (rects.NumDirtyTiles == 0))
+        return;
+
     ds->SetClip(rects.Viewport);
 
-    if (rects.NumDirtyRegions == WHOLESCREENDIRTY)
+    if (rects.IsWholeDirty())
     {
         ds->FillRect(rects.Viewport, fill_color);
+        PixelsRedrawn += rects.Viewport.GetWidth() * rects.Viewport.GetHeight();
     }
     else
     {
-        const std::vector<IRRow> &dirtyRow = rects.DirtyRows;
-        const int surf_height = rects.SurfaceSize.Height;
+        const PlaneScaling &tf = rects.Room2Screen;
+        for_each_dirty_rect(rects, [ds, fill_color, &tf](const Rect &r)
         {
-            const PlaneScaling &tf = rects.Room2Screen;
-            for (int i = 0, rowsInOne = 1; i < surf_height; i += rowsInOne, rowsInOne = 1)
-            {
-                // if there are rows with identical masks, do them all in one go
-                // TODO: what is this for? may this be done at the invalidate_rect merge step?
-                while ((i + rowsInOne < surf_height) && (memcmp(&dirtyRow[i], &dirtyRow[i + rowsInOne], sizeof(IRRow)) == 0))
-                    rowsInOne++;
-
-                const IRRow &dirty_row = dirtyRow[i];
-                for (int k = 0; k < dirty_row.numSpans; k++)
-                {
-                    Rect src_r(dirty_row.span[k].x1, i, dirty_row.span[k].x2, i + rowsInOne - 1);
-                    Rect dst_r = tf.ScaleRange(src_r);
-                    ds->FillRect(dst_r, fill_color);
-                }
-            }
-        }
+            Rect dst_r = tf.ScaleRange(r);
+            ds->FillRect(dst_r, fill_color);
+            PixelsRedrawn += dst_r.GetWidth() * dst_r.GetHeight();
+        });
     }
 }
 
@@ -510,3 +484,13 @@ void update_room_invreg_and_reset(int view_index, Bitmap *ds, Bitmap *src, bool
     update_invalid_region(ds, src, RoomCamRects[view_index], no_transform);
     RoomCamRects[view_index].Reset();
 }
+
+size_t get_invalidrects_pixels_redrawn()
+{
+    return PixelsRedrawn;
+}
+
+void reset_invalidrects_stats()
+{
+    PixelsRedrawn = 0;
+}
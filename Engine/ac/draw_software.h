@@ -47,5 +47,9 @@ void update_black_invreg_and_reset(AGS::Common::Bitmap *ds);
 // Copies the room regions marked as dirty from source (src) to destination (ds) with the given offset (x, y)
 // no_transform flag tells the system that the regions should be plain copied to the ds.
 void update_room_invreg_and_reset(int view_index, AGS::Common::Bitmap *ds, AGS::Common::Bitmap *src, bool no_transform);
+// Gets the number of pixels redrawn by the dirty regions updates since the last stats reset
+size_t get_invalidrects_pixels_redrawn();
+// Resets the dirty regions stats; this is done at the start of each frame
+void reset_invalidrects_stats();
 
 #endif // __AGS_EE_AC__DRAWSOFTWARE_H
@@ -12,10 +12,12 @@
 //
 //=============================================================================
 #include <math.h>
+#include <functional>
 #include "ac/dynamicsprite.h"
 #include "ac/common.h"
 #include "ac/draw.h"
 #include "ac/game.h"
+#include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
 #include "ac/global_dynamicsprite.h"
@@ -27,11 +29,15 @@
 #include "ac/system.h"
 #include "ac/dynobj/dynobj_manager.h"
 #include "debug/debug_log.h"
+#include "debug/out.h"
 #include "game/roomstruct.h"
 #include "gui/guibutton.h"
 #include "ac/spritecache.h"
 #include "gfx/graphicsdriver.h"
+#include "gfx/scalekernels.h"
+#include "gfx/transformkernels.h"
 #include "script/runtimescriptvalue.h"
+#include "util/threadpool.h"
 
 using namespace Common;
 using namespace Engine;
@@ -47,6 +53,53 @@ extern AGS::Engine::IGraphicsDriver *gfxDriver;
 
 char check_dynamic_sprites_at_exit = 1;
 
+// Thread pool for the sprite transforms, created on the first use
+static std::unique_ptr<ThreadPool> transform_pool;
+static bool transform_pool_init = false;
+// Minimal number of rows per each thread's task
+static const size_t MinRowsPerTask = 16;
+
+static ThreadPool *get_transform_pool()
+{
+    if (!transform_pool_init)
+    {
+        const size_t thread_count = (usetup.SpriteThreads > 0) ?
+            static_cast<size_t>(usetup.SpriteThreads) : ThreadPool::GetHardwareThreadCount();
+        if (thread_count > 1)
+            transform_pool.reset(new ThreadPool(thread_count));
+        transform_pool_init = true;
+        Debug::Printf(kDbgMsg_Info, "Dynamic sprites: transforming with %zu thread(s)", transform_pool ? thread_count : 1);
+    }
+    return transform_pool.get();
+}
+
+// Runs func(row_begin, row_end) for the range of rows, either splitting it
+// between the transform pool's threads, or on the calling thread
+static void ForEachRows(int rows, const std::function<void(size_t, size_t)> &func)
+{
+    ThreadPool *pool = get_transform_pool();
+    if (pool)
+        pool->ParallelFor(0, rows, func, MinRowsPerTask);
+    else
+        func(0, rows);
+}
+
+static const uint32_t *GetPixels32(const Bitmap *bmp)
+{
+    return reinterpret_cast<const uint32_t*>(bmp->GetData());
+}
+
+static uint32_t *GetPixels32(Bitmap *bmp)
+{
+    return reinterpret_cast<uint32_t*>(bmp->GetDataForWriting());
+}
+
+void shutdown_dynamic_sprite_transforms()
+{
+    transform_pool.reset();
+    transform_pool_init = false;
+}
+
 // ** SCRIPT DYNAMIC SPRITE
 
 void DynamicSprite_Delete(ScriptDynamicSprite *sds) {
@@ -92,7 +145,11 @@ int DynamicSprite_GetColorDepth(ScriptDynamicSprite *sds) {
     return depth;
 }
 
-void DynamicSprite_Resize(ScriptDynamicSprite *sds, int width, int height) {
+void DynamicSprite_Resize2(ScriptDynamicSprite *sds, int width, int height) {
+    DynamicSprite_Resize(sds, width, height, kTransform_Nearest);
+}
+
+void DynamicSprite_Resize(ScriptDynamicSprite *sds, int width, int height, int quality) {
     if ((width < 1) || (height < 1))
         quit("!DynamicSprite.Resize: width and height must be greater than zero");
     if (sds->slot == 0)
@@ -105,10 +162,30 @@ void DynamicSprite_Resize(ScriptDynamicSprite *sds, int width, int height) {
 
     // resize the sprite to the requested size
     Bitmap *sprite = spriteset[sds->slot];
-    std::unique_ptr<Bitmap> new_pic(BitmapHelper::CreateBitmap(width, height, sprite->GetColorDepth()));
-    new_pic->StretchBlt(sprite,
-        RectWH(0, 0, game.SpriteInfos[sds->slot].Width, game.SpriteInfos[sds->slot].Height),
-        RectWH(0, 0, width, height));
+    const bool has_alpha = (game.SpriteInfos[sds->slot].Flags & SPF_ALPHACHANNEL) != 0;
+    const int src_w = game.SpriteInfos[sds->slot].Width, src_h = game.SpriteInfos[sds->slot].Height;
+    std::unique_ptr<Bitmap> new_pic;
+    if ((sprite->GetColorDepth() == 32) && (quality == kTransform_Bilinear))
+    {
+        new_pic.reset(BitmapHelper::CreateTransparentBitmap(width, height, 32));
+        TransformKernels::SpanMap map;
+        TransformKernels::MapScale(map, src_w, src_h, width, height);
+        ForEachRows(height, [&](size_t y1, size_t y2) {
+            TransformKernels::DrawBilinear(GetPixels32(sprite), sprite->GetLineLength(), src_w, src_h,
+                GetPixels32(new_pic.get()), new_pic->GetLineLength(), map, has_alpha, y1, y2); });
+    }
+    else if (sprite->GetColorDepth() == 32)
+    {
+        new_pic.reset(BitmapHelper::CreateBitmap(width, height, 32));
+        ForEachRows(height, [&](size_t y1, size_t y2) {
+            ScaleKernels::ScaleNearest(GetPixels32(sprite), sprite->GetLineLength(), src_w, src_h,
+                GetPixels32(new_pic.get()), new_pic->GetLineLength(), width, height, y1, y2); });
+    }
+    else
+    {
+        new_pic.reset(BitmapHelper::CreateBitmap(width, height, sprite->GetColorDepth()));
+        new_pic->StretchBlt(sprite, RectWH(0, 0, src_w, src_h), RectWH(0, 0, width, height));
+    }
 
     add_dynamic_sprite(sds->slot, std::move(new_pic), (game.SpriteInfos[sds->slot].Flags & SPF_ALPHACHANNEL) != 0);
     game_sprite_updated(sds->slot);
@@ -120,13 +197,24 @@ void DynamicSprite_Flip(ScriptDynamicSprite *sds, int direction) {
     if (sds->slot == 0)
         quit("!DynamicSprite.Flip: sprite has been deleted");
 
-    // resize the sprite to the requested size
     Bitmap *sprite = spriteset[sds->slot];
-    std::unique_ptr<Bitmap> new_pic(
-        BitmapHelper::CreateTransparentBitmap(sprite->GetWidth(), sprite->GetHeight(), sprite->GetColorDepth()));
-
     // AGS script FlipDirection corresponds to internal GraphicFlip
-    new_pic->FlipBlt(sprite, 0, 0, static_cast<GraphicFlip>(direction));
+    const GraphicFlip flip = static_cast<GraphicFlip>(direction);
+    std::unique_ptr<Bitmap> new_pic;
+    if (sprite->GetColorDepth() == 32)
+    {
+        // all the pixels are copied, so no need to clear the bitmap first
+        const int width = sprite->GetWidth(), height = sprite->GetHeight();
+        new_pic.reset(BitmapHelper::CreateBitmap(width, height, 32));
+        ForEachRows(height, [&](size_t y1, size_t y2) {
+            TransformKernels::Flip(GetPixels32(sprite), sprite->GetLineLength(),
+                GetPixels32(new_pic.get()), new_pic->GetLineLength(), width, height, flip, y1, y2); });
+    }
+    else
+    {
+        new_pic.reset(BitmapHelper::CreateTransparentBitmap(sprite->GetWidth(), sprite->GetHeight(), sprite->GetColorDepth()));
+        new_pic->FlipBlt(sprite, 0, 0, flip);
+    }
 
     add_dynamic_sprite(sds->slot, std::move(new_pic), (game.SpriteInfos[sds->slot].Flags & SPF_ALPHACHANNEL) != 0);
     game_sprite_updated(sds->slot);
@@ -203,7 +291,11 @@ void DynamicSprite_Crop(ScriptDynamicSprite *sds, int x1, int y1, int width, int
     game_sprite_updated(sds->slot);
 }
 
-void DynamicSprite_Rotate(ScriptDynamicSprite *sds, int angle, int width, int height) {
+void DynamicSprite_Rotate3(ScriptDynamicSprite *sds, int angle, int width, int height) {
+    DynamicSprite_Rotate(sds, angle, width, height, kTransform_Nearest);
+}
+
+void DynamicSprite_Rotate(ScriptDynamicSprite *sds, int angle, int width, int height, int quality) {
     if ((angle < 1) || (angle > 359))
         quit("!DynamicSprite.Rotate: invalid angle (must be 1-359)");
     if (sds->slot == 0)
@@ -237,8 +329,26 @@ void DynamicSprite_Rotate(ScriptDynamicSprite *sds, int angle, int width, int he
 
     // rotate the sprite about its centre
     // (+ width%2 fixes one pixel offset problem)
-    new_pic->RotateBlt(sprite, width / 2 + width % 2, height / 2,
-        sprite->GetWidth() / 2, sprite->GetHeight() / 2, itofix(angle));
+    if (sprite->GetColorDepth() == 32)
+    {
+        const bool has_alpha = (game.SpriteInfos[sds->slot].Flags & SPF_ALPHACHANNEL) != 0;
+        const int src_w = sprite->GetWidth(), src_h = sprite->GetHeight();
+        TransformKernels::SpanMap map;
+        TransformKernels::MapRotation(map, src_w, src_h, width, height,
+            width / 2 + width % 2, height / 2, src_w / 2, src_h / 2, itofix(angle));
+        ForEachRows(height, [&](size_t y1, size_t y2) {
+            if (quality == kTransform_Bilinear)
+                TransformKernels::DrawBilinear(GetPixels32(sprite), sprite->GetLineLength(), src_w, src_h,
+                    GetPixels32(new_pic.get()), new_pic->GetLineLength(), map, has_alpha, y1, y2);
+            else
+                TransformKernels::DrawNearest(GetPixels32(sprite), sprite->GetLineLength(), src_w, src_h,
+                    GetPixels32(new_pic.get()), new_pic->GetLineLength(), map, y1, y2); });
+    }
+    else
+    {
+        new_pic->RotateBlt(sprite, width / 2 + width % 2, height / 2,
+            sprite->GetWidth() / 2, sprite->GetHeight() / 2, itofix(angle));
+    }
 
     // replace the bitmap in the sprite set
     add_dynamic_sprite(sds->slot, std::move(new_pic), (game.SpriteInfos[sds->slot].Flags & SPF_ALPHACHANNEL) != 0);
@@ -251,7 +361,8 @@ void DynamicSprite_Tint(ScriptDynamicSprite *sds, int red, int green, int blue,
     std::unique_ptr<Bitmap> new_pic(
         BitmapHelper::CreateBitmap(source->GetWidth(), source->GetHeight(), source->GetColorDepth()));
 
-    tint_image(new_pic.get(), source, red, green, blue, saturation, (luminance * 25) / 10);
+    tint_image(new_pic.get(), source, red, green, blue, saturation, (luminance * 25) / 10,
+        get_transform_pool());
 
     add_dynamic_sprite(sds->slot, std::move(new_pic), (game.SpriteInfos[sds->slot].Flags & SPF_ALPHACHANNEL) != 0);
     game_sprite_updated(sds->slot);
@@ -467,6 +578,11 @@ int add_dynamic_sprite(int slot, std::unique_ptr<Bitmap> image, bool has_alpha,
         return 0; // invalid slot, or reserved for the static sprite
 
     uint32_t flags = SPF_DYNAMICALLOC | (SPF_ALPHACHANNEL * has_alpha) | extra_flags;
+    // Sprite images are allocated with the exact size, so that the sprite cache
+    // accounts for all their memory; the pool only keeps the freed blocks which
+    // fit its buckets, and uses them for the temporary bitmaps
+    if ((static_cast<size_t>(slot) < game.SpriteInfos.size()) && (game.SpriteInfos[slot].Flags & SPF_DYNAMICALLOC))
+        release_pooled_bitmap(spriteset.RemoveSprite(slot));
     if (!spriteset.SetSprite(slot, std::move(image), flags))
         return 0; // failed to add the sprite, bad image or realloc failed
     return slot;
@@ -479,7 +595,7 @@ void free_dynamic_sprite(int slot, bool notify_all) {
         (game.SpriteInfos[slot].Flags & SPF_DYNAMICALLOC) == 0)
         return;
 
-    spriteset.DisposeSprite(slot);
+    release_pooled_bitmap(spriteset.RemoveSprite(slot));
     if (notify_all)
         game_sprite_updated(slot, true);
     else
@@ -533,15 +649,27 @@ RuntimeScriptValue Sc_DynamicSprite_GetDrawingSurface(void *self, const RuntimeS
 }
 
 // void (ScriptDynamicSprite *sds, int width, int height)
+RuntimeScriptValue Sc_DynamicSprite_Resize2(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID_PINT2(ScriptDynamicSprite, DynamicSprite_Resize2);
+}
+
+// void (ScriptDynamicSprite *sds, int width, int height, int quality)
 RuntimeScriptValue Sc_DynamicSprite_Resize(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_VOID_PINT2(ScriptDynamicSprite, DynamicSprite_Resize);
+    API_OBJCALL_VOID_PINT3(ScriptDynamicSprite, DynamicSprite_Resize);
 }
 
 // void (ScriptDynamicSprite *sds, int angle, int width, int height)
+RuntimeScriptValue Sc_DynamicSprite_Rotate3(void *self, const RuntimeScriptValue *params, int32_t param_count)
+{
+    API_OBJCALL_VOID_PINT3(ScriptDynamicSprite, DynamicSprite_Rotate3);
+}
+
+// void (ScriptDynamicSprite *sds, int angle, int width, int height, int quality)
 RuntimeScriptValue Sc_DynamicSprite_Rotate(void *self, const RuntimeScriptValue *params, int32_t param_count)
 {
-    API_OBJCALL_VOID_PINT3(ScriptDynamicSprite, DynamicSprite_Rotate);
+    API_OBJCALL_VOID_PINT4(ScriptDynamicSprite, DynamicSprite_Rotate);
 }
 
 // int (ScriptDynamicSprite *sds, const char* namm)
@@ -647,8 +775,10 @@ void RegisterDynamicSpriteAPI()
         { "DynamicSprite::Delete",                    API_FN_PAIR(DynamicSprite_Delete) },
         { "DynamicSprite::Flip^1",                    API_FN_PAIR(DynamicSprite_Flip) },
         { "DynamicSprite::GetDrawingSurface^0",       API_FN_PAIR(DynamicSprite_GetDrawingSurface) },
-        { "DynamicSprite::Resize^2",                  API_FN_PAIR(DynamicSprite_Resize) },
-        { "DynamicSprite::Rotate^3",                  API_FN_PAIR(DynamicSprite_Rotate) },
+        { "DynamicSprite::Resize^2",                  API_FN_PAIR(DynamicSprite_Resize2) },
+        { "DynamicSprite::Resize^3",                  API_FN_PAIR(DynamicSprite_Resize) },
+        { "DynamicSprite::Rotate^3",                  API_FN_PAIR(DynamicSprite_Rotate3) },
+        { "DynamicSprite::Rotate^4",                  API_FN_PAIR(DynamicSprite_Rotate) },
         { "DynamicSprite::SaveToFile^1",              API_FN_PAIR(DynamicSprite_SaveToFile) },
         { "DynamicSprite::Tint^5",                    API_FN_PAIR(DynamicSprite_Tint) },
         { "DynamicSprite::get_ColorDepth",            API_FN_PAIR(DynamicSprite_GetColorDepth) },
@@ -21,18 +21,27 @@
 #include "ac/dynobj/scriptdynamicsprite.h"
 #include "ac/dynobj/scriptdrawingsurface.h"
 
+// Sampling quality of the sprite transforms, matches the script's TransformQuality
+enum TransformQuality
+{
+    kTransform_Nearest  = 0,
+    kTransform_Bilinear = 1
+};
+
 void	DynamicSprite_Delete(ScriptDynamicSprite *sds);
 ScriptDrawingSurface* DynamicSprite_GetDrawingSurface(ScriptDynamicSprite *dss);
 int		DynamicSprite_GetGraphic(ScriptDynamicSprite *sds);
 int		DynamicSprite_GetWidth(ScriptDynamicSprite *sds);
 int		DynamicSprite_GetHeight(ScriptDynamicSprite *sds);
 int		DynamicSprite_GetColorDepth(ScriptDynamicSprite *sds);
-void	DynamicSprite_Resize(ScriptDynamicSprite *sds, int width, int height);
+void	DynamicSprite_Resize2(ScriptDynamicSprite *sds, int width, int height);
+void	DynamicSprite_Resize(ScriptDynamicSprite *sds, int width, int height, int quality);
 void	DynamicSprite_Flip(ScriptDynamicSprite *sds, int direction);
 void	DynamicSprite_CopyTransparencyMask(ScriptDynamicSprite *sds, int sourceSprite);
 void	DynamicSprite_ChangeCanvasSize(ScriptDynamicSprite *sds, int width, int height, int x, int y);
 void	DynamicSprite_Crop(ScriptDynamicSprite *sds, int x1, int y1, int width, int height);
-void	DynamicSprite_Rotate(ScriptDynamicSprite *sds, int angle, int width, int height);
+void	DynamicSprite_Rotate3(ScriptDynamicSprite *sds, int angle, int width, int height);
+void	DynamicSprite_Rotate(ScriptDynamicSprite *sds, int angle, int width, int height, int quality);
 void	DynamicSprite_Tint(ScriptDynamicSprite *sds, int red, int green, int blue, int saturation, int luminance);
 int		DynamicSprite_SaveToFile(ScriptDynamicSprite *sds, const char* namm);
 ScriptDynamicSprite* DynamicSprite_CreateFromSaveGame(int sgslot, int width, int height);
@@ -55,5 +64,7 @@ int     add_dynamic_sprite(std::unique_ptr<AGS::Common::Bitmap> image, bool has_
 int     add_dynamic_sprite(int slot, std::unique_ptr<AGS::Common::Bitmap> image, bool has_alpha = false, uint32_t extra_flags = 0u);
 // Disposes a dynamic sprite, and frees the slot
 void    free_dynamic_sprite(int slot, bool notify_all = true);
+// Stops the threads used by the sprite transforms
+void    shutdown_dynamic_sprite_transforms();
 
 #endif // __AGS_EE_AC__DYNAMICSPRITE_H
@@ -42,6 +42,7 @@
 #include "ac/roomstatus.h"
 #include "ac/sprite.h"
 #include "ac/spritecache.h"
+#include "ac/spriteprecache.h"
 #include "ac/string.h"
 #include "ac/translation.h"
 #include "ac/dynobj/all_dynamicclasses.h"
@@ -503,6 +504,7 @@ void unload_game()
 
     // Reset all resource caches
     // IMPORTANT: this is hard reset, including locked items
+    shutdown_anim_precache();
     spriteset.Reset();
     soundcache_clear();
 }
@@ -46,6 +46,15 @@ enum ScreenRotation
     kNumScreenRotationOptions
 };
 
+// Animation sprites precaching mode
+enum AnimPrecacheMode
+{
+    kAnimPrecache_Off = 0,  // don't precache, load sprites as they are drawn
+    kAnimPrecache_Sync,     // load all loop's sprites when animation starts
+    kAnimPrecache_Thread,   // load loop's sprites on a background thread
+    kNumAnimPrecacheModes
+};
+
 using AGS::Common::String;
 
 // TODO: reconsider the purpose of this struct in the future.
@@ -61,8 +70,11 @@ struct GameSetup
     static const size_t DefSpriteCacheSize = (128 * 1024); // 128 MB
 #endif
     static const size_t DefTexCacheSize = (128 * 1024); // 128 MB
+    static const size_t DefTransformCacheSize = (16 * 1024); // 16 MB
+    static const size_t DefGlyphCacheSize = 1024; // 1 MB
     static const size_t DefSoundLoadAtOnce = 1024; // 1 MB
     static const size_t DefSoundCache = 1024u * 32; // 32 MB
+    static const int DefAnimPrecacheFrames = 32;
 
 
     bool  audio_enabled;
@@ -97,14 +109,29 @@ struct GameSetup
     bool  touch_motion_relative;
     //
     bool  RenderAtScreenRes; // render sprites at screen resolution, as opposed to native one
+    int   RenderThreads = 1; // number of threads for the software renderer, 0 = auto
+    int   SpriteThreads = 1; // number of threads for the dynamic sprite transforms, 0 = auto
+    bool  RenderThread = false; // render and present frames on a separate thread
+    int   FrameDumpInterval = 0; // save every Nth frame with the Null renderer, 0 = never
+    String FrameDumpDir; // where the Null renderer saves frames
+    String FrameProfileFile; // file to record frame phase timings to
+    String InputRecordFile; // file to record player's input to
+    String InputReplayFile; // file to replay player's input from
     size_t SpriteCacheSize = DefSpriteCacheSize; // in KB
     size_t TextureCacheSize = DefTexCacheSize; // in KB
+    size_t TransformCacheSize = DefTransformCacheSize; // transformed sprites cache (software renderer), in KB
+    size_t GlyphCacheSize = DefGlyphCacheSize; // rasterized TTF glyphs cache, in KB
     size_t SoundLoadAtOnceSize = DefSoundLoadAtOnce; // threshold for loading sounds immediately, in KB
     size_t SoundCacheSize = DefSoundCache; // sound cache limit, in KB
+    AnimPrecacheMode AnimPrecache = kAnimPrecache_Off; // animation sprites precaching mode
+    int   AnimPrecacheMaxFrames = DefAnimPrecacheFrames; // max frames in a loop to precache
     bool  clear_cache_on_room_change; // for low-end devices: clear resource caches on room change
+    bool  MemoryMapAssets = false; // map asset packages into memory
+    bool  ParallelStartup = false; // run independent startup stages in parallel
     bool  load_latest_save; // load latest saved game on launch
     ScreenRotation rotation;
     bool  show_fps;
+    bool  PreciseFramePacing = false; // spin for the last part of the frame wait
     bool  multitasking = false; // whether run on background, when game is switched out
 
     DisplayModeSetup Screen;
@@ -29,6 +29,7 @@
 #include "ac/properties.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
+#include "ac/spriteprecache.h"
 #include "ac/string.h"
 #include "ac/viewframe.h"
 #include "ac/dynobj/cc_object.h"
@@ -250,6 +251,7 @@ void AnimateObjectImpl(int obn, int loopn, int spdd, int rept, int direction, in
     debug_script_log("Obj %d start anim view %d loop %d, speed %d, repeat %d, frame %d",
         obn, obj.view + 1, loopn, spdd, rept, sframe);
 
+    precache_anim_loop(obj.view, loopn);
     obj.set_animating(rept, direction == 0, spdd);
     obj.loop = (uint16_t)loopn;
     obj.frame = (uint16_t)SetFirstAnimFrame(obj.view, loopn, sframe, direction);
@@ -0,0 +1,362 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/inputreplay.h"
+#include <algorithm>
+#include <string.h>
+#include <vector>
+#include "ac/timer.h"
+#include "debug/out.h"
+#include "util/file.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+
+extern volatile bool want_exit;
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace InputReplay
+{
+
+static const char *RecordingSig = "AGSInputRecord";
+static const int32_t RecordingVersion = 2;
+// Event type which marks the end of the recording
+static const int32_t EndOfRecording = 0;
+
+static struct ReplayState
+{
+    bool Recording = false;
+    bool Replaying = false;
+    std::unique_ptr<Stream> File;
+    // Current position in the game session
+    uint32_t Frame = 0u;
+    uint32_t Poll = 0u;
+    uint32_t EventCount = 0u;
+    // Next recorded event, read in advance
+    bool HasEvent = false;
+    uint32_t EventFrame = 0u;
+    uint32_t EventPoll = 0u;
+    SDL_Event Event{};
+    // Frame after which the replay ends, valid when EndFrameKnown is set
+    bool EndFrameKnown = false;
+    uint32_t EndFrame = 0u;
+    // Emulated keyboard and key modifiers state
+    Uint8 KeyState[SDL_NUM_SCANCODES]{};
+    SDL_Keymod ModState = KMOD_NONE;
+    // Replay timings
+    AGS_Clock::time_point StartTime;
+    AGS_Clock::time_point FrameTime;
+    std::vector<float> FrameMs;
+} rec;
+
+static void WriteEvent(Stream *out, const SDL_Event &evt)
+{
+    out->WriteInt32(evt.type);
+    switch (evt.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        out->WriteInt32(evt.key.repeat);
+        out->WriteInt32(evt.key.keysym.scancode);
+        out->WriteInt32(evt.key.keysym.sym);
+        out->WriteInt32(evt.key.keysym.mod);
+        break;
+    case SDL_TEXTINPUT:
+        out->Write(evt.text.text, sizeof(evt.text.text));
+        break;
+    case SDL_MOUSEMOTION:
+        out->WriteInt32(evt.motion.which);
+        out->WriteInt32(evt.motion.state);
+        out->WriteInt32(evt.motion.x);
+        out->WriteInt32(evt.motion.y);
+        out->WriteInt32(evt.motion.xrel);
+        out->WriteInt32(evt.motion.yrel);
+        break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        out->WriteInt32(evt.button.which);
+        out->WriteInt32(evt.button.button);
+        out->WriteInt32(evt.button.clicks);
+        out->WriteInt32(evt.button.x);
+        out->WriteInt32(evt.button.y);
+        break;
+    case SDL_MOUSEWHEEL:
+        out->WriteInt32(evt.wheel.which);
+        out->WriteInt32(evt.wheel.x);
+        out->WriteInt32(evt.wheel.y);
+        out->WriteInt32(evt.wheel.direction);
+        break;
+    default:
+        break;
+    }
+}
+
+static bool ReadEvent(Stream *in, SDL_Event &evt)
+{
+    evt = {};
+    evt.type = in->ReadInt32();
+    switch (evt.type)
+    {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        evt.key.state = (evt.type == SDL_KEYDOWN) ? SDL_PRESSED : SDL_RELEASED;
+        evt.key.repeat = in->ReadInt32();
+        evt.key.keysym.scancode = static_cast<SDL_Scancode>(in->ReadInt32());
+        evt.key.keysym.sym = in->ReadInt32();
+        evt.key.keysym.mod = in->ReadInt32();
+        return true;
+    case SDL_TEXTINPUT:
+        in->Read(evt.text.text, sizeof(evt.text.text));
+        evt.text.text[sizeof(evt.text.text) - 1] = 0;
+        return true;
+    case SDL_MOUSEMOTION:
+        evt.motion.which = in->ReadInt32();
+        evt.motion.state = in->ReadInt32();
+        evt.motion.x = in->ReadInt32();
+        evt.motion.y = in->ReadInt32();
+        evt.motion.xrel = in->ReadInt32();
+        evt.motion.yrel = in->ReadInt32();
+        return true;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        evt.button.state = (evt.type == SDL_MOUSEBUTTONDOWN) ? SDL_PRESSED : SDL_RELEASED;
+        evt.button.which = in->ReadInt32();
+        evt.button.button = in->ReadInt32();
+        evt.button.clicks = in->ReadInt32();
+        evt.button.x = in->ReadInt32();
+        evt.button.y = in->ReadInt32();
+        return true;
+    case SDL_MOUSEWHEEL:
+        evt.wheel.which = in->ReadInt32();
+        evt.wheel.x = in->ReadInt32();
+        evt.wheel.y = in->ReadInt32();
+        evt.wheel.direction = in->ReadInt32();
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Reads the next recorded event, or the end of recording
+static void ReadNextEvent()
+{
+    rec.HasEvent = false;
+    if (rec.EndFrameKnown)
+        return;
+    const uint32_t frame = static_cast<uint32_t>(rec.File->ReadInt32());
+    const uint32_t poll = static_cast<uint32_t>(rec.File->ReadInt32());
+    if (rec.File->EOS())
+    {
+        // the recording was not finished properly, stop after the last event
+        rec.EndFrameKnown = true;
+        rec.EndFrame = rec.EventFrame;
+        return;
+    }
+    SDL_Event evt;
+    if (!ReadEvent(rec.File.get(), evt))
+    {
+        if (evt.type != EndOfRecording)
+            Debug::Printf(kDbgMsg_Error, "Input replay: unknown event type %u, stopping at frame %u", evt.type, frame);
+        rec.EndFrameKnown = true;
+        rec.EndFrame = frame;
+        return;
+    }
+    rec.HasEvent = true;
+    rec.EventFrame = frame;
+    rec.EventPoll = poll;
+    rec.Event = evt;
+}
+
+static bool OpenRecording(const String &filename, bool write)
+{
+    Stop();
+    rec = ReplayState();
+    rec.File = write ? File::CreateFile(filename) : File::OpenFileRead(filename);
+    if (!rec.File)
+    {
+        Debug::Printf(kDbgMsg_Error, "Input replay: failed to open file: %s", filename.GetCStr());
+        return false;
+    }
+    return true;
+}
+
+bool StartRecording(const String &filename, int game_uid, int rand_seed)
+{
+    if (!OpenRecording(filename, true))
+        return false;
+    rec.File->Write(RecordingSig, strlen(RecordingSig));
+    rec.File->WriteInt32(RecordingVersion);
+    rec.File->WriteInt32(game_uid);
+    rec.File->WriteInt32(rand_seed);
+    // lock keys may be already on, which is not told by any key event
+    rec.File->WriteInt32(SDL_GetModState());
+    rec.Recording = true;
+    Debug::Printf(kDbgMsg_Info, "Input replay: recording input to %s", filename.GetCStr());
+    return true;
+}
+
+bool StartReplay(const String &filename, int game_uid, int &rand_seed)
+{
+    if (!OpenRecording(filename, false))
+        return false;
+    char sig[16]{};
+    rec.File->Read(sig, strlen(RecordingSig));
+    const int32_t version = rec.File->ReadInt32();
+    if ((strcmp(sig, RecordingSig) != 0) || (version != RecordingVersion))
+    {
+        Debug::Printf(kDbgMsg_Error, "Input replay: not a supported input recording: %s", filename.GetCStr());
+        rec.File.reset();
+        return false;
+    }
+    const int32_t rec_game_uid = rec.File->ReadInt32();
+    if (rec_game_uid != game_uid)
+        Debug::Printf(kDbgMsg_Warn, "Input replay: the recording was made with a different game (uid %d, expected %d)",
+            rec_game_uid, game_uid);
+    rand_seed = rec.File->ReadInt32();
+    rec.ModState = static_cast<SDL_Keymod>(rec.File->ReadInt32());
+    ReadNextEvent();
+    rec.Replaying = true;
+    rec.StartTime = AGS_Clock::now();
+    rec.FrameTime = rec.StartTime;
+    Debug::Printf(kDbgMsg_Info, "Input replay: replaying input from %s", filename.GetCStr());
+    return true;
+}
+
+// Gets the value at the given percentile, using nearest rank
+static float Percentile(const std::vector<float> &sorted, float pc)
+{
+    const size_t index = static_cast<size_t>(pc * (sorted.size() - 1) / 100.f + 0.5f);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static void PrintReport()
+{
+    const float total_ms = std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(
+        AGS_Clock::now() - rec.StartTime).count();
+    Debug::Printf(kDbgMsg_Info, "Input replay: %u frames, %u events, total time %.3f s, average %.2f fps",
+        rec.Frame, rec.EventCount, total_ms / 1000.f, total_ms > 0.f ? rec.Frame * 1000.f / total_ms : 0.f);
+    if (rec.FrameMs.empty())
+        return;
+    auto &values = rec.FrameMs;
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (float v : values)
+        sum += v;
+    Debug::Printf(kDbgMsg_Info, "Input replay: frame time (ms): avg %.2f, p50 %.2f, p90 %.2f, p95 %.2f, p99 %.2f, max %.2f",
+        sum / values.size(), Percentile(values, 50.f), Percentile(values, 90.f),
+        Percentile(values, 95.f), Percentile(values, 99.f), values.back());
+}
+
+void Stop()
+{
+    if (rec.Recording)
+    {
+        rec.File->WriteInt32(rec.Frame);
+        rec.File->WriteInt32(rec.Poll);
+        rec.File->WriteInt32(EndOfRecording);
+        Debug::Printf(kDbgMsg_Info, "Input replay: recorded %u frames, %u events", rec.Frame, rec.EventCount);
+    }
+    else if (rec.Replaying)
+    {
+        if (rec.HasEvent || !rec.EndFrameKnown || (rec.Frame < rec.EndFrame))
+            Debug::Printf(kDbgMsg_Warn, "Input replay: stopped before the end of recording");
+        PrintReport();
+    }
+    rec.File.reset();
+    rec.Recording = false;
+    rec.Replaying = false;
+    rec.FrameMs.clear();
+}
+
+bool IsRecording()
+{
+    return rec.Recording;
+}
+
+bool IsReplaying()
+{
+    return rec.Replaying;
+}
+
+void NextFrame()
+{
+    if (!rec.Recording && !rec.Replaying)
+        return;
+    rec.Frame++;
+    rec.Poll = 0u;
+    if (!rec.Replaying)
+        return;
+
+    const auto now = AGS_Clock::now();
+    rec.FrameMs.push_back(std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(now - rec.FrameTime).count());
+    rec.FrameTime = now;
+    if (rec.EndFrameKnown && (rec.Frame >= rec.EndFrame) && !want_exit)
+    {
+        Debug::Printf(kDbgMsg_Info, "Input replay: reached the end of recording, quitting");
+        want_exit = true;
+    }
+}
+
+void NextPoll()
+{
+    rec.Poll++;
+}
+
+void RecordEvent(const SDL_Event &evt)
+{
+    if (!rec.Recording)
+        return;
+    rec.File->WriteInt32(rec.Frame);
+    rec.File->WriteInt32(rec.Poll);
+    WriteEvent(rec.File.get(), evt);
+    rec.EventCount++;
+}
+
+bool GetNextEvent(SDL_Event &evt)
+{
+    if (!rec.Replaying || !rec.HasEvent)
+        return false;
+    // events are due when we have reached their frame and poll, or if we have
+    // passed their frame, which may happen if the number of polls differ
+    if ((rec.EventFrame > rec.Frame) || ((rec.EventFrame == rec.Frame) && (rec.EventPoll > rec.Poll)))
+        return false;
+    evt = rec.Event;
+    if (((evt.type == SDL_KEYDOWN) || (evt.type == SDL_KEYUP)) &&
+        (evt.key.keysym.scancode >= 0) && (evt.key.keysym.scancode < SDL_NUM_SCANCODES))
+        rec.KeyState[evt.key.keysym.scancode] = (evt.type == SDL_KEYDOWN);
+    // key events tell the modifiers state after the key was handled
+    if ((evt.type == SDL_KEYDOWN) || (evt.type == SDL_KEYUP))
+        rec.ModState = static_cast<SDL_Keymod>(evt.key.keysym.mod);
+    rec.EventCount++;
+    ReadNextEvent();
+    return true;
+}
+
+const Uint8 *GetKeyboardState()
+{
+    return rec.KeyState;
+}
+
+SDL_Keymod GetModState()
+{
+    return rec.ModState;
+}
+
+} // namespace InputReplay
+
+} // namespace Engine
+} // namespace AGS
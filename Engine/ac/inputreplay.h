@@ -0,0 +1,76 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// InputReplay records the player's input events into a file, and plays
+// them back later, for running the same game session repeatedly, e.g. when
+// comparing the engine performance between builds.
+//
+// Each event is saved along with the number of the game frame, and the
+// number of the event poll within that frame, at which it was received.
+// The replay passes the events to the engine at the same frame and poll,
+// ignoring the real player's input, and starts the game with the recorded
+// random seed. Since the game logic is updated in fixed steps per frame,
+// this reproduces the recorded session, as long as the game does not
+// depend on the real time (e.g. waits for the audio clip's end).
+//
+// The replay runs with the frame limiter disabled, and quits the game after
+// the last recorded frame, printing the total time and the frame times
+// distribution into the log.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__INPUTREPLAY_H
+#define __AGS_EE_AC__INPUTREPLAY_H
+
+#include <SDL_events.h>
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace InputReplay
+{
+    // Starts recording the input into the given file; saves the game's
+    // unique id and the random seed used for this session
+    bool StartRecording(const Common::String &filename, int game_uid, int rand_seed);
+    // Starts replaying the input from the given file; on success
+    // assigns the random seed which must be used for this session
+    bool StartReplay(const Common::String &filename, int game_uid, int &rand_seed);
+    // Stops recording or replaying, closes the file; prints the replay report
+    void Stop();
+    // Tells if the input is being recorded or replayed right now
+    bool IsRecording();
+    bool IsReplaying();
+
+    // Marks the start of the next game frame
+    void NextFrame();
+    // Marks the start of the next event poll
+    void NextPoll();
+    // Saves the player's input event
+    void RecordEvent(const SDL_Event &evt);
+    // Gets the next recorded event which is due at the current poll;
+    // returns false if there are none
+    bool GetNextEvent(SDL_Event &evt);
+    // Gets the keyboard state, made by the replayed key events
+    const Uint8 *GetKeyboardState();
+    // Gets the key modifiers state, starting with the one recorded at the
+    // beginning, and updated by the replayed key events
+    SDL_Keymod GetModState();
+} // namespace InputReplay
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_AC__INPUTREPLAY_H
@@ -0,0 +1,245 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "ac/spriteprecache.h"
+#include <vector>
+#if !defined(AGS_DISABLE_THREADS)
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#endif
+#include "ac/draw.h"
+#include "ac/game.h"
+#include "ac/gamesetup.h"
+#include "ac/gamesetupstruct.h"
+#include "ac/spritecache.h"
+#include "ac/view.h"
+#include "core/assetmanager.h"
+#include "debug/out.h"
+#include "gfx/bitmap.h"
+#include "util/memory_compat.h"
+
+using namespace AGS::Common;
+
+extern GameSetupStruct game;
+extern SpriteCache spriteset;
+extern std::vector<ViewStruct> views;
+
+
+#if !defined(AGS_DISABLE_THREADS)
+
+// AnimSpriteLoader reads sprites from its own sprite file stream
+// on a background thread.
+class AnimSpriteLoader
+{
+public:
+    typedef std::pair<sprkey_t, std::unique_ptr<Bitmap>> LoadedSprite;
+
+    ~AnimSpriteLoader() { Stop(); }
+
+    HError Start();
+    void   Stop();
+    // Schedules the sprite for loading
+    void   Request(sprkey_t index);
+    // Retrieves all the sprites loaded so far; failed sprites are reported
+    // with a null bitmap
+    void   GetLoaded(std::vector<LoadedSprite> &loaded);
+
+private:
+    void   Run();
+
+    SpriteFile _file;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    std::deque<sprkey_t> _requests;
+    std::vector<LoadedSprite> _loaded;
+    bool _stop = false;
+};
+
+HError AnimSpriteLoader::Start()
+{
+    auto sprite_file = AssetMgr->OpenAsset(SpriteFile::DefaultSpriteFileName);
+    if (!sprite_file)
+        return new Error(String::FromFormat("Failed to open spriteset file '%s'.",
+            SpriteFile::DefaultSpriteFileName.GetCStr()));
+    auto index_file = AssetMgr->OpenAsset(SpriteFile::DefaultSpriteIndexName);
+    std::vector<Size> metrics;
+    HError err = _file.OpenFile(std::move(sprite_file), std::move(index_file), metrics);
+    if (!err)
+        return err;
+    _stop = false;
+    _thread = std::thread(&AnimSpriteLoader::Run, this);
+    return HError::None();
+}
+
+void AnimSpriteLoader::Stop()
+{
+    if (_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            _stop = true;
+        }
+        _cond.notify_one();
+        _thread.join();
+    }
+    _requests.clear();
+    _loaded.clear();
+    _file.Close();
+}
+
+void AnimSpriteLoader::Request(sprkey_t index)
+{
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _requests.push_back(index);
+    }
+    _cond.notify_one();
+}
+
+void AnimSpriteLoader::GetLoaded(std::vector<LoadedSprite> &loaded)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    for (auto &spr : _loaded)
+        loaded.push_back(std::move(spr));
+    _loaded.clear();
+}
+
+void AnimSpriteLoader::Run()
+{
+    for (;;)
+    {
+        sprkey_t index;
+        {
+            std::unique_lock<std::mutex> lk(_mutex);
+            _cond.wait(lk, [this]() { return _stop || !_requests.empty(); });
+            if (_stop)
+                return;
+            index = _requests.front();
+            _requests.pop_front();
+        }
+
+        Bitmap *image = nullptr;
+        _file.LoadSprite(index, image);
+
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            _loaded.emplace_back(index, std::unique_ptr<Bitmap>(image));
+        }
+    }
+}
+
+
+static std::unique_ptr<AnimSpriteLoader> anim_loader;
+// Sprites requested from the loader which have not been received yet
+static std::unordered_set<sprkey_t> anim_pending;
+
+#endif // !AGS_DISABLE_THREADS
+
+HError init_anim_precache()
+{
+    shutdown_anim_precache();
+#if !defined(AGS_DISABLE_THREADS)
+    if (usetup.AnimPrecache != kAnimPrecache_Thread)
+        return HError::None();
+    auto loader = std::make_unique<AnimSpriteLoader>();
+    HError err = loader->Start();
+    if (!err)
+        return err;
+    anim_loader = std::move(loader);
+    Debug::Printf("Animation precache: background loading enabled");
+#endif
+    return HError::None();
+}
+
+void shutdown_anim_precache()
+{
+#if !defined(AGS_DISABLE_THREADS)
+    anim_loader.reset();
+    anim_pending.clear();
+#endif
+}
+
+void precache_anim_loop(int view, int loop)
+{
+    if ((usetup.AnimPrecache == kAnimPrecache_Off) || (usetup.AnimPrecacheMaxFrames <= 0))
+        return;
+    if ((view < 0) || (static_cast<size_t>(view) >= views.size()) ||
+        (loop < 0) || (loop >= views[view].numLoops))
+        return;
+
+    // Gather the frames of this loop, and all the loops it continues into;
+    // skip the loops that are too long to be worth loading in advance
+    auto &vw = views[view];
+    int last_loop = loop;
+    int total_frames = vw.loops[loop].numFrames;
+    for (; vw.loops[last_loop].RunNextLoop() && (last_loop + 1 < vw.numLoops); ++last_loop)
+        total_frames += vw.loops[last_loop + 1].numFrames;
+    if (total_frames > usetup.AnimPrecacheMaxFrames)
+        return;
+
+    // Don't let a single loop push out most of the cache
+    const size_t bpp = (game.GetColorDepth() + 7) / 8;
+    size_t est_size = 0;
+    for (int l = loop; l <= last_loop; ++l)
+    {
+        for (int f = 0; f < vw.loops[l].numFrames; ++f)
+        {
+            const int pic = vw.loops[l].frames[f].pic;
+            if (spriteset.IsAssetSprite(pic) && !spriteset.IsSpriteLoaded(pic))
+                est_size += game.SpriteInfos[pic].Width * game.SpriteInfos[pic].Height * bpp;
+        }
+    }
+    if (est_size == 0 || est_size > spriteset.GetMaxCacheSize() / 2)
+        return;
+
+    for (int l = loop; l <= last_loop; ++l)
+    {
+        for (int f = 0; f < vw.loops[l].numFrames; ++f)
+        {
+            const int pic = vw.loops[l].frames[f].pic;
+            if (!spriteset.IsAssetSprite(pic) || spriteset.IsSpriteLoaded(pic))
+                continue;
+#if !defined(AGS_DISABLE_THREADS)
+            if (anim_loader)
+            {
+                if (anim_pending.insert(pic).second)
+                    anim_loader->Request(pic);
+                continue;
+            }
+#endif
+            spriteset.PrecacheSprite(pic);
+            texturecache_precache(pic);
+        }
+    }
+}
+
+void update_anim_precache()
+{
+#if !defined(AGS_DISABLE_THREADS)
+    if (!anim_loader || anim_pending.empty())
+        return;
+    std::vector<AnimSpriteLoader::LoadedSprite> loaded;
+    anim_loader->GetLoaded(loaded);
+    for (auto &spr : loaded)
+    {
+        anim_pending.erase(spr.first);
+        // A failed sprite will be dealt with by the cache when it's used
+        if (spr.second && spriteset.SetPreloadedSprite(spr.first, std::move(spr.second)))
+            texturecache_precache(spr.first);
+    }
+#endif
+}
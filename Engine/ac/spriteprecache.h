@@ -0,0 +1,44 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Animation sprite precaching.
+//
+// When a character or object starts an animation or a walk, the sprites of
+// the whole loop are requested in advance, so that the following frames do
+// not stall on loading from the sprite file one by one.
+//
+// In "sync" mode the loop's sprites are loaded right away. In "thread" mode
+// they are read and decoded on a background thread, using a separate sprite
+// file stream, because the SpriteCache itself is not thread-safe; the ready
+// images are passed to the cache on the main thread by update_anim_precache().
+// If the sprite is required for drawing before its preloaded image arrives,
+// it's loaded by the cache as usual, and the late image is discarded.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__SPRITEPRECACHE_H
+#define __AGS_EE_AC__SPRITEPRECACHE_H
+
+#include "util/error.h"
+
+// Starts the animation precacher, in accordance to the game setup;
+// must be called after the game's sprite file was opened.
+AGS::Common::HError init_anim_precache();
+// Stops the background loading, and disposes any pending requests
+void shutdown_anim_precache();
+// Requests precaching of all the frames of the given view loop
+void precache_anim_loop(int view, int loop);
+// Passes any sprites that were loaded in the background to the sprite cache
+void update_anim_precache();
+
+#endif // __AGS_EE_AC__SPRITEPRECACHE_H
@@ -20,6 +20,7 @@
 #include "ac/common.h"
 #include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
+#include "ac/inputreplay.h"
 #include "ac/keycode.h"
 #include "ac/mouse.h"
 #include "ac/timer.h"
@@ -302,6 +303,9 @@ bool ags_key_to_sdl_scan(eAGSKeyCode key, SDL_Scancode(&scan)[3])
 // Because our game engine still uses input polling, we have to accumulate
 // input events for our internal use whenever engine have to query player input.
 static std::deque<SDL_Event> g_inputEvtQueue;
+// Window ID assigned to the input events simulated by the engine,
+// which lets to tell them apart from the real player's input
+static const Uint32 SimulatedEventWindowID = UINT32_MAX;
 
 int sys_modkeys = 0; // saved accumulated key mods
 bool sys_modkeys_fired = false; // saved mod key combination already fired
@@ -344,11 +348,24 @@ int ags_iskeydown(eAGSKeyCode ags_key)
     if (game.options[OPT_KEYHANDLEAPI] == 0)
         SDL_PumpEvents();
 
-    const Uint8 *state = SDL_GetKeyboardState(NULL);
     SDL_Scancode scan[3];
     if (!ags_key_to_sdl_scan(ags_key, scan))
         return 0;
-    return (state[scan[0]] || state[scan[1]] || state[scan[2]]);
+    return ags_isscancodedown(scan[0]) || ags_isscancodedown(scan[1]) || ags_isscancodedown(scan[2]);
+}
+
+bool ags_isscancodedown(SDL_Scancode scan)
+{
+    // input replay emulates the keyboard state, real keys are ignored
+    const Uint8 *state = InputReplay::IsReplaying() ?
+        InputReplay::GetKeyboardState() : SDL_GetKeyboardState(NULL);
+    return state[scan] != 0;
+}
+
+SDL_Keymod ags_get_modstate()
+{
+    return InputReplay::IsReplaying() ?
+        InputReplay::GetModState() : SDL_GetModState();
 }
 
 void ags_simulate_keypress(eAGSKeyCode ags_key)
@@ -359,6 +376,7 @@ void ags_simulate_keypress(eAGSKeyCode ags_key)
     // Push a key event to the event queue; note that this won't affect the key states array
     SDL_Event sdlevent = {};
     sdlevent.type = SDL_KEYDOWN;
+    sdlevent.key.windowID = SimulatedEventWindowID;
     sdlevent.key.keysym.sym = SDL_GetKeyFromScancode(scan[0]);
     sdlevent.key.keysym.scancode = scan[0];
     SDL_PushEvent(&sdlevent);
@@ -464,6 +482,7 @@ void ags_simulate_mouseclick(eAGSMouseButton but)
 {
     SDL_Event sdlevent = {};
     sdlevent.type = SDL_MOUSEBUTTONDOWN;
+    sdlevent.button.windowID = SimulatedEventWindowID;
     sdlevent.button.button = ags_button_to_sdl(but);
     sdlevent.button.x = sys_mouse_x; // CHECKME later if this is okay...
     sdlevent.button.y = sys_mouse_y;
@@ -1054,9 +1073,40 @@ void sys_evt_process_one(const SDL_Event &event) {
     }
 }
 
+// Tells if this is the input event made by the player (not simulated by the engine)
+static bool is_player_input_event(const SDL_Event &event) {
+    switch (event.type) {
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        return event.key.windowID != SimulatedEventWindowID;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+        return event.button.windowID != SimulatedEventWindowID;
+    case SDL_TEXTINPUT:
+    case SDL_MOUSEMOTION:
+    case SDL_MOUSEWHEEL:
+    case SDL_FINGERDOWN:
+    case SDL_FINGERUP:
+    case SDL_FINGERMOTION:
+        return true;
+    default:
+        return false;
+    }
+}
+
 void sys_evt_process_pending(void) {
+    InputReplay::NextPoll();
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
+        if (InputReplay::IsReplaying() && is_player_input_event(event))
+            continue; // real input is ignored during replay
+        // touches are not recorded, only the mouse events emulated by them
+        if (InputReplay::IsRecording() && is_player_input_event(event) &&
+            (event.type < SDL_FINGERDOWN || event.type > SDL_FINGERMOTION))
+            InputReplay::RecordEvent(event);
+        sys_evt_process_one(event);
+    }
+    while (InputReplay::GetNextEvent(event)) {
         sys_evt_process_one(event);
     }
 }
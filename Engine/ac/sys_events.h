@@ -88,6 +88,10 @@ SDL_Event ags_get_next_inputevent();
 // Tells if the key is currently down, provided AGS key.
 // NOTE: for particular script codes this function returns positive if either of two keys are down.
 int ags_iskeydown(eAGSKeyCode ags_key);
+// Tells if the key is currently down, provided SDL scancode
+bool ags_isscancodedown(SDL_Scancode scan);
+// Gets the current state of the key modifiers, including lock keys
+SDL_Keymod ags_get_modstate();
 // Simulates key press with the given AGS key
 void ags_simulate_keypress(eAGSKeyCode ags_key);
 
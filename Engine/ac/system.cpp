@@ -14,6 +14,7 @@
 #include <SDL.h>
 #include "ac/common.h"
 #include "ac/draw.h"
+#include "ac/draw_software.h"
 #include "ac/dynobj/cc_audiochannel.h"
 #include "ac/game.h"
 #include "ac/gamesetup.h"
@@ -25,6 +26,7 @@
 #include "ac/spritecache.h"
 #include "ac/string.h"
 #include "ac/system.h"
+#include "ac/sys_events.h"
 #include "ac/dynobj/scriptsystem.h"
 #include "debug/debug_log.h"
 #include "debug/out.h"
@@ -111,20 +113,19 @@ int System_GetHardwareAcceleration()
 
 int System_GetNumLock()
 {
-    SDL_Keymod mod_state = SDL_GetModState();
+    SDL_Keymod mod_state = ags_get_modstate();
     return (mod_state & KMOD_NUM) ? 1 : 0;
 }
 
 int System_GetCapsLock()
 {
-    SDL_Keymod mod_state = SDL_GetModState();
+    SDL_Keymod mod_state = ags_get_modstate();
     return (mod_state & KMOD_CAPS) ? 1 : 0;
 }
 
 int System_GetScrollLock()
 {
-    const Uint8 *state = SDL_GetKeyboardState(NULL);
-    return (state[SDL_SCANCODE_SCROLLLOCK]) ? 1 : 0;
+    return ags_isscancodedown(SDL_SCANCODE_SCROLLLOCK) ? 1 : 0;
 }
 
 int System_GetVsync() {
@@ -269,6 +270,16 @@ bool GetEngineInteger(int &value, EngineValueID value_id, int index)
         value = std::isnan(fps) ? -1 : static_cast<int>(std::round(fps));
         return true;
     }
+    case ENGINE_VALUE_I_RENDER_SPRITES:
+        value = gfxDriver ? static_cast<int>(gfxDriver->GetRenderStats().Sprites) : 0; return true;
+    case ENGINE_VALUE_I_RENDER_DRAWCALLS:
+        value = gfxDriver ? static_cast<int>(gfxDriver->GetRenderStats().DrawCalls) : 0; return true;
+    case ENGINE_VALUE_I_RENDER_PIXELS_REDRAWN:
+        value = static_cast<int>(get_invalidrects_pixels_redrawn()); return true;
+    case ENGINE_VALUE_I_RENDER_GUI_CONTROLS_REDRAWN:
+        value = static_cast<int>(get_gui_controls_redrawn()); return true;
+    case ENGINE_VALUE_I_BITMAP_ALLOCS:
+        value = static_cast<int>(get_bitmap_pool_allocations()); return true;
     default: return false;
     }
 }
@@ -333,6 +344,11 @@ String GetEngineValueName(EngineValueID value_id)
     case ENGINE_VALUE_I_TEXCACHE_NORMAL: return "Texture cache: normal size (KB)";
     case ENGINE_VALUE_I_FPS_MAX: return "FPS cap";
     case ENGINE_VALUE_I_FPS: return "FPS real";
+    case ENGINE_VALUE_I_RENDER_SPRITES: return "Render: sprites per frame";
+    case ENGINE_VALUE_I_RENDER_DRAWCALLS: return "Render: draw calls per frame";
+    case ENGINE_VALUE_I_RENDER_PIXELS_REDRAWN: return "Render: background pixels redrawn per frame";
+    case ENGINE_VALUE_I_RENDER_GUI_CONTROLS_REDRAWN: return "Render: GUI controls redrawn per frame";
+    case ENGINE_VALUE_I_BITMAP_ALLOCS: return "Bitmap allocations per frame";
     default: return "";
     }
 }
@@ -67,6 +67,11 @@ enum EngineValueID
     ENGINE_VALUE_I_TEXCACHE_NORMAL,
     ENGINE_VALUE_I_FPS_MAX,
     ENGINE_VALUE_I_FPS,
+    ENGINE_VALUE_I_RENDER_SPRITES,
+    ENGINE_VALUE_I_RENDER_DRAWCALLS,
+    ENGINE_VALUE_I_RENDER_PIXELS_REDRAWN,  // software renderer only
+    ENGINE_VALUE_I_RENDER_GUI_CONTROLS_REDRAWN,
+    ENGINE_VALUE_I_BITMAP_ALLOCS,
     ENGINE_VALUE_LAST                      // in case user wants to iterate them
 };
 
@@ -13,8 +13,11 @@
 //=============================================================================
 #include "ac/timer.h"
 #include "core/platform.h"
+#include <algorithm>
 #include <thread>
+#include "ac/inputreplay.h"
 #include "ac/sys_events.h"
+#include "debug/out.h"
 #include "platform/base/agsplatformdriver.h"
 #if defined(AGS_DISABLE_THREADS)
 #include "media/audio/audio_core.h"
@@ -33,15 +36,77 @@ const auto MAXIMUM_FALL_BEHIND = 3; // number of full frames
 auto tick_duration = std::chrono::microseconds(1000000LL/40);
 auto framerate = 0;
 auto framerate_maxed = false;
+auto framerate_unlimited = false; // maxed regardless of the game's fps
 
 auto last_tick_time = AGS_Clock::now();
 auto next_frame_timestamp = AGS_Clock::now();
 
+// Precise frame pacing: the time left to spin after the coarse sleep;
+// adapts to the sleep overshoot, which depends on the system.
+auto precise_pacing = false;
+#if !AGS_PLATFORM_OS_EMSCRIPTEN
+const auto MIN_SPIN_MARGIN = std::chrono::microseconds(200);
+const auto MAX_SPIN_MARGIN = std::chrono::microseconds(4000);
+auto spin_margin = std::chrono::microseconds(1000);
+#endif
+
+// Frame start lateness of the recent frames, in ms
+const size_t RECENT_FRAMES = 256;
+float recent_lateness[RECENT_FRAMES];
+size_t recent_count = 0u;
+#if !AGS_PLATFORM_OS_EMSCRIPTEN
+size_t recent_pos = 0u;
+#endif
+// Histogram of frame start lateness for the whole session,
+// the last bucket counts everything past the range
+const int HISTOGRAM_STEP_US = 50;
+const int HISTOGRAM_BUCKETS = 400; // up to 20 ms
+uint32_t session_histogram[HISTOGRAM_BUCKETS + 1];
+uint32_t session_frames = 0u;
+float session_max = 0.f;
+
 }
 
+#if !AGS_PLATFORM_OS_EMSCRIPTEN
+// Sleeps until shortly before the given time, and spins for the rest
+static void WaitPrecise(const AGS_Clock::time_point &target)
+{
+    const auto remaining = target - AGS_Clock::now();
+    if (remaining > spin_margin) {
+        const auto wake_time = target - spin_margin;
+        std::this_thread::sleep_for(remaining - spin_margin);
+        // Adapt the spin time: grow fast if we woke up too late,
+        // and shrink slowly while the sleep is accurate
+        const auto overshoot = std::chrono::duration_cast<std::chrono::microseconds>(AGS_Clock::now() - wake_time);
+        const auto want_margin = overshoot + overshoot / 4 + MIN_SPIN_MARGIN;
+        if (want_margin > spin_margin)
+            spin_margin = want_margin;
+        else
+            spin_margin -= (spin_margin - want_margin) / 64;
+        spin_margin = std::min(std::max(spin_margin, MIN_SPIN_MARGIN), MAX_SPIN_MARGIN);
+    }
+
+    while (AGS_Clock::now() < target) {
+        std::this_thread::yield();
+    }
+}
+
+static void RecordFrameLateness(const AGS_Clock::duration &lateness)
+{
+    const auto us = std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(lateness).count());
+    const float ms = us / 1000.f;
+    recent_lateness[recent_pos] = ms;
+    recent_pos = (recent_pos + 1) % RECENT_FRAMES;
+    recent_count = std::min(recent_count + 1, RECENT_FRAMES);
+    session_histogram[std::min<int64_t>(us / HISTOGRAM_STEP_US, HISTOGRAM_BUCKETS)]++;
+    session_frames++;
+    session_max = std::max(session_max, ms);
+}
+#endif // !AGS_PLATFORM_OS_EMSCRIPTEN
+
 std::chrono::microseconds GetFrameDuration()
 {
-    if (framerate_maxed) {
+    if (framerate_maxed || framerate_unlimited) {
         return std::chrono::microseconds(0);
     }
     return tick_duration;
@@ -66,8 +131,20 @@ bool isTimerFpsMaxed()
     return framerate_maxed;
 }
 
+void setTimerFpsUnlimited(bool on)
+{
+    framerate_unlimited = on;
+}
+
+void setTimerPrecisePacing(bool on)
+{
+    precise_pacing = on;
+}
+
 void WaitForNextFrame()
 {
+    AGS::Engine::InputReplay::NextFrame();
+
     // Do the last polls on this frame, if necessary
 #if defined(AGS_DISABLE_THREADS)
     audio_core_entry_poll();
@@ -100,7 +177,11 @@ void WaitForNextFrame()
         // pass the time as negative in Emscripten Platform Driver
         platform->Delay(-std::chrono::duration_cast<std::chrono::milliseconds>(frame_time_remaining).count());
 #else
-        std::this_thread::sleep_for(frame_time_remaining);
+        if (precise_pacing)
+            WaitPrecise(next_frame_timestamp);
+        else
+            std::this_thread::sleep_for(frame_time_remaining);
+        RecordFrameLateness(AGS_Clock::now() - next_frame_timestamp);
 #endif
     }
 
@@ -119,3 +200,55 @@ void skipMissedTicks()
     last_tick_time = AGS_Clock::now();
     next_frame_timestamp = AGS_Clock::now();
 }
+
+// Gets the value at the given percentile of the histogram, in ms
+static float HistogramPercentile(float pc)
+{
+    const uint32_t rank = static_cast<uint32_t>(pc * (session_frames - 1) / 100.f + 0.5f);
+    uint32_t count = 0u;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        count += session_histogram[i];
+        if (count > rank)
+            return (i + 1) * HISTOGRAM_STEP_US / 1000.f; // upper bound of the bucket
+    }
+    return session_max;
+}
+
+FramePacingStats getFramePacingStats(bool whole_session)
+{
+    FramePacingStats stats;
+    if (whole_session) {
+        if (session_frames == 0u)
+            return stats;
+        stats.Frames = session_frames;
+        stats.P50 = HistogramPercentile(50.f);
+        stats.P90 = HistogramPercentile(90.f);
+        stats.P99 = HistogramPercentile(99.f);
+        stats.Max = session_max;
+        return stats;
+    }
+
+    if (recent_count == 0u)
+        return stats;
+    float sorted[RECENT_FRAMES];
+    std::copy(recent_lateness, recent_lateness + recent_count, sorted);
+    std::sort(sorted, sorted + recent_count);
+    auto percentile = [&sorted](float pc)
+        { return sorted[std::min(static_cast<size_t>(pc * (recent_count - 1) / 100.f + 0.5f), recent_count - 1)]; };
+    stats.Frames = static_cast<uint32_t>(recent_count);
+    stats.P50 = percentile(50.f);
+    stats.P90 = percentile(90.f);
+    stats.P99 = percentile(99.f);
+    stats.Max = sorted[recent_count - 1];
+    return stats;
+}
+
+void printFramePacingStats()
+{
+    const auto stats = getFramePacingStats(true);
+    if (stats.Frames == 0u)
+        return;
+    AGS::Common::Debug::Printf(AGS::Common::kDbgMsg_Info,
+        "Frame pacing (%s): %u frames waited, start lateness (ms): p50 %.2f, p90 %.2f, p99 %.2f, max %.2f",
+        precise_pacing ? "precise" : "sleep", stats.Frames, stats.P50, stats.P90, stats.P99, stats.Max);
+}
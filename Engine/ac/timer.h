@@ -42,7 +42,29 @@ extern void WaitForNextFrame();
 extern int setTimerFps(int new_fps);
 // Tells whether maxed FPS mode is currently set
 extern bool isTimerFpsMaxed();
+// Disables frame waiting regardless of the game speed, without changing
+// the speed reported to the game; used for benchmarking
+extern void setTimerFpsUnlimited(bool on);
 // If more than N frames, just skip all, start a fresh.
 extern void skipMissedTicks();
+// Enables or disables the precise frame pacing: the engine sleeps until
+// shortly before the next frame's time, and spins for the rest; the spin
+// time adapts to the observed sleep precision
+extern void setTimerPrecisePacing(bool on);
+
+// Frame pacing statistics: how late did the frames start, compared to
+// their scheduled time. Only the frames that had to wait are counted.
+struct FramePacingStats
+{
+    uint32_t Frames = 0u; // number of frames measured
+    // Lateness percentiles and maximum, in milliseconds
+    float P50 = 0.f, P90 = 0.f, P99 = 0.f, Max = 0.f;
+};
+
+// Gets the frame pacing statistics, either for the recent frames,
+// or for the whole session
+extern FramePacingStats getFramePacingStats(bool whole_session);
+// Prints the frame pacing statistics of the whole session to the log
+extern void printFramePacingStats();
 
 #endif // __AGS_EE_AC__TIMER_H
@@ -12,6 +12,7 @@
 //
 //=============================================================================
 #include "ac/walkbehind.h"
+#include <string.h>
 #include <algorithm>
 #include "ac/draw.h"
 #include "ac/gamestate.h"
@@ -27,14 +28,18 @@ extern RoomStruct thisroom;
 extern IGraphicsDriver *gfxDriver;
 extern RoomStatus *croom;
 
-// An info on vertical column of walk-behind mask, which may contain WB area
-struct WalkBehindColumn
+// A horizontal run of the walk-behind mask pixels belonging to same WB area
+struct WalkBehindSpan
 {
-    bool Exists = false; // whether any WB area is in this column
-    int Y1 = 0, Y2 = 0; // WB top and bottom Y coords
+    int X1 = 0, X2 = 0; // span's left and right (exclusive) X coords
+    int Area = 0; // WB area index
 };
 
-std::vector<WalkBehindColumn> walkBehindCols; // precalculated WB positions
+// Precalculated WB spans, in the order of mask rows, and sorted by X in each row
+std::vector<WalkBehindSpan> walkBehindSpans;
+// Index of the first span of each mask row in walkBehindSpans, plus one
+// final element equal to the total number of spans
+std::vector<uint32_t> walkBehindRows;
 Rect walkBehindAABB[MAX_WALK_BEHINDS]; // WB bounding box
 int walkBehindsCachedForBgNum = 0; // WB textures are for this background
 bool noWalkBehindsAtAll = false; // quick report that no WBs in this room
@@ -91,6 +96,12 @@ void walkbehinds_generate_sprites()
     walkBehindsCachedForBgNum = play.bg_frame;
 }
 
+template <typename T>
+static inline void fill_pixels(uint8_t *dst_line, int x1, int x2, int color)
+{
+    std::fill(reinterpret_cast<T*>(dst_line) + x1, reinterpret_cast<T*>(dst_line) + x2, static_cast<T>(color));
+}
+
 // Edits the given game object's sprite, cutting out pixels covered by walk-behinds;
 // returns whether any pixels were updated;
 bool walkbehinds_cropout(Bitmap *sprit, int sprx, int spry, int basel)
@@ -98,48 +109,59 @@ bool walkbehinds_cropout(Bitmap *sprit, int sprx, int spry, int basel)
     if (noWalkBehindsAtAll)
         return false;
 
+    // quickly test if the sprite is in front of all the areas
+    bool any_in_front = false;
+    for (int wb = 1; (wb < MAX_WALK_BEHINDS) && !any_in_front; ++wb)
+        any_in_front = (walkBehindAABB[wb].Right >= 0) && (croom->walkbehind_base[wb] > basel);
+    if (!any_in_front)
+        return false;
+
+    // only process the part of the sprite that lies inside the mask
+    const int mask_w = thisroom.WalkBehindMask->GetWidth();
+    const int mask_h = static_cast<int>(walkBehindRows.size()) - 1; // as precalculated
+    const int x1 = std::max(0, sprx), x2 = std::min(mask_w, sprx + sprit->GetWidth());
+    const int y1 = std::max(0, spry), y2 = std::min(mask_h, spry + sprit->GetHeight());
+    if ((x1 >= x2) || (y1 >= y2))
+        return false;
+
     const int maskcol = sprit->GetMaskColor();
     const int spcoldep = sprit->GetColorDepth();
-
     bool pixels_changed = false;
-    // pass along the sprite's pixels, but skip those that lie outside the mask
-    for (int x = std::max(0, 0 - sprx);
-        (x < sprit->GetWidth()) && (x + sprx < thisroom.WalkBehindMask->GetWidth()); ++x)
+    for (int y = y1; y < y2; ++y)
     {
-        // select the WB column at this x
-        const auto &wbcol = walkBehindCols[x + sprx];
-        // skip if no area, or sprite lies outside of all areas in this column
-        if ((!wbcol.Exists) ||
-            (wbcol.Y2 <= spry) ||
-            (wbcol.Y1 > spry + sprit->GetHeight()))
-            continue;
-
-        // ensure we only check within the valid areas (between Y1 and Y2)
-        // we assume that Y1 and Y2 are always within the mask
-        for (int y = std::max(0, wbcol.Y1 - spry);
-            (y < sprit->GetHeight()) && (y + spry < wbcol.Y2); ++y)
+        const auto row_begin = walkBehindSpans.begin() + walkBehindRows[y];
+        const auto row_end = walkBehindSpans.begin() + walkBehindRows[y + 1];
+        if (row_begin == row_end)
+            continue; // no areas in this row
+        // find the first span that ends past the sprite's left edge
+        auto span = std::upper_bound(row_begin, row_end, x1,
+            [](int x, const WalkBehindSpan &sp) { return x < sp.X2; });
+        uint8_t *dst_line = nullptr;
+        for (; (span != row_end) && (span->X1 < x2); ++span)
         {
-            const int wb = thisroom.WalkBehindMask->GetScanLine(y + spry)[x + sprx];
-            if (wb < 1) continue; // "no area"
-            if (croom->walkbehind_base[wb] <= basel) continue;
+            if (croom->walkbehind_base[span->Area] <= basel)
+                continue; // sprite is in front of this area
 
-            pixels_changed = true;
-            uint8_t *dst_line = sprit->GetScanLineForWriting(y);
+            if (!dst_line)
+                dst_line = sprit->GetScanLineForWriting(y - spry);
+            const int fill_x1 = std::max(x1, span->X1) - sprx;
+            const int fill_x2 = std::min(x2, span->X2) - sprx;
             switch (spcoldep)
             {
             case 8:
-                dst_line[x] = maskcol;
+                memset(dst_line + fill_x1, maskcol, fill_x2 - fill_x1);
                 break;
             case 16:
-                reinterpret_cast<uint16_t*>(dst_line)[x] = maskcol;
+                fill_pixels<uint16_t>(dst_line, fill_x1, fill_x2, maskcol);
                 break;
             case 32:
-                reinterpret_cast<uint32_t*>(dst_line)[x] = maskcol;
+                fill_pixels<uint32_t>(dst_line, fill_x1, fill_x2, maskcol);
                 break;
             default:
                 assert(0);
                 break;
             }
+            pixels_changed = true;
         }
     }
     return pixels_changed;
@@ -148,7 +170,8 @@ bool walkbehinds_cropout(Bitmap *sprit, int sprx, int spry, int basel)
 void walkbehinds_recalc()
 {
     // Reset all data
-    walkBehindCols.clear();
+    walkBehindSpans.clear();
+    walkBehindRows.clear();
     for (int wb = 0; wb < MAX_WALK_BEHINDS; ++wb)
     {
         walkBehindAABB[wb] = Rect(INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN);
@@ -157,29 +180,34 @@ void walkbehinds_recalc()
 
     // Recalculate everything; note that mask is always 8-bit
     const Bitmap *mask = thisroom.WalkBehindMask.get();
-    walkBehindCols.resize(mask->GetWidth());
-    for (int col = 0; col < mask->GetWidth(); ++col)
+    const int mask_w = mask->GetWidth();
+    walkBehindRows.reserve(mask->GetHeight() + 1);
+    for (int y = 0; y < mask->GetHeight(); ++y)
     {
-        auto &wbcol = walkBehindCols[col];
-        for (int y = 0; y < mask->GetHeight(); ++y)
+        walkBehindRows.push_back(static_cast<uint32_t>(walkBehindSpans.size()));
+        const uint8_t *line = mask->GetScanLine(y);
+        for (int x = 0; x < mask_w;)
         {
-            int wb = mask->GetScanLine(y)[col];
+            const int wb = line[x];
             // Valid areas start with index 1, 0 = no area
-            if ((wb >= 1) && (wb < MAX_WALK_BEHINDS))
+            if ((wb < 1) || (wb >= MAX_WALK_BEHINDS))
             {
-                if (!wbcol.Exists)
-                {
-                    wbcol.Y1 = y;
-                    wbcol.Exists = true;
-                    noWalkBehindsAtAll = false;
-                }
-                wbcol.Y2 = y + 1; // +1 to allow bottom line of screen to work (CHECKME??)
-                // resize the bounding rect
-                walkBehindAABB[wb].Left = std::min(col, walkBehindAABB[wb].Left);
-                walkBehindAABB[wb].Top = std::min(y, walkBehindAABB[wb].Top);
-                walkBehindAABB[wb].Right = std::max(col, walkBehindAABB[wb].Right);
-                walkBehindAABB[wb].Bottom = std::max(y, walkBehindAABB[wb].Bottom);
+                ++x;
+                continue;
             }
+            WalkBehindSpan span;
+            span.X1 = x;
+            for (++x; (x < mask_w) && (line[x] == wb); ++x);
+            span.X2 = x;
+            span.Area = wb;
+            walkBehindSpans.push_back(span);
+            noWalkBehindsAtAll = false;
+            // resize the bounding rect
+            walkBehindAABB[wb].Left = std::min(span.X1, walkBehindAABB[wb].Left);
+            walkBehindAABB[wb].Top = std::min(y, walkBehindAABB[wb].Top);
+            walkBehindAABB[wb].Right = std::max(span.X2 - 1, walkBehindAABB[wb].Right);
+            walkBehindAABB[wb].Bottom = std::max(y, walkBehindAABB[wb].Bottom);
         }
     }
+    walkBehindRows.push_back(static_cast<uint32_t>(walkBehindSpans.size()));
 }
@@ -0,0 +1,226 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "debug/frameprofiler.h"
+#include <algorithm>
+#include <vector>
+#include "debug/out.h"
+#include "util/file.h"
+#include "util/memory_compat.h"
+#include "util/path.h"
+#include "util/textstreamwriter.h"
+
+using namespace AGS::Common;
+
+namespace AGS
+{
+namespace Engine
+{
+
+namespace FrameProfiler
+{
+
+static const char *PhaseNames[kNumFramePhases] = {
+    "ScriptEarly", "Input", "Update", "ScriptLate", "Audio",
+    "Render", "PrepareRoom", "DrawGUI", "DriverRender", "Present", "Wait"
+};
+
+// A frame which is currently being measured
+struct FrameRecord
+{
+    AGS_Clock::time_point Start;
+    AGS_Clock::duration Phases[kNumFramePhases]{};
+    uint32_t Nested = 0u; // number of nested frames run from within this one
+};
+
+static struct ProfilerState
+{
+    bool Running = false;
+    bool Trace = false; // write Chrome trace, otherwise CSV
+    bool FirstEvent = true;
+    std::unique_ptr<TextStreamWriter> Out;
+    AGS_Clock::time_point StartTime;
+    // Stack of the frames in progress, for the nested game loops
+    std::vector<FrameRecord> Frames;
+    uint32_t FrameCount = 0u;
+    // Times of the completed frames (not containing nested ones), for the summary
+    std::vector<float> FrameMs;
+    std::vector<float> BusyMs;
+    double PhaseTotalMs[kNumFramePhases]{};
+} prof;
+
+static inline long long ToMicroseconds(const AGS_Clock::duration &dur)
+{
+    return static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(dur).count());
+}
+
+static inline float ToMs(const AGS_Clock::duration &dur)
+{
+    return std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(dur).count();
+}
+
+static void WriteTraceEvent(const char *name, const AGS_Clock::time_point &start,
+    const AGS_Clock::time_point &end, int frame = -1)
+{
+    prof.Out->WriteFormat("%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%lld,\"dur\":%lld",
+        prof.FirstEvent ? "" : ",\n", name,
+        ToMicroseconds(start - prof.StartTime), ToMicroseconds(end - start));
+    if (frame >= 0)
+        prof.Out->WriteFormat(",\"args\":{\"frame\":%d}", frame);
+    prof.Out->WriteChar('}');
+    prof.FirstEvent = false;
+}
+
+// Gets the value at the given percentile, using nearest rank
+static float Percentile(const std::vector<float> &sorted, float pc)
+{
+    const size_t index = static_cast<size_t>(pc * (sorted.size() - 1) / 100.f + 0.5f);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static void PrintSummary(const char *what, std::vector<float> &values)
+{
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (float v : values)
+        sum += v;
+    Debug::Printf(kDbgMsg_Info, "Frame profile: %s time (ms): avg %.2f, p50 %.2f, p90 %.2f, p95 %.2f, p99 %.2f, max %.2f",
+        what, sum / values.size(), Percentile(values, 50.f), Percentile(values, 90.f),
+        Percentile(values, 95.f), Percentile(values, 99.f), values.back());
+}
+
+bool Start(const String &filename)
+{
+#if DEBUG_FRAME_PROFILER
+    Stop();
+    auto out = File::CreateFile(filename);
+    if (!out)
+    {
+        Debug::Printf(kDbgMsg_Error, "Frame profile: failed to open output file: %s", filename.GetCStr());
+        return false;
+    }
+    prof = ProfilerState();
+    prof.Out = std::make_unique<TextStreamWriter>(std::move(out));
+    prof.Trace = Path::GetFileExtension(filename).CompareNoCase("json") == 0;
+    if (prof.Trace)
+    {
+        prof.Out->WriteLine("{\"traceEvents\":[");
+    }
+    else
+    {
+        prof.Out->WriteString("frame,start_ms,frame_ms,busy_ms");
+        for (const char *name : PhaseNames)
+            prof.Out->WriteFormat(",%s_ms", name);
+        prof.Out->WriteLine(",nested");
+    }
+    prof.StartTime = AGS_Clock::now();
+    prof.Running = true;
+    Debug::Printf(kDbgMsg_Info, "Frame profile: recording to %s", filename.GetCStr());
+    return true;
+#else
+    Debug::Printf(kDbgMsg_Warn, "Frame profile: not supported by this engine build, ignoring %s", filename.GetCStr());
+    return false;
+#endif
+}
+
+void Stop()
+{
+    if (!prof.Running)
+        return;
+    if (prof.Trace)
+        prof.Out->WriteLine("\n]}");
+    prof.Out.reset();
+    prof.Running = false;
+
+    if (prof.FrameMs.empty())
+    {
+        Debug::Printf(kDbgMsg_Info, "Frame profile: no frames recorded");
+        return;
+    }
+    const size_t frame_count = prof.FrameMs.size();
+    Debug::Printf(kDbgMsg_Info, "Frame profile: %u frames total, %zu in summary (excluding the ones running nested game loops)",
+        prof.FrameCount, frame_count);
+    PrintSummary("frame", prof.FrameMs);
+    PrintSummary("busy (excluding wait)", prof.BusyMs);
+    String phases = "Frame profile: average phase times (ms):";
+    for (int i = 0; i < kNumFramePhases; ++i)
+        phases.AppendFmt(" %s %.2f;", PhaseNames[i], prof.PhaseTotalMs[i] / frame_count);
+    Debug::Printf(kDbgMsg_Info, phases);
+    prof.FrameMs.clear();
+    prof.BusyMs.clear();
+}
+
+bool IsRunning()
+{
+    return prof.Running;
+}
+
+void BeginFrame()
+{
+    if (!prof.Running)
+        return;
+    if (!prof.Frames.empty())
+        prof.Frames.back().Nested++;
+    prof.Frames.emplace_back();
+    prof.Frames.back().Start = AGS_Clock::now();
+}
+
+void EndFrame()
+{
+    if (!prof.Running || prof.Frames.empty())
+        return;
+    const auto end = AGS_Clock::now();
+    const FrameRecord frame = prof.Frames.back();
+    prof.Frames.pop_back();
+    const uint32_t frame_index = prof.FrameCount++;
+
+    const float frame_ms = ToMs(end - frame.Start);
+    const float busy_ms = frame_ms - ToMs(frame.Phases[kFramePhase_Wait]);
+    if (prof.Trace)
+    {
+        WriteTraceEvent("Frame", frame.Start, end, static_cast<int>(frame_index));
+    }
+    else
+    {
+        prof.Out->WriteFormat("%u,%.3f,%.3f,%.3f", frame_index, ToMs(frame.Start - prof.StartTime), frame_ms, busy_ms);
+        for (const auto &phase : frame.Phases)
+            prof.Out->WriteFormat(",%.3f", ToMs(phase));
+        prof.Out->WriteFormat(",%u", frame.Nested);
+        prof.Out->WriteLineBreak();
+    }
+
+    if (frame.Nested == 0)
+    {
+        prof.FrameMs.push_back(frame_ms);
+        prof.BusyMs.push_back(busy_ms);
+        for (int i = 0; i < kNumFramePhases; ++i)
+            prof.PhaseTotalMs[i] += ToMs(frame.Phases[i]);
+    }
+}
+
+void AddPhase(FramePhase phase, const AGS_Clock::time_point &start, const AGS_Clock::time_point &end)
+{
+    if (!prof.Running)
+        return;
+    if (prof.Trace)
+        WriteTraceEvent(PhaseNames[phase], start, end);
+    // phases may happen outside of the game frame too, e.g. during fades;
+    // these are only written into the trace
+    if (!prof.Frames.empty())
+        prof.Frames.back().Phases[phase] += (end - start);
+}
+
+} // namespace FrameProfiler
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,126 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// FrameProfiler measures the time spent in the phases of each game frame:
+// script updates, game state update, scene preparation, rendering, and so on.
+//
+// The timers are placed in code with AGS_PROFILE_FRAME and AGS_PROFILE_SCOPE
+// macros, which are compiled out unless the engine is built with
+// DEBUG_FRAME_PROFILER enabled. Even then nothing is measured until the
+// profiler is started with an output file. Depending on the file extension
+// it writes either:
+// * ".json" - a Chrome trace_event file, which may be opened in the
+//   chrome://tracing or Perfetto UI;
+// * anything else - a CSV table, with one row per frame, and the time of
+//   each phase in columns.
+// When stopped, profiler prints the frame time percentiles into the log.
+//
+// Phase times are inclusive, that is they contain the time of the nested
+// phases. Blocking script commands run nested game loops, so a frame which
+// ran them contains the whole nested frames in its script phase; these
+// frames are marked in the CSV and excluded from the summary.
+//
+//=============================================================================
+#ifndef __AGS_EE_DEBUG__FRAMEPROFILER_H
+#define __AGS_EE_DEBUG__FRAMEPROFILER_H
+
+#include "core/platform.h"
+#include "ac/timer.h"
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+enum FramePhase
+{
+    kFramePhase_ScriptEarly,    // early script callbacks and room change
+    kFramePhase_Input,          // player's input handling
+    kFramePhase_Update,         // game state update (update_stuff)
+    kFramePhase_ScriptLate,     // late script callbacks
+    kFramePhase_Audio,          // audio system update
+    kFramePhase_Render,         // whole frame rendering
+    kFramePhase_PrepareRoom,    // preparing room objects and characters
+    kFramePhase_DrawGUI,        // preparing GUI and overlays
+    kFramePhase_DriverRender,   // graphics driver's rendering and presenting
+    kFramePhase_Present,        // presenting the final frame on screen
+    kFramePhase_Wait,           // waiting for the next frame
+    kNumFramePhases
+};
+
+namespace FrameProfiler
+{
+    // Starts recording frames into the given file; returns false if the
+    // file could not be opened, or if profiler is not supported by this build
+    bool Start(const Common::String &filename);
+    // Stops recording, closes the file and prints the summary into the log
+    void Stop();
+    // Tells if the profiler is currently recording
+    bool IsRunning();
+
+    // Marks the start and the end of a game frame
+    void BeginFrame();
+    void EndFrame();
+    // Records the time spent in the given phase of the current frame
+    void AddPhase(FramePhase phase, const AGS_Clock::time_point &start, const AGS_Clock::time_point &end);
+
+    // Measures a game frame, from construction to destruction
+    class FrameScope
+    {
+    public:
+        FrameScope() { BeginFrame(); }
+        ~FrameScope() { EndFrame(); }
+    };
+
+    // Measures a frame phase, from construction to destruction
+    class PhaseScope
+    {
+    public:
+        PhaseScope(FramePhase phase)
+            : _phase(phase)
+            , _running(IsRunning())
+        {
+            if (_running)
+                _start = AGS_Clock::now();
+        }
+        ~PhaseScope()
+        {
+            if (_running)
+                AddPhase(_phase, _start, AGS_Clock::now());
+        }
+
+    private:
+        FramePhase _phase;
+        bool _running;
+        AGS_Clock::time_point _start;
+    };
+} // namespace FrameProfiler
+
+} // namespace Engine
+} // namespace AGS
+
+#if DEBUG_FRAME_PROFILER
+#define AGS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define AGS_PROFILE_CONCAT(a, b) AGS_PROFILE_CONCAT_IMPL(a, b)
+#define AGS_PROFILE_FRAME() \
+    AGS::Engine::FrameProfiler::FrameScope AGS_PROFILE_CONCAT(ags_prof_frame_, __LINE__)
+#define AGS_PROFILE_SCOPE(phase) \
+    AGS::Engine::FrameProfiler::PhaseScope AGS_PROFILE_CONCAT(ags_prof_scope_, __LINE__)(phase)
+#else
+#define AGS_PROFILE_FRAME()
+#define AGS_PROFILE_SCOPE(phase)
+#endif
+
+#endif // __AGS_EE_DEBUG__FRAMEPROFILER_H
@@ -0,0 +1,154 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/ali3dnull.h"
+#include <allegro.h> // get_palette
+#include "debug/out.h"
+#include "gfx/blitkernels.h"
+#include "util/directory.h"
+#include "util/path.h"
+
+namespace AGS
+{
+namespace Engine
+{
+namespace ALNull
+{
+
+using namespace Common;
+
+// ----------------------------------------------------------------------------
+// NullGraphicsDriver
+// ----------------------------------------------------------------------------
+
+bool NullGraphicsDriver::SetDisplayMode(const DisplayMode &mode)
+{
+    ReleaseDisplayMode();
+
+    set_color_depth(mode.ColorDepth);
+
+    if (_initGfxCallback != nullptr)
+        _initGfxCallback(nullptr);
+
+    if (!IsModeSupported(mode))
+        return false;
+
+    // There's no window, so any requested mode is accepted as is
+    _capsVsync = false;
+    Debug::Printf(kDbgMsg_Info, "Null renderer: headless mode %d x %d", mode.Width, mode.Height);
+    Debug::Printf(kDbgMsg_Info, "Software blit kernels: %s", BlitKernels::GetSimdName(BlitKernels::GetSimd()));
+
+    OnInit();
+    OnModeSet(mode);
+    return true;
+}
+
+IGfxModeList *NullGraphicsDriver::GetSupportedModeList(int /*color_depth*/)
+{
+    // No display, so no fixed modes: any valid mode may be set
+    return new ALSW::SDLRendererGfxModeList(std::vector<DisplayMode>());
+}
+
+void NullGraphicsDriver::Render(int /*xoff*/, int /*yoff*/, GraphicFlip /*flip*/)
+{
+    RenderToBackBuffer();
+    if ((_dumpInterval > 0) && (_frameIndex % _dumpInterval == 0))
+        DumpFrame();
+    _frameIndex++;
+}
+
+void NullGraphicsDriver::SetFrameDump(const String &dir, int interval, const String &ext)
+{
+    _dumpDir = dir;
+    _dumpExt = ext;
+    _dumpInterval = std::max(0, interval);
+    _frameIndex = 0u;
+    if (_dumpInterval > 0)
+    {
+        if (!_dumpDir.IsEmpty() && !Directory::CreateDirectory(_dumpDir))
+            Debug::Printf(kDbgMsg_Error, "Null renderer: failed to create frame dump directory: %s", _dumpDir.GetCStr());
+        Debug::Printf(kDbgMsg_Info, "Null renderer: saving every %d frame(s) to %s",
+            _dumpInterval, _dumpDir.IsEmpty() ? "current directory" : _dumpDir.GetCStr());
+    }
+}
+
+void NullGraphicsDriver::DumpFrame()
+{
+    Bitmap *screen = GetMemoryBackBuffer();
+    if (!screen)
+        return;
+    const String filename = Path::ConcatPaths(_dumpDir,
+        String::FromFormat("frame%06u.%s", _frameIndex, _dumpExt.GetCStr()));
+    PALETTE pal;
+    get_palette(pal);
+    if (!screen->SaveToFile(filename, pal))
+    {
+        Debug::Printf(kDbgMsg_Error, "Null renderer: failed to save frame %u to %s; frame dumps disabled",
+            _frameIndex, filename.GetCStr());
+        _dumpInterval = 0;
+    }
+}
+
+
+// ----------------------------------------------------------------------------
+// NullGraphicsFactory
+// ----------------------------------------------------------------------------
+
+NullGraphicsFactory *NullGraphicsFactory::_factory = nullptr;
+
+NullGraphicsFactory::~NullGraphicsFactory()
+{
+    _factory = nullptr;
+}
+
+size_t NullGraphicsFactory::GetFilterCount() const
+{
+    return 1;
+}
+
+const GfxFilterInfo *NullGraphicsFactory::GetFilterInfo(size_t index) const
+{
+    return (index == 0) ? &ALSW::SDLRendererGfxFilter::FilterInfo : nullptr;
+}
+
+String NullGraphicsFactory::GetDefaultFilterID() const
+{
+    return ALSW::SDLRendererGfxFilter::FilterInfo.Id;
+}
+
+/* static */ NullGraphicsFactory *NullGraphicsFactory::GetFactory()
+{
+    if (!_factory)
+        _factory = new NullGraphicsFactory();
+    return _factory;
+}
+
+NullGraphicsDriver *NullGraphicsFactory::EnsureDriverCreated()
+{
+    if (!_driver)
+        _driver = new NullGraphicsDriver();
+    return _driver;
+}
+
+ALSW::SDLRendererGfxFilter *NullGraphicsFactory::CreateFilter(const String &id)
+{
+    // Frames are not presented anywhere, so only the standard filter is provided;
+    // any other request will fall back to it
+    if (ALSW::SDLRendererGfxFilter::FilterInfo.Id.CompareNoCase(id) == 0)
+        return new ALSW::SDLRendererGfxFilter();
+    return nullptr;
+}
+
+} // namespace ALNull
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,93 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// Null graphics factory: a headless software renderer, which draws the game
+// onto the virtual screen exactly like the Software driver does, but never
+// creates a window and does not present the frames anywhere.
+//
+// Meant for the benchmarks and automated runs on machines without display.
+// Optionally saves every Nth rendered frame into a image file, so that the
+// results of such runs could be inspected.
+// NOTE: SDL still requires a video backend to initialize; on systems without
+// any display set SDL_VIDEODRIVER=dummy in the environment.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__ALI3DNULL_H
+#define __AGS_EE_GFX__ALI3DNULL_H
+
+#include "gfx/ali3dsw.h"
+#include "gfx/gfxfilter_sdl_renderer.h"
+
+namespace AGS
+{
+namespace Engine
+{
+namespace ALNull
+{
+
+class NullGraphicsDriver : public ALSW::SDLRendererGraphicsDriver
+{
+public:
+    const char *GetDriverID() override { return "Null"; }
+    const char *GetDriverName() override { return "Null (headless) software renderer"; }
+
+    bool SetDisplayMode(const DisplayMode &mode) override;
+    IGfxModeList *GetSupportedModeList(int color_depth) override;
+    bool DoesSupportVsyncToggle() override { return false; }
+
+    void Render(int xoff, int yoff, Common::GraphicFlip flip) override;
+
+    // Sets up saving every Nth rendered frame into the given directory;
+    // interval 0 disables frame dumps. The file format is chosen by the
+    // extension, which may be "bmp" or "pcx".
+    void SetFrameDump(const String &dir, int interval, const String &ext);
+    void SetFrameDump(const String &dir, int interval) override { SetFrameDump(dir, interval, "bmp"); }
+
+protected:
+    bool SetVsyncImpl(bool /*vsync*/, bool &/*vsync_res*/) override { return false; }
+
+private:
+    // Saves the current state of the virtual screen into a file
+    void DumpFrame();
+
+    String _dumpDir;
+    String _dumpExt;
+    int    _dumpInterval = 0;
+    uint32_t _frameIndex = 0u;
+};
+
+
+class NullGraphicsFactory : public GfxDriverFactoryBase<NullGraphicsDriver, ALSW::SDLRendererGfxFilter>
+{
+public:
+    ~NullGraphicsFactory() override;
+
+    size_t               GetFilterCount() const override;
+    const GfxFilterInfo *GetFilterInfo(size_t index) const override;
+    String               GetDefaultFilterID() const override;
+
+    static NullGraphicsFactory *GetFactory();
+
+private:
+    NullGraphicsDriver   *EnsureDriverCreated() override;
+    ALSW::SDLRendererGfxFilter *CreateFilter(const String &id) override;
+
+    static NullGraphicsFactory *_factory;
+};
+
+} // namespace ALNull
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__ALI3DNULL_H
@@ -16,10 +16,12 @@
 #if AGS_HAS_OPENGL
 #include "gfx/ali3dogl.h"
 #include <algorithm>
+#include <mutex>
 #include <stack>
 #include <SDL.h>
 #include "ac/sys_events.h"
 #include "ac/timer.h"
+#include "debug/frameprofiler.h"
 #include "debug/out.h"
 #include "gfx/ali3dexception.h"
 #include "gfx/gfx_def.h"
@@ -71,12 +73,59 @@ Rect TopDownRect(const Rect &rect, int surface_height)
 }
 
 
+// Textures of this size or smaller are placed on the atlas pages
+static const int AtlasMaxTextureSize = 128;
+static const int AtlasPageSize = 1024;
+
+// When rendering on a separate thread, the textures may be released by the
+// thread which does not own the GL context at the moment; in such case
+// their deletion is postponed until the context is acquired again.
+static std::mutex DeferredTexturesMutex;
+static std::vector<GLuint> DeferredTextures;
+// Atlas pages may be freed by the textures released on either thread
+static std::mutex AtlasPagesMutex;
+
+static void DeleteGLTexture(GLuint texture)
+{
+    if (SDL_GL_GetCurrentContext())
+    {
+        glDeleteTextures(1, &texture);
+        return;
+    }
+    std::lock_guard<std::mutex> lk(DeferredTexturesMutex);
+    DeferredTextures.push_back(texture);
+}
+
+static void DeleteDeferredGLTextures()
+{
+    std::lock_guard<std::mutex> lk(DeferredTexturesMutex);
+    if (DeferredTextures.empty())
+        return;
+    glDeleteTextures(static_cast<GLsizei>(DeferredTextures.size()), DeferredTextures.data());
+    DeferredTextures.clear();
+}
+
+OGLAtlasPage::~OGLAtlasPage()
+{
+    DeleteGLTexture(texture);
+}
+
 OGLTexture::~OGLTexture()
 {
     if (_tiles)
     {
         for (size_t i = 0; i < _numTiles; ++i)
-            glDeleteTextures(1, &(_tiles[i].texture));
+        {
+            if (_tiles[i].atlas)
+            {
+                std::lock_guard<std::mutex> lk(AtlasPagesMutex);
+                _tiles[i].atlas->packer.Free(_tiles[i].atlasRect);
+            }
+            else
+            {
+                DeleteGLTexture(_tiles[i].texture);
+            }
+        }
         delete[] _tiles;
     }
     if (_vertex)
@@ -145,6 +194,7 @@ void OGLGraphicsDriver::SetupDefaultVertices()
 
 void OGLGraphicsDriver::UpdateDeviceScreen(const Size &/*screen_size*/)
 {
+    WaitForRender();
     SDL_GL_GetDrawableSize(_sdlWindow, &device_screen_physical_width, &device_screen_physical_height);
     Debug::Printf("OGL: notified of device screen updated to %d x %d, resizing viewport", device_screen_physical_width, device_screen_physical_height);
     _mode.Width = device_screen_physical_width;
@@ -153,6 +203,7 @@ void OGLGraphicsDriver::UpdateDeviceScreen(const Size &/*screen_size*/)
 
 void OGLGraphicsDriver::RenderSpritesAtScreenResolution(bool enabled)
 {
+  WaitForRender();
   if (_canRenderToTexture)
   {
     _doRenderToTexture = !enabled;
@@ -185,14 +236,50 @@ void OGLGraphicsDriver::SetGamma(int /*newGamma*/)
 {
 }
 
+void OGLGraphicsDriver::UseSmoothScaling(bool enabled)
+{
+  WaitForRender();
+  _smoothScaling = enabled;
+}
+
+bool OGLGraphicsDriver::UseRenderThread(bool enabled)
+{
+#if defined(AGS_DISABLE_THREADS)
+  enabled = false;
+#endif
+  _useRenderThread = enabled;
+  // If the mode is not set yet, then the thread will be started along with it
+  if (IsModeSet())
+  {
+    if (enabled)
+      StartRenderThread();
+    else
+      StopRenderThread();
+  }
+  return _useRenderThread;
+}
+
+void OGLGraphicsDriver::AcquireRenderContext()
+{
+  SDL_GL_MakeCurrent(_sdlWindow, _sdlGlContext);
+  DeleteDeferredGLTextures();
+}
+
+void OGLGraphicsDriver::ReleaseRenderContext()
+{
+  SDL_GL_MakeCurrent(_sdlWindow, nullptr);
+}
+
 void OGLGraphicsDriver::SetGraphicsFilter(POGLFilter filter)
 {
+  WaitForRender();
   _filter = filter;
   OnSetFilter();
 }
 
 void OGLGraphicsDriver::SetTintMethod(TintMethod method)
 {
+  WaitForRender();
   _legacyPixelShader = (method == TintReColourise);
 }
 
@@ -396,7 +483,13 @@ void OGLGraphicsDriver::TestRenderToTexture()
 }
 
 
+// Vertex attribute locations, bound to the same names in all the programs
+static const GLuint AttrLoc_Position = 0;
+static const GLuint AttrLoc_TexCoord = 1;
+static const GLuint AttrLoc_Alpha = 2;
+
 bool CreateTransparencyShader(ShaderProgram &prg);
+bool CreateBatchShader(ShaderProgram &prg);
 bool CreateTintShader(ShaderProgram &prg);
 bool CreateLightShader(ShaderProgram &prg);
 bool CreateShaderProgram(ShaderProgram &prg, const char *name, const char *vertex_shader_src, const char *fragment_shader_src);
@@ -418,6 +511,9 @@ bool OGLGraphicsDriver::CreateShaders()
   shaders_created &= CreateTransparencyShader(_transparencyShader);
   shaders_created &= CreateTintShader(_tintShader);
   shaders_created &= CreateLightShader(_lightShader);
+  // Batch shader is optional, without it each sprite is drawn separately
+  if (!CreateBatchShader(_batchShader))
+    Debug::Printf(kDbgMsg_Warn, "OGL: sprite batching is disabled");
   return shaders_created;
 }
 
@@ -468,6 +564,55 @@ void main()
 )EOS";
 
 
+// Batch shaders draw a number of sprites at once: the vertex positions are
+// already transformed, and alpha is passed along with each vertex.
+
+static const auto batch_vertex_shader_src =  ""
+#if AGS_OPENGL_ES2
+"#version 100 \n"
+#else
+"#version 120 \n"
+#endif
+R"EOS(
+uniform mat4 uMVPMatrix;
+
+attribute vec2 a_Position;
+attribute vec2 a_TexCoord;
+attribute float a_Alpha;
+
+varying vec2 v_TexCoord;
+varying float v_Alpha;
+
+void main() {
+  v_TexCoord = a_TexCoord;
+  v_Alpha = a_Alpha;
+  gl_Position = uMVPMatrix * vec4(a_Position.xy, 0.0, 1.0);
+}
+
+)EOS";
+
+
+static const auto batch_fragment_shader_src = ""
+#if AGS_OPENGL_ES2
+"#version 100 \n"
+"precision mediump float; \n"
+#else
+"#version 120 \n"
+#endif
+R"EOS(
+uniform sampler2D textID;
+
+varying vec2 v_TexCoord;
+varying float v_Alpha;
+
+void main()
+{
+  vec4 src_col = texture2D(textID, v_TexCoord);
+  gl_FragColor = vec4(src_col.xyz, src_col.w * v_Alpha);
+}
+)EOS";
+
+
 // NOTE: this shader emulates "historical" AGS software tinting; it is not
 // necessarily "proper" tinting in modern terms.
 // The RGB-HSV-RGB conversion found in the Internet (copyright unknown);
@@ -582,6 +727,15 @@ bool CreateTransparencyShader(ShaderProgram &prg)
 }
 
 
+bool CreateBatchShader(ShaderProgram &prg)
+{
+  if(!CreateShaderProgram(prg, "Batch", batch_vertex_shader_src, batch_fragment_shader_src)) return false;
+  prg.MVPMatrix = glGetUniformLocation(prg.Program, "uMVPMatrix");
+  prg.TextureId = glGetUniformLocation(prg.Program, "textID");
+  return true;
+}
+
+
 bool CreateTintShader(ShaderProgram &prg)
 {
   if(!CreateShaderProgram(prg, "Tinting", default_vertex_shader_src, tint_fragment_shader_src)) return false;
@@ -634,6 +788,9 @@ bool CreateShaderProgram(ShaderProgram &prg, const char *name, const char *verte
   GLuint program = glCreateProgram();
   glAttachShader(program, vertex_shader);
   glAttachShader(program, fragment_shader);
+  glBindAttribLocation(program, AttrLoc_Position, "a_Position");
+  glBindAttribLocation(program, AttrLoc_TexCoord, "a_TexCoord");
+  glBindAttribLocation(program, AttrLoc_Alpha, "a_Alpha");
   glLinkProgram(program);
   glGetProgramiv(program, GL_LINK_STATUS, &result);
   if(result == GL_FALSE)
@@ -769,6 +926,9 @@ bool OGLGraphicsDriver::SetDisplayMode(const DisplayMode &mode)
   SetupNativeTarget();
   // If we already have a render frame configured, then setup viewport and backbuffer mappings immediately
   SetupViewport();
+
+  if (_useRenderThread)
+    StartRenderThread();
   return true;
 }
 
@@ -782,6 +942,7 @@ void OGLGraphicsDriver::CreateVirtualScreen()
 
 bool OGLGraphicsDriver::SetNativeResolution(const GraphicResolution &native_res)
 {
+  WaitForRender();
   OnSetNativeRes(native_res);
   SetupNativeTarget();
   // If we already have a gfx mode set, then update virtual screen immediately
@@ -793,6 +954,7 @@ bool OGLGraphicsDriver::SetRenderFrame(const Rect &dst_rect)
 {
   if (!IsNativeSizeValid())
     return false;
+  WaitForRender();
   OnSetRenderFrame(dst_rect);
   // Also make sure viewport and backbuffer mappings are updated using new native & destination rectangles
   SetupViewport();
@@ -828,6 +990,8 @@ void OGLGraphicsDriver::ReleaseDisplayMode()
   if (!IsModeSet())
     return;
 
+  StopRenderThread();
+
   _screenBackbuffer = BackbufferState();
 
   OnModeReleased();
@@ -841,6 +1005,7 @@ void OGLGraphicsDriver::ReleaseDisplayMode()
 
 void OGLGraphicsDriver::UnInit()
 {
+  StopRenderThread();
   OnUnInit();
   ReleaseDisplayMode();
 
@@ -854,6 +1019,9 @@ void OGLGraphicsDriver::UnInit()
   DeleteShaderProgram(_transparencyShader);
   DeleteShaderProgram(_tintShader);
   DeleteShaderProgram(_lightShader);
+  DeleteShaderProgram(_batchShader);
+  _batchVertices.clear();
+  _atlasPages.clear();
 
   DeleteWindowAndGlContext();
   sys_window_destroy();
@@ -871,6 +1039,7 @@ void OGLGraphicsDriver::ClearRectangle(int /*x1*/, int /*y1*/, int /*x2*/, int /
 
 void OGLGraphicsDriver::GetCopyOfScreenIntoDDB(IDriverDependantBitmap *target, uint32_t batch_skip_filter)
 {
+    WaitForRender();
     // If we normally render in screen res, restore last frame's lists and
     // render in native res on the given target
     // Also force re-render last frame if we require batch filtering
@@ -892,7 +1061,8 @@ void OGLGraphicsDriver::GetCopyOfScreenIntoDDB(IDriverDependantBitmap *target, u
             glm::ortho(0.0f, (float)surf_sz.Width, 0.0f, (float)surf_sz.Height, 0.0f, 1.0f),
             PlaneScaling(), GL_NEAREST, GL_CLAMP);
         SetBackbufferState(&backbuffer, true);
-        RenderTexture(_nativeSurface, 0, 0, backbuffer.Projection, glmex::identity(), SpriteColorTransform(), surf_sz);
+        RenderTexture(_nativeSurface->GetDrawParams(), 0, 0, backbuffer.Projection, glmex::identity(), SpriteColorTransform(), surf_sz);
+        FlushSpriteBatch();
     }
 }
 
@@ -900,6 +1070,7 @@ bool OGLGraphicsDriver::GetCopyOfScreenIntoBitmap(Bitmap *destination,
     const Rect *src_rect, bool at_native_res,
     GraphicResolution *want_fmt, uint32_t batch_skip_filter)
 {
+  WaitForRender();
   // Currently don't support copying in screen resolution when we are rendering in native
   if (_doRenderToTexture)
       at_native_res = true;
@@ -973,16 +1144,30 @@ void OGLGraphicsDriver::Render()
 
 void OGLGraphicsDriver::Render(int /*xoff*/, int /*yoff*/, GraphicFlip /*flip*/)
 {
+    // Plugins may draw on the stage screens during render,
+    // so such frames are rendered on the calling thread
+    if (IsRenderThreadRunning() && !HasStageCallbacks())
+    {
+        RenderInThread([this]() {
+            RenderImpl(true);
+            SDL_GL_SwapWindow(_sdlWindow);
+        });
+        return;
+    }
+
+    WaitForRender();
     RenderAndPresent(true);
 }
 
 void OGLGraphicsDriver::RenderToBackBuffer()
 {
+    WaitForRender();
     RenderImpl(true);
 }
 
 void OGLGraphicsDriver::Render(IDriverDependantBitmap *target)
 {
+    WaitForRender();
     OGLBitmap *bitmap = (OGLBitmap*)target;
     Size surf_sz(bitmap->_width, bitmap->_height);
     BackbufferState backbuffer = BackbufferState(bitmap->_fbo, surf_sz, surf_sz,
@@ -996,20 +1181,31 @@ void OGLGraphicsDriver::RenderSprite(const OGLDrawListEntry *drawListEntry,
     const glm::mat4 &projection, const glm::mat4 &matGlobal,
     const SpriteColorTransform &color, const Size &rend_sz)
 {
-    RenderTexture(drawListEntry->ddb, drawListEntry->x, drawListEntry->y, projection, matGlobal, color, rend_sz);
+    RenderTexture(drawListEntry->params, drawListEntry->x, drawListEntry->y, projection, matGlobal, color, rend_sz);
 }
 
-void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
+void OGLGraphicsDriver::RenderTexture(const OGLSpriteParams &bmpToDraw, int draw_x, int draw_y,
     const glm::mat4 &projection, const glm::mat4 &matGlobal,
     const SpriteColorTransform &color, const Size &rend_sz)
 {
-  const int alpha = (color.Alpha * bmpToDraw->_alpha) / 255;
+  const int alpha = (color.Alpha * bmpToDraw.Alpha) / 255;
 
   ShaderProgram program;
 
-  const bool do_tint = bmpToDraw->_tintSaturation > 0 && _tintShader.Program > 0;
-  const bool do_light = bmpToDraw->_tintSaturation == 0 && bmpToDraw->_lightLevel > 0 && _lightShader.Program > 0;
-  if (do_tint)
+  const bool do_tint = bmpToDraw.TintSaturation > 0 && _tintShader.Program > 0;
+  const bool do_light = bmpToDraw.TintSaturation == 0 && bmpToDraw.LightLevel > 0 && _lightShader.Program > 0;
+  // Sprites without special effects are collected into batches, which
+  // are drawn when the texture or render state has to change
+  const bool do_batch = !do_tint && !do_light && (bmpToDraw.RenderHint == kTxHint_Normal) &&
+    _batchShader.Program > 0;
+  if (!do_batch)
+    FlushSpriteBatch();
+
+  if (do_batch)
+  {
+    // Uniforms will be set when the batch is drawn
+  }
+  else if (do_tint)
   {
     // Use tinting shader
     program = _tintShader;
@@ -1019,20 +1215,20 @@ void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw
     float sat_trs_lum[3]; // saturation / transparency / luminance
     if (_legacyPixelShader)
     {
-      rgb_to_hsv(bmpToDraw->_red, bmpToDraw->_green, bmpToDraw->_blue, &rgb[0], &rgb[1], &rgb[2]);
+      rgb_to_hsv(bmpToDraw.Red, bmpToDraw.Green, bmpToDraw.Blue, &rgb[0], &rgb[1], &rgb[2]);
       rgb[0] /= 360.0; // In HSV, Hue is 0-360
     }
     else
     {
-      rgb[0] = (float)bmpToDraw->_red / 255.0;
-      rgb[1] = (float)bmpToDraw->_green / 255.0;
-      rgb[2] = (float)bmpToDraw->_blue / 255.0;
+      rgb[0] = (float)bmpToDraw.Red / 255.0;
+      rgb[1] = (float)bmpToDraw.Green / 255.0;
+      rgb[2] = (float)bmpToDraw.Blue / 255.0;
     }
 
-    sat_trs_lum[0] = (float)bmpToDraw->_tintSaturation / 255.0;
+    sat_trs_lum[0] = (float)bmpToDraw.TintSaturation / 255.0;
 
-    if (bmpToDraw->_lightLevel > 0)
-      sat_trs_lum[2] = (float)bmpToDraw->_lightLevel / 255.0;
+    if (bmpToDraw.LightLevel > 0)
+      sat_trs_lum[2] = (float)bmpToDraw.LightLevel / 255.0;
     else
       sat_trs_lum[2] = 1.0f;
 
@@ -1051,16 +1247,16 @@ void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw
     // 1/255 (although effectively 1/250, see draw.cpp), but contains two
     // ranges: 1-255 is darker range and 256-511 is brighter range.
     // (light level of 0 means "default color")
-    if ((bmpToDraw->_lightLevel > 0) && (bmpToDraw->_lightLevel < 256))
+    if ((bmpToDraw.LightLevel > 0) && (bmpToDraw.LightLevel < 256))
     {
       // darkening the sprite... this stupid calculation is for
       // consistency with the allegro software-mode code that does
       // a trans blend with a (8,8,8) sprite
-      light_lev = -((bmpToDraw->_lightLevel * 192) / 256 + 64) / 255.f; // darker, uses MODULATE op
+      light_lev = -((bmpToDraw.LightLevel * 192) / 256 + 64) / 255.f; // darker, uses MODULATE op
     }
-    else if (bmpToDraw->_lightLevel > 256)
+    else if (bmpToDraw.LightLevel > 256)
     {
-      light_lev = ((bmpToDraw->_lightLevel - 256) / 2) / 255.f; // brighter, uses ADD op
+      light_lev = ((bmpToDraw.LightLevel - 256) / 2) / 255.f; // brighter, uses ADD op
     }
 
     glUniform1f(_lightShader.LightingAmount, light_lev);
@@ -1072,23 +1268,26 @@ void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw
     glUseProgram(_transparencyShader.Program);
   }
 
-  glUniform1i(program.TextureId, 0);
-  glUniform1f(program.Alpha, alpha / 255.0f);
+  if (!do_batch)
+  {
+    glUniform1i(program.TextureId, 0);
+    glUniform1f(program.Alpha, alpha / 255.0f);
+  }
 
-  float width = bmpToDraw->GetWidthToRender();
-  float height = bmpToDraw->GetHeightToRender();
-  float xProportion = width / (float)bmpToDraw->_width;
-  float yProportion = height / (float)bmpToDraw->_height;
+  float width = bmpToDraw.StretchToWidth;
+  float height = bmpToDraw.StretchToHeight;
+  float xProportion = width / (float)bmpToDraw.Width;
+  float yProportion = height / (float)bmpToDraw.Height;
 
-  const auto *txdata = bmpToDraw->_data.get();
+  const auto *txdata = bmpToDraw.Data.get();
   for (size_t ti = 0; ti < txdata->_numTiles; ++ti)
   {
     width = txdata->_tiles[ti].width * xProportion;
     height = txdata->_tiles[ti].height * yProportion;
     float xOffs;
     float yOffs = txdata->_tiles[ti].y * yProportion;
-    if (bmpToDraw->_flipped)
-      xOffs = (bmpToDraw->_width - (txdata->_tiles[ti].x + txdata->_tiles[ti].width)) * xProportion;
+    if (bmpToDraw.Flipped)
+      xOffs = (bmpToDraw.Width - (txdata->_tiles[ti].x + txdata->_tiles[ti].width)) * xProportion;
     else
       xOffs = txdata->_tiles[ti].x * xProportion;
     float thisX = draw_x + xOffs;
@@ -1099,7 +1298,7 @@ void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw
     //Setup translation and scaling matrices
     float widthToScale = width;
     float heightToScale = height;
-    if (bmpToDraw->_flipped)
+    if (bmpToDraw.Flipped)
     {
       // The usual transform changes 0..1 into 0..width
       // So first negate it (which changes 0..w into -w..0)
@@ -1120,51 +1319,48 @@ void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw
     // Self sprite transform (first scale, then rotate and then translate, reversed)
     transform = glmex::transform2d(transform, thisX, thisY, widthToScale, heightToScale, 0.f);
 
-    glUniformMatrix4fv(program.MVPMatrix, 1, GL_FALSE, glm::value_ptr(transform));
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, txdata->_tiles[ti].texture);
-
-    if ((_smoothScaling) && bmpToDraw->_useResampler && (bmpToDraw->_stretchToHeight > 0) &&
-        ((bmpToDraw->_stretchToHeight != bmpToDraw->_height) ||
-         (bmpToDraw->_stretchToWidth != bmpToDraw->_width)))
+    GLint filter, tx_clamp;
+    if ((_smoothScaling) && bmpToDraw.UseResampler && (bmpToDraw.StretchToHeight > 0) &&
+        ((bmpToDraw.StretchToHeight != bmpToDraw.Height) ||
+         (bmpToDraw.StretchToWidth != bmpToDraw.Width)))
     {
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      filter = GL_LINEAR;
+      tx_clamp = GL_CLAMP_TO_EDGE;
     }
     else
     {
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _currentBackbuffer->Filter);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _currentBackbuffer->Filter);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _currentBackbuffer->TxClamp);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _currentBackbuffer->TxClamp);
+      filter = _currentBackbuffer->Filter;
+      tx_clamp = _currentBackbuffer->TxClamp;
     }
 
-    if (txdata->_vertex != nullptr)
-    {
-        glEnableVertexAttribArray(0);
-        GLint a_Position = glGetAttribLocation(program.Program, "a_Position");
-        glVertexAttribPointer(a_Position, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(txdata->_vertex[ti * 4].position));
+    const OGLCUSTOMVERTEX *vertices = (txdata->_vertex != nullptr) ?
+      &txdata->_vertex[ti * 4] : &defaultVertices[0];
 
-        glEnableVertexAttribArray(1);
-        GLint a_TexCoord = glGetAttribLocation(program.Program, "a_TexCoord");
-        glVertexAttribPointer(a_TexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(txdata->_vertex[ti * 4].tu));
-    }
-    else
+    if (do_batch)
     {
-        glEnableVertexAttribArray(0);
-        GLint a_Position = glGetAttribLocation(program.Program, "a_Position");
-        glVertexAttribPointer(a_Position, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(defaultVertices[0].position));
-
-        glEnableVertexAttribArray(1);
-        GLint a_TexCoord = glGetAttribLocation(program.Program, "a_TexCoord");
-        glVertexAttribPointer(a_TexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(defaultVertices[0].tu));
+      AddToSpriteBatch(txdata->_tiles[ti].texture, filter, tx_clamp, transform, vertices, alpha / 255.0f);
+      continue;
     }
 
+    glUniformMatrix4fv(program.MVPMatrix, 1, GL_FALSE, glm::value_ptr(transform));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, txdata->_tiles[ti].texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, tx_clamp);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, tx_clamp);
+
+    glEnableVertexAttribArray(0);
+    GLint a_Position = glGetAttribLocation(program.Program, "a_Position");
+    glVertexAttribPointer(a_Position, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(vertices->position));
+
+    glEnableVertexAttribArray(1);
+    GLint a_TexCoord = glGetAttribLocation(program.Program, "a_TexCoord");
+    glVertexAttribPointer(a_TexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(OGLCUSTOMVERTEX), &(vertices->tu));
+
     // Treat special render modes
-    switch (bmpToDraw->_renderHint)
+    switch (bmpToDraw.RenderHint)
     {
     case kTxHint_PremulAlpha:
         glBlendColor(alpha / 255.0f, alpha / 255.0f, alpha / 255.0f, 1.0);
@@ -1174,21 +1370,96 @@ void OGLGraphicsDriver::RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw
     }
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    _renderStats.DrawCalls++;
 
     // Restore default blending mode
     SetBlendOpRGB(GL_FUNC_ADD, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   }
+  if (!do_batch)
+    glUseProgram(0);
+}
+
+void OGLGraphicsDriver::AddToSpriteBatch(GLuint texture, GLint filter, GLint tx_clamp,
+    const glm::mat4 &transform, const OGLCUSTOMVERTEX *vertices, float alpha)
+{
+  if (!_batchVertices.empty() &&
+      ((texture != _batchTexture) || (filter != _batchFilter) || (tx_clamp != _batchTxClamp)))
+    FlushSpriteBatch();
+
+  _batchTexture = texture;
+  _batchFilter = filter;
+  _batchTxClamp = tx_clamp;
+  // Two triangles, same as a strip made of 4 vertices
+  static const int quad_index[6] = { 0, 1, 2, 2, 1, 3 };
+  for (int i : quad_index)
+  {
+    const glm::vec4 pos = transform * glm::vec4(vertices[i].position.x, vertices[i].position.y, 0.f, 1.f);
+    OGLBatchVertex v;
+    v.position.x = pos.x / pos.w;
+    v.position.y = pos.y / pos.w;
+    v.tu = vertices[i].tu;
+    v.tv = vertices[i].tv;
+    v.alpha = alpha;
+    _batchVertices.push_back(v);
+  }
+}
+
+void OGLGraphicsDriver::FlushSpriteBatch()
+{
+  if (_batchVertices.empty())
+    return;
+
+  const ShaderProgram &program = _batchShader;
+  glUseProgram(program.Program);
+  glUniform1i(program.TextureId, 0);
+  glUniformMatrix4fv(program.MVPMatrix, 1, GL_FALSE, glm::value_ptr(glmex::identity()));
+
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, _batchTexture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _batchFilter);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, _batchFilter);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _batchTxClamp);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _batchTxClamp);
+
+  glEnableVertexAttribArray(AttrLoc_Position);
+  glVertexAttribPointer(AttrLoc_Position, 2, GL_FLOAT, GL_FALSE, sizeof(OGLBatchVertex), &(_batchVertices[0].position));
+  glEnableVertexAttribArray(AttrLoc_TexCoord);
+  glVertexAttribPointer(AttrLoc_TexCoord, 2, GL_FLOAT, GL_FALSE, sizeof(OGLBatchVertex), &(_batchVertices[0].tu));
+  glEnableVertexAttribArray(AttrLoc_Alpha);
+  glVertexAttribPointer(AttrLoc_Alpha, 1, GL_FLOAT, GL_FALSE, sizeof(OGLBatchVertex), &(_batchVertices[0].alpha));
+
+  glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(_batchVertices.size()));
+  _renderStats.DrawCalls++;
+
+  // Don't leave the arrays pointing into the vertex buffer, which is cleared
+  // below and may be reallocated by the next batch
+  glDisableVertexAttribArray(AttrLoc_Position);
+  glDisableVertexAttribArray(AttrLoc_TexCoord);
+  glDisableVertexAttribArray(AttrLoc_Alpha);
   glUseProgram(0);
+  _batchVertices.clear();
 }
 
 void OGLGraphicsDriver::RenderAndPresent(bool clearDrawListAfterwards)
 {
     RenderImpl(clearDrawListAfterwards);
+    AGS_PROFILE_SCOPE(kFramePhase_Present);
     SDL_GL_SwapWindow(_sdlWindow);
 }
 
+bool OGLGraphicsDriver::HasStageCallbacks() const
+{
+    for (const auto &e : _spriteList)
+    {
+        if (reinterpret_cast<uintptr_t>(e.ddb) == DRAWENTRY_STAGECALLBACK)
+            return true;
+    }
+    return false;
+}
+
 void OGLGraphicsDriver::RenderImpl(bool clearDrawListAfterwards)
 {
+    _renderStats = RenderStats();
     if (_doRenderToTexture)
     {
         RenderToSurface(&_nativeBackbuffer, clearDrawListAfterwards);
@@ -1202,7 +1473,8 @@ void OGLGraphicsDriver::RenderImpl(bool clearDrawListAfterwards)
     {
         // Draw native texture on a real backbuffer
         SetBackbufferState(&_screenBackbuffer, true);
-        RenderTexture(_nativeSurface, 0, 0, _screenBackbuffer.Projection, glmex::identity(), SpriteColorTransform(), _srcRect.GetSize());
+        RenderTexture(_nativeSurface->GetDrawParams(), 0, 0, _screenBackbuffer.Projection, glmex::identity(), SpriteColorTransform(), _srcRect.GetSize());
+        FlushSpriteBatch();
         glFinish();
     }
 }
@@ -1404,19 +1676,25 @@ size_t OGLGraphicsDriver::RenderSpriteBatch(const OGLSpriteBatch &batch, size_t
         switch (reinterpret_cast<uintptr_t>(e.ddb))
         {
         case DRAWENTRY_STAGECALLBACK:
-            // raw-draw plugin support
+            // raw-draw plugin support; plugin may use GL directly,
+            // so anything batched must be drawn before
+            FlushSpriteBatch();
             int sx, sy;
             if (auto *ddb = DoSpriteEvtCallback(e.x, 0, sx, sy))
             {
                 auto stageEntry = OGLDrawListEntry((OGLBitmap*)ddb, batch.ID, sx, sy);
                 RenderSprite(&stageEntry, projection, batch.Matrix, batch.Color, surface_size);
+                _renderStats.Sprites++;
             }
             break;
         default:
             RenderSprite(&e, projection, batch.Matrix, batch.Color, surface_size);
+            _renderStats.Sprites++;
             break;
         }
     }
+    // Next batch may have a different clipping or render target
+    FlushSpriteBatch();
     return from;
 }
 
@@ -1546,6 +1824,7 @@ void OGLGraphicsDriver::FilterSpriteBatches(uint32_t skip_filter)
 
 void OGLGraphicsDriver::RedrawLastFrame(uint32_t skip_filter)
 {
+    WaitForRender();
     RestoreDrawLists();
     FilterSpriteBatches(skip_filter);
 }
@@ -1558,6 +1837,7 @@ void OGLGraphicsDriver::DrawSprite(int x, int y, IDriverDependantBitmap* ddb)
 
 void OGLGraphicsDriver::DestroyDDB(IDriverDependantBitmap* ddb)
 {
+    WaitForRender();
     // Remove from render targets
     // FIXME: this ugly accessing internal texture members
     if (((OGLBitmap*)ddb)->_data->RenderTarget)
@@ -1662,13 +1942,17 @@ void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, const Bitmap *
   }
 
   glBindTexture(GL_TEXTURE_2D, tile->texture);
-  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tileWidth, tileHeight, GL_RGBA, GL_UNSIGNED_BYTE, origPtr);
+  if (tile->atlas)
+    glTexSubImage2D(GL_TEXTURE_2D, 0, tile->atlasRect.Left, tile->atlasRect.Top, tileWidth, tileHeight, GL_RGBA, GL_UNSIGNED_BYTE, origPtr);
+  else
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tileWidth, tileHeight, GL_RGBA, GL_UNSIGNED_BYTE, origPtr);
 
   delete []origPtr;
 }
 
 void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* ddb, const Bitmap *bitmap, bool has_alpha)
 {
+  WaitForRender();
   // FIXME: what to do if texture is shared??
   OGLBitmap *target = (OGLBitmap*)ddb;
   UpdateTexture(target->_data.get(), bitmap, has_alpha, target->_opaque);
@@ -1677,6 +1961,7 @@ void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* ddb, const B
 
 void OGLGraphicsDriver::UpdateTexture(Texture *txdata, const Bitmap *bitmap, bool has_alpha, bool opaque)
 {
+  WaitForRender();
   const int color_depth = bitmap->GetColorDepth();
   if (bitmap->GetColorDepth() != txdata->Res.ColorDepth)
     throw Ali3DException("UpdateDDBFromBitmap: mismatched colour depths");
@@ -1724,6 +2009,7 @@ int OGLGraphicsDriver::GetCompatibleBitmapFormat(int color_depth)
 
 uint64_t OGLGraphicsDriver::GetAvailableTextureMemory()
 {
+    WaitForRender();
     GLint mem[4]{}; // ATI requires array of 4 ints
     const char *exts = (const char*)glGetString(GL_EXTENSIONS);
     if (strstr(exts, "GL_NVX_gpu_memory_info") != nullptr)
@@ -1770,6 +2056,7 @@ IDriverDependantBitmap *OGLGraphicsDriver::CreateDDB(std::shared_ptr<Texture> tx
 
 IDriverDependantBitmap* OGLGraphicsDriver::CreateRenderTargetDDB(int width, int height, int color_depth, bool opaque)
 {
+    WaitForRender();
     if (color_depth != GetCompatibleBitmapFormat(color_depth))
         throw Ali3DException("CreateDDB: bitmap colour depth not supported");
     OGLBitmap *ddb = new OGLBitmap(width, height, color_depth, opaque);
@@ -1795,10 +2082,106 @@ std::shared_ptr<Texture> OGLGraphicsDriver::GetTexture(IDriverDependantBitmap *d
     return std::static_pointer_cast<Texture>((reinterpret_cast<OGLBitmap*>(ddb))->_data);
 }
 
+bool OGLGraphicsDriver::AllocateAtlasTile(OGLTextureTile &tile, int width, int height)
+{
+  // Reserve a 1-pixel border around the image, same as with the standalone
+  // textures, in order to avoid filtering artifacts on the edges
+  const int alloc_width = width + 2;
+  const int alloc_height = height + 2;
+
+  Rect rc;
+  std::shared_ptr<OGLAtlasPage> page;
+  {
+    // The textures on the render thread may free their rects meanwhile
+    std::lock_guard<std::mutex> lk(AtlasPagesMutex);
+    // Release the pages that are no longer used, but keep one spare
+    bool has_spare = false;
+    for (auto it = _atlasPages.begin(); it != _atlasPages.end();)
+    {
+      if ((*it)->packer.IsEmpty() && (it->use_count() == 1))
+      {
+        if (has_spare)
+        {
+          it = _atlasPages.erase(it);
+          continue;
+        }
+        has_spare = true;
+      }
+      ++it;
+    }
+
+    for (const auto &p : _atlasPages)
+    {
+      if (p->packer.Allocate(alloc_width, alloc_height, rc))
+      {
+        page = p;
+        break;
+      }
+    }
+  }
+
+  if (!page)
+  {
+    GLint max_size = AtlasPageSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    const int page_size = std::min<int>(AtlasPageSize, max_size);
+    if ((alloc_width > page_size) || (alloc_height > page_size))
+      return false;
+
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, page_size, page_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    page = std::make_shared<OGLAtlasPage>(texture, page_size, page_size);
+    if (!page->packer.Allocate(alloc_width, alloc_height, rc))
+      return false;
+    _atlasPages.push_back(page);
+  }
+
+  tile.x = 0;
+  tile.y = 0;
+  tile.width = width;
+  tile.height = height;
+  tile.allocWidth = alloc_width;
+  tile.allocHeight = alloc_height;
+  tile.texture = page->texture;
+  tile.atlas = page;
+  tile.atlasRect = rc;
+  return true;
+}
+
 Texture *OGLGraphicsDriver::CreateTexture(int width, int height, int color_depth, bool /*opaque*/, bool as_render_target)
 {
   assert(width > 0);
   assert(height > 0);
+  WaitForRender();
+
+  // Small textures are placed on the shared atlas pages,
+  // which lets to draw more sprites with a single call
+  OGLTextureTile atlas_tile;
+  if ((!as_render_target) && (width <= AtlasMaxTextureSize) && (height <= AtlasMaxTextureSize) &&
+      AllocateAtlasTile(atlas_tile, width, height))
+  {
+    auto *txdata = new OGLTexture(GraphicResolution(width, height, color_depth), false);
+    const float page_width = static_cast<float>(atlas_tile.atlas->packer.GetWidth());
+    const float page_height = static_cast<float>(atlas_tile.atlas->packer.GetHeight());
+    const Rect &rc = atlas_tile.atlasRect;
+    txdata->_vertex = new OGLCUSTOMVERTEX[4];
+    for (int i = 0; i < 4; ++i)
+    {
+      txdata->_vertex[i] = defaultVertices[i];
+      txdata->_vertex[i].tu = (rc.Left + 1 + (defaultVertices[i].tu > 0.f ? width : 0)) / page_width;
+      txdata->_vertex[i].tv = (rc.Top + 1 + (defaultVertices[i].tv > 0.f ? height : 0)) / page_height;
+    }
+    txdata->_tiles = new OGLTextureTile[1];
+    txdata->_tiles[0] = atlas_tile;
+    txdata->_numTiles = 1;
+    return txdata;
+  }
   int allocatedWidth = width;
   int allocatedHeight = height;
   AdjustSizeToNearestSupportedByCard(&allocatedWidth, &allocatedHeight);
@@ -23,6 +23,7 @@
 
 #include "glm/glm.hpp"
 
+#include "gfx/atlaspacker.h"
 #include "gfx/bitmap.h"
 #include "gfx/ddb.h"
 #include "gfx/gfxdriverfactorybase.h"
@@ -57,9 +58,34 @@ struct OGLCUSTOMVERTEX
     float tv = 0.f;
 };
 
+// Vertex of a sprite batch, its position is already transformed
+// into the clip space
+struct OGLBatchVertex
+{
+    OGLVECTOR2D position;
+    float tu = 0.f;
+    float tv = 0.f;
+    float alpha = 0.f;
+};
+
+// Atlas page is a texture shared by several small textures
+struct OGLAtlasPage
+{
+    unsigned int texture = 0;
+    AtlasPacker packer;
+
+    OGLAtlasPage(unsigned int texture_, int width, int height)
+        : texture(texture_), packer(width, height) {}
+    ~OGLAtlasPage();
+};
+
 struct OGLTextureTile : public TextureTile
 {
     unsigned int texture = 0;
+    // Optional atlas page this tile is placed on, and the tile's region
+    // on that page, including the 1-pixel border
+    std::shared_ptr<OGLAtlasPage> atlas;
+    Rect atlasRect;
 };
 
 // Full OpenGL texture data
@@ -77,6 +103,21 @@ struct OGLTexture : Texture
     size_t GetMemSize() const override;
 };
 
+// A copy of the OGLBitmap's drawing parameters
+struct OGLSpriteParams
+{
+    std::shared_ptr<OGLTexture> Data;
+    TextureHint RenderHint = kTxHint_Normal;
+    int Width = 0, Height = 0;
+    bool Flipped = false;
+    int StretchToWidth = 0, StretchToHeight = 0;
+    bool UseResampler = false;
+    int Red = 0, Green = 0, Blue = 0;
+    int TintSaturation = 0;
+    int LightLevel = 0;
+    int Alpha = 255;
+};
+
 class OGLBitmap : public BaseDDB
 {
 public:
@@ -151,6 +192,26 @@ public:
     int GetWidthToRender() const { return _stretchToWidth; }
     int GetHeightToRender() const { return _stretchToHeight; }
 
+    OGLSpriteParams GetDrawParams() const
+    {
+        OGLSpriteParams p;
+        p.Data = _data;
+        p.RenderHint = _renderHint;
+        p.Width = _width;
+        p.Height = _height;
+        p.Flipped = _flipped;
+        p.StretchToWidth = _stretchToWidth;
+        p.StretchToHeight = _stretchToHeight;
+        p.UseResampler = _useResampler;
+        p.Red = _red;
+        p.Green = _green;
+        p.Blue = _blue;
+        p.TintSaturation = _tintSaturation;
+        p.LightLevel = _lightLevel;
+        p.Alpha = _alpha;
+        return p;
+    }
+
     ~OGLBitmap() override;
 };
 
@@ -171,7 +232,22 @@ struct OGLSpriteBatch : VMSpriteBatch
         , Fbo(render_target ? render_target->_fbo : 0u) {}
 };
 
-typedef SpriteDrawListEntry<OGLBitmap> OGLDrawListEntry;
+// OGL renderer's sprite entry; keeps a copy of the bitmap's drawing
+// parameters, made when the sprite was added to the list, so that the engine
+// may change the bitmap while the list is being rendered on the render thread.
+struct OGLDrawListEntry : SpriteDrawListEntry<OGLBitmap>
+{
+    OGLSpriteParams params;
+
+    OGLDrawListEntry() = default;
+    OGLDrawListEntry(OGLBitmap *ddb_, uint32_t node_, int x_, int y_)
+        : SpriteDrawListEntry<OGLBitmap>(ddb_, node_, x_, y_)
+    {
+        if (ddb_) // may be a special entry
+            params = ddb_->GetDrawParams();
+    }
+};
+
 typedef std::vector<OGLSpriteBatch>    OGLSpriteBatches;
 
 
@@ -274,7 +350,10 @@ public:
     void RenderSpritesAtScreenResolution(bool enabled) override;
     bool SupportsGammaControl() override;
     void SetGamma(int newGamma) override;
-    void UseSmoothScaling(bool enabled) override { _smoothScaling = enabled; }
+    void UseSmoothScaling(bool enabled) override;
+    void SetRenderThreads(int /*count*/) override { /* not supported */ }
+    bool UseRenderThread(bool enabled) override;
+    void SetFrameDump(const String &/*dir*/, int /*interval*/) override { /* not supported */ }
 
     typedef std::shared_ptr<OGLGfxFilter> POGLFilter;
 
@@ -285,6 +364,8 @@ public:
 
 protected:
     bool SetVsyncImpl(bool vsync, bool &vsync_res) override;
+    void AcquireRenderContext() override;
+    void ReleaseRenderContext() override;
 
     // Create DDB using preexisting texture data
     IDriverDependantBitmap *CreateDDB(std::shared_ptr<Texture> txdata, bool opaque) override;
@@ -300,10 +381,22 @@ private:
     OGLCUSTOMVERTEX defaultVertices[4];
     bool _smoothScaling;
     bool _legacyPixelShader;
+    // Whether to render and present frames on a separate thread
+    bool _useRenderThread = false;
 
     ShaderProgram _tintShader;
     ShaderProgram _lightShader;
     ShaderProgram _transparencyShader;
+    ShaderProgram _batchShader;
+
+    // Atlas pages for the small textures
+    std::vector<std::shared_ptr<OGLAtlasPage>> _atlasPages;
+    // Sprite batch which is being collected: the consecutive sprites that
+    // use the same texture and render settings are drawn with a single call
+    std::vector<OGLBatchVertex> _batchVertices;
+    GLuint _batchTexture = 0u;
+    GLint _batchFilter = 0;
+    GLint _batchTxClamp = 0;
 
     int device_screen_physical_width;
     int device_screen_physical_height;
@@ -390,11 +483,19 @@ private:
     void ReleaseDisplayMode();
     void AdjustSizeToNearestSupportedByCard(int *width, int *height);
     void UpdateTextureRegion(OGLTextureTile *tile, const Bitmap *bitmap, bool has_alpha, bool opaque);
+    // Tries to place a texture tile of the given size on one of the atlas pages
+    bool AllocateAtlasTile(OGLTextureTile &tile, int width, int height);
+    // Adds a textured quad to the sprite batch; if the texture or filtering
+    // are different from the current batch's, then draws the batch first
+    void AddToSpriteBatch(GLuint texture, GLint filter, GLint tx_clamp,
+        const glm::mat4 &transform, const OGLCUSTOMVERTEX *vertices, float alpha);
+    // Draws the collected sprite batch, if there's any
+    void FlushSpriteBatch();
     void CreateVirtualScreen();
     void RenderSprite(const OGLDrawListEntry *entry, const glm::mat4 &projection, const glm::mat4 &matGlobal,
         const SpriteColorTransform &color, const Size &rend_sz);
     // Renders given texture onto the current render target
-    void RenderTexture(OGLBitmap *bmpToDraw, int draw_x, int draw_y,
+    void RenderTexture(const OGLSpriteParams &bmpToDraw, int draw_x, int draw_y,
         const glm::mat4 &projection, const glm::mat4 &matGlobal,
         const SpriteColorTransform &color, const Size &rend_sz);
     void SetupViewport();
@@ -417,6 +518,8 @@ private:
     void FilterSpriteBatches(uint32_t skip_filter);
 
     void RenderAndPresent(bool clearDrawListAfterwards);
+    // Tells if the current draw list has plugin render stages
+    bool HasStageCallbacks() const;
     void RenderImpl(bool clearDrawListAfterwards);
     void RenderToSurface(BackbufferState *state, bool clearDrawListAfterwards);
     // Set current backbuffer state, which properties are used when refering to backbuffer
@@ -15,7 +15,9 @@
 #include <algorithm>
 #include <stack>
 #include "ac/sys_events.h"
+#include "debug/frameprofiler.h"
 #include "gfx/ali3dexception.h"
+#include "gfx/blitkernels.h"
 #include "gfx/gfxfilter_sdl_renderer.h"
 #include "gfx/gfx_util.h"
 #include "platform/base/agsplatformdriver.h"
@@ -101,11 +103,7 @@ void SDLRendererGraphicsDriver::SetGraphicsFilter(PSDLRenderFilter filter)
 {
   _filter = filter;
   OnSetFilter();
-
-  // TODO: support separate nearest and linear filters, initialize hint by calls to filter object
-  // e.g like D3D and OGL filters act
-  SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
-  // SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");  // make the scaled rendering look smoother.
+  // NOTE: screen texture is recreated on demand, according to the filter's output
 }
 
 void SDLRendererGraphicsDriver::SetTintMethod(TintMethod /*method*/) 
@@ -143,6 +141,8 @@ bool SDLRendererGraphicsDriver::SetDisplayMode(const DisplayMode &mode)
     SDL_RendererInfo rinfo{};
     if (SDL_GetRendererInfo(_renderer, &rinfo) == 0) {
       Debug::Printf(kDbgMsg_Info, "Created SDL Renderer: %s", rinfo.name);
+      Debug::Printf(kDbgMsg_Info, "Software blit kernels: %s", BlitKernels::GetSimdName(BlitKernels::GetSimd()));
+      _maxTextureSize = Size(rinfo.max_texture_width, rinfo.max_texture_height);
       Debug::Printf("Available texture formats:");
       for (Uint32 i = 0; i < rinfo.num_texture_formats; i++) {
         Debug::Printf("\t- %s", SDL_GetPixelFormatName(rinfo.texture_formats[i]));
@@ -193,7 +193,7 @@ void SDLRendererGraphicsDriver::CreateVirtualScreen()
   virtualScreen = _origVirtualScreen.get();
   _stageVirtualScreen = virtualScreen;
 
-  _screenTex = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, vscreen_w, vscreen_h);
+  // NOTE: screen texture is created by BlitToTexture, as its size depends on the filter
 
   // Fake bitmap that will wrap over texture pixels for simplier conversion
   _fakeTexBitmap = create_bitmap_placeholder(32, vscreen_w, vscreen_h, nullptr);
@@ -210,6 +210,8 @@ void SDLRendererGraphicsDriver::DestroyVirtualScreen()
       SDL_DestroyTexture(_screenTex);
   }
   _screenTex = nullptr;
+  _screenTexSize = Size();
+  _filterSrcScreen.reset();
 
   _origVirtualScreen.reset();
   virtualScreen = nullptr;
@@ -447,6 +449,7 @@ void SDLRendererGraphicsDriver::RenderToBackBuffer()
     while (_actSpriteBatch != UINT32_MAX)
         EndSpriteBatch();
 
+    _renderStats = RenderStats();
     if (_spriteBatchDesc.size() == 0)
     {
         ClearDrawLists();
@@ -542,9 +545,25 @@ void SDLRendererGraphicsDriver::RenderToBackBuffer()
 
 size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch, size_t from, Bitmap *surface, int surf_offx, int surf_offy)
 {
-  for (; (from < _spriteList.size()) && (_spriteList[from].node == batch.ID); ++from)
+  while ((from < _spriteList.size()) && (_spriteList[from].node == batch.ID))
   {
-    const auto &sprite = _spriteList[from];
+    if (_renderPool)
+    {
+      // Find the longest sequence of sprites which may be drawn in parallel
+      size_t to = from;
+      for (; (to < _spriteList.size()) && (_spriteList[to].node == batch.ID) &&
+             CanRenderSpriteInBands(_spriteList[to], surface); ++to);
+      if (to > from)
+      {
+        RenderSpritesInBands(from, to, surface, surf_offx, surf_offy);
+        _renderStats.Sprites += to - from;
+        _renderStats.DrawCalls += to - from;
+        from = to;
+        continue;
+      }
+    }
+
+    const auto &sprite = _spriteList[from++];
     if (sprite.ddb == nullptr)
     {
       if (_spriteEvtCallback)
@@ -555,12 +574,28 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
       surface = _stageVirtualScreen;
       continue;
     }
-    else if (sprite.ddb == reinterpret_cast<ALSoftwareBitmap*>(DRAWENTRY_TINT))
+    RenderSprite(sprite, surface, surf_offx, surf_offy);
+    _renderStats.Sprites++;
+    _renderStats.DrawCalls++;
+  }
+  return from;
+}
+
+void SDLRendererGraphicsDriver::RenderSprite(const ALDrawListEntry &sprite, Bitmap *surface, int surf_offx, int surf_offy)
+{
+    if (sprite.ddb == reinterpret_cast<ALSoftwareBitmap*>(DRAWENTRY_TINT))
     {
       // draw screen tint fx
-      set_trans_blender(_tint_red, _tint_green, _tint_blue, 0);
-      surface->LitBlendBlt(surface, 0, 0, 128);
-      continue;
+      if (surface->GetColorDepth() == 32)
+      {
+        BlitKernels::Tint(surface, makecol32(_tint_red, _tint_green, _tint_blue), 128);
+      }
+      else
+      {
+        set_trans_blender(_tint_red, _tint_green, _tint_blue, 0);
+        surface->LitBlendBlt(surface, 0, 0, 128);
+      }
+      return;
     }
 
     ALSoftwareBitmap* bitmap = sprite.ddb;
@@ -576,6 +611,10 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
         // Allegro 4 **does not have such function ready** :( (only masked blends, where it skips magenta pixels);
         // I am leaving this problem for the future, as coincidentally software mode does not need this atm.
     }
+    else if (bitmap->_hasAlpha && (surface->GetColorDepth() == 32) && (bitmap->_bmp->GetColorDepth() == 32))
+    {
+      BlitKernels::AlphaBlend(surface, bitmap->_bmp, drawAtX, drawAtY, bitmap->_alpha);
+    }
     else if (bitmap->_hasAlpha)
     {
       if (bitmap->_alpha == 255) // no global transparency, simple alpha blend
@@ -591,17 +630,114 @@ size_t SDLRendererGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch,
       GfxUtil::DrawSpriteWithTransparency(surface, bitmap->_bmp, drawAtX, drawAtY,
           bitmap->_alpha);
     }
-  }
-  return from;
+}
+
+bool SDLRendererGraphicsDriver::CanRenderSpriteInBands(const ALDrawListEntry &sprite, const Bitmap *surface) const
+{
+    if (sprite.ddb == nullptr)
+        return false; // stage callbacks are run on the main thread
+    if (surface->GetColorDepth() != 32)
+        return false; // only 32-bit blits are using the thread-safe kernels
+    if (sprite.ddb == reinterpret_cast<ALSoftwareBitmap*>(DRAWENTRY_TINT))
+        return true;
+    const ALSoftwareBitmap *bitmap = sprite.ddb;
+    if (bitmap->_alpha == 0)
+        return true; // not drawn at all
+    return (bitmap->_bmp != surface) && (bitmap->_bmp->GetColorDepth() == 32);
+}
+
+void SDLRendererGraphicsDriver::RenderSpritesInBands(size_t from, size_t to, Bitmap *surface, int surf_offx, int surf_offy)
+{
+    // Each band is a subbitmap covering a part of the surface's clipping
+    // rectangle; since every thread only writes to its own band, and draws
+    // sprites in the same order, the result is identical to drawing them
+    // on a single thread.
+    const int min_band_height = 16;
+    const Rect clip = surface->GetClip();
+    const size_t band_count = std::min(_renderPool->GetThreadCount(),
+        static_cast<size_t>(std::max(1, clip.GetHeight() / min_band_height)));
+    if (band_count < 2 || clip.GetWidth() <= 0)
+    {
+        for (size_t i = from; i < to; ++i)
+            RenderSprite(_spriteList[i], surface, surf_offx, surf_offy);
+        return;
+    }
+
+    const int band_height = (clip.GetHeight() + band_count - 1) / band_count;
+    std::vector<std::unique_ptr<Bitmap>> band_bmps(band_count);
+    for (size_t band = 0; band < band_count; ++band)
+    {
+        const int top = clip.Top + band * band_height;
+        const int bottom = std::min(clip.Bottom, top + band_height - 1);
+        band_bmps[band].reset(BitmapHelper::CreateSubBitmap(surface, Rect(clip.Left, top, clip.Right, bottom)));
+    }
+
+    _renderPool->ParallelFor(0, band_count, [&](size_t band_begin, size_t band_end)
+    {
+        for (size_t band = band_begin; band < band_end; ++band)
+        {
+            Bitmap *band_bmp = band_bmps[band].get();
+            const int top = clip.Top + band * band_height;
+            for (size_t i = from; i < to; ++i)
+                RenderSprite(_spriteList[i], band_bmp, surf_offx - clip.Left, surf_offy - top);
+        }
+    });
+}
+
+void SDLRendererGraphicsDriver::SetRenderThreads(int count)
+{
+    const size_t thread_count = (count > 0) ? static_cast<size_t>(count) : ThreadPool::GetHardwareThreadCount();
+    if (thread_count > 1)
+        _renderPool.reset(new ThreadPool(thread_count));
+    else
+        _renderPool.reset();
+    Debug::Printf(kDbgMsg_Info, "Software renderer: drawing with %zu thread(s)", _renderPool ? thread_count : 1);
+}
+
+void SDLRendererGraphicsDriver::CreateScreenTexture(const Size &size, bool linear)
+{
+    if (_screenTex)
+        SDL_DestroyTexture(_screenTex);
+    // Scale quality hint is applied to the textures at their creation
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, linear ? "linear" : "nearest");
+    _screenTex = SDL_CreateTexture(_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, size.Width, size.Height);
+    _screenTexSize = size;
+    _screenTexLinear = linear;
+    _lastTexPixels = nullptr;
+    _lastTexPitch = -1;
+    Debug::Printf("SDLRenderer: screen texture %d x %d", size.Width, size.Height);
 }
 
 void SDLRendererGraphicsDriver::BlitToTexture()
 {
+    const Size vsize = virtualScreen->GetSize();
+    const Size tex_size = _filter ? _filter->GetScaledSize(vsize, _maxTextureSize) : vsize;
+    const bool linear = _filter && _filter->IsLinearStretch();
+    if (!_screenTex || (tex_size != _screenTexSize) || (linear != _screenTexLinear))
+        CreateScreenTexture(tex_size, linear);
+
     void *pixels = nullptr;
     int pitch = 0;
     auto res = SDL_LockTexture(_screenTex, NULL, &pixels, &pitch);
     if (res != 0) { return; }
 
+    if (tex_size != vsize)
+    {
+        // The filter scales the frame on its own, but needs 32-bit pixels
+        const Bitmap *src = virtualScreen;
+        if (virtualScreen->GetColorDepth() != 32)
+        {
+            if (!_filterSrcScreen || (_filterSrcScreen->GetSize() != vsize))
+                _filterSrcScreen.reset(new Bitmap(vsize.Width, vsize.Height, 32));
+            _filterSrcScreen->Blit(virtualScreen, 0, 0, 0, 0, vsize.Width, vsize.Height);
+            src = _filterSrcScreen.get();
+        }
+        _filter->ScaleFrame(reinterpret_cast<const uint32_t*>(src->GetData()), src->GetLineLength(), vsize,
+            static_cast<uint32_t*>(pixels), pitch, tex_size, _renderPool.get());
+        SDL_UnlockTexture(_screenTex);
+        return;
+    }
+
     // Because the virtual screen may be of any color depth,
     // we wrap texture pixels in a fake bitmap here and call
     // standard blit operation, for simplicity sake.
@@ -631,6 +767,7 @@ void SDLRendererGraphicsDriver::Present(int xoff, int yoff, GraphicFlip flip)
     default: sdl_flip = SDL_FLIP_NONE; break;
     }
 
+    AGS_PROFILE_SCOPE(kFramePhase_Present);
     BlitToTexture();
 
     SDL_SetRenderDrawColor(_renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
@@ -794,7 +931,7 @@ SDLRendererGraphicsFactory::~SDLRendererGraphicsFactory()
 
 size_t SDLRendererGraphicsFactory::GetFilterCount() const
 {
-    return 1;
+    return 3;
 }
 
 const GfxFilterInfo *SDLRendererGraphicsFactory::GetFilterInfo(size_t index) const
@@ -803,6 +940,10 @@ const GfxFilterInfo *SDLRendererGraphicsFactory::GetFilterInfo(size_t index) con
     {
     case 0:
         return &SDLRendererGfxFilter::FilterInfo;
+    case 1:
+        return &SDLLinearGfxFilter::FilterInfo;
+    case 2:
+        return &SDLPixelArtGfxFilter::FilterInfo;
     default:
         return nullptr;
     }
@@ -831,6 +972,10 @@ SDLRendererGfxFilter *SDLRendererGraphicsFactory::CreateFilter(const String &id)
 {
     if (SDLRendererGfxFilter::FilterInfo.Id.CompareNoCase(id) == 0)
         return new SDLRendererGfxFilter();
+    else if (SDLLinearGfxFilter::FilterInfo.Id.CompareNoCase(id) == 0)
+        return new SDLLinearGfxFilter();
+    else if (SDLPixelArtGfxFilter::FilterInfo.Id.CompareNoCase(id) == 0)
+        return new SDLPixelArtGfxFilter();
     return nullptr;
 }
 
@@ -30,6 +30,7 @@
 #include "gfx/ddb.h"
 #include "gfx/gfxdriverfactorybase.h"
 #include "gfx/gfxdriverbase.h"
+#include "util/threadpool.h"
 
 namespace AGS
 {
@@ -212,6 +213,9 @@ public:
     bool SupportsGammaControl() override ;
     void SetGamma(int newGamma) override;
     void UseSmoothScaling(bool /*enabled*/) override { }
+    void SetRenderThreads(int count) override;
+    bool UseRenderThread(bool /*enabled*/) override { return false; /* not supported */ }
+    void SetFrameDump(const String &/*dir*/, int /*interval*/) override { /* not supported */ }
     bool DoesSupportVsyncToggle() override { return (SDL_VERSION_ATLEAST(2, 0, 18)) && _capsVsync; }
     void RenderSpritesAtScreenResolution(bool /*enabled*/) override { }
     Bitmap *GetMemoryBackBuffer() override;
@@ -228,6 +232,8 @@ public:
 protected:
     bool SetVsyncImpl(bool vsync, bool &vsync_res) override;
     size_t GetLastDrawEntryIndex() override { return _spriteList.size(); }
+    // Unset parameters and release resources related to the display mode
+    void ReleaseDisplayMode();
 
 private:
     PSDLRenderFilter _filter;
@@ -240,6 +246,13 @@ private:
 
     SDL_Renderer *_renderer = nullptr;
     SDL_Texture *_screenTex = nullptr;
+    // Screen texture's size and filtering, these depend on the gfx filter
+    Size _screenTexSize;
+    bool _screenTexLinear = false;
+    // Largest supported texture size; zero means unknown
+    Size _maxTextureSize;
+    // 32-bit copy of the virtual screen, for the filters that scale on CPU
+    std::unique_ptr<Bitmap> _filterSrcScreen;
     // BITMAP struct for wrapping screen texture locked pixels, so that we may use blit()
     BITMAP *_fakeTexBitmap = nullptr;
     unsigned char *_lastTexPixels = nullptr;
@@ -261,6 +274,9 @@ private:
     ALSpriteBatches _spriteBatches;
     // List of sprites to render
     std::vector<ALDrawListEntry> _spriteList;
+    // Worker threads for drawing sprites in horizontal bands of the surface;
+    // null if rendering on a single thread
+    std::unique_ptr<Common::ThreadPool> _renderPool;
 
     void InitSpriteBatch(size_t index, const SpriteBatchDesc &desc) override;
     void ResetAllBatches() override;
@@ -268,12 +284,22 @@ private:
     // Use gfx filter to create a new virtual screen
     void CreateVirtualScreen();
     void DestroyVirtualScreen();
-    // Unset parameters and release resources related to the display mode
-    void ReleaseDisplayMode();
     // Renders single sprite batch on the precreated surface
     size_t RenderSpriteBatch(const ALSpriteBatch &batch, size_t from, Common::Bitmap *surface, int surf_offx, int surf_offy);
-
-    // Copy raw screen bitmap pixels to the SDL texture
+    // Renders single sprite list entry; callback entries are not handled here
+    void RenderSprite(const ALDrawListEntry &sprite, Common::Bitmap *surface, int surf_offx, int surf_offy);
+    // Tells if the sprite may be drawn in parallel with the others onto
+    // the separate parts of the surface; this requires that drawing
+    // does not depend on any global state, which is true for 32-bit blits.
+    bool CanRenderSpriteInBands(const ALDrawListEntry &sprite, const Common::Bitmap *surface) const;
+    // Renders a range of sprites, splitting the surface's clipping rectangle
+    // into horizontal bands, drawn on the worker threads
+    void RenderSpritesInBands(size_t from, size_t to, Common::Bitmap *surface, int surf_offx, int surf_offy);
+
+    // (Re)creates the SDL texture used for presenting the screen
+    void CreateScreenTexture(const Size &size, bool linear);
+    // Copy raw screen bitmap pixels to the SDL texture, scaling them with
+    // the gfx filter if the one does that on CPU
     void BlitToTexture();
     // Render SDL texture on screen
     void Present(int xoff = 0, int yoff = 0, Common::GraphicFlip flip = Common::kFlip_None);
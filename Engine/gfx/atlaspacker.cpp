@@ -0,0 +1,140 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include "gfx/atlaspacker.h"
+#include <algorithm>
+
+namespace AGS
+{
+namespace Engine
+{
+
+AtlasPacker::AtlasPacker(int width, int height)
+    : _width(width)
+    , _height(height)
+{
+}
+
+bool AtlasPacker::Allocate(int width, int height, Rect &rc)
+{
+    if (width <= 0 || height <= 0 || width > _width || height > _height)
+        return false;
+
+    // First try the shelves of a close height, so that we don't waste
+    // too much space; pick the lowest fitting one
+    Shelf *best = nullptr;
+    const int max_height = height + height / 2;
+    for (auto &shelf : _shelves)
+    {
+        if (shelf.Height < height || shelf.Height > max_height)
+            continue;
+        if (best && best->Height <= shelf.Height)
+            continue;
+        for (const auto &span : shelf.Free)
+        {
+            if (span.Width >= width)
+            {
+                best = &shelf;
+                break;
+            }
+        }
+    }
+    if (best)
+        return AllocateOnShelf(*best, width, height, rc);
+
+    // Next start a new shelf, if there's any space left below
+    if (_nextY + height <= _height)
+    {
+        Shelf shelf;
+        shelf.Y = _nextY;
+        shelf.Height = height;
+        shelf.Free.emplace_back(0, _width);
+        _shelves.push_back(shelf);
+        _nextY += height;
+        return AllocateOnShelf(_shelves.back(), width, height, rc);
+    }
+
+    // Finally, try any shelf that is tall enough
+    for (auto &shelf : _shelves)
+    {
+        if ((shelf.Height >= height) && AllocateOnShelf(shelf, width, height, rc))
+            return true;
+    }
+    return false;
+}
+
+bool AtlasPacker::AllocateOnShelf(Shelf &shelf, int width, int height, Rect &rc)
+{
+    for (auto it = shelf.Free.begin(); it != shelf.Free.end(); ++it)
+    {
+        if (it->Width < width)
+            continue;
+        rc = RectWH(it->X, shelf.Y, width, height);
+        it->X += width;
+        it->Width -= width;
+        if (it->Width == 0)
+            shelf.Free.erase(it);
+        _regionCount++;
+        _usedArea += width * height;
+        return true;
+    }
+    return false;
+}
+
+void AtlasPacker::Free(const Rect &rc)
+{
+    auto shelf_it = std::find_if(_shelves.begin(), _shelves.end(),
+        [&rc](const Shelf &shelf) { return shelf.Y == rc.Top; });
+    if (shelf_it == _shelves.end())
+        return; // not our region
+
+    // Insert the span back, merging with the neighbours
+    auto &free = shelf_it->Free;
+    auto it = std::lower_bound(free.begin(), free.end(), rc.Left,
+        [](const Span &span, int x) { return span.X < x; });
+    it = free.insert(it, Span(rc.Left, rc.GetWidth()));
+    if ((it + 1) != free.end() && (it->X + it->Width == (it + 1)->X))
+    {
+        it->Width += (it + 1)->Width;
+        free.erase(it + 1);
+    }
+    if (it != free.begin() && ((it - 1)->X + (it - 1)->Width == it->X))
+    {
+        (it - 1)->Width += it->Width;
+        free.erase(it);
+    }
+
+    _regionCount--;
+    _usedArea -= rc.GetWidth() * rc.GetHeight();
+
+    // Remove the empty shelves from the bottom of the page
+    while (!_shelves.empty())
+    {
+        const Shelf &last = _shelves.back();
+        if (last.Free.size() != 1 || last.Free[0].Width != _width)
+            break;
+        _nextY = last.Y;
+        _shelves.pop_back();
+    }
+}
+
+void AtlasPacker::Clear()
+{
+    _shelves.clear();
+    _nextY = 0;
+    _regionCount = 0;
+    _usedArea = 0;
+}
+
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,88 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+//
+// AtlasPacker allocates rectangular regions on a fixed-size atlas page.
+//
+// The page is divided into "shelves": horizontal strips, each having a
+// height of the first region placed on it. Regions are put on the shelf
+// of the closest height, from left to right. Released regions are merged
+// back into their shelf's free spans, and the empty shelves at the bottom
+// of the page are removed, making space for the shelves of other heights.
+//
+// This packing is not the tightest one, but is fast and handles frequent
+// allocations and deallocations well, which is what the renderer needs for
+// the textures of the GUI controls, overlays and similar small sprites.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__ATLASPACKER_H
+#define __AGS_EE_GFX__ATLASPACKER_H
+
+#include <vector>
+#include "util/geometry.h"
+
+namespace AGS
+{
+namespace Engine
+{
+
+class AtlasPacker
+{
+public:
+    AtlasPacker(int width, int height);
+
+    int GetWidth() const { return _width; }
+    int GetHeight() const { return _height; }
+    // Tells if there are no regions allocated on this page
+    bool IsEmpty() const { return _regionCount == 0; }
+    // Gets the number of currently allocated regions
+    size_t GetRegionCount() const { return _regionCount; }
+    // Gets the total area of the allocated regions, in pixels
+    size_t GetUsedArea() const { return _usedArea; }
+
+    // Allocates a region of the given size, fills its position in rc;
+    // returns false if there's no space left for it
+    bool Allocate(int width, int height, Rect &rc);
+    // Releases previously allocated region
+    void Free(const Rect &rc);
+    // Releases everything
+    void Clear();
+
+private:
+    struct Span
+    {
+        int X, Width;
+        Span(int x, int width) : X(x), Width(width) {}
+    };
+
+    struct Shelf
+    {
+        int Y, Height;
+        std::vector<Span> Free; // free spans, sorted by X
+    };
+
+    // Tries to allocate a region on the given shelf
+    bool AllocateOnShelf(Shelf &shelf, int width, int height, Rect &rc);
+
+    int _width;
+    int _height;
+    std::vector<Shelf> _shelves; // sorted by Y
+    int _nextY = 0; // the top of the free space below the last shelf
+    size_t _regionCount = 0;
+    size_t _usedArea = 0;
+};
+
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__ATLASPACKER_H
@@ -132,6 +132,14 @@ uint32_t _myblender_color32(uint32_t x, uint32_t y, uint32_t /*n*/)
     return makeacol32(r, g, b, geta32(y));
 }
 
+void make_tint_table32(uint32_t *table, int r, int g, int b, int luminance)
+{
+    const uint32_t col = makecol32(r, g, b);
+    BLENDER_FUNC blender = (luminance >= 250) ? _myblender_color32 : _myblender_color32_light;
+    for (int v = 0; v < 256; ++v)
+        table[v] = blender(col, makeacol32(v, v, v, 0), luminance) & 0xFFFFFF;
+}
+
 // trans24 blender, but preserve alpha channel from image
 uint32_t _myblender_alpha_trans24(uint32_t x, uint32_t y, uint32_t n)
 {
@@ -38,6 +38,12 @@ uint32_t _myblender_color32(uint32_t x, uint32_t y, uint32_t n);
 uint32_t _myblender_color15_light(uint32_t x, uint32_t y, uint32_t n);
 uint32_t _myblender_color16_light(uint32_t x, uint32_t y, uint32_t n);
 uint32_t _myblender_color32_light(uint32_t x, uint32_t y, uint32_t n);
+// Fills the 256-entry lookup table with the results of the 32-bit tint
+// blender (chosen by luminance same as tint_image does), indexed by the max
+// color component of the image pixel. The HSV tint only takes the "value"
+// of the image pixel, so the table reproduces the blender exactly for any
+// pixel, except for the alpha, which the blenders copy from the image as-is.
+void make_tint_table32(uint32_t *table, int r, int g, int b, int luminance);
 // Customizable alpha blender that uses the supplied alpha value as src alpha,
 // and preserves destination's alpha channel (if there was one);
 void set_my_trans_blender(int r, int g, int b, int a);
@@ -15,6 +15,7 @@
 #include "core/platform.h"
 #include "gfx/gfx_util.h"
 #include "gfx/blender.h"
+#include "gfx/blitkernels.h"
 
 namespace AGS
 {
@@ -152,7 +153,15 @@ void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int al
         sprite = &hctemp;
     }
 
-    if ((alpha < 0xFF) && (surface_depth > 8) && (sprite_depth > 8))
+    if ((surface_depth == 32) && (sprite->GetColorDepth() == 32))
+    {
+        // most common case, use the vectorized kernels
+        if (alpha < 0xFF)
+            BlitKernels::TransBlend(ds, sprite, x, y, alpha);
+        else
+            BlitKernels::MaskedCopy(ds, sprite, x, y);
+    }
+    else if ((alpha < 0xFF) && (surface_depth > 8) && (sprite_depth > 8))
     {
         set_trans_blender(0, 0, 0, alpha);
         ds->TransBlendBlt(sprite, x, y);
@@ -33,6 +33,11 @@ GraphicsDriverBase::GraphicsDriverBase()
     _rendSpriteBatch = UINT32_MAX;
 }
 
+GraphicsDriverBase::~GraphicsDriverBase()
+{
+    StopRenderThread();
+}
+
 bool GraphicsDriverBase::IsModeSet() const
 {
     return _mode.Width != 0 && _mode.Height != 0 && _mode.ColorDepth != 0;
@@ -70,6 +75,7 @@ bool GraphicsDriverBase::SetVsync(bool enabled)
         return _mode.Vsync;
     }
 
+    WaitForRender();
     bool new_value;
     if (SetVsyncImpl(enabled, new_value) && new_value == enabled)
     {
@@ -104,6 +110,7 @@ void GraphicsDriverBase::BeginSpriteBatch(IDriverDependantBitmap *render_target,
 
 void GraphicsDriverBase::BeginSpriteBatch(const SpriteBatchDesc &desc)
 {
+    WaitForRender();
     _spriteBatchDesc.push_back(desc);
     _spriteBatchRange.push_back(std::make_pair(GetLastDrawEntryIndex(), SIZE_MAX));
     _actSpriteBatch = _spriteBatchDesc.size() - 1;
@@ -121,12 +128,123 @@ void GraphicsDriverBase::EndSpriteBatch()
 
 void GraphicsDriverBase::ClearDrawLists()
 {
+    WaitForRender();
     ResetAllBatches();
     _actSpriteBatch = UINT32_MAX;
     _spriteBatchDesc.clear();
     _spriteBatchRange.clear();
 }
 
+RenderStats GraphicsDriverBase::GetRenderStats() const
+{
+#if !defined(AGS_DISABLE_THREADS)
+    // While the render thread has a job, return the stats of the last complete frame
+    if (!_renderContextPassed)
+        return _renderStats;
+    std::lock_guard<std::mutex> lk(_renderMutex);
+    return _threadRenderStats;
+#else
+    return _renderStats;
+#endif
+}
+
+#if !defined(AGS_DISABLE_THREADS)
+
+void GraphicsDriverBase::StartRenderThread()
+{
+    if (_renderThread.joinable())
+        return;
+    _renderBusy = false;
+    _renderThreadExit = false;
+    _renderContextPassed = false;
+    _renderThread = std::thread(&GraphicsDriverBase::RenderThreadProc, this);
+    Debug::Printf("Render thread started");
+}
+
+void GraphicsDriverBase::StopRenderThread()
+{
+    if (!_renderThread.joinable())
+        return;
+    WaitForRender();
+    {
+        std::lock_guard<std::mutex> lk(_renderMutex);
+        _renderThreadExit = true;
+    }
+    _renderJobCond.notify_one();
+    _renderThread.join();
+    Debug::Printf("Render thread stopped");
+}
+
+void GraphicsDriverBase::RenderInThread(std::function<void()> job)
+{
+    WaitForRender();
+    ReleaseRenderContext();
+    _renderContextPassed = true;
+    {
+        std::lock_guard<std::mutex> lk(_renderMutex);
+        _renderJob = std::move(job);
+        _renderBusy = true;
+        _threadRenderStats = _renderStats;
+    }
+    _renderJobCond.notify_one();
+}
+
+void GraphicsDriverBase::WaitForRender()
+{
+    if (!_renderContextPassed || (std::this_thread::get_id() == _renderThread.get_id()))
+        return;
+    {
+        std::unique_lock<std::mutex> lk(_renderMutex);
+        _renderDoneCond.wait(lk, [this]() { return !_renderBusy; });
+    }
+    AcquireRenderContext();
+    _renderContextPassed = false;
+}
+
+void GraphicsDriverBase::RenderThreadProc()
+{
+    std::unique_lock<std::mutex> lk(_renderMutex);
+    for (;;)
+    {
+        _renderJobCond.wait(lk, [this]() { return _renderBusy || _renderThreadExit; });
+        if (!_renderBusy)
+            break; // exit requested, and no more jobs
+        std::function<void()> job;
+        job.swap(_renderJob);
+        lk.unlock();
+
+        AcquireRenderContext();
+        job();
+        ReleaseRenderContext();
+
+        lk.lock();
+        _threadRenderStats = _renderStats;
+        _renderBusy = false;
+        _renderDoneCond.notify_all();
+    }
+}
+
+#else // AGS_DISABLE_THREADS
+
+void GraphicsDriverBase::StartRenderThread()
+{
+}
+
+void GraphicsDriverBase::StopRenderThread()
+{
+}
+
+void GraphicsDriverBase::RenderInThread(std::function<void()> job)
+{
+    job();
+}
+
+void GraphicsDriverBase::WaitForRender()
+{
+}
+
+#endif // AGS_DISABLE_THREADS
+
 void GraphicsDriverBase::OnInit()
 {
 }
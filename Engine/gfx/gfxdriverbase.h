@@ -18,9 +18,15 @@
 #ifndef __AGS_EE_GFX__GFXDRIVERBASE_H
 #define __AGS_EE_GFX__GFXDRIVERBASE_H
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <vector>
+#if !defined(AGS_DISABLE_THREADS)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
 #include "gfx/ddb.h"
 #include "gfx/gfx_def.h"
 #include "gfx/graphicsdriver.h"
@@ -111,6 +117,7 @@ class GraphicsDriverBase : public IGraphicsDriver
 {
 public:
     GraphicsDriverBase();
+    ~GraphicsDriverBase() override;
 
     bool        IsModeSet() const override;
     bool        IsNativeSizeValid() const override;
@@ -132,6 +139,9 @@ public:
     void        SetCallbackOnInit(GFXDRV_CLIENTCALLBACKINITGFX callback) override { _initGfxCallback = callback; }
     void        SetCallbackOnSpriteEvt(GFXDRV_CLIENTCALLBACKEVT callback) override { _spriteEvtCallback = callback; }
 
+    RenderStats GetRenderStats() const override;
+    uint32_t    GetRenderTargetsGeneration() const override { return _rtGeneration; }
+
 protected:
     // Special internal values, applied to DrawListEntry
     static const uintptr_t DRAWENTRY_STAGECALLBACK = 0x0;
@@ -168,6 +178,37 @@ protected:
     void BeginSpriteBatch(const SpriteBatchDesc &desc);
     void OnScalingChanged();
 
+    // Render thread support.
+    // The render thread executes one render job at a time, while the calling
+    // thread may proceed with the game update. The implementation must make
+    // sure that the render job does not use any data that may be modified by
+    // the engine, and call WaitForRender() before changing any data which
+    // the render job uses, or accessing the render context.
+    // When the engine is built with AGS_DISABLE_THREADS, the render thread
+    // is never started, and the render jobs are run on the calling thread.
+    //
+    // Starts the render thread, if it's not running yet
+    void StartRenderThread();
+    // Waits for the current render job and stops the render thread
+    void StopRenderThread();
+#if !defined(AGS_DISABLE_THREADS)
+    bool IsRenderThreadRunning() const { return _renderThread.joinable(); }
+#else
+    bool IsRenderThreadRunning() const { return false; }
+#endif
+    // Passes the render job to the render thread, and returns immediately;
+    // waits for the previous job to complete first. The render context is
+    // passed to the render thread along with the job.
+    void RenderInThread(std::function<void()> job);
+    // Waits until the render thread completes its job, and takes the render
+    // context back to the calling thread. Does nothing if the render thread
+    // is not running, or has no job, or if called from the render thread itself.
+    void WaitForRender();
+    // Makes the render context current for the calling thread
+    virtual void AcquireRenderContext() {}
+    // Releases the render context from the calling thread
+    virtual void ReleaseRenderContext() {}
+
     DisplayMode         _mode;          // display mode settings
     Rect                _srcRect;       // rendering source rect
     int                 _srcColorDepth; // rendering source color depth (in bits per pixel)
@@ -192,6 +233,30 @@ protected:
     // The index of a currently rendered sprite batch
     // (or -1 / UINT32_MAX if we are outside of the render pass)
     uint32_t _rendSpriteBatch;
+    // Statistics of the last rendered frame, filled by the implementation
+    RenderStats _renderStats;
+    // Render targets contents generation, the implementation should increment
+    // this whenever the render targets lose their contents
+    uint32_t _rtGeneration = 0u;
+
+private:
+#if !defined(AGS_DISABLE_THREADS)
+    void RenderThreadProc();
+
+    std::thread _renderThread;
+    mutable std::mutex _renderMutex;
+    std::condition_variable _renderJobCond;
+    std::condition_variable _renderDoneCond;
+    std::function<void()> _renderJob;
+    bool _renderBusy = false; // render thread has a job
+    bool _renderThreadExit = false;
+    // Tells that the render context was passed to the render thread,
+    // and must be taken back before using it on the calling thread
+    bool _renderContextPassed = false;
+    // Copy of the render statistics, made by the render thread
+    // after completing its job
+    RenderStats _threadRenderStats;
+#endif // !AGS_DISABLE_THREADS
 };
 
 
@@ -16,6 +16,7 @@
 
 #include "core/platform.h"
 
+#include "gfx/ali3dnull.h"
 #include "gfx/ali3dsw.h"
 #include "gfx/gfxfilter_sdl_renderer.h"
 
@@ -57,6 +58,10 @@ IGfxDriverFactory *GetGfxDriverFactory(const String id)
 #endif
     if (id.CompareNoCase("Software") == 0)
         return ALSW::SDLRendererGraphicsFactory::GetFactory();
+    // NOTE: Null driver is not in the list of names, as it's never a
+    // suitable fallback for the real ones, but may be requested explicitly
+    if (id.CompareNoCase("Null") == 0)
+        return ALNull::NullGraphicsFactory::GetFactory();
     SDL_SetError("No graphics factory with such id: %s", id.GetCStr());
     return nullptr;
 }
@@ -12,6 +12,11 @@
 //
 //=============================================================================
 #include "gfx/gfxfilter_sdl_renderer.h"
+#include <algorithm>
+#include "gfx/scalekernels.h"
+#include "util/threadpool.h"
+
+using namespace AGS::Common;
 
 namespace AGS
 {
@@ -21,12 +26,125 @@ namespace ALSW
 {
 
 const GfxFilterInfo SDLRendererGfxFilter::FilterInfo = GfxFilterInfo("StdScale", "Nearest-neighbour");
+const GfxFilterInfo SDLLinearGfxFilter::FilterInfo = GfxFilterInfo("Linear", "Linear interpolation");
+const GfxFilterInfo SDLPixelArtGfxFilter::FilterInfo = GfxFilterInfo("Hqx", "Pixel art (Scale2x/3x)");
+
+// Minimal number of rows per each thread's task
+static const size_t MinRowsPerTask = 16;
+
+// Runs func(row_begin, row_end) for the range of rows, either splitting it
+// between the pool's threads, or on the calling thread
+static void ForEachRows(ThreadPool *pool, int rows, const std::function<void(size_t, size_t)> &func)
+{
+    if (pool)
+        pool->ParallelFor(0, rows, func, MinRowsPerTask);
+    else
+        func(0, rows);
+}
+
+static Size LimitSize(const Size &size, const Size &max_size)
+{
+    return Size(max_size.Width > 0 ? std::min(size.Width, max_size.Width) : size.Width,
+        max_size.Height > 0 ? std::min(size.Height, max_size.Height) : size.Height);
+}
 
 const GfxFilterInfo &SDLRendererGfxFilter::GetInfo() const
 {
     return FilterInfo;
 }
 
+Size SDLRendererGfxFilter::GetScaledSize(const Size &src_size, const Size &/*max_size*/) const
+{
+    return src_size;
+}
+
+const GfxFilterInfo &SDLLinearGfxFilter::GetInfo() const
+{
+    return FilterInfo;
+}
+
+Size SDLLinearGfxFilter::GetScaledSize(const Size &src_size, const Size &max_size) const
+{
+    if (_dstRect.IsEmpty())
+        return src_size;
+    return LimitSize(_dstRect.GetSize(), max_size);
+}
+
+void SDLLinearGfxFilter::ScaleFrame(const uint32_t *src, size_t src_pitch, const Size &src_size,
+    uint32_t *dst, size_t dst_pitch, const Size &dst_size, ThreadPool *pool)
+{
+    ForEachRows(pool, dst_size.Height, [&](size_t row_begin, size_t row_end)
+    {
+        ScaleKernels::ScaleBilinear(src, src_pitch, src_size.Width, src_size.Height,
+            dst, dst_pitch, dst_size.Width, dst_size.Height, row_begin, row_end);
+    });
+}
+
+const GfxFilterInfo &SDLPixelArtGfxFilter::GetInfo() const
+{
+    return FilterInfo;
+}
+
+void SDLPixelArtGfxFilter::GetScaleFactors(const Size &src_size, const Size &dst_size,
+    const Size &max_size, int &art_factor, int &int_factor)
+{
+    const Size limit = LimitSize(dst_size, max_size);
+    const int total = std::min(limit.Width / src_size.Width, limit.Height / src_size.Height);
+    art_factor = int_factor = 1;
+    // Choose the pixel art factor which gives the largest total integer scale
+    for (int factor = 3; factor >= 2; --factor)
+    {
+        if ((total >= factor) && (factor * (total / factor) > art_factor * int_factor))
+        {
+            art_factor = factor;
+            int_factor = total / factor;
+        }
+    }
+}
+
+Size SDLPixelArtGfxFilter::GetScaledSize(const Size &src_size, const Size &max_size) const
+{
+    if (_dstRect.IsEmpty() || src_size.IsNull())
+        return src_size;
+    int art_factor, int_factor;
+    GetScaleFactors(src_size, _dstRect.GetSize(), max_size, art_factor, int_factor);
+    return src_size * (art_factor * int_factor);
+}
+
+void SDLPixelArtGfxFilter::ScaleFrame(const uint32_t *src, size_t src_pitch, const Size &src_size,
+    uint32_t *dst, size_t dst_pitch, const Size &dst_size, ThreadPool *pool)
+{
+    int art_factor, int_factor;
+    GetScaleFactors(src_size, dst_size, Size(), art_factor, int_factor);
+    if (art_factor == 1)
+        return;
+
+    uint32_t *art_dst = dst;
+    size_t art_pitch = dst_pitch;
+    const Size art_size = src_size * art_factor;
+    if (int_factor > 1)
+    {
+        _artBuffer.resize(art_size.Width * art_size.Height);
+        art_dst = _artBuffer.data();
+        art_pitch = art_size.Width * sizeof(uint32_t);
+    }
+
+    ForEachRows(pool, src_size.Height, [&](size_t row_begin, size_t row_end)
+    {
+        ScaleKernels::ScalePixelArt(src, src_pitch, src_size.Width, src_size.Height,
+            art_dst, art_pitch, art_factor, row_begin, row_end);
+    });
+
+    if (int_factor > 1)
+    {
+        ForEachRows(pool, dst_size.Height, [&](size_t row_begin, size_t row_end)
+        {
+            ScaleKernels::ScaleNearest(art_dst, art_pitch, art_size.Width, art_size.Height,
+                dst, dst_pitch, dst_size.Width, dst_size.Height, row_begin, row_end);
+        });
+    }
+}
+
 } // namespace ALSW
 } // namespace Engine
 } // namespace AGS
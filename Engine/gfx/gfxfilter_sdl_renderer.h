@@ -12,16 +12,21 @@
 //
 //=============================================================================
 //
-// SDL software renderer filter. Technically a non-op, as SDL_Renderer
-// does the job.
+// SDL software renderer filters. The standard filter is technically
+// a non-op, as SDL_Renderer does the job. Other filters upscale the final
+// frame on CPU before passing it to the SDL_Renderer, optionally splitting
+// the work between several threads.
 //
 //=============================================================================
 #ifndef __AGS_EE_GFX__SDLRENDERERFILTER_H
 #define __AGS_EE_GFX__SDLRENDERERFILTER_H
+#include <vector>
 #include "gfx/gfxfilter_scaling.h"
 
 namespace AGS
 {
+namespace Common { class ThreadPool; }
+
 namespace Engine
 {
 namespace ALSW
@@ -32,7 +37,57 @@ class SDLRendererGfxFilter : public ScalingGfxFilter
 public:
     const GfxFilterInfo &GetInfo() const override;
 
+    // Gets the size of a frame which this filter produces from the source
+    // frame of src_size, not exceeding max_size; returns src_size if the
+    // scaling is left entirely to the SDL_Renderer.
+    virtual Size GetScaledSize(const Size &src_size, const Size &max_size) const;
+    // Tells if SDL_Renderer should use linear filtering when stretching
+    // the frame to the final size
+    virtual bool IsLinearStretch() const { return false; }
+    // Scales the 32-bit source frame into the destination of GetScaledSize();
+    // the optional thread pool is used to split the work
+    virtual void ScaleFrame(const uint32_t* /*src*/, size_t /*src_pitch*/, const Size &/*src_size*/,
+        uint32_t* /*dst*/, size_t /*dst_pitch*/, const Size &/*dst_size*/, Common::ThreadPool* /*pool*/) {}
+
+    static const GfxFilterInfo FilterInfo;
+};
+
+// Bilinear scaling to the final size, done on CPU
+class SDLLinearGfxFilter : public SDLRendererGfxFilter
+{
+public:
+    const GfxFilterInfo &GetInfo() const override;
+
+    Size GetScaledSize(const Size &src_size, const Size &max_size) const override;
+    bool IsLinearStretch() const override { return true; }
+    void ScaleFrame(const uint32_t *src, size_t src_pitch, const Size &src_size,
+        uint32_t *dst, size_t dst_pitch, const Size &dst_size, Common::ThreadPool *pool) override;
+
+    static const GfxFilterInfo FilterInfo;
+};
+
+// Pixel art upscaling: Scale2x or Scale3x, followed by the nearest-neighbour
+// scaling by the largest integer factor which fits the final size; the rest
+// of stretching is done by SDL_Renderer with linear filtering.
+class SDLPixelArtGfxFilter : public SDLRendererGfxFilter
+{
+public:
+    const GfxFilterInfo &GetInfo() const override;
+
+    Size GetScaledSize(const Size &src_size, const Size &max_size) const override;
+    bool IsLinearStretch() const override { return true; }
+    void ScaleFrame(const uint32_t *src, size_t src_pitch, const Size &src_size,
+        uint32_t *dst, size_t dst_pitch, const Size &dst_size, Common::ThreadPool *pool) override;
+
     static const GfxFilterInfo FilterInfo;
+
+private:
+    // Chooses the pixel art and integer scaling factors for the given sizes
+    static void GetScaleFactors(const Size &src_size, const Size &dst_size,
+        const Size &max_size, int &art_factor, int &int_factor);
+
+    // Pixel art scaler's output, when it has to be scaled further
+    std::vector<uint32_t> _artBuffer;
 };
 
 } // namespace ALSW
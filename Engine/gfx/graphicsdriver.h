@@ -25,6 +25,7 @@
 #include "gfx/gfxdefines.h"
 #include "gfx/gfxmodelist.h"
 #include "util/geometry.h"
+#include "util/string.h"
 
 namespace AGS
 {
@@ -82,6 +83,14 @@ struct RenderMatrixes
     glm::mat4 Projection;
 };
 
+// Statistics of the last rendered frame
+struct RenderStats
+{
+    uint32_t Sprites = 0u;   // number of sprites drawn
+    uint32_t DrawCalls = 0u; // number of draw calls issued to the device
+                             // (or bitmap blits, for the software renderer)
+};
+
 
 typedef void (*GFXDRV_CLIENTCALLBACK)();
 typedef bool (*GFXDRV_CLIENTCALLBACKEVT)(int evt, int data);
@@ -232,6 +241,17 @@ public:
   // rendered in the high-res mode.
   virtual void RenderSpritesAtScreenResolution(bool enabled) = 0;
   virtual void UseSmoothScaling(bool enabled) = 0;
+  // Sets the number of threads that the renderer may use to draw sprites;
+  // 1 means drawing on the calling thread only, 0 means use as many threads
+  // as there are hardware threads. Only used by the software renderer.
+  virtual void SetRenderThreads(int count) = 0;
+  // Enables or disables rendering and presenting the frames on a separate
+  // thread, letting the engine prepare the next frame in the meantime;
+  // returns the *new state*. Only supported by the OpenGL renderer.
+  virtual bool UseRenderThread(bool enabled) = 0;
+  // Sets up saving every Nth rendered frame into the given directory;
+  // interval 0 disables frame dumps. Only supported by the Null renderer.
+  virtual void SetFrameDump(const Common::String &dir, int interval) = 0;
   virtual bool SupportsGammaControl() = 0;
   virtual void SetGamma(int newGamma) = 0;
   // Returns the virtual screen. Will return NULL if renderer does not support memory backbuffer.
@@ -252,6 +272,12 @@ public:
   // These matrixes will be filled in accordance to the renderer's compatible format;
   // returns false if renderer does not use matrixes (not a 3D renderer).
   virtual bool GetStageMatrixes(RenderMatrixes &rm) = 0;
+  // Returns the statistics of the last rendered frame
+  virtual RenderStats GetRenderStats() const = 0;
+  // Returns the number of times when the existing render targets have lost
+  // their contents (e.g. on a device reset). The render targets stay valid,
+  // but anything drawn on them has to be drawn again if this value changes.
+  virtual uint32_t GetRenderTargetsGeneration() const = 0;
 
   virtual ~IGraphicsDriver() = default;
 };
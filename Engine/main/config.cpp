@@ -332,6 +332,11 @@ void apply_config(const ConfigTree &cfg)
         usetup.Screen.Params.RefreshRate = CfgReadInt(cfg, "graphics", "refresh");
         usetup.Screen.Params.VSync = CfgReadBoolInt(cfg, "graphics", "vsync");
         usetup.RenderAtScreenRes = CfgReadBoolInt(cfg, "graphics", "render_at_screenres");
+        usetup.RenderThreads = CfgReadInt(cfg, "graphics", "render_threads", usetup.RenderThreads);
+        usetup.SpriteThreads = CfgReadInt(cfg, "graphics", "sprite_threads", usetup.SpriteThreads);
+        usetup.RenderThread = CfgReadBoolInt(cfg, "graphics", "render_thread", usetup.RenderThread);
+        usetup.FrameDumpInterval = CfgReadInt(cfg, "graphics", "frame_dump_interval", usetup.FrameDumpInterval);
+        usetup.FrameDumpDir = CfgReadString(cfg, "graphics", "frame_dump_dir", usetup.FrameDumpDir);
         usetup.enable_antialiasing = CfgReadBoolInt(cfg, "graphics", "antialias", usetup.enable_antialiasing);
         usetup.software_render_driver = CfgReadString(cfg, "graphics", "software_driver");
 
@@ -346,14 +351,26 @@ void apply_config(const ConfigTree &cfg)
         usetup.user_data_dir = CfgReadString(cfg, "misc", "user_data_dir");
         usetup.shared_data_dir = CfgReadString(cfg, "misc", "shared_data_dir");
         usetup.show_fps = CfgReadBoolInt(cfg, "misc", "show_fps");
+        usetup.PreciseFramePacing = CfgReadBoolInt(cfg, "misc", "precise_frame_pacing", usetup.PreciseFramePacing);
+        usetup.FrameProfileFile = CfgReadString(cfg, "misc", "frame_profile");
+        usetup.InputRecordFile = CfgReadString(cfg, "misc", "input_record");
+        usetup.InputReplayFile = CfgReadString(cfg, "misc", "input_replay");
 
         // Translation / localization
         usetup.translation = CfgReadString(cfg, "language", "translation");
 
         // Resource caches and options
         usetup.clear_cache_on_room_change = CfgReadBoolInt(cfg, "misc", "clear_cache_on_room_change", usetup.clear_cache_on_room_change);
+        usetup.MemoryMapAssets = CfgReadBoolInt(cfg, "misc", "memory_map_assets", usetup.MemoryMapAssets);
+        usetup.ParallelStartup = CfgReadBoolInt(cfg, "misc", "parallel_startup", usetup.ParallelStartup);
         usetup.SpriteCacheSize = CfgReadInt(cfg, "graphics", "sprite_cache_size", usetup.SpriteCacheSize);
         usetup.TextureCacheSize = CfgReadInt(cfg, "graphics", "texture_cache_size", usetup.TextureCacheSize);
+        usetup.TransformCacheSize = CfgReadInt(cfg, "graphics", "transform_cache_size", usetup.TransformCacheSize);
+        usetup.GlyphCacheSize = CfgReadInt(cfg, "graphics", "glyph_cache_size", usetup.GlyphCacheSize);
+        usetup.AnimPrecache = StrUtil::ParseEnum<AnimPrecacheMode>(
+            CfgReadString(cfg, "graphics", "anim_precache"),
+            CstrArr<kNumAnimPrecacheModes>{ "off", "sync", "thread" }, usetup.AnimPrecache);
+        usetup.AnimPrecacheMaxFrames = CfgReadInt(cfg, "graphics", "anim_precache_frames", usetup.AnimPrecacheMaxFrames);
         usetup.SoundCacheSize = CfgReadInt(cfg, "sound", "cache_size", usetup.SoundCacheSize);
         usetup.SoundLoadAtOnceSize = CfgReadInt(cfg, "sound", "stream_threshold", usetup.SoundLoadAtOnceSize);
 
@@ -39,6 +39,7 @@
 #include "ac/global_character.h"
 #include "ac/global_game.h"
 #include "ac/gui.h"
+#include "ac/inputreplay.h"
 #include "ac/lipsync.h"
 #include "ac/path_helper.h"
 #include "ac/route_finder.h"
@@ -46,6 +47,8 @@
 #include "ac/roomstatus.h"
 #include "ac/speech.h"
 #include "ac/spritecache.h"
+#include "ac/spriteprecache.h"
+#include "ac/timer.h"
 #include "ac/translation.h"
 #include "ac/viewframe.h"
 #include "ac/dynobj/scriptobject.h"
@@ -53,6 +56,7 @@
 #include "core/assetmanager.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
+#include "debug/frameprofiler.h"
 #include "debug/out.h"
 #include "device/mousew32.h"
 #include "font/agsfontrenderer.h"
@@ -74,8 +78,11 @@
 #include "script/script_runtime.h"
 #include "util/directory.h"
 #include "util/error.h"
+#include "util/memory_compat.h"
 #include "util/path.h"
 #include "util/string_utils.h"
+#include "util/taskgraph.h"
+#include "util/threadpool.h"
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -295,6 +302,8 @@ void engine_init_fonts()
     Debug::Printf(kDbgMsg_Info, "Initializing TTF renderer");
 
     init_font_renderer(AssetMgr.get());
+    font_set_glyph_cache_size(usetup.GlyphCacheSize * 1024);
+    Debug::Printf("TTF glyph cache set: %zu KB", usetup.GlyphCacheSize);
 }
 
 void engine_init_mouse()
@@ -340,6 +349,7 @@ void engine_locate_audio_pak()
 // Assign asset locations to the AssetManager
 void engine_assign_assetpaths()
 {
+    AssetMgr->SetMemoryMapping(usetup.MemoryMapAssets);
     AssetMgr->AddLibrary(ResPaths.GamePak.Path, ",audio"); // main pack may have audio bundled too
     // The asset filters are currently a workaround for limiting search to certain locations;
     // this is both an optimization and to prevent unexpected behavior.
@@ -568,9 +578,10 @@ void show_preload()
     }
 }
 
-HError engine_init_sprites()
+// Opens the game's sprite file and reads the sprite metrics from the index;
+// does not touch the sprite cache, and so may be run on another thread
+static HError engine_open_sprite_file(SpriteFile &file, std::vector<Size> &metrics)
 {
-    spriteset.Reset();
     Debug::Printf(kDbgMsg_Info, "Initialize sprites");
     auto sprite_file = AssetMgr->OpenAsset(SpriteFile::DefaultSpriteFileName);
     if (!sprite_file)
@@ -579,14 +590,33 @@ HError engine_init_sprites()
             SpriteFile::DefaultSpriteFileName.GetCStr()));
     }
     auto index_file = AssetMgr->OpenAsset(SpriteFile::DefaultSpriteIndexName);
-    HError err = spriteset.InitFile(std::move(sprite_file), std::move(index_file));
+    return file.OpenFile(std::move(sprite_file), std::move(index_file), metrics);
+}
+
+// Assigns the opened sprite file to the sprite cache, and configures the cache
+static void engine_setup_sprite_cache(SpriteFile &&file, const std::vector<Size> &metrics)
+{
+    spriteset.InitFile(std::move(file), metrics);
+    if (usetup.SpriteCacheSize > 0)
+        spriteset.SetMaxCacheSize(usetup.SpriteCacheSize * 1024);
+    Debug::Printf("Sprite cache set: %zu KB", spriteset.GetMaxCacheSize() / 1024);
+    HError err = init_anim_precache();
+    if (!err)
+        Debug::Printf(kDbgMsg_Warn, "Failed to start background sprite loading:\n%s",
+            err->FullMessage().GetCStr());
+}
+
+HError engine_init_sprites()
+{
+    spriteset.Reset();
+    SpriteFile file;
+    std::vector<Size> metrics;
+    HError err = engine_open_sprite_file(file, metrics);
     if (!err) 
     {
         return err;
     }
-    if (usetup.SpriteCacheSize > 0)
-        spriteset.SetMaxCacheSize(usetup.SpriteCacheSize * 1024);
-    Debug::Printf("Sprite cache set: %zu KB", spriteset.GetMaxCacheSize() / 1024);
+    engine_setup_sprite_cache(std::move(file), metrics);
     return HError::None();
 }
 
@@ -597,8 +627,18 @@ void engine_init_game_settings()
     set_our_eip(-7);
     Debug::Printf("Initialize game settings");
 
-    // Initialize randomizer
-    play.randseed = time(nullptr);
+    // Initialize randomizer; the input replay must use the recorded seed
+    int rand_seed = static_cast<int>(time(nullptr));
+    if (!usetup.InputReplayFile.IsEmpty())
+    {
+        if (InputReplay::StartReplay(usetup.InputReplayFile, game.uniqueid, rand_seed))
+            setTimerFpsUnlimited(true);
+    }
+    else if (!usetup.InputRecordFile.IsEmpty())
+    {
+        InputReplay::StartRecording(usetup.InputRecordFile, game.uniqueid, rand_seed);
+    }
+    play.randseed = rand_seed;
     srand(play.randseed);
 
     if (usetup.audio_enabled)
@@ -1165,6 +1205,99 @@ void engine_init_editor_debugging(const ConfigTree &cfg)
     ccSetDebugHook(scriptDebugHook);
 }
 
+// Loads the game data and initializes the systems which depend on it.
+// The stages which do not depend on each other are run as a task graph:
+// reading of the sprite file's index is done on a worker thread, while the
+// game data is loaded on the main thread. Audio and graphics mode are
+// initialized on the main thread too, as SDL subsystems may only be
+// initialized from the main thread on some platforms.
+// If parallel startup is disabled, all stages are run in order on the main thread.
+// Returns 0 on success, or the engine's exit code.
+static int engine_load_game_and_init_systems()
+{
+    int res = 0;
+    SpriteFile sprite_file;
+    std::vector<Size> sprite_metrics;
+    HError sprite_err = HError::None();
+
+    TaskGraph tasks;
+    const auto audio_task = tasks.Add("audio", []()
+    {
+        engine_init_audio();
+        return true;
+    }, {}, true);
+    const auto gamedata_task = tasks.Add("game data", [&res]()
+    {
+        set_our_eip(-19);
+        res = engine_load_game_data();
+        if (res != 0)
+            return false;
+        set_our_eip(-189);
+        res = engine_check_disk_space();
+        if (res != 0)
+            return false;
+        // Make sure that at least one font was loaded in the process of loading
+        // the game data.
+        // TODO: Fold this check into engine_load_game_data()
+        res = engine_check_font_was_loaded();
+        return res == 0;
+    }, {}, true);
+    const auto sprfile_task = tasks.Add("sprite file", [&]()
+    {
+        sprite_err = engine_open_sprite_file(sprite_file, sprite_metrics);
+        return (bool)sprite_err;
+    });
+    const auto gfxmode_task = tasks.Add("graphics mode", [&res]()
+    {
+        set_our_eip(-179);
+        engine_adjust_for_rotation_settings();
+        // Attempt to initialize graphics mode
+        if (!engine_try_set_gfxmode_any(usetup.Screen))
+        {
+            res = EXIT_ERROR;
+            return false;
+        }
+        // Configure game window after renderer was initialized
+        engine_setup_window();
+        SetMultitasking(usetup.multitasking);
+        sys_window_show_cursor(false); // hide the system cursor
+        show_preload();
+        return true;
+    }, { gamedata_task, audio_task }, true);
+    tasks.Add("sprites", [&]()
+    {
+        engine_setup_sprite_cache(std::move(sprite_file), sprite_metrics);
+        return true;
+    }, { gfxmode_task, sprfile_task }, true);
+
+    std::unique_ptr<ThreadPool> pool;
+    if (usetup.ParallelStartup)
+        pool = std::make_unique<ThreadPool>(2);
+    const bool tasks_ok = tasks.Run(pool.get());
+
+    for (const auto &task : tasks.GetTasks())
+    {
+        if (task.Done)
+            Debug::Printf(kDbgMsg_Info, "Startup stage '%s': started at %lld ms, took %lld ms%s",
+                task.Name.GetCStr(),
+                static_cast<long long>(task.StartTime.count() / 1000),
+                static_cast<long long>(task.Duration.count() / 1000),
+                task.Succeeded ? "" : " (failed)");
+    }
+    Debug::Printf(kDbgMsg_Info, "Startup stages completed in %lld ms (%s)",
+        static_cast<long long>(tasks.GetTotalTime().count() / 1000),
+        pool ? "parallel" : "sequential");
+
+    if (res != 0)
+        return res;
+    if (!sprite_err)
+    {
+        platform->DisplayAlert("Could not load sprite set file:\n%s", sprite_err->FullMessage().GetCStr());
+        return EXIT_ERROR;
+    }
+    return tasks_ok ? 0 : EXIT_ERROR;
+}
+
 // TODO: this function is still a big mess, engine/system-related initialization
 // is mixed with game-related data adjustments. Divide it in parts, move game
 // data init into either InitGameState() or other game method as appropriate.
@@ -1216,6 +1349,14 @@ int initialize_engine(const ConfigTree &startup_opts)
         return EXIT_NORMAL;
     }
 
+    // Start recording frame timings, if requested
+    if (!usetup.FrameProfileFile.IsEmpty())
+        FrameProfiler::Start(usetup.FrameProfileFile);
+    // Input replay runs as fast as possible
+    if (!usetup.InputReplayFile.IsEmpty())
+        usetup.Screen.Params.VSync = false;
+    setTimerPrecisePacing(usetup.PreciseFramePacing);
+
     set_our_eip(-190);
 
     //-----------------------------------------------------
@@ -1249,10 +1390,6 @@ int initialize_engine(const ConfigTree &startup_opts)
 
     engine_init_mouse();
 
-    set_our_eip(-198);
-
-    engine_init_audio();
-
     set_our_eip(-199);
 
     engine_init_debug();
@@ -1265,49 +1402,10 @@ int initialize_engine(const ConfigTree &startup_opts)
 
     set_game_speed(40);
 
-    set_our_eip(-20);
-    set_our_eip(-19);
-
-    int res = engine_load_game_data();
+    int res = engine_load_game_and_init_systems();
     if (res != 0)
         return res;
 
-    set_our_eip(-189);
-
-    res = engine_check_disk_space();
-    if (res != 0)
-        return res;
-
-    // Make sure that at least one font was loaded in the process of loading
-    // the game data.
-    // TODO: Fold this check into engine_load_game_data()
-    res = engine_check_font_was_loaded();
-    if (res != 0)
-        return res;
-
-    set_our_eip(-179);
-
-    engine_adjust_for_rotation_settings();
-
-    // Attempt to initialize graphics mode
-    if (!engine_try_set_gfxmode_any(usetup.Screen))
-        return EXIT_ERROR;
-
-    // Configure game window after renderer was initialized
-    engine_setup_window();
-
-    SetMultitasking(usetup.multitasking);
-
-    sys_window_show_cursor(false); // hide the system cursor
-
-    show_preload();
-    HError err = engine_init_sprites();
-    if (!err)
-    {
-        platform->DisplayAlert("Could not load sprite set file:\n%s", err->FullMessage().GetCStr());
-        return EXIT_ERROR;
-    }
-
     // TODO: move *init_game_settings to game init code unit
     engine_init_game_settings();
     engine_prepare_to_start_game();
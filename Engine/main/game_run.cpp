@@ -42,6 +42,7 @@
 #include "ac/object.h"
 #include "ac/overlay.h"
 #include "ac/spritecache.h"
+#include "ac/spriteprecache.h"
 #include "ac/sys_events.h"
 #include "ac/room.h"
 #include "ac/roomobject.h"
@@ -51,6 +52,7 @@
 #include "ac/walkbehind.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/frameprofiler.h"
 #include "device/mousew32.h"
 #include "gui/animatingguibutton.h"
 #include "gui/guiinv.h"
@@ -222,6 +224,7 @@ static void game_loop_check_problems_at_start()
 // Runs rep-exec
 static void game_loop_do_early_script_update()
 {
+    AGS_PROFILE_SCOPE(kFramePhase_ScriptEarly);
     if (in_new_room == 0) {
         // Run the room and game script repeatedly_execute
         run_function_on_non_blocking_thread(&repExecAlways);
@@ -233,6 +236,7 @@ static void game_loop_do_early_script_update()
 // Runs late-rep-exec
 static void game_loop_do_late_script_update()
 {
+    AGS_PROFILE_SCOPE(kFramePhase_ScriptLate);
     if (in_new_room == 0)
     {
         // Run the room and game script late_repeatedly_execute
@@ -748,6 +752,7 @@ static void game_loop_check_controls(bool checkControls)
 
 static void game_loop_do_update()
 {
+    AGS_PROFILE_SCOPE(kFramePhase_Update);
     if (debug_flags & DBG_NOUPDATE) ;
     else if (game_paused==0) update_stuff();
 }
@@ -952,6 +957,7 @@ void set_loop_counter(unsigned int new_counter) {
 }
 
 void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int extraX, int extraY) {
+    AGS_PROFILE_FRAME();
     sys_evt_process_pending();
 
     numEventsAtStartOfFunction = events.size();
@@ -992,14 +998,17 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
     // Handle player's input
     // remember old mouse pos, needed for update_cursor_over_location() later
     const int mwasatx = mousex, mwasaty = mousey;
-    // update mouse position (mousex, mousey)
-    ags_domouse();
-    // update gui under mouse; this also updates gui control focus;
-    // atm we must call this before "check_controls", because GUI interaction
-    // relies on remembering which control was focused by the cursor prior
-    update_cursor_over_gui();
-    // handle actual input (keys, mouse, and so forth)
-    game_loop_check_controls(checkControls);
+    {
+        AGS_PROFILE_SCOPE(kFramePhase_Input);
+        // update mouse position (mousex, mousey)
+        ags_domouse();
+        // update gui under mouse; this also updates gui control focus;
+        // atm we must call this before "check_controls", because GUI interaction
+        // relies on remembering which control was focused by the cursor prior
+        update_cursor_over_gui();
+        // handle actual input (keys, mouse, and so forth)
+        game_loop_check_controls(checkControls);
+    }
 
     set_our_eip(2);
 
@@ -1016,7 +1025,12 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
     update_cursor_over_location(mwasatx, mwasaty);
     update_cursor_view();
 
-    update_audio_system_on_game_loop();
+    {
+        AGS_PROFILE_SCOPE(kFramePhase_Audio);
+        update_audio_system_on_game_loop();
+    }
+    // receive the sprites that were preloaded for the starting animations
+    update_anim_precache();
 
     // Only render if we are not skipping a cutscene
     if (!play.fast_forward)
@@ -1034,6 +1048,8 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     game_loop_update_loop_counter();
 
+    update_bitmap_pool();
+
     // Immediately start the next frame if we are skipping a cutscene
     if (play.fast_forward)
         return;
@@ -1044,6 +1060,7 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 
     update_polled_stuff();
 
+    AGS_PROFILE_SCOPE(kFramePhase_Wait);
     WaitForNextFrame();
 }
 
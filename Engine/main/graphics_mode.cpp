@@ -21,6 +21,7 @@
 #include <SDL.h>
 #include "core/platform.h"
 #include "ac/draw.h"
+#include "ac/gamesetup.h"
 #include "debug/debugger.h"
 #include "debug/out.h"
 #include "gfx/ali3dexception.h"
@@ -437,6 +438,9 @@ bool graphics_mode_init_any(const GraphicResolution &game_res, const DisplayMode
     // TODO: make factory & driver IDs case-insensitive!
     StringV ids;
     GetGfxDriverFactoryNames(ids);
+    // Headless driver is only used on explicit request, and with no fallbacks
+    if (setup.DriverID.CompareNoCase("Null") == 0)
+        ids = { setup.DriverID };
     StringV::iterator it = ids.begin();
     for (; it != ids.end(); ++it)
     {
@@ -485,6 +489,9 @@ bool graphics_mode_create_renderer(const String &driver_id)
     // TODO: this is remains of the old code; find out if this is really
     // the best time and place to set the tint method
     gfxDriver->SetTintMethod(TintReColourise);
+    gfxDriver->SetRenderThreads(usetup.RenderThreads);
+    gfxDriver->UseRenderThread(usetup.RenderThread);
+    gfxDriver->SetFrameDump(usetup.FrameDumpDir, usetup.FrameDumpInterval);
     return true;
 }
 
@@ -116,13 +116,17 @@ void main_print_help() {
            "  --console-attach             Write output to the parent process's console\n"
 #endif
            "  --fps                        Display fps counter\n"
+           "  --frame-profile FILEPATH     Record frame phase timings into a Chrome trace\n"
+           "                               (.json) or CSV file; requires the engine built\n"
+           "                               with the frame profiler\n"
            "  --fullscreen                 Force display mode to fullscreen\n"
            "  --gfxdriver <id>             Request graphics driver. Available options:\n"
 #if AGS_PLATFORM_OS_WINDOWS
-           "                                 d3d9, ogl, software\n"
+           "                                 d3d9, ogl, software, null\n"
 #else
-           "                                 ogl, software\n"
+           "                                 ogl, software, null\n"
 #endif
+           "                               (null draws the game without a window)\n"
            "  --gfxfilter FILTER [SCALING]\n"
            "                               Request graphics filter. Available options:\n"           
            "                                 stdscale, linear\n"
@@ -164,6 +168,9 @@ void main_print_help() {
            "  --nospr                      Don't draw room objects and characters\n"
            "  --noupdate                   Don't run game update\n"
            "  --novideo                    Don't play game videos\n"
+           "  --record-input FILEPATH      Record player's input into a file\n"
+           "  --replay-input FILEPATH      Replay the recorded input as fast as possible,\n"
+           "                               print the frame times and quit\n"
            "  --rotation <MODE>            Screen rotation preferences. MODEs are:\n"
            "                                 unlocked (0), portrait (1), landscape (2)\n"
            "  --sdl-log=LEVEL              Setup SDL backend logging level\n"
@@ -319,6 +326,12 @@ static int main_process_cmdline(ConfigTree &cfg, int argc, char *argv[])
             cfg["override"]["noplugins"] = "1";
         else if (ags_stricmp(arg, "--fps") == 0)
             cfg["misc"]["show_fps"] = "1";
+        else if ((ags_stricmp(arg, "--frame-profile") == 0) && (argc > ee + 1))
+            cfg["misc"]["frame_profile"] = argv[++ee];
+        else if ((ags_stricmp(arg, "--record-input") == 0) && (argc > ee + 1))
+            cfg["misc"]["input_record"] = argv[++ee];
+        else if ((ags_stricmp(arg, "--replay-input") == 0) && (argc > ee + 1))
+            cfg["misc"]["input_replay"] = argv[++ee];
         else if (ags_stricmp(arg, "--test") == 0) debug_flags |= DBG_DEBUGMODE;
         else if (ags_stricmp(arg, "--noiface") == 0) debug_flags |= DBG_NOIFACE;
         else if (ags_stricmp(arg, "--nosprdisp") == 0) debug_flags |= DBG_NODRAWSPRITES;
@@ -20,17 +20,21 @@
 #include <allegro.h> // find files, allegro_exit
 #include "ac/cdaudio.h"
 #include "ac/common.h"
+#include "ac/dynamicsprite.h"
 #include "ac/game.h"
 #include "ac/gamesetup.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/gamestate.h"
+#include "ac/inputreplay.h"
 #include "ac/roomstatus.h"
 #include "ac/route_finder.h"
+#include "ac/timer.h"
 #include "ac/translation.h"
 #include "ac/dynobj/dynobj_manager.h"
 #include "debug/agseditordebugger.h"
 #include "debug/debug_log.h"
 #include "debug/debugger.h"
+#include "debug/frameprofiler.h"
 #include "debug/out.h"
 #include "font/fonts.h"
 #include "main/config.h"
@@ -180,6 +184,9 @@ QuitReason quit_check_for_error_state(const char *qmsg, String &errmsg, String &
 void quit(const char *quitmsg)
 {
     Debug::Printf(kDbgMsg_Info, "Quitting the game...");
+    FrameProfiler::Stop();
+    InputReplay::Stop();
+    printFramePacingStats();
 
     // NOTE: we must not use the quitmsg pointer past this step,
     // as it may be from a plugin and we're about to free plugins
@@ -211,6 +218,7 @@ void quit(const char *quitmsg)
     set_our_eip(9908);
 
     shutdown_pathfinder();
+    shutdown_dynamic_sprite_transforms();
 
     // Release game data and unregister assets
     quit_check_dynamic_sprites(qreason);
@@ -782,6 +782,8 @@ void D3DGraphicsDriver::ReleaseRenderTargetData()
 
 void D3DGraphicsDriver::RecreateRenderTargets()
 {
+    // The recreated render targets are empty, let the users know
+    _rtGeneration++;
     for (auto &ddb : _renderTargets)
     {
         ddb->ReleaseTextureData();
@@ -1193,6 +1195,7 @@ void D3DGraphicsDriver::RenderTexture(D3DBitmap *bmpToDraw, int draw_x, int draw
     {
       throw Ali3DException("IDirect3DDevice9::DrawPrimitive failed");
     }
+    _renderStats.DrawCalls++;
 
     // Restore default blending mode
     SetBlendOp(D3DBLENDOP_ADD, D3DBLEND_SRCALPHA, D3DBLEND_INVSRCALPHA);
@@ -1207,6 +1210,7 @@ void D3DGraphicsDriver::RenderAndPresent(bool clearDrawListAfterwards)
 
 void D3DGraphicsDriver::RenderImpl(bool clearDrawListAfterwards)
 {
+    _renderStats = RenderStats();
     if (_renderAtScreenRes)
     {
         RenderToSurface(&_screenBackbuffer, clearDrawListAfterwards);
@@ -1450,10 +1454,12 @@ size_t D3DGraphicsDriver::RenderSpriteBatch(const D3DSpriteBatch &batch, size_t
             {
                 auto stageEntry = D3DDrawListEntry((D3DBitmap*)ddb, batch.ID, sx, sy);
                 RenderSprite(&stageEntry, batch.Matrix, batch.Color, rend_sz);
+                _renderStats.Sprites++;
             }
             break;
         default:
             RenderSprite(&e, batch.Matrix, batch.Color, rend_sz);
+            _renderStats.Sprites++;
             break;
         }
     }
@@ -265,6 +265,9 @@ public:
     bool SupportsGammaControl() override;
     void SetGamma(int newGamma) override;
     void UseSmoothScaling(bool enabled) override { _smoothScaling = enabled; }
+    void SetRenderThreads(int /*count*/) override { /* not supported */ }
+    bool UseRenderThread(bool /*enabled*/) override { return false; /* not supported */ }
+    void SetFrameDump(const String &/*dir*/, int /*interval*/) override { /* not supported */ }
 
     typedef std::shared_ptr<D3DGfxFilter> PD3DFilter;
 
@@ -0,0 +1,138 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <vector>
+#include "gtest/gtest.h"
+#include "gfx/atlaspacker.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+static bool Overlaps(const Rect &r1, const Rect &r2)
+{
+    return r1.Left <= r2.Right && r2.Left <= r1.Right &&
+        r1.Top <= r2.Bottom && r2.Top <= r1.Bottom;
+}
+
+// Tests that all the regions are within the page and do not overlap
+static void CheckRegions(const AtlasPacker &packer, const std::vector<Rect> &regions)
+{
+    size_t area = 0;
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        const Rect &rc = regions[i];
+        ASSERT_GE(rc.Left, 0);
+        ASSERT_GE(rc.Top, 0);
+        ASSERT_LT(rc.Right, packer.GetWidth());
+        ASSERT_LT(rc.Bottom, packer.GetHeight());
+        for (size_t j = i + 1; j < regions.size(); ++j)
+            ASSERT_FALSE(Overlaps(rc, regions[j])) << "regions " << i << " and " << j;
+        area += rc.GetWidth() * rc.GetHeight();
+    }
+    ASSERT_EQ(packer.GetRegionCount(), regions.size());
+    ASSERT_EQ(packer.GetUsedArea(), area);
+}
+
+TEST(AtlasPacker, Allocate) {
+    AtlasPacker packer(256, 256);
+    ASSERT_TRUE(packer.IsEmpty());
+    Rect rc;
+    // Invalid or too large sizes
+    ASSERT_FALSE(packer.Allocate(0, 10, rc));
+    ASSERT_FALSE(packer.Allocate(10, -1, rc));
+    ASSERT_FALSE(packer.Allocate(257, 10, rc));
+    ASSERT_FALSE(packer.Allocate(10, 257, rc));
+
+    // Regions of the same height share a shelf, from left to right
+    ASSERT_TRUE(packer.Allocate(100, 32, rc));
+    ASSERT_EQ(rc, RectWH(0, 0, 100, 32));
+    ASSERT_TRUE(packer.Allocate(50, 30, rc));
+    ASSERT_EQ(rc, RectWH(100, 0, 50, 30));
+    // A much lower region starts a new shelf
+    ASSERT_TRUE(packer.Allocate(20, 8, rc));
+    ASSERT_EQ(rc, RectWH(0, 32, 20, 8));
+    ASSERT_EQ(packer.GetRegionCount(), 3u);
+    ASSERT_EQ(packer.GetUsedArea(), 100u * 32 + 50 * 30 + 20 * 8);
+
+    // The whole page may be filled
+    AtlasPacker full(64, 64);
+    std::vector<Rect> regions;
+    for (int i = 0; i < 16; ++i)
+    {
+        ASSERT_TRUE(full.Allocate(16, 16, rc));
+        regions.push_back(rc);
+    }
+    ASSERT_FALSE(full.Allocate(1, 1, rc));
+    CheckRegions(full, regions);
+    ASSERT_EQ(full.GetUsedArea(), 64u * 64);
+}
+
+TEST(AtlasPacker, Free) {
+    AtlasPacker packer(128, 128);
+    Rect rc[3];
+    ASSERT_TRUE(packer.Allocate(40, 20, rc[0]));
+    ASSERT_TRUE(packer.Allocate(40, 20, rc[1]));
+    ASSERT_TRUE(packer.Allocate(40, 20, rc[2]));
+
+    // Freed spans are merged, and a wider region fits in their place
+    packer.Free(rc[0]);
+    packer.Free(rc[1]);
+    Rect wide;
+    ASSERT_TRUE(packer.Allocate(80, 20, wide));
+    ASSERT_EQ(wide, RectWH(0, 0, 80, 20));
+    packer.Free(wide);
+    packer.Free(rc[2]);
+    ASSERT_TRUE(packer.IsEmpty());
+    ASSERT_EQ(packer.GetUsedArea(), 0u);
+
+    // The empty shelf was removed, so the space is used for another height
+    Rect tall;
+    ASSERT_TRUE(packer.Allocate(128, 128, tall));
+    ASSERT_EQ(tall, RectWH(0, 0, 128, 128));
+    packer.Clear();
+    ASSERT_TRUE(packer.IsEmpty());
+    ASSERT_TRUE(packer.Allocate(128, 128, tall));
+}
+
+TEST(AtlasPacker, RandomAllocations) {
+    AtlasPacker packer(512, 512);
+    std::vector<Rect> regions;
+    uint32_t seed = 1;
+    for (int i = 0; i < 2000; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        if ((seed >> 16) % 3 == 0 && !regions.empty())
+        {
+            const size_t index = (seed >> 8) % regions.size();
+            packer.Free(regions[index]);
+            regions.erase(regions.begin() + index);
+        }
+        else
+        {
+            Rect rc;
+            const int w = 1 + (seed >> 4) % 64, h = 1 + (seed >> 12) % 64;
+            if (packer.Allocate(w, h, rc))
+            {
+                ASSERT_EQ(rc.GetWidth(), w);
+                ASSERT_EQ(rc.GetHeight(), h);
+                regions.push_back(rc);
+            }
+        }
+        if (i % 100 == 0)
+            CheckRegions(packer, regions);
+    }
+    CheckRegions(packer, regions);
+    for (const auto &rc : regions)
+        packer.Free(rc);
+    ASSERT_TRUE(packer.IsEmpty());
+}
@@ -0,0 +1,164 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/gamestructdefines.h"
+#include "ac/gui.h"
+#include "ac/spritecache.h"
+#include "gfx/bitmap.h"
+#include "gui/guiinv.h"
+#include "gui/guimain.h"
+#include "gui/guiobject.h"
+
+using namespace AGS::Common;
+
+// A control which fills its rectangle with a plain color
+class TestControl : public GUIObject
+{
+public:
+    TestControl(int x, int y, int width, int height, color_t color, int zorder)
+        : _color(color)
+    {
+        X = x;
+        Y = y;
+        ZOrder = zorder;
+        SetSize(width, height);
+    }
+
+    void Draw(Bitmap *ds, int x, int y) override
+    {
+        ds->FillRect(RectWH(x, y, _width, _height), _color);
+    }
+
+private:
+    color_t _color;
+};
+
+static void AssertBitmapsEqual(Bitmap *bmp1, Bitmap *bmp2)
+{
+    ASSERT_EQ(bmp1->GetSize(), bmp2->GetSize());
+    for (int y = 0; y < bmp1->GetHeight(); ++y)
+        for (int x = 0; x < bmp1->GetWidth(); ++x)
+            ASSERT_EQ(bmp1->GetPixel(x, y), bmp2->GetPixel(x, y)) << "at " << x << "," << y;
+}
+
+TEST(GUI, DrawRegion) {
+    std::vector<SpriteInfo> sprinfos;
+    SpriteCache spriteset(sprinfos, SpriteCache::Callbacks());
+    GUI::Context.Spriteset = &spriteset;
+
+    GUIMain gui;
+    gui.InitDefaults();
+    gui.ID = 0;
+    gui.Width = 64;
+    gui.Height = 48;
+    gui.BgColor = 0;
+    gui.FgColor = 0;
+    std::vector<std::unique_ptr<TestControl>> controls;
+    controls.emplace_back(new TestControl(0, 0, 20, 20, 0xFF0000FF, 0));
+    controls.emplace_back(new TestControl(10, 10, 20, 20, 0xFF00FF00, 1)); // overlaps first
+    controls.emplace_back(new TestControl(40, 30, 10, 10, 0xFFFF0000, 2));
+    for (size_t i = 0; i < controls.size(); ++i)
+    {
+        controls[i]->Id = i; // control's index in the parent GUI
+        gui.AddControl(kGUIButton, i, controls[i].get());
+    }
+    gui.ResortZOrder();
+
+    std::unique_ptr<Bitmap> ref(BitmapHelper::CreateTransparentBitmap(gui.Width, gui.Height, 32));
+    ASSERT_EQ(gui.DrawWithControls(ref.get()), 3);
+
+    // Redrawing a region restores it, and draws only the overlapping controls
+    std::unique_ptr<Bitmap> ds(BitmapHelper::CreateBitmapCopy(ref.get()));
+    ds->FillRect(RectWH(5, 5, 10, 10), 0xFFFFFFFF);
+    ASSERT_EQ(gui.DrawRegion(ds.get(), RectWH(5, 5, 10, 10)), 2);
+    AssertBitmapsEqual(ds.get(), ref.get());
+    ds->FillRect(RectWH(35, 0, 29, 48), 0xFFFFFFFF);
+    ASSERT_EQ(gui.DrawRegion(ds.get(), RectWH(35, 0, 29, 48)), 1);
+    AssertBitmapsEqual(ds.get(), ref.get());
+    // Regions are clipped by the surface
+    ds->FillRect(RectWH(50, 40, 14, 8), 0xFFFFFFFF);
+    ASSERT_EQ(gui.DrawRegion(ds.get(), RectWH(50, 40, 100, 100)), 0);
+    AssertBitmapsEqual(ds.get(), ref.get());
+    ASSERT_EQ(gui.DrawRegion(ds.get(), RectWH(-20, -20, 10, 10)), 0);
+    AssertBitmapsEqual(ds.get(), ref.get());
+
+    // Moved control is redrawn by updating its old and new areas
+    const Rect old_area = RectWH(controls[2]->X, controls[2]->Y, 10, 10);
+    controls[2]->X = 25;
+    controls[2]->Y = 5;
+    const Rect new_area = RectWH(controls[2]->X, controls[2]->Y, 10, 10);
+    ref->ClearTransparent();
+    gui.DrawWithControls(ref.get());
+    ASSERT_EQ(gui.DrawRegion(ds.get(), old_area), 0);
+    ASSERT_EQ(gui.DrawRegion(ds.get(), new_area), 2); // overlaps second control
+    AssertBitmapsEqual(ds.get(), ref.get());
+
+    GUI::Context.Spriteset = nullptr;
+}
+
+TEST(GUI, FindControlAt) {
+    // The GUI has to be registered in the game, for the controls to notify it
+    guis.resize(1);
+    GUIMain &gui = guis[0];
+    gui.InitDefaults();
+    gui.ID = 0;
+    gui.X = 10;
+    gui.Y = 20;
+    gui.Width = 320;
+    gui.Height = 240;
+    // Have enough controls for the GUI to use the controls grid
+    std::vector<std::unique_ptr<GUIObject>> controls;
+    for (int i = 0; i < 20; ++i)
+        controls.emplace_back(new TestControl((i % 5) * 40, (i / 5) * 40, 20, 20, 0, i));
+    controls.emplace_back(new TestControl(10, 10, 20, 20, 0, 20)); // overlaps first
+    GUIInvWindow *inv = new GUIInvWindow();
+    inv->X = 250;
+    inv->Y = 200;
+    inv->SetSize(10, 10);
+    controls.emplace_back(inv);
+    for (size_t i = 0; i < controls.size(); ++i)
+    {
+        controls[i]->ParentId = gui.ID;
+        controls[i]->Id = i; // control's index in the parent GUI
+        gui.AddControl(kGUIButton, i, controls[i].get());
+    }
+    gui.ResortZOrder();
+
+    // Coordinates are in the screen space, outside of controls there's none
+    ASSERT_EQ(gui.FindControlAt(gui.X + 45, gui.Y + 5, 0, false), 1);
+    ASSERT_EQ(gui.FindControlAt(gui.X + 165, gui.Y + 125, 0, false), 19);
+    ASSERT_EQ(gui.FindControlAt(gui.X + 25, gui.Y + 5, 0, false), -1);
+    ASSERT_EQ(gui.FindControlAt(gui.X + 300, gui.Y + 230, 0, false), -1);
+    ASSERT_EQ(gui.FindControlAt(gui.X - 5, gui.Y - 5, 0, false), -1);
+    // The topmost control is found where they overlap
+    ASSERT_EQ(gui.FindControlAt(gui.X + 15, gui.Y + 15, 0, false), 20);
+    ASSERT_EQ(gui.FindControlAt(gui.X + 5, gui.Y + 5, 0, false), 0);
+    ASSERT_EQ(gui.FindControlAt(gui.X + 255, gui.Y + 205, 0, false), 21);
+
+    // Moved and resized controls are found at their new place
+    controls[19]->X = 280;
+    controls[19]->MarkPositionChanged(false);
+    ASSERT_EQ(gui.FindControlAt(gui.X + 165, gui.Y + 125, 0, false), -1);
+    ASSERT_EQ(gui.FindControlAt(gui.X + 285, gui.Y + 125, 0, false), 19);
+    controls[18]->SetSize(60, 20);
+    ASSERT_EQ(gui.FindControlAt(gui.X + 165, gui.Y + 125, 0, false), 18);
+    inv->SetSize(60, 30);
+    ASSERT_EQ(gui.FindControlAt(gui.X + 300, gui.Y + 225, 0, false), 21);
+    inv->SetSize(5, 5);
+    ASSERT_EQ(gui.FindControlAt(gui.X + 257, gui.Y + 207, 0, false), -1);
+
+    guis.clear();
+}
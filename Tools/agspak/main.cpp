@@ -19,6 +19,8 @@ using namespace AGS::DataUtil;
 
 const char *HELP_STRING = "Usage: agspak <input-dir> <output-pak> [OPTIONS]\n"
 "Options:\n"
+"  -c <type>      compress assets: none, deflate (default: none);\n"
+"                 compressed packages require a newer engine to read\n"
 "  -p <MB>        split game assets between partitions of this size max\n"
 "  -r             recursive mode: include all subdirectories too";
 
@@ -44,9 +46,23 @@ int main(int argc, char *argv[])
 
     size_t part_size = 0;
     bool do_subdirs = false;
+    AssetCompression compress = kAssetCompress_None;
     for (int i = 3; i < argc; ++i)
     {
-        if (ags_stricmp(argv[i], "-p") == 0 && (i < argc - 1))
+        if (ags_stricmp(argv[i], "-c") == 0 && (i < argc - 1))
+        {
+            const char *type = argv[++i];
+            if (ags_stricmp(type, "none") == 0)
+                compress = kAssetCompress_None;
+            else if (ags_stricmp(type, "deflate") == 0)
+                compress = kAssetCompress_Deflate;
+            else
+            {
+                printf("Error: unknown compression type: %s\n", type);
+                return -1;
+            }
+        }
+        else if (ags_stricmp(argv[i], "-p") == 0 && (i < argc - 1))
             part_size = StrUtil::StringToInt(argv[++i]);
         else if (ags_stricmp(argv[i], "-r") == 0)
             do_subdirs = true;
@@ -83,6 +99,10 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    // Each asset is only stored compressed if that makes it smaller
+    for (auto &asset : assets)
+        asset.Compression = compress;
+
     AssetLibInfo lib;
     soff_t part_size_b = part_size * 1024 * 1024; // MB to bytes
     err = MakeAssetLib(lib, lib_basefile, assets, part_size_b);
@@ -97,7 +117,10 @@ int main(int argc, char *argv[])
     // Write pack file
     //-----------------------------------------------------------------------//
     String lib_dir = Path::GetParent(lib_basefile);
-    err = WriteLibrary(lib, asset_dir, lib_dir, MFLUtil::kMFLVersion_MultiV30);
+    // Only use the newer format if needed, for compatibility with older engines
+    const MFLUtil::MFLVersion lib_version = (compress != kAssetCompress_None) ?
+        MFLUtil::kMFLVersion_MultiV31 : MFLUtil::kMFLVersion_MultiV30;
+    err = WriteLibrary(lib, asset_dir, lib_dir, lib_version);
     if (!err)
     {
         printf("Error: failed to write pack file:\n");
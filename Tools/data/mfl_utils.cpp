@@ -13,8 +13,11 @@
 //=============================================================================
 #include "data/mfl_utils.h"
 #include <memory>
+#include "util/compressedframestream.h"
 #include "util/directory.h"
 #include "util/file.h"
+#include "util/memory_compat.h"
+#include "util/memorystream.h"
 #include "util/path.h"
 #include "util/stream.h"
 
@@ -58,13 +61,24 @@ HError UnpackLibrary(const AssetLibInfo &lib, const String &lib_dir, const Strin
                 printf("Error: unable to open a file for writing: %s\n", asset.FileName.GetCStr());
                 continue;
             }
-            lib_in->Seek(asset.Offset, kSeekBegin);
-            soff_t wrote = CopyStream(lib_in.get(), out.get(), asset.Size);
-            if (wrote == asset.Size)
+            soff_t wrote;
+            if (asset.Compression == kAssetCompress_None)
+            {
+                lib_in->Seek(asset.Offset, kSeekBegin);
+                wrote = CopyStream(lib_in.get(), out.get(), asset.Size);
+            }
+            else
+            {
+                Stream asset_in(std::make_unique<CompressedFrameStream>(
+                    File::OpenFile(path, asset.Offset, asset.Offset + asset.Size),
+                    asset.DataSize, asset.FrameSize));
+                wrote = asset_in.IsValid() ? CopyStream(&asset_in, out.get(), asset.DataSize) : 0;
+            }
+            if (wrote == asset.DataSize)
                 printf("+ %s\n", asset.FileName.GetCStr());
             else
                 printf("Error: file was not written correctly: %s\n Expected: %jd, wrote: %jd bytes\n",
-                    asset.FileName.GetCStr(), static_cast<intmax_t>(asset.Size), static_cast<intmax_t>(wrote));
+                    asset.FileName.GetCStr(), static_cast<intmax_t>(asset.DataSize), static_cast<intmax_t>(wrote));
         }
     }
     return HError::None();
@@ -85,6 +99,7 @@ HError MakeAssetList(std::vector<AssetInfo> &assets, const String &asset_dir,
         asset.FileName = ff.Current();
         Path::ConcatPaths(fpath, parent, asset.FileName);
         asset.Size = File::GetFileSize(fpath);
+        asset.DataSize = asset.Size;
         assets.push_back(asset);
     }
     return HError::None();
@@ -147,7 +162,8 @@ HError WriteLibraryFile(AssetLibInfo &lib, const String &asset_dir,
         return new Error("Error: failed to open pack file for writing.");
 
     soff_t s_offset = out->GetPosition();
-    MFLUtil::WriteHeader(lib, MFLUtil::kMFLVersion_MultiV30, lib_index, out.get());
+    MFLUtil::WriteHeader(lib, lib_version, lib_index, out.get());
+    std::vector<uint8_t> packed;
     for (auto &asset : lib.AssetInfos)
     {
         if (asset.LibUid == lib_index)
@@ -157,12 +173,34 @@ HError WriteLibraryFile(AssetLibInfo &lib, const String &asset_dir,
             std::unique_ptr<Stream> in(File::OpenFileRead(path));
             if (!in)
                 return new Error("Failed to open the file for reading.");
+            if ((asset.Compression != kAssetCompress_None) && (asset.DataSize > 0))
+            {
+                if (lib_version < MFLUtil::kMFLVersion_MultiV31)
+                    return new Error("Asset compression is not supported by the requested library format.");
+                // Compress in memory first, and only keep compressed data if it's actually smaller
+                packed.clear();
+                Stream packed_out(std::make_unique<VectorStream>(packed, kStream_Write));
+                const uint32_t frame_size = asset.FrameSize > 0 ? asset.FrameSize : CompressedFrameStream::DefaultFrameSize;
+                if (!CompressedFrameStream::Compress(in.get(), asset.DataSize, frame_size, &packed_out))
+                    return new Error(String::FromFormat("Failed to compress the asset '%s'.", asset.FileName.GetCStr()));
+                if (static_cast<soff_t>(packed.size()) < asset.DataSize)
+                {
+                    out->Write(packed.data(), packed.size());
+                    asset.Size = packed.size();
+                    asset.FrameSize = frame_size;
+                    continue;
+                }
+                asset.Compression = kAssetCompress_None;
+                in->Seek(0, kSeekBegin);
+            }
+            asset.Size = asset.DataSize;
+            asset.FrameSize = 0;
             if (CopyStream(in.get(), out.get(), asset.Size) < asset.Size)
                 return new Error(String::FromFormat("Failed to write the asset '%s'.", asset.FileName.GetCStr()));
         }
     }
     out->Seek(s_offset, kSeekBegin);
-    MFLUtil::WriteHeader(lib, MFLUtil::kMFLVersion_MultiV30, lib_index, out.get());
+    MFLUtil::WriteHeader(lib, lib_version, lib_index, out.get());
     out->Seek(0, kSeekEnd);
     MFLUtil::WriteEnder(s_offset, lib_version, out.get());
     return HError::None();
@@ -171,8 +209,12 @@ HError WriteLibraryFile(AssetLibInfo &lib, const String &asset_dir,
 HError WriteLibrary(AssetLibInfo &lib, const String &asset_dir,
     const String &dst_dir, MFLUtil::MFLVersion lib_version)
 {
-    for (size_t id = 0; id < lib.LibFileNames.size(); ++id)
+    // The first part contains the table of contents for all the parts,
+    // so it has to be written last, when every asset's offset and
+    // (possibly compressed) size are already known.
+    for (size_t i = 1; i <= lib.LibFileNames.size(); ++i)
     {
+        const size_t id = i % lib.LibFileNames.size();
         String dst_file = Path::ConcatPaths(dst_dir, lib.LibFileNames[id]);
         HError err = WriteLibraryFile(lib, asset_dir, dst_file, lib_version, id);
         if (!err)
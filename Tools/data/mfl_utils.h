@@ -44,6 +44,8 @@ namespace DataUtil
         std::vector<AssetInfo> &assets, soff_t part_size = 0);
     // Writes the library partition into the file lib_filename;
     // recalculates asset offsets and stores in lib as it goes.
+    // The first partition (lib_index 0) holds the table of contents for the
+    // whole library, so it must be written after all the other ones.
     HError WriteLibraryFile(AssetLibInfo &lib, const String &src_dir,
         const String &lib_filename, AGS::Common::MFLUtil::MFLVersion lib_version, int lib_index);
     // Writes the potentially multi-file library into the dst_dir directory;
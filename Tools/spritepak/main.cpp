@@ -0,0 +1,193 @@
+//-----------------------------------------------------------------------//
+// TODO:
+// * option for writing sprites in a different storage format
+//   (i.e. converting to a different color depth)
+//-----------------------------------------------------------------------//
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include "ac/spritefile.h"
+#include "gfx/bitmap.h"
+#include "util/file.h"
+#include "util/path.h"
+#include "util/stdio_compat.h"
+#include "util/string_compat.h"
+#include "util/string_utils.h"
+
+using namespace AGS::Common;
+
+// Common's Bitmap requires the program to provide a palette color conversion;
+// we never draw anything here, so a plain value copy is enough.
+void __my_setcolor(int *ctset, int newcol, int /*wantColDep*/)
+{
+    ctset[0] = newcol;
+}
+
+const char *HELP_STRING = "Usage: spritepak <input-spr> <output-spr> [OPTIONS]\n"
+"Options:\n"
+"  -c <type>      compression: none, rle, lzw, deflate (default: keep)\n"
+"  -i <index>     input sprite index file (default: look for sprindex.dat\n"
+"                 next to the input sprite file)\n"
+"  -o             optimize for size: store sprites as paletted images,\n"
+"                 if that results in less data\n"
+"  -O             do not optimize for size, even if input file did\n"
+"  -t <threads>   number of worker threads (default: all hardware threads)\n"
+"  -x <index>     also write the sprite index file";
+
+static bool ParseCompression(const char *name, SpriteCompression &compress)
+{
+    if (ags_stricmp(name, "none") == 0)
+        compress = kSprCompress_None;
+    else if (ags_stricmp(name, "rle") == 0)
+        compress = kSprCompress_RLE;
+    else if (ags_stricmp(name, "lzw") == 0)
+        compress = kSprCompress_LZW;
+    else if (ags_stricmp(name, "deflate") == 0)
+        compress = kSprCompress_Deflate;
+    else
+        return false;
+    return true;
+}
+
+static const char *GetCompressionName(SpriteCompression compress)
+{
+    switch (compress)
+    {
+    case kSprCompress_None: return "none";
+    case kSprCompress_RLE: return "rle";
+    case kSprCompress_LZW: return "lzw";
+    case kSprCompress_Deflate: return "deflate";
+    default: return "unknown";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    printf("spritepak v0.1.0 - AGS sprite file repacking tool\n"\
+        "Copyright (c) 2024 AGS Team and contributors\n");
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        if (ags_stricmp(arg, "--help") == 0 || ags_stricmp(arg, "/?") == 0 || ags_stricmp(arg, "-?") == 0)
+        {
+            printf("%s\n", HELP_STRING);
+            return 0; // display help and bail out
+        }
+    }
+    if (argc < 3)
+    {
+        printf("Error: not enough arguments\n");
+        printf("%s\n", HELP_STRING);
+        return -1;
+    }
+
+    const char *src = argv[1];
+    const char *dst = argv[2];
+    String src_index;
+    String dst_index;
+    bool set_compress = false;
+    SpriteCompression compress = kSprCompress_None;
+    int set_store_flags = -1;
+    size_t num_threads = 0;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (ags_stricmp(argv[i], "-c") == 0 && (i < argc - 1))
+        {
+            if (!ParseCompression(argv[++i], compress))
+            {
+                printf("Error: unknown compression type: %s\n", argv[i]);
+                return -1;
+            }
+            set_compress = true;
+        }
+        else if (ags_stricmp(argv[i], "-i") == 0 && (i < argc - 1))
+            src_index = argv[++i];
+        else if (strcmp(argv[i], "-o") == 0)
+            set_store_flags = kSprStore_OptimizeForSize;
+        else if (strcmp(argv[i], "-O") == 0)
+            set_store_flags = 0;
+        else if (ags_stricmp(argv[i], "-t") == 0 && (i < argc - 1))
+        {
+            const int threads = StrUtil::StringToInt(argv[++i]);
+            if (threads < 1)
+            {
+                printf("Error: invalid number of threads: %s\n", argv[i]);
+                return -1;
+            }
+            num_threads = static_cast<size_t>(threads);
+        }
+        else if (ags_stricmp(argv[i], "-x") == 0 && (i < argc - 1))
+            dst_index = argv[++i];
+        else
+        {
+            printf("Error: unknown option or missing option value: %s\n", argv[i]);
+            printf("%s\n", HELP_STRING);
+            return -1;
+        }
+    }
+    if (src_index.IsEmpty())
+        src_index = Path::ConcatPaths(Path::GetParent(src), SpriteFile::DefaultSpriteIndexName);
+
+    printf("Input sprite file: %s\n", src);
+    printf("Output sprite file: %s\n", dst);
+
+    //-----------------------------------------------------------------------//
+    // Open the input sprite file
+    //-----------------------------------------------------------------------//
+    auto in = File::OpenFileRead(src);
+    if (!in)
+    {
+        printf("Error: failed to open the input sprite file.\n");
+        return -1;
+    }
+    // sprite index is optional, the file will be scanned if index is missing
+    auto in_index = File::OpenFileRead(src_index);
+    SpriteFile sprite_file;
+    std::vector<Size> metrics;
+    HError err = sprite_file.OpenFile(std::move(in), std::move(in_index), metrics);
+    if (!err)
+    {
+        printf("Error: failed to read the input sprite file:\n");
+        printf("%s\n", err->FullMessage().GetCStr());
+        return -1;
+    }
+
+    if (!set_compress)
+        compress = sprite_file.GetSpriteCompression();
+    const int store_flags = set_store_flags >= 0 ? set_store_flags : sprite_file.GetStoreFlags();
+    printf("Sprites: %d, input compression: %s, output compression: %s\n",
+        sprite_file.GetTopmostSprite() + 1,
+        GetCompressionName(sprite_file.GetSpriteCompression()), GetCompressionName(compress));
+
+    //-----------------------------------------------------------------------//
+    // Write the output sprite file
+    //-----------------------------------------------------------------------//
+    // Nothing is loaded in memory here, SaveSpriteFile will either
+    // copy the sprites' raw data or load and repack them, as necessary.
+    std::vector<std::pair<bool, Bitmap*>> sprites(metrics.size());
+    for (size_t i = 0; i < metrics.size(); ++i)
+        sprites[i] = std::make_pair(!metrics[i].IsNull(), nullptr);
+
+    const auto time_start = std::chrono::steady_clock::now();
+    SpriteFileIndex index;
+    if (SaveSpriteFile(dst, sprites, &sprite_file, store_flags, compress, index, num_threads) != 0)
+    {
+        printf("Error: failed to write the output sprite file.\n");
+        return -1;
+    }
+    const auto time_spent = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - time_start);
+    printf("Sprite file written in %lld ms.\n", static_cast<long long>(time_spent.count()));
+
+    if (!dst_index.IsEmpty())
+    {
+        if (SaveSpriteIndex(dst_index, index) != 0)
+        {
+            printf("Error: failed to write the sprite index file.\n");
+            return -1;
+        }
+        printf("Sprite index file written: %s\n", dst_index.GetCStr());
+    }
+    printf("Done.\n");
+    return 0;
+}
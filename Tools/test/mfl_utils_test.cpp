@@ -0,0 +1,110 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-2024 various contributors
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// https://opensource.org/license/artistic-2-0/
+//
+//=============================================================================
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "core/asset.h"
+#include "core/platform.h"
+#include "data/mfl_utils.h"
+#include "util/compressedframestream.h"
+#include "util/file.h"
+#include "util/memory_compat.h"
+#include "util/multifilelib.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+using namespace AGS::DataUtil;
+
+#if (AGS_PLATFORM_TEST_FILE_IO)
+
+static const char *LibFile = "mfltest.ags";
+static const char *LibPartFiles[] = { "mfltest.ags", "mfltest.001", "mfltest.002" };
+static const char *AssetFiles[] = { "mfltest0.dat", "mfltest1.dat", "mfltest2.dat" };
+static const size_t AssetCount = sizeof(AssetFiles) / sizeof(AssetFiles[0]);
+
+class MFLUtilsTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        for (const char *f : LibPartFiles)
+            File::DeleteFile(f);
+        for (const char *f : AssetFiles)
+            File::DeleteFile(f);
+    }
+};
+
+// Makes a well compressible asset, which takes more than one compressed frame
+static std::vector<uint8_t> MakeAssetData(size_t index)
+{
+    std::vector<uint8_t> data(CompressedFrameStream::DefaultFrameSize + 10000 * (index + 1));
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<uint8_t>((i / 64) * (index + 3));
+    return data;
+}
+
+TEST_F(MFLUtilsTest, MultiPartCompressedLibrary) {
+    std::vector<AssetInfo> assets;
+    for (size_t i = 0; i < AssetCount; ++i)
+    {
+        const auto data = MakeAssetData(i);
+        auto out = File::CreateFile(AssetFiles[i]);
+        ASSERT_TRUE(out);
+        out->Write(data.data(), data.size());
+        AssetInfo asset;
+        asset.FileName = AssetFiles[i];
+        asset.Size = data.size();
+        asset.DataSize = data.size();
+        asset.Compression = kAssetCompress_Deflate;
+        assets.push_back(asset);
+    }
+
+    // A tiny part size puts every asset into its own part
+    AssetLibInfo lib;
+    ASSERT_TRUE(MakeAssetLib(lib, LibFile, assets, 1));
+    ASSERT_EQ(lib.LibFileNames.size(), AssetCount);
+    ASSERT_TRUE(WriteLibrary(lib, ".", ".", MFLUtil::kMFLVersion_MultiV31));
+
+    // Read the table of contents back from the first part
+    AssetLibInfo read_lib;
+    {
+        auto in = File::OpenFileRead(LibFile);
+        ASSERT_TRUE(in);
+        ASSERT_EQ(MFLUtil::ReadHeader(read_lib, in.get()), MFLUtil::kMFLNoError);
+    }
+    ASSERT_EQ(read_lib.LibFileNames.size(), AssetCount);
+    ASSERT_EQ(read_lib.AssetInfos.size(), AssetCount);
+    for (const auto &asset : read_lib.AssetInfos)
+    {
+        size_t index = AssetCount;
+        for (size_t i = 0; i < AssetCount; ++i)
+            if (asset.FileName.CompareNoCase(AssetFiles[i]) == 0)
+                index = i;
+        ASSERT_LT(index, AssetCount);
+        const auto data = MakeAssetData(index);
+        ASSERT_EQ(asset.Compression, kAssetCompress_Deflate);
+        ASSERT_GT(asset.FrameSize, 0u);
+        ASSERT_EQ(asset.DataSize, static_cast<soff_t>(data.size()));
+        ASSERT_LT(asset.Size, asset.DataSize);
+
+        const String part_file = read_lib.LibFileNames[asset.LibUid];
+        Stream in(std::make_unique<CompressedFrameStream>(
+            File::OpenFile(part_file, asset.Offset, asset.Offset + asset.Size),
+            asset.DataSize, asset.FrameSize));
+        ASSERT_TRUE(in.IsValid());
+        std::vector<uint8_t> read_data(data.size());
+        ASSERT_EQ(in.Read(read_data.data(), read_data.size()), read_data.size());
+        ASSERT_EQ(read_data, data);
+    }
+}
+
+#endif // AGS_PLATFORM_TEST_FILE_IO